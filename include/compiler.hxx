@@ -85,4 +85,36 @@ constexpr inline bool AARCH64 = true;
 constexpr inline bool AARCH64 = false;
 #endif
 
+#ifdef __powerpc64__
+/// Whether we're sitting on 64-bit PowerPC
+#	define COSMOS_PPC64
+constexpr inline bool PPC64 = true;
+#else
+constexpr inline bool PPC64 = false;
+#endif
+
+#if defined(__powerpc__) && !defined(__powerpc64__)
+/// Whether we're sitting on 32-bit PowerPC
+#	define COSMOS_PPC
+constexpr inline bool PPC = true;
+#else
+constexpr inline bool PPC = false;
+#endif
+
+#ifdef __mips64
+/// Whether we're sitting on 64-bit MIPS
+#	define COSMOS_MIPS64
+constexpr inline bool MIPS64 = true;
+#else
+constexpr inline bool MIPS64 = false;
+#endif
+
+#if defined(__mips__) && !defined(__mips64)
+/// Whether we're sitting on 32-bit MIPS
+#	define COSMOS_MIPS
+constexpr inline bool MIPS = true;
+#else
+constexpr inline bool MIPS = false;
+#endif
+
 } // end ns
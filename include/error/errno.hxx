@@ -100,6 +100,7 @@ enum class Errno : int { // errnos are distinct positive `int` values says `man
 	READ_ONLY_FS          = EROFS,
 	IS_PIPE               = ESPIPE,          ///< device does not support seek (e.g. a pipe)
 	SEARCH                = ESRCH,           ///< no such process
+	STALE                 = ESTALE,          ///< stale file handle (e.g. the object no longer exists)
 	TIMER                 = ETIME,           ///< time expired
 	TIMEDOUT              = ETIMEDOUT,       ///< connection timed out
 	WOULD_BLOCK           = EWOULDBLOCK,     ///< operation would block
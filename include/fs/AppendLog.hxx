@@ -0,0 +1,174 @@
+#pragma once
+
+// C++
+#include <exception>
+#include <string_view>
+
+// cosmos
+#include <cosmos/dso_export.h>
+#include <cosmos/fs/File.hxx>
+#include <cosmos/io/iovector.hxx>
+#include <cosmos/thread/Condition.hxx>
+
+namespace cosmos {
+
+/// Append-only log file with group commit for concurrent writers.
+/**
+ * This type is intended for write-ahead logs and similar files where each
+ * appended record needs to be durable before the caller continues.
+ * Syncing every single record individually limits throughput to the
+ * latency of the storage device. Instead this type implements a group
+ * commit: concurrent callers of append() queue their records, and one of
+ * them becomes the flusher which writes all queued records using a single
+ * pwritev2() call followed by a single fdatasync() (or uses
+ * ReadWriteFlag::DSYNC). All callers of the batch are released together
+ * once it is durable. Thus throughput scales with the number of
+ * concurrent writers instead of being bound by disk latency.
+ *
+ * No copy of the record data is made. The caller's buffer needs to stay
+ * valid only for the duration of the append() call, since append() only
+ * returns once the data has been written.
+ *
+ * Records are written in the order in which they were enqueued. If a
+ * write or sync fails then the error is reported to all callers of the
+ * affected batch and the log enters a sticky error state: all further
+ * operations rethrow the original error, since it is not known which
+ * data actually reached the storage.
+ *
+ * Additionally preallocate() allows to reserve disk space ahead of time to
+ * avoid fragmentation and costly block allocation during commits.
+ * setWritebackThreshold() enables early writeback of written data via
+ * sync_file_range(), which is useful with SyncMode::NONE to limit the
+ * amount of dirty data and to keep a later sync() short.
+ **/
+class COSMOS_API AppendLog {
+public: // types
+
+	/// Determines how durability is achieved for each batch.
+	enum class SyncMode {
+		/// Write the batch, then call FileDescriptor::dataSync().
+		DATA_SYNC,
+		/// Write the batch using ReadWriteFlag::DSYNC, saving a separate system call.
+		DSYNC_WRITE,
+		/// Don't sync, append() returns once the data has been written to the page cache.
+		NONE
+	};
+
+	/// Statistics about the operation of the log.
+	struct Stats {
+		/// Number of records appended.
+		size_t records = 0;
+		/// Number of batches written (i.e. number of syncs in the syncing modes).
+		size_t batches = 0;
+		/// Number of bytes appended.
+		size_t bytes = 0;
+	};
+
+public: // functions
+
+	/// Create an AppendLog operating on the given file.
+	/**
+	 * The file needs to be open for writing. Records will be appended
+	 * starting at the current end of the file.
+	 **/
+	explicit AppendLog(File &&file, const SyncMode mode = SyncMode::DATA_SYNC);
+
+	AppendLog(const AppendLog&) = delete;
+	AppendLog& operator=(const AppendLog&) = delete;
+
+	/// Append a record to the log and wait until it is durable.
+	/**
+	 * This call is thread safe. The returned value is the file offset
+	 * at which the record has been written.
+	 *
+	 * On error an ApiError is thrown as documented for
+	 * StreamIO::writeAtPos() and FileDescriptor::dataSync().
+	 **/
+	off_t append(const void *data, const size_t length);
+
+	/// string_view wrapper around append(const void*, const size_t).
+	off_t append(const std::string_view data) {
+		return append(data.data(), data.size());
+	}
+
+	/// Make all data appended so far durable.
+	/**
+	 * This is mostly useful with SyncMode::NONE.
+	 **/
+	void sync();
+
+	/// Reserve disk space for `length` bytes beyond the current end of the log.
+	/**
+	 * This uses FileDescriptor::allocate() with
+	 * FileDescriptor::AllocateFlag::KEEP_SIZE, thus the
+	 * visible file size is not changed. On error an ApiError is thrown,
+	 * Errno::OP_NOT_SUPPORTED means that the file system does not
+	 * support preallocation.
+	 **/
+	void preallocate(const off_t length);
+
+	/// Initiate writeback of newly written data every `bytes` bytes.
+	/**
+	 * After each batch, once at least `bytes` have been written since the
+	 * last writeback, sync_file_range() is used to asynchronously start
+	 * writeback of the new data range. This doesn't guarantee
+	 * durability. A value of zero disables this feature (the default).
+	 **/
+	void setWritebackThreshold(const size_t bytes);
+
+	/// Returns the offset at which the next record will be written.
+	off_t tail() const;
+
+	/// Returns a snapshot of the current statistics.
+	Stats stats() const;
+
+	/// Returns the underlying file.
+	const File& file() const {
+		return m_file;
+	}
+
+protected: // functions
+
+	/// Wait until record `seq` has been completed, acting as flusher if necessary.
+	/**
+	 * Must be called with m_cond locked.
+	 **/
+	void waitFor(const size_t seq);
+
+	/// Write out the given batch starting at `offset` and sync it as configured.
+	/**
+	 * Returns the end offset of the written data.
+	 **/
+	off_t writeBatch(WriteIOVector &batch, off_t offset);
+
+	/// Start asynchronous writeback up to `end` if `threshold` bytes are pending.
+	void checkWriteback(const off_t end, const size_t threshold);
+
+protected: // data
+
+	File m_file;
+	const SyncMode m_sync_mode;
+	/// Protects the following members, unless noted otherwise.
+	ConditionMutex m_cond;
+	/// Records enqueued but not yet handed to a flusher.
+	WriteIOVector m_queue;
+	/// Sequence number of the last enqueued record.
+	size_t m_enqueued = 0;
+	/// Sequence number of the last record that has been written (and synced).
+	size_t m_completed = 0;
+	/// Whether a flusher is currently active.
+	bool m_flushing = false;
+	/// Offset at which the next enqueued record will be placed.
+	off_t m_tail = 0;
+	/// Offset at which the next batch will be written.
+	off_t m_flush_offset = 0;
+	/// Sticky error from a failed batch.
+	std::exception_ptr m_error;
+	/// Threshold for sync_file_range() writeback, zero if disabled.
+	size_t m_writeback_threshold = 0;
+	/// Start of the range not yet handed to sync_file_range() (only accessed by the flusher).
+	off_t m_writeback_offset = 0;
+	Stats m_stats;
+};
+
+} // end ns
@@ -0,0 +1,159 @@
+#pragma once
+
+// C++
+#include <optional>
+
+// cosmos
+#include <cosmos/fs/DirFD.hxx>
+#include <cosmos/fs/File.hxx>
+#include <cosmos/io/iovector.hxx>
+#include <cosmos/memory.hxx>
+#include <cosmos/SysString.hxx>
+
+namespace cosmos {
+
+/// File objects for direct I/O bypassing the page cache.
+/**
+ * Files of this type are always opened with OpenFlag::DIRECT. Direct I/O
+ * imposes alignment requirements on the memory buffers, file offsets and
+ * transfer lengths used in read and write operations. These requirements
+ * depend on the file system and underlying block device. When opening the
+ * file they are queried via `statx()` with STATX_DIOALIGN and made
+ * available via alignment().
+ *
+ * On kernels that don't support STATX_DIOALIGN (before Linux 6.1), or
+ * for file systems that don't report it, the page size is used as a
+ * conservative fallback for both memory and offset alignment.
+ *
+ * Suitably aligned buffers are obtained via allocateBuffer(). The
+ * positional I/O functions readAligned() and writeAligned() validate the
+ * alignment of their parameters and throw a UsageError on violation,
+ * instead of having the kernel return a generic Errno::INVALID_ARG. The
+ * I/O functions inherited from StreamIO (including readAtPos() and
+ * writeAtPos()) are still available but perform no such validation. This
+ * also applies to any I/O performed through a `File&` or `StreamIO&`
+ * reference to a DirectFile.
+ **/
+class COSMOS_API DirectFile :
+		public File {
+public: // types
+
+	/// Alignment requirements for direct I/O.
+	struct Alignment {
+		/// Required alignment of memory buffers in bytes.
+		size_t memory = 0;
+		/// Required alignment of file offsets and transfer lengths in bytes.
+		size_t offset = 0;
+	};
+
+public: // functions
+
+	DirectFile() = default;
+
+	/// Open the given path for direct I/O.
+	/**
+	 * OpenFlag::DIRECT is implicitly added to `flags`. Besides the errors
+	 * documented for File::open(), Errno::INVALID_ARG will be thrown if
+	 * the file system does not support direct I/O.
+	 **/
+	DirectFile(const SysString path, const OpenMode mode,
+			const OpenFlags flags = {OpenFlag::CLOEXEC}, const std::optional<FileMode> fmode = {}) {
+		open(path, mode, flags, fmode);
+	}
+
+	/// Open the given path relative to `dir_fd` for direct I/O.
+	DirectFile(const DirFD dir_fd, const SysString path, const OpenMode mode,
+			const OpenFlags flags = {OpenFlag::CLOEXEC}, const std::optional<FileMode> fmode = {}) {
+		open(dir_fd, path, mode, flags, fmode);
+	}
+
+	/// Wrap the given file descriptor for direct I/O.
+	/**
+	 * If `fd` does not already have OpenFlag::DIRECT set then it will be
+	 * added via FileDescriptor::setStatusFlags().
+	 **/
+	DirectFile(const FileDescriptor fd, const AutoCloseFD auto_close) {
+		open(fd, auto_close);
+	}
+
+	DirectFile(DirectFile &&other) noexcept {
+		*this = std::move(other);
+	}
+
+	DirectFile& operator=(DirectFile &&other) noexcept {
+		m_alignment = other.m_alignment;
+		other.m_alignment = Alignment{};
+		File::operator=(std::move(other));
+		return *this;
+	}
+
+	/// \see DirectFile(const SysString, const OpenMode, const OpenFlags, const std::optional<FileMode>).
+	void open(const SysString path, const OpenMode mode,
+			const OpenFlags flags = {OpenFlag::CLOEXEC}, const std::optional<FileMode> fmode = {});
+
+	/// \see DirectFile(const DirFD, const SysString, const OpenMode, const OpenFlags, const std::optional<FileMode>).
+	void open(const DirFD dir_fd, const SysString path, const OpenMode mode,
+			const OpenFlags flags = {OpenFlag::CLOEXEC}, const std::optional<FileMode> fmode = {});
+
+	/// \see DirectFile(const FileDescriptor, const AutoCloseFD).
+	void open(const FileDescriptor fd, const AutoCloseFD auto_close);
+
+	void close() override {
+		m_alignment = Alignment{};
+		File::close();
+	}
+
+	/// Returns the alignment requirements for the currently open file.
+	const Alignment& alignment() const {
+		return m_alignment;
+	}
+
+	/// Rounds `length` up to the next multiple of the offset alignment.
+	size_t alignedLength(const size_t length) const {
+		const auto align = m_alignment.offset;
+		return (length + align - 1) & ~(align - 1);
+	}
+
+	/// Allocate a buffer suitable for direct I/O on this file.
+	/**
+	 * The returned buffer will be aligned according to the memory
+	 * alignment requirements and its size will be `size` rounded up to
+	 * the offset alignment requirements.
+	 **/
+	AlignedBuffer allocateBuffer(const size_t size) const;
+
+	/// Checks whether the given I/O parameters satisfy the alignment requirements.
+	bool isAligned(const void *buf, const size_t length, const off_t offset) const;
+
+	/// Like isAligned() but throws a UsageError describing the violation.
+	void checkAligned(const void *buf, const size_t length, const off_t offset) const;
+
+	/// Validated variant of StreamIO::readAtPos(void*, size_t, off_t).
+	size_t readAligned(void *buf, size_t length, off_t offset) {
+		checkAligned(buf, length, offset);
+		return readAtPos(buf, length, offset);
+	}
+
+	/// Validated variant of StreamIO::writeAtPos(const void*, size_t, off_t).
+	size_t writeAligned(const void *buf, size_t length, off_t offset) {
+		checkAligned(buf, length, offset);
+		return writeAtPos(buf, length, offset);
+	}
+
+	/// Validated variant of StreamIO::readAtPos(ReadIOVector&, off_t, const ReadWriteFlags).
+	bool readAligned(ReadIOVector &iovec, off_t offset, const ReadWriteFlags flags = {});
+
+	/// Validated variant of StreamIO::writeAtPos(WriteIOVector&, off_t, const ReadWriteFlags).
+	bool writeAligned(WriteIOVector &iovec, off_t offset, const ReadWriteFlags flags = {});
+
+protected: // functions
+
+	/// Queries the alignment requirements for the currently open file.
+	void queryAlignment();
+
+protected: // data
+
+	Alignment m_alignment;
+};
+
+} // end ns
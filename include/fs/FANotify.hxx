@@ -0,0 +1,446 @@
+#pragma once
+
+// C++
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Linux
+#include <sys/fanotify.h>
+#include <sys/statfs.h>
+
+// cosmos
+#include <cosmos/BitMask.hxx>
+#include <cosmos/dso_export.h>
+#include <cosmos/error/errno.hxx>
+#include <cosmos/fs/DirFD.hxx>
+#include <cosmos/fs/File.hxx>
+#include <cosmos/fs/FileHandle.hxx>
+#include <cosmos/fs/types.hxx>
+#include <cosmos/proc/types.hxx>
+#include <cosmos/SysString.hxx>
+
+namespace cosmos {
+
+/// Efficient file system monitoring via the Linux fanotify API.
+/**
+ * Compared to INotify this API allows to monitor complete mounts or file
+ * systems with a single mark, instead of requiring a watch for every
+ * single directory. This scales to very large trees without the kernel
+ * memory overhead of per-directory watches.
+ *
+ * In the classical mode of operation every event carries an open file
+ * descriptor for the affected object. When one of the InitFlag::REPORT_*
+ * flags is used instead, then events carry file handles (see FileHandle)
+ * that identify the affected object and/or its parent directory plus the
+ * name of the directory entry. This mode is required for directory entry
+ * events like EventType::CREATE and is the mode of choice for tracking
+ * changes in large trees. File handles can be resolved into open file
+ * descriptors via FileHandle::open(), which needs CAP_DAC_READ_SEARCH.
+ *
+ * Events are read from the kernel in batches into an internal buffer of
+ * configurable size. `readEvent()` returns views (`Event`) into this
+ * buffer one by one, a new system call is only performed once the buffer
+ * has been fully consumed.
+ *
+ * Most features of fanotify require the CAP_SYS_ADMIN capability. Since
+ * Linux 5.13 an unprivileged subset is available: only MarkType::INODE
+ * marks, no permission events and one of the InitFlag::REPORT_*FID flags
+ * is required.
+ **/
+class COSMOS_API FANotify {
+public: // types
+
+	/// Flags provided at construction time.
+	enum class InitFlag : unsigned int {
+		/// Set the close-on-exec flag on the fanotify file descriptor.
+		CLOEXEC           = FAN_CLOEXEC,
+		/// Use non-blocking mode for the fanotify file descriptor.
+		NONBLOCK          = FAN_NONBLOCK,
+		/// Receive permission events before file content is accessed.
+		CLASS_CONTENT     = FAN_CLASS_CONTENT,
+		/// Receive permission events before file content is available.
+		CLASS_PRE_CONTENT = FAN_CLASS_PRE_CONTENT,
+		/// Don't limit the event queue size (requires CAP_SYS_ADMIN).
+		UNLIMITED_QUEUE   = FAN_UNLIMITED_QUEUE,
+		/// Don't limit the number of marks (requires CAP_SYS_ADMIN).
+		UNLIMITED_MARKS   = FAN_UNLIMITED_MARKS,
+		/// Allow audit records for permission events.
+		ENABLE_AUDIT      = FAN_ENABLE_AUDIT,
+		/// Report a pidfd for the process that caused an event.
+		REPORT_PIDFD      = FAN_REPORT_PIDFD,
+		/// Report thread IDs instead of process IDs.
+		REPORT_TID        = FAN_REPORT_TID,
+		/// Report file handles for the affected object instead of file descriptors.
+		REPORT_FID        = FAN_REPORT_FID,
+		/// Report file handles for the parent directory of the affected object.
+		REPORT_DIR_FID    = FAN_REPORT_DIR_FID,
+		/// Report the directory entry name, requires REPORT_DIR_FID.
+		REPORT_NAME       = FAN_REPORT_NAME,
+		/// Combination of REPORT_DIR_FID and REPORT_NAME.
+		REPORT_DFID_NAME  = FAN_REPORT_DFID_NAME,
+		/// Report the file handle of the directory entry's target, requires REPORT_DFID_NAME and REPORT_FID.
+		REPORT_TARGET_FID = FAN_REPORT_TARGET_FID,
+	};
+
+	using InitFlags = BitMask<InitFlag>;
+
+	/// Event types that can be monitored and reported.
+	enum class EventType : uint64_t {
+		/// File was accessed (read).
+		ACCESS         = FAN_ACCESS,
+		/// File was modified (written).
+		MODIFY         = FAN_MODIFY,
+		/// Metadata changed.
+		ATTRIB         = FAN_ATTRIB,
+		/// Writable file was closed.
+		CLOSE_WRITE    = FAN_CLOSE_WRITE,
+		/// Read-only file was closed.
+		CLOSE_NOWRITE  = FAN_CLOSE_NOWRITE,
+		/// Combination of CLOSE_WRITE and CLOSE_NOWRITE.
+		CLOSED         = FAN_CLOSE,
+		/// File or directory was opened.
+		OPEN           = FAN_OPEN,
+		/// File was opened for execution.
+		OPEN_EXEC      = FAN_OPEN_EXEC,
+		/// Entry was moved out of a directory (REPORT_*FID modes only).
+		MOVED_FROM     = FAN_MOVED_FROM,
+		/// Entry was moved into a directory (REPORT_*FID modes only).
+		MOVED_TO       = FAN_MOVED_TO,
+		/// Combination of MOVED_FROM and MOVED_TO.
+		MOVED          = FAN_MOVE,
+		/// Entry was renamed, old and new names are reported in one event (REPORT_*FID modes only).
+		RENAME         = FAN_RENAME,
+		/// Entry was created in a directory (REPORT_*FID modes only).
+		CREATE         = FAN_CREATE,
+		/// Entry was deleted from a directory (REPORT_*FID modes only).
+		DELETE         = FAN_DELETE,
+		/// The marked object itself was deleted (REPORT_*FID modes only).
+		DELETE_SELF    = FAN_DELETE_SELF,
+		/// The marked object itself was moved (REPORT_*FID modes only).
+		MOVE_SELF      = FAN_MOVE_SELF,
+		/// A file system error was detected (MarkType::FILESYSTEM only).
+		FS_ERROR       = FAN_FS_ERROR,
+		/// Permission to open a file is requested.
+		OPEN_PERM      = FAN_OPEN_PERM,
+		/// Permission to read a file is requested.
+		ACCESS_PERM    = FAN_ACCESS_PERM,
+		/// Permission to open a file for execution is requested.
+		OPEN_EXEC_PERM = FAN_OPEN_EXEC_PERM,
+		/// Event queue overflow, events have been lost (reported only).
+		QUEUE_OVERFLOW = FAN_Q_OVERFLOW,
+		/// Report events for direct children of a marked directory.
+		ON_CHILD       = FAN_EVENT_ON_CHILD,
+		/// Also report events for directories, in events: the object is a directory.
+		ON_DIR         = FAN_ONDIR,
+	};
+
+	using EventTypes = BitMask<EventType>;
+
+	/// The kind of object a mark is placed on.
+	enum class MarkType : unsigned int {
+		/// Only the given file or directory is monitored.
+		INODE      = FAN_MARK_INODE,
+		/// The complete mount the given path belongs to is monitored.
+		MOUNT      = FAN_MARK_MOUNT,
+		/// The complete file system the given path belongs to is monitored.
+		FILESYSTEM = FAN_MARK_FILESYSTEM
+	};
+
+	/// Additional flags for adding and removing marks.
+	enum class MarkFlag : unsigned int {
+		/// Don't follow a symbolic link found in the path.
+		DONT_FOLLOW         = FAN_MARK_DONT_FOLLOW,
+		/// Fail if the path is not a directory.
+		ONLY_DIR            = FAN_MARK_ONLYDIR,
+		/// The mask describes events to be ignored (legacy variant of IGNORE).
+		IGNORED_MASK        = FAN_MARK_IGNORED_MASK,
+		/// The ignore mask survives modify events.
+		IGNORED_SURV_MODIFY = FAN_MARK_IGNORED_SURV_MODIFY,
+		/// The mark may be evicted from memory if the inode isn't referenced otherwise.
+		EVICTABLE           = FAN_MARK_EVICTABLE,
+		/// The mask describes events to be ignored.
+		IGNORE              = FAN_MARK_IGNORE
+	};
+
+	using MarkFlags = BitMask<MarkFlag>;
+
+	/// Types of additional information records attached to events.
+	enum class InfoType : uint8_t {
+		/// File handle of the affected object (REPORT_FID).
+		FID           = FAN_EVENT_INFO_TYPE_FID,
+		/// File handle of the parent directory plus entry name (REPORT_DFID_NAME).
+		DFID_NAME     = FAN_EVENT_INFO_TYPE_DFID_NAME,
+		/// File handle of the parent directory (REPORT_DIR_FID).
+		DFID          = FAN_EVENT_INFO_TYPE_DFID,
+		/// A pidfd for the process that caused the event (REPORT_PIDFD).
+		PIDFD         = FAN_EVENT_INFO_TYPE_PIDFD,
+		/// File system error information (EventType::FS_ERROR).
+		ERROR         = FAN_EVENT_INFO_TYPE_ERROR,
+		/// Old parent directory and name for EventType::RENAME.
+		OLD_DFID_NAME = FAN_EVENT_INFO_TYPE_OLD_DFID_NAME,
+		/// New parent directory and name for EventType::RENAME.
+		NEW_DFID_NAME = FAN_EVENT_INFO_TYPE_NEW_DFID_NAME
+	};
+
+	/// View of a file handle reported in an event.
+	/**
+	 * This is only valid as long as the Event it was obtained from.
+	 **/
+	struct FileID {
+		/// The ID of the file system the handle belongs to, \see FileSystemStatus::id().
+		fsid_t fsid;
+		/// The raw handle data.
+		const struct file_handle *handle = nullptr;
+
+		/// Creates a persistent copy of the handle.
+		FileHandle copy() const {
+			return FileHandle{*handle};
+		}
+
+		/// Checks whether this ID refers to the same object as `other`.
+		bool operator==(const FileHandle &other) const;
+	};
+
+	/// View of a single fanotify event.
+	/**
+	 * Instances of this type can only be obtained via
+	 * FANotify::readEvent() and FANotify::tryReadEvent(). The objects are
+	 * backed by internal FANotify memory and are only valid until the next
+	 * call to one of the readEvent() functions at the FANotify instance
+	 * it was obtained from, or until that instance is destroyed.
+	 *
+	 * File descriptors carried in the event (see fd() and pidFD()) are
+	 * owned by the FANotify instance and will be closed during the next
+	 * readEvent() call, unless ownership is taken over via takeFD() or
+	 * takePidFD().
+	 **/
+	struct Event {
+
+		/// The events which occurred.
+		/**
+		 * This may contain EventType::ON_DIR to signal that the
+		 * object in question is a directory.
+		 **/
+		EventTypes events() const {
+			return EventTypes{static_cast<uint64_t>(m_ev->mask)};
+		}
+
+		/// Whether this is a queue overflow event.
+		/**
+		 * This means that events have been lost and the application
+		 * should rescan the monitored objects.
+		 **/
+		bool isOverflow() const {
+			return events()[EventType::QUEUE_OVERFLOW];
+		}
+
+		/// Whether the object in question is a directory.
+		bool isDir() const {
+			return events()[EventType::ON_DIR];
+		}
+
+		/// The process (or thread, \see InitFlag::REPORT_TID) that caused the event.
+		ProcessID pid() const {
+			return ProcessID{m_ev->pid};
+		}
+
+		/// Returns the file descriptor for the affected object.
+		/**
+		 * In REPORT_*FID modes and for overflow events no file
+		 * descriptor is available and FileNum::INVALID is set. The
+		 * file descriptor remains owned by the FANotify instance.
+		 **/
+		FileDescriptor fd() const {
+			return FileDescriptor{FileNum{m_ev->fd}};
+		}
+
+		/// Takes over ownership of the file descriptor for the affected object.
+		FileDescriptor takeFD() const;
+
+		/// Returns the file handle of the affected object, if reported.
+		std::optional<FileID> fileID() const {
+			return findFileID(InfoType::FID);
+		}
+
+		/// Returns the file handle of the parent directory, if reported.
+		/**
+		 * `type` selects the information record to look at, for
+		 * EventType::RENAME events InfoType::OLD_DFID_NAME and
+		 * InfoType::NEW_DFID_NAME are reported instead of
+		 * InfoType::DFID_NAME.
+		 **/
+		std::optional<FileID> dirID(const InfoType type = InfoType::DFID_NAME) const;
+
+		/// Returns the name of the directory entry the event is about, if reported.
+		/**
+		 * If no name is reported then an empty string is returned.
+		 * For events that relate to the marked directory itself the
+		 * name "." is reported. See dirID() for the meaning of `type`.
+		 **/
+		std::string_view name(const InfoType type = InfoType::DFID_NAME) const;
+
+		/// Returns the pidfd of the process that caused the event, if reported.
+		/**
+		 * \see InitFlag::REPORT_PIDFD. If the process already exited
+		 * or the pidfd could not be created then std::nullopt is
+		 * returned. The file descriptor remains owned by the FANotify
+		 * instance.
+		 **/
+		std::optional<FileNum> pidFD() const;
+
+		/// Takes over ownership of the pidfd, \see pidFD().
+		std::optional<FileNum> takePidFD() const;
+
+		/// Returns the error information for EventType::FS_ERROR events.
+		/**
+		 * The returned pair contains the first error that occurred
+		 * and the number of errors that occurred since the last
+		 * event.
+		 **/
+		std::optional<std::pair<Errno, size_t>> fsError() const;
+
+		/// Access to the raw event metadata.
+		const struct fanotify_event_metadata* raw() const {
+			return m_ev;
+		}
+
+	protected: // functions
+
+		friend class FANotify;
+
+		explicit Event(struct fanotify_event_metadata *ev) :
+				m_ev{ev} {
+		}
+
+		/// Returns the first info record of the given type.
+		const struct fanotify_event_info_header* findInfo(const InfoType type) const;
+
+		std::optional<FileID> findFileID(const InfoType type) const;
+
+	protected: // data
+
+		struct fanotify_event_metadata *m_ev = nullptr;
+	};
+
+public: // functions
+
+	/// Create a new FANotify instance.
+	/**
+	 * This creates a new fanotify file descriptor via fanotify_init().
+	 * `flags` determine the operation mode, by default the descriptor
+	 * is close-on-exec and events carry parent directory handles and
+	 * entry names (REPORT_DFID_NAME mode).
+	 *
+	 * `event_mode` and `event_flags` are used for file descriptors
+	 * passed in events (only in non REPORT_*FID modes).
+	 *
+	 * `io_buffer_size` determines the size of the buffer that events are
+	 * read into. Larger buffers reduce the number of system calls
+	 * needed for processing large amounts of events.
+	 *
+	 * On error an ApiError is thrown. Errno::PERMISSION indicates that
+	 * the requested features are not available without CAP_SYS_ADMIN,
+	 * Errno::INVALID_ARG that a feature is not supported by the kernel.
+	 **/
+	explicit FANotify(
+			const InitFlags flags = {InitFlag::CLOEXEC, InitFlag::REPORT_DFID_NAME},
+			const OpenMode event_mode = OpenMode::READ_ONLY,
+			const OpenFlags event_flags = {OpenFlag::CLOEXEC},
+			const size_t io_buffer_size = 64 * 1024);
+
+	~FANotify();
+
+	FANotify(const FANotify&) = delete;
+	FANotify& operator=(const FANotify&) = delete;
+
+	/// Adds a mark for monitoring the events in `mask`.
+	/**
+	 * Depending on `type` either the object found at `path`, its mount or
+	 * its complete file system is monitored. Adding a mark for an
+	 * existing object ORs the new mask into the existing one.
+	 *
+	 * On error an ApiError is thrown, e.g. Errno::INVALID_ARG if the
+	 * combination of mask, flags and operation mode is not supported,
+	 * Errno::PERMISSION for MOUNT and FILESYSTEM marks without
+	 * CAP_SYS_ADMIN and Errno::CROSS_DEVICE if REPORT_*FID modes are
+	 * used on a file system that doesn't support file handles in a
+	 * mount or sub-volume that is not the root of the file system.
+	 **/
+	void addMark(const SysString path, const EventTypes mask,
+			const MarkType type = MarkType::INODE, const MarkFlags flags = {}) {
+		addMarkAt(AT_CWD, path, mask, type, flags);
+	}
+
+	/// Variant of addMark() operating on a path relative to `dir_fd`.
+	/**
+	 * If `path` is empty then `dir_fd` itself is marked.
+	 **/
+	void addMarkAt(const DirFD dir_fd, const SysString path, const EventTypes mask,
+			const MarkType type = MarkType::INODE, const MarkFlags flags = {}) {
+		mark(FAN_MARK_ADD, dir_fd, path, mask, type, flags);
+	}
+
+	/// Removes the events in `mask` from an existing mark.
+	void removeMark(const SysString path, const EventTypes mask,
+			const MarkType type = MarkType::INODE, const MarkFlags flags = {}) {
+		mark(FAN_MARK_REMOVE, AT_CWD, path, mask, type, flags);
+	}
+
+	/// Removes all marks of the given type.
+	void flushMarks(const MarkType type = MarkType::INODE);
+
+	/// Read the next event.
+	/**
+	 * If the internal buffer is exhausted then a new batch of events is
+	 * read from the kernel. This call will block if no event is available
+	 * unless InitFlag::NONBLOCK was used. In the latter case an ApiError
+	 * with Errno::AGAIN is thrown. Use tryReadEvent() to avoid that.
+	 *
+	 * The returned object is only valid until the next call to one of the
+	 * readEvent() functions.
+	 **/
+	Event readEvent();
+
+	/// Variant of readEvent() that returns std::nullopt if no events are available.
+	std::optional<Event> tryReadEvent();
+
+	/// Returns whether events are left in the internal buffer.
+	/**
+	 * If this returns `true` then readEvent() will not perform a system
+	 * call.
+	 **/
+	bool hasBufferedEvents() const {
+		return m_offset < m_buffer.size();
+	}
+
+	/// Returns the underlying fanotify file descriptor for use with Poller.
+	FileDescriptor fd() const {
+		return m_notify_file.fd();
+	}
+
+protected: // functions
+
+	void mark(const unsigned int action, const DirFD dir_fd, const SysString path,
+			const EventTypes mask, const MarkType type, const MarkFlags flags);
+
+	/// Close file descriptors carried by the event at `offset`, if any.
+	void closeEventFDs(const size_t offset);
+
+protected: // data
+
+	/// A file operating on the descriptor returned from fanotify_init().
+	File m_notify_file;
+	/// The I/O buffer size configured during construction of the object.
+	size_t m_io_buffer_size;
+	/// Batch of events read from the kernel.
+	std::vector<uint8_t> m_buffer;
+	/// Offset of the next event to be returned in m_buffer.
+	size_t m_offset = 0;
+	/// Offset of the event last returned from readEvent(), if any.
+	std::optional<size_t> m_current;
+};
+
+} // end ns
@@ -226,6 +226,31 @@ public: // types
 		DONTNEED   = POSIX_FADV_DONTNEED,
 	};
 
+	/// Flags used with allocate() to select the kind of space manipulation.
+	/**
+	 * Without any flags allocate() reserves disk space for the given range
+	 * and extends the file size if necessary. Not all file systems
+	 * support all operations, unsupported operations cause an ApiError
+	 * with Errno::OP_NOT_SUPPORTED.
+	 **/
+	enum class AllocateFlag : int {
+		/// Don't change the file size, even if the range exceeds the end-of-file.
+		KEEP_SIZE      = FALLOC_FL_KEEP_SIZE,
+		/// Deallocate the range, subsequent reads return zeroes (requires KEEP_SIZE).
+		PUNCH_HOLE     = FALLOC_FL_PUNCH_HOLE,
+		/// Remove the range from the file without leaving a hole, shifting following data.
+		COLLAPSE_RANGE = FALLOC_FL_COLLAPSE_RANGE,
+		/// Zero the range, preferably by converting it into unwritten extents.
+		ZERO_RANGE     = FALLOC_FL_ZERO_RANGE,
+		/// Insert a hole at the given range, shifting following data.
+		INSERT_RANGE   = FALLOC_FL_INSERT_RANGE,
+		/// Unshare extents shared with other files (e.g. after reflink copies).
+		UNSHARE_RANGE  = FALLOC_FL_UNSHARE_RANGE
+	};
+
+	/// Collection of AllocateFlag used with allocate().
+	using AllocateFlags = BitMask<AllocateFlag>;
+
 public: // functions
 
 	constexpr FileDescriptor() = default;
@@ -618,6 +643,76 @@ public: // functions
 	 **/
 	void setAdvice(off_t offset, off_t size, const AccessAdvice advice);
 
+	/// Manipulate the disk space allocated for the given range of the file.
+	/**
+	 * This is a wrapper around `fallocate()`. Without `flags` the disk
+	 * blocks for the range [offset, offset + length) are allocated, which
+	 * guarantees that subsequent writes into the range will not fail
+	 * due to lack of disk space. It also avoids fragmentation when a
+	 * file is grown incrementally. If the range exceeds the end-of-file
+	 * then the file size is increased, unless AllocateFlag::KEEP_SIZE is
+	 * passed.
+	 *
+	 * Other operations are selected via `flags`, see AllocateFlag and the
+	 * convenience wrappers punchHole(), zeroRange(), collapseRange() and
+	 * insertRange(). The latter two require `offset` and `length` to be
+	 * multiples of the file system block size.
+	 *
+	 * This call can throw an ApiError containing e.g. one of the
+	 * following Errno values:
+	 *
+	 * - Errno::OP_NOT_SUPPORTED: the file system does not support the
+	 *   operation.
+	 * - Errno::NO_SPACE: not enough disk space is available.
+	 * - Errno::INVALID_ARG: bad range or flags combination.
+	 * - Errno::NO_DEVICE: the file descriptor does not refer to a regular
+	 *   file.
+	 **/
+	void allocate(off_t offset, off_t length, const AllocateFlags flags = {});
+
+	/// Deallocate the given range of the file, creating a hole.
+	/**
+	 * The file size remains unchanged. Partial file system blocks at the
+	 * range boundaries are zeroed out.
+	 **/
+	void punchHole(off_t offset, off_t length) {
+		allocate(offset, length, {AllocateFlag::PUNCH_HOLE, AllocateFlag::KEEP_SIZE});
+	}
+
+	/// Zero the given range of the file.
+	/**
+	 * If the range exceeds the end-of-file then the file size is
+	 * increased. Use allocate() with AllocateFlag::KEEP_SIZE added to
+	 * avoid this.
+	 **/
+	void zeroRange(off_t offset, off_t length) {
+		allocate(offset, length, AllocateFlags{AllocateFlag::ZERO_RANGE});
+	}
+
+	/// Remove the given range from the file, shifting subsequent data down.
+	void collapseRange(off_t offset, off_t length) {
+		allocate(offset, length, AllocateFlags{AllocateFlag::COLLAPSE_RANGE});
+	}
+
+	/// Insert a hole of `length` bytes at `offset`, shifting subsequent data up.
+	void insertRange(off_t offset, off_t length) {
+		allocate(offset, length, AllocateFlags{AllocateFlag::INSERT_RANGE});
+	}
+
+	/// Populate the page cache with the given range of the file.
+	/**
+	 * This is a wrapper around `readahead()`. The call blocks until the
+	 * data has been read into the page cache. It can be used to prefetch
+	 * the next segment of a file in a separate thread while the current
+	 * one is being processed. Contrary to AccessAdvice::WILLNEED the
+	 * operation is not merely a hint.
+	 *
+	 * This call can throw an ApiError with Errno::INVALID_ARG if the
+	 * file descriptor does not refer to a file type that supports this
+	 * operation.
+	 **/
+	void readAhead(off_t offset, size_t count);
+
 protected: // functions
 
 	int fcntl(int cmd) const;
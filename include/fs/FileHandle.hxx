@@ -0,0 +1,105 @@
+#pragma once
+
+// C++
+#include <cstdint>
+#include <vector>
+
+// Linux
+#include <fcntl.h>
+
+// cosmos
+#include <cosmos/dso_export.h>
+#include <cosmos/fs/DirFD.hxx>
+#include <cosmos/fs/FileDescriptor.hxx>
+#include <cosmos/fs/types.hxx>
+#include <cosmos/SysString.hxx>
+
+namespace cosmos {
+
+/// Persistent file system object handle.
+/**
+ * A file handle uniquely identifies a file system object on a given file
+ * system. Unlike a path it stays valid across renames, and unlike an open
+ * file descriptor it does not occupy any kernel resources. Handles are
+ * obtained via name_to_handle_at() or from fanotify events (see
+ * FANotify::Event::fileID()). They can be turned into an open file
+ * descriptor again via open().
+ *
+ * The handle data is opaque and file system specific. Comparing two
+ * handles for equality is only meaningful if they stem from the same file
+ * system.
+ **/
+class COSMOS_API FileHandle {
+public: // functions
+
+	/// Creates an empty handle, valid() returns false.
+	FileHandle() = default;
+
+	/// Creates a copy of the given raw file handle.
+	explicit FileHandle(const struct file_handle &raw);
+
+	/// Obtains the handle for `path` via name_to_handle_at().
+	/**
+	 * \see FileHandle(const DirFD, const SysString, const FollowSymlinks).
+	 **/
+	explicit FileHandle(const SysString path, const FollowSymlinks follow = FollowSymlinks{false}) :
+			FileHandle{AT_CWD, path, follow} {
+	}
+
+	/// Obtains the handle for `path` relative to `dir_fd` via name_to_handle_at().
+	/**
+	 * If `path` is empty then the handle for `dir_fd` itself is
+	 * returned.
+	 *
+	 * On error an ApiError is thrown. Errno::OP_NOT_SUPPORTED indicates
+	 * that the file system does not support file handles.
+	 **/
+	FileHandle(const DirFD dir_fd, const SysString path, const FollowSymlinks follow = FollowSymlinks{false});
+
+	bool valid() const {
+		return !m_data.empty();
+	}
+
+	/// Returns the file system specific handle type.
+	int type() const {
+		return valid() ? raw()->handle_type : 0;
+	}
+
+	/// Returns the size of the opaque handle data in bytes.
+	size_t size() const {
+		return valid() ? raw()->handle_bytes : 0;
+	}
+
+	/// Returns a pointer to the raw handle data structure.
+	const struct file_handle* raw() const {
+		return reinterpret_cast<const struct file_handle*>(m_data.data());
+	}
+
+	/// Opens the file system object represented by this handle.
+	/**
+	 * `mount_fd` needs to refer to any object on the file system the
+	 * handle belongs to. The returned file descriptor is owned by the
+	 * caller.
+	 *
+	 * This operation requires the CAP_DAC_READ_SEARCH capability. On
+	 * error an ApiError is thrown, Errno::STALE indicates that the object
+	 * no longer exists.
+	 **/
+	FileDescriptor open(const FileDescriptor mount_fd, const OpenMode mode = OpenMode::READ_ONLY,
+			const OpenFlags flags = {OpenFlag::CLOEXEC}) const;
+
+	bool operator==(const FileHandle &other) const {
+		return m_data == other.m_data;
+	}
+
+	bool operator!=(const FileHandle &other) const {
+		return !(*this == other);
+	}
+
+protected: // data
+
+	/// The complete struct file_handle including the opaque data.
+	std::vector<uint8_t> m_data;
+};
+
+} // end ns
@@ -0,0 +1,129 @@
+#pragma once
+
+// C++
+#include <optional>
+
+// Linux
+#include <sys/types.h>
+
+// cosmos
+#include <cosmos/dso_export.h>
+#include <cosmos/fs/FileDescriptor.hxx>
+
+namespace cosmos {
+
+/// Iterate over the data extents of a (possibly sparse) file.
+/**
+ * This type uses `lseek()` with SEEK_DATA and SEEK_HOLE to find the ranges
+ * of a file that actually contain data, skipping over holes. This allows to
+ * efficiently process or copy large sparse files without reading the
+ * (implicitly zero) holes.
+ *
+ * File systems that don't support hole detection report the complete file
+ * as a single data extent. Also note that unwritten (preallocated) extents
+ * may be reported as data or as holes, depending on the file system.
+ *
+ * \warning Since there are no positional variants of these seek operations,
+ * iterating changes the file position of the open file description
+ * referred to by the file descriptor. The position is not restored.
+ *
+ * The next extent is obtained via nextExtent(). Alternatively range based
+ * for loops are supported via begin(SparseExtents&) and
+ * end(SparseExtents&).
+ **/
+class COSMOS_API SparseExtents {
+public: // types
+
+	/// A contiguous range of a file containing data.
+	struct Extent {
+		off_t offset = 0;
+		off_t length = 0;
+
+		/// Returns the offset just past the end of the extent.
+		off_t end() const {
+			return offset + length;
+		}
+
+		bool operator==(const Extent &other) const {
+			return offset == other.offset && length == other.length;
+		}
+	};
+
+public: // functions
+
+	/// Iterate the data extents of `fd` starting at file offset `start`.
+	explicit SparseExtents(const FileDescriptor fd, const off_t start = 0) :
+			m_fd{fd}, m_start{start}, m_pos{start} {}
+
+	/// Returns the next data extent, or std::nullopt if no more data follows.
+	/**
+	 * On error an ApiError is thrown, e.g. with Errno::INVALID_ARG if
+	 * the file descriptor does not support seeking.
+	 **/
+	std::optional<Extent> nextExtent();
+
+	/// Restart iteration at the start offset passed to the constructor.
+	void rewind() {
+		m_pos = m_start;
+	}
+
+	FileDescriptor fd() const {
+		return m_fd;
+	}
+
+protected: // data
+
+	FileDescriptor m_fd;
+	/// Offset at which iteration started.
+	off_t m_start = 0;
+	/// Offset at which to look for the next extent.
+	off_t m_pos = 0;
+};
+
+/// This type implements range based for loop iterator semantics for SparseExtents.
+class SparseExtentIterator {
+public: // functions
+
+	explicit SparseExtentIterator(SparseExtents &extents, bool at_end) :
+			m_extents{extents} {
+		if (!at_end)
+			m_extent = extents.nextExtent();
+	}
+
+	bool operator==(const SparseExtentIterator &other) const {
+		return m_extent == other.m_extent;
+	}
+
+	bool operator!=(const SparseExtentIterator &other) const {
+		return !(*this == other);
+	}
+
+	auto& operator++() {
+		m_extent = m_extents.nextExtent();
+		return *this;
+	}
+
+	const SparseExtents::Extent& operator*() const {
+		return *m_extent;
+	}
+
+protected: // data
+	SparseExtents &m_extents;
+	std::optional<SparseExtents::Extent> m_extent;
+};
+
+inline SparseExtentIterator end(SparseExtents &extents) {
+	return SparseExtentIterator{extents, true};
+}
+
+/// Get a begin iterator for the given SparseExtents.
+/**
+ * \warning This rewinds `extents` to its start offset. Only a single
+ * iterator should be in use at any time.
+ **/
+inline SparseExtentIterator begin(SparseExtents &extents) {
+	extents.rewind();
+	return SparseExtentIterator{extents, false};
+}
+
+} // end ns
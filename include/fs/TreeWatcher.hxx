@@ -0,0 +1,259 @@
+#pragma once
+
+// C++
+#include <deque>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// cosmos
+#include <cosmos/dso_export.h>
+#include <cosmos/fs/INotify.hxx>
+#include <cosmos/time/Clock.hxx>
+#include <cosmos/time/types.hxx>
+
+namespace cosmos {
+
+/// Recursive directory tree monitoring based on INotify.
+/**
+ * inotify only supports watching individual directories. This type
+ * manages a set of inotify watches covering complete directory trees.
+ * Watches for newly created or moved-in sub-directories are added
+ * automatically, and watches of sub-directories that are removed or
+ * moved out of the tree are dropped again.
+ *
+ * Instead of full paths only the parent WatchID and the basename of each
+ * directory are kept per watch, full paths are reconstructed on demand.
+ * This keeps memory usage low for large trees and allows to handle
+ * directory renames within the tree by relinking a single table entry.
+ *
+ * Events are not reported one by one but are coalesced into `Change`
+ * records per path. All events for the same path that occur within the
+ * configured coalescing window are merged into a single `Change`. This
+ * avoids a flood of notifications for e.g. a file that is written to in
+ * many small chunks.
+ *
+ * When the kernel's inotify queue overflows (EventFlag::OVERFLOW), or when
+ * the number of pending changes exceeds the configured limit, then
+ * information has been lost. In this case all pending changes are
+ * discarded and a `Change` with `rescan == true` is reported for each
+ * root path instead. The application should then rescan the affected
+ * tree(s) to bring its state up to date.
+ *
+ * The inotify file descriptor operates in non-blocking mode. The intended
+ * use is to monitor fd() for input via a Poller, call readEvents() when
+ * input is available and use nextTimeout() as the Poller timeout to
+ * collect due changes via takeChanges():
+ *
+ * ```
+ * TreeWatcher watcher{{INotify::EventType::CLOSE_WRITE}, IntervalTime{std::chrono::milliseconds{100}}};
+ * watcher.addTree("/some/path");
+ * Poller poller{8};
+ * poller.addFD(watcher.fd(), {Poller::MonitorFlag::INPUT});
+ *
+ * while (true) {
+ *     poller.wait(watcher.nextTimeout());
+ *     watcher.readEvents();
+ *     for (const auto &change: watcher.takeChanges()) {
+ *         ...
+ *     }
+ * }
+ * ```
+ *
+ * This type is not thread safe.
+ **/
+class COSMOS_API TreeWatcher {
+public: // types
+
+	using WatchID = INotify::WatchID;
+	using EventType = INotify::EventType;
+	using EventTypes = INotify::EventTypes;
+
+	/// A coalesced change report for a single path.
+	struct Change {
+		/// The full path the change relates to.
+		std::string path;
+		/// All events that have been observed for `path`.
+		EventTypes events;
+		/// Whether `path` refers to a directory.
+		bool is_dir = false;
+		/// Event information was lost, the tree below `path` needs to be rescanned.
+		bool rescan = false;
+	};
+
+	using ChangeList = std::vector<Change>;
+
+public: // functions
+
+	/// Create a new TreeWatcher.
+	/**
+	 * `mask` determines the events that are reported via `Change`
+	 * records. Some events are always monitored internally to keep
+	 * track of the directory tree structure, but they are only reported
+	 * if they are part of `mask`.
+	 *
+	 * `window` is the coalescing window. A change becomes due for
+	 * reporting once `window` has passed since the first event for its
+	 * path was seen. A zero window causes changes to be due immediately,
+	 * which still merges events for the same path that are read in a
+	 * single batch.
+	 *
+	 * `max_pending` limits the number of pending changes. If it is
+	 * exceeded then pending changes are replaced by rescan requests.
+	 *
+	 * \see INotify::INotify() for possible errors.
+	 **/
+	explicit TreeWatcher(
+			const EventTypes mask,
+			const IntervalTime window = IntervalTime{0},
+			const size_t max_pending = 16384);
+
+	/// Recursively add watches for the directory tree found at `root`.
+	/**
+	 * Only directories are watched, `root` must refer to a directory.
+	 * Symbolic links are not followed. Multiple independent trees can be
+	 * added to the same TreeWatcher.
+	 *
+	 * If adding the watch for `root` itself fails then an ApiError is
+	 * thrown (see INotify::addWatch()). Sub-directories that vanish or
+	 * cannot be accessed during the recursive walk are silently skipped.
+	 *
+	 * The root path is stored as given. If a root directory itself is
+	 * renamed then paths reported for its tree will become stale.
+	 **/
+	void addTree(const std::string_view root);
+
+	/// Process all events that are currently available on fd().
+	/**
+	 * Returns the number of raw inotify events that have been processed.
+	 * Changes resulting from these events are queued and can be obtained
+	 * via takeChanges().
+	 **/
+	size_t readEvents();
+
+	/// Returns all changes that are due for reporting.
+	/**
+	 * If `flush` is set then all pending changes are returned,
+	 * regardless of the coalescing window. Pending rescan requests are
+	 * always reported first.
+	 **/
+	ChangeList takeChanges(const bool flush = false);
+
+	/// Returns the time until the next pending change becomes due.
+	/**
+	 * If no changes are pending then std::nullopt is returned, which
+	 * matches the "wait forever" semantics of Poller::wait().
+	 **/
+	std::optional<IntervalTime> nextTimeout() const;
+
+	/// Returns whether changes are pending (due or not yet due).
+	bool hasPending() const {
+		return !m_pending.empty() || m_rescan_pending;
+	}
+
+	/// Returns the number of directories currently watched.
+	size_t numWatches() const {
+		return m_nodes.size();
+	}
+
+	/// Returns the inotify file descriptor for use with Poller.
+	FileDescriptor fd() const {
+		return m_inotify.fd();
+	}
+
+	/// Returns the full path of the watched directory `id`.
+	/**
+	 * If `id` is unknown then an empty string is returned.
+	 **/
+	std::string path(const WatchID id) const;
+
+protected: // types
+
+	/// Compact watch table entry.
+	struct Node {
+		/// The parent directory's watch or WatchID::INVALID for roots.
+		WatchID parent = WatchID::INVALID;
+		/// The basename of the directory, or the full path for roots.
+		std::string name;
+		/// Watches of direct sub-directories.
+		std::vector<WatchID> children;
+	};
+
+	/// A coalesced change that is not yet reported.
+	struct Pending {
+		Change change;
+		/// The time at which the change is due for reporting.
+		MonotonicTime due;
+	};
+
+	/// A directory MOVED_FROM event waiting for its MOVED_TO counterpart.
+	struct MoveSource {
+		INotify::Cookie cookie;
+		WatchID id;
+	};
+
+protected: // functions
+
+	/// Add a watch for the directory `path` and link it into the watch table.
+	/**
+	 * If the directory is already known then std::nullopt is returned.
+	 * Errors from INotify::addWatch() are propagated.
+	 **/
+	std::optional<WatchID> addNode(const WatchID parent, std::string name, const std::string &path);
+
+	/// Walk the directory tree below the already watched `path`.
+	/**
+	 * All sub-directories found are added to the watch table. If
+	 * `report` is not empty then all entries found are queued as
+	 * synthetic changes carrying the `report` events.
+	 **/
+	void scanDir(const WatchID id, const std::string &path, const EventTypes report);
+
+	void processEvent(const INotify::Event &event);
+
+	/// Drop `id` and all nodes below it from the watch table.
+	void dropSubtree(const WatchID id, const bool remove_watches);
+
+	void unlinkFromParent(const WatchID id);
+
+	WatchID findChild(const WatchID parent, const std::string_view name) const;
+
+	void queueChange(std::string &&path, const EventTypes events, const bool is_dir);
+
+	/// Discard pending changes and request rescans for all roots.
+	void requestRescan();
+
+	/// Rebuild the watch table after information has been lost.
+	void resync();
+
+	/// Drop sub-trees that have been moved out of the watched trees.
+	void resolveMoves();
+
+protected: // data
+
+	INotify m_inotify;
+	/// Events reported to the user.
+	EventTypes m_mask;
+	/// Events used for watches (m_mask plus internally needed events).
+	EventTypes m_watch_mask;
+	IntervalTime m_window;
+	size_t m_max_pending;
+	/// The compact watch table.
+	std::unordered_map<WatchID, Node> m_nodes;
+	/// The roots added via addTree().
+	std::vector<WatchID> m_roots;
+	/// Pending changes in order of appearance.
+	std::deque<Pending> m_pending;
+	/// Index of m_pending by path, values are sequence numbers.
+	std::unordered_map<std::string, size_t> m_pending_index;
+	/// Sequence number of m_pending.front().
+	size_t m_pending_base = 0;
+	/// Directory moves that are not yet resolved in the current batch.
+	std::vector<MoveSource> m_move_sources;
+	bool m_rescan_pending = false;
+	Clock<ClockType::MONOTONIC> m_clock;
+};
+
+} // end ns
@@ -1,6 +1,7 @@
 #pragma once
 
 // Linux
+#include <fcntl.h>
 #include <linux/close_range.h>
 
 // C++
@@ -792,6 +793,35 @@ size_t copy_file_range(CopyFileRangeParameters &pars);
 size_t copy_file_range(
 		const FileDescriptor fd_in, const FileDescriptor fd_out, const size_t len);
 
+/// Flags used with splice().
+enum class SpliceFlag : unsigned int {
+	/// Attempt to move pages instead of copying (merely a hint to the kernel).
+	MOVE     = SPLICE_F_MOVE,
+	/// Don't block on the pipe I/O (the other FD's mode still applies).
+	NONBLOCK = SPLICE_F_NONBLOCK,
+	/// More data will be coming in a subsequent splice (hint for sockets).
+	MORE     = SPLICE_F_MORE
+};
+
+using SpliceFlags = BitMask<SpliceFlag>;
+
+/// Move data between a pipe and another file descriptor in the kernel.
+/**
+ * This is a wrapper around `splice()` which does not route data through
+ * userspace. One of `fd_in` or `fd_out` needs to be a pipe. Data is read
+ * from and written to the current file descriptor offsets. Up to `len`
+ * bytes are transferred and the actual number of bytes transferred is
+ * returned. If the input reached end-of-file then 0 is returned.
+ *
+ * If the pipe is in non-blocking mode or SpliceFlag::NONBLOCK is passed and
+ * the operation would block then a WouldBlock exception is thrown. Other
+ * errors are reported as ApiError. Note that `fd_out` must not be opened
+ * with OpenFlag::APPEND.
+ **/
+size_t splice(
+		const FileDescriptor fd_in, const FileDescriptor fd_out,
+		const size_t len, const SpliceFlags flags = SpliceFlags{});
+
 /// Different access checks that can be performed in check_access().
 enum class AccessCheck : int {
 	 READ_OK = R_OK, ///< Read access is allowed.
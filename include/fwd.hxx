@@ -30,19 +30,25 @@ class RuntimeError;
 class UsageError;
 class WouldBlock;
 
+class AppendLog;
 class DirEntry;
 class DirFD;
 class DirIterator;
 class DirStream;
+class DirectFile;
 class Directory;
+class FANotify;
 class FDFile;
 class File;
 class FileBase;
 class FileDescriptor;
+class FileHandle;
 class FileLock;
 class FileStatus;
+class SparseExtents;
 class TempDir;
 class TempFile;
+class TreeWatcher;
 class FileType;
 class FileMode;
 
@@ -101,7 +107,11 @@ class UnixRightsMessage;
 class UnixCredentialsMessage;
 
 class ChildCloner;
+class ChildReaper;
+class CPUSet;
+class Topology;
 class Mapping;
+class OutputCapture;
 class PidFD;
 class ProcessFile;
 class SchedulerSettings;
@@ -109,19 +119,35 @@ class OtherSchedulerSettings;
 class RealTimeSchedulerSettings;
 class FifoSchedulerSettings;
 class RoundRobinSchedulerSettings;
+class BatchSchedulerSettings;
+class IdleSchedulerSettings;
+class DeadlineSchedulerSettings;
 class SigAction;
 class SigInfo;
 class SigSet;
 class SignalFD;
+class SpawnServer;
 class SubProc;
 class Tracee;
 class WaitStatus;
 class Signal;
 
+class Barrier;
 class Condition;
 class ConditionMutex;
+class Doorbell;
+class FutexCondition;
+class FutexConditionMutex;
+class FutexMutex;
+class Latch;
+class LockStats;
 class Mutex;
+class PerCPUCounter;
 class PosixThread;
+class RCUDomain;
 class RWLock;
+class Semaphore;
+class ThreadAttributes;
+class ThreadPool;
 
 } // end ns
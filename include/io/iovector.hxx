@@ -158,6 +158,7 @@ class IOVector :
 	friend class SendMessageHeader;
 	friend class ReceiveMessageHeader;
 	friend class MessageHeaderBase;
+	friend class Tracee;
 
 public: // functions
 
@@ -1,8 +1,12 @@
 #pragma once
 
 // C++
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
+#include <new>
 #include <type_traits>
+#include <utility>
 
 /**
  * @file
@@ -12,6 +16,22 @@
 
 namespace cosmos {
 
+/// The assumed size of a CPU cache line in bytes.
+/**
+ * Objects that are frequently modified by different threads should be
+ * placed in different cache lines to avoid "false sharing", e.g. by using
+ * `alignas(CACHE_LINE_SIZE)`. This is a compile time approximation, the
+ * actual value for the current system can be found in Topology::caches().
+ *
+ * `std::hardware_destructive_interference_size` is not used, since it is
+ * not stable across compiler versions and thus unsuitable for an ABI.
+ **/
+#if defined(__powerpc64__)
+constexpr inline size_t CACHE_LINE_SIZE = 128;
+#else
+constexpr inline size_t CACHE_LINE_SIZE = 64;
+#endif
+
 /// Completely overwrites the given object with zeroes.
 /**
  * This is typically used in C-APIs to get a defined object state.
@@ -26,4 +46,72 @@ void zero_object(T &obj) {
 	std::memset(&obj, 0, sizeof(T));
 }
 
+/// Heap allocated, move-only memory buffer with custom alignment.
+/**
+ * This is useful for APIs that impose alignment requirements on memory
+ * buffers, like I/O on files opened with OpenFlag::DIRECT (see DirectFile).
+ * The memory is not initialized.
+ **/
+class AlignedBuffer {
+public: // functions
+
+	AlignedBuffer() = default;
+
+	/// Allocate `size` bytes aligned to `alignment`.
+	/**
+	 * `alignment` needs to be a power of two. If the allocation fails
+	 * then std::bad_alloc is thrown.
+	 **/
+	AlignedBuffer(const size_t size, const size_t alignment) :
+			m_data{static_cast<uint8_t*>(::operator new(size, std::align_val_t{alignment}))},
+			m_size{size},
+			m_alignment{alignment} {
+	}
+
+	AlignedBuffer(AlignedBuffer &&other) noexcept {
+		*this = std::move(other);
+	}
+
+	AlignedBuffer& operator=(AlignedBuffer &&other) noexcept {
+		release();
+		m_data = other.m_data;
+		m_size = other.m_size;
+		m_alignment = other.m_alignment;
+		other.m_data = nullptr;
+		other.m_size = 0;
+		return *this;
+	}
+
+	AlignedBuffer(const AlignedBuffer&) = delete;
+	AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+	~AlignedBuffer() {
+		release();
+	}
+
+	uint8_t* data() { return m_data; }
+	const uint8_t* data() const { return m_data; }
+
+	size_t size() const { return m_size; }
+
+	size_t alignment() const { return m_alignment; }
+
+	bool empty() const { return m_size == 0; }
+
+protected: // functions
+
+	void release() {
+		if (m_data) {
+			::operator delete(m_data, std::align_val_t{m_alignment});
+			m_data = nullptr;
+		}
+	}
+
+protected: // data
+
+	uint8_t *m_data = nullptr;
+	size_t m_size = 0;
+	size_t m_alignment = 0;
+};
+
 } // end ns
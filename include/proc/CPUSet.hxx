@@ -0,0 +1,144 @@
+#pragma once
+
+// Linux
+#include <sched.h>
+
+// C++
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// cosmos
+#include <cosmos/dso_export.h>
+
+namespace cosmos {
+
+/// A set of CPU numbers used for CPU affinity settings.
+/**
+ * This is a wrapper around the `cpu_set_t` type. It is used to restrict the
+ * CPUs a process or thread is allowed to run on, see
+ * proc::set_affinity(), pthread::set_affinity() and
+ * ChildCloner::setAffinity().
+ *
+ * CPU numbers range from 0 to MAX_CPUS - 1. CPU numbers outside of this
+ * range are silently ignored by the modifying functions.
+ **/
+class COSMOS_API CPUSet {
+public: // types
+
+	/// The maximum number of CPUs that can be represented.
+	static constexpr unsigned MAX_CPUS = CPU_SETSIZE;
+
+public: // functions
+
+	/// Creates an empty CPU set.
+	CPUSet() {
+		clear();
+	}
+
+	/// Creates a CPU set containing the given CPU numbers.
+	CPUSet(const std::initializer_list<unsigned> cpus) :
+			CPUSet{} {
+		for (const auto cpu: cpus) {
+			set(cpu);
+		}
+	}
+
+	/// Creates a CPU set containing the given CPU numbers.
+	explicit CPUSet(const std::vector<unsigned> &cpus) :
+			CPUSet{} {
+		for (const auto cpu: cpus) {
+			set(cpu);
+		}
+	}
+
+	explicit CPUSet(const cpu_set_t &raw) :
+			m_set{raw} {
+	}
+
+	/// Removes all CPUs from the set.
+	void clear() {
+		CPU_ZERO(&m_set);
+	}
+
+	/// Adds the given CPU to the set.
+	void set(const unsigned cpu) {
+		CPU_SET(cpu, &m_set);
+	}
+
+	/// Removes the given CPU from the set.
+	void reset(const unsigned cpu) {
+		CPU_CLR(cpu, &m_set);
+	}
+
+	/// Returns whether the given CPU is part of the set.
+	bool isSet(const unsigned cpu) const {
+		return CPU_ISSET(cpu, &m_set);
+	}
+
+	/// Returns the number of CPUs in the set.
+	size_t count() const {
+		return static_cast<size_t>(CPU_COUNT(&m_set));
+	}
+
+	/// Returns whether no CPU is part of the set.
+	bool empty() const {
+		return count() == 0;
+	}
+
+	/// Returns the list of CPU numbers in the set in ascending order.
+	std::vector<unsigned> cpus() const;
+
+	bool operator==(const CPUSet &other) const {
+		return CPU_EQUAL(&m_set, &other.m_set);
+	}
+
+	bool operator!=(const CPUSet &other) const {
+		return !(*this == other);
+	}
+
+	/// Returns the intersection of both sets.
+	CPUSet operator&(const CPUSet &other) const {
+		CPUSet ret;
+		CPU_AND(&ret.m_set, &m_set, &other.m_set);
+		return ret;
+	}
+
+	/// Returns the union of both sets.
+	CPUSet operator|(const CPUSet &other) const {
+		CPUSet ret;
+		CPU_OR(&ret.m_set, &m_set, &other.m_set);
+		return ret;
+	}
+
+	/// Returns the CPUs of this set that are not part of `other`.
+	CPUSet operator-(const CPUSet &other) const {
+		CPUSet ret = *this | other;
+		CPU_XOR(&ret.m_set, &ret.m_set, &other.m_set);
+		return ret;
+	}
+
+	/// Parses a CPU list in the kernel's format like "0-3,8,10-11".
+	/**
+	 * This format is found e.g. in sysfs or in `/proc/<pid>/status`. An
+	 * empty string results in an empty set. On parse errors a
+	 * RuntimeError is thrown.
+	 **/
+	static CPUSet fromList(const std::string_view list);
+
+	/// Returns the set in the CPU list format understood by fromList().
+	std::string toList() const;
+
+	cpu_set_t* raw() { return &m_set; }
+	const cpu_set_t* raw() const { return &m_set; }
+
+	/// Returns the size of the raw data structure in bytes.
+	static constexpr size_t size() { return sizeof(cpu_set_t); }
+
+protected: // data
+
+	cpu_set_t m_set;
+};
+
+} // end ns
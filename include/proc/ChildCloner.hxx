@@ -9,6 +9,8 @@
 // cosmos
 #include <cosmos/error/UsageError.hxx>
 #include <cosmos/fs/FileDescriptor.hxx>
+#include <cosmos/proc/CPUSet.hxx>
+#include <cosmos/proc/numa.hxx>
 #include <cosmos/proc/Scheduler.hxx>
 #include <cosmos/proc/SubProc.hxx>
 #include <cosmos/string.hxx>
@@ -40,6 +42,8 @@ class Pipe;
  * actions before the child process is replaced by the new target executable.
  **/
 class COSMOS_API ChildCloner {
+	// for transferring the configuration to its helper process
+	friend class SpawnServer;
 public: // types
 
 	/// callback function type used in setPostForkCB().
@@ -235,6 +239,42 @@ public: // functions
 		m_forward_child_errors = forward;
 	}
 
+	/// Enable or disable lightweight vfork() style process creation.
+	/**
+	 * By default child processes are created with fork() semantics, which
+	 * requires the kernel to duplicate the page tables of the current
+	 * process. For processes with a large memory footprint this makes
+	 * process creation expensive. In vfork mode the child process shares
+	 * the address space with the parent (`CLONE_VM|CLONE_VFORK`) and runs
+	 * on a small dedicated stack until it calls `execve()`. The calling
+	 * thread is suspended during this time. This makes the cost of
+	 * run() independent of the parent's memory size.
+	 *
+	 * Since the child shares memory with the parent it may only perform
+	 * async-signal-safe operations. Therefore the following restrictions
+	 * apply in this mode:
+	 *
+	 * - setPostForkCB() and setNoExe() cannot be used, run() throws a
+	 *   UsageError if they are configured.
+	 * - the argument and environment vectors are prepared in the parent.
+	 * - errors in applying scheduler settings are silently ignored in
+	 *   the child instead of being printed.
+	 * - all file descriptors except stdin, stdout, stderr and those
+	 *   added via addInheritFD() are marked close-on-exec in the child
+	 *   via `close_range()`, even if the caller did not set the flag.
+	 *
+	 * Pre-execve() errors are communicated to the parent via shared
+	 * memory, thus setForwardChildErrors() is supported without the
+	 * extra cost of a Pipe.
+	 *
+	 * When running on Valgrind the regular process creation is used
+	 * instead, since Valgrind does not support sharing the address space
+	 * this way.
+	 **/
+	void setUseVFork(const bool vfork) {
+		m_use_vfork = vfork;
+	}
+
 	/// Sets scheduler type and settings.
 	/**
 	 * By default the parent's scheduling settings will be inherited. If
@@ -247,6 +287,52 @@ public: // functions
 	/// clear previously set scheduler settings and inherit them from the parent instead
 	void setInheritSchedulerSettings() { m_sched_settings.reset(); }
 
+	/// Restrict the child process to the given set of CPUs.
+	/**
+	 * By default the parent's CPU affinity is inherited. Like scheduler
+	 * settings, errors applying the affinity in the child are treated as
+	 * non-critical.
+	 *
+	 * \see proc::set_affinity()
+	 **/
+	void setAffinity(const CPUSet &cpus) { m_affinity = cpus; }
+
+	/// Clear a previously set CPU affinity and inherit it from the parent instead.
+	void setInheritAffinity() { m_affinity.reset(); }
+
+	/// Sets the NUMA memory policy for the child process.
+	/**
+	 * By default the parent's memory policy is inherited. Errors applying
+	 * the policy in the child are treated as non-critical.
+	 *
+	 * \see numa::set_mem_policy()
+	 **/
+	void setMemPolicy(const numa::MemPolicySettings &settings) { m_mem_policy = settings; }
+
+	/// Clear a previously set memory policy and inherit it from the parent instead.
+	void setInheritMemPolicy() { m_mem_policy.reset(); }
+
+	/// Place the child process into the given cgroup version 2.
+	/**
+	 * `dir_fd` needs to be an open file descriptor of a cgroup2
+	 * directory. The child is atomically created as a member of this
+	 * cgroup via CloneFlag::INTO_CGROUP, thus resource limits apply
+	 * right from the start. If the child cannot be placed into the
+	 * cgroup then run() throws an ApiError.
+	 *
+	 * In vfork mode and when running on Valgrind clone3() is not
+	 * available. In this case the child moves itself into the cgroup by
+	 * writing to the `cgroup.procs` file before execve(). A failure to do
+	 * so is still reported via an ApiError from run(), independently of
+	 * setForwardChildErrors(). When running on Valgrind this means that
+	 * run() blocks until the child called execve(), like described for
+	 * setForwardChildErrors().
+	 *
+	 * The file descriptor needs to stay open until run() returns. Pass an
+	 * invalid file descriptor to disable this feature again.
+	 **/
+	void setCGroup(const FileDescriptor dir_fd) { m_cgroup = dir_fd; }
+
 	/// Sets a callback function to be invoked in the child process context.
 	/**
 	 * This function will be invoked in the child process after the clone
@@ -327,6 +413,9 @@ protected: // functions
 	/// restore a default signal mask in child process context.
 	void resetSignals();
 
+	/// Moves the calling process into m_cgroup (used in child context).
+	void joinCGroup();
+
 	/// Redirects the given \p orig file descriptor to \p redirect (used in child context).
 	/**
 	 * \param[in] orig The file descriptor that should be replaced by `redirect`
@@ -352,6 +441,12 @@ protected: // functions
 
 	std::optional<SubProc> runClone3();
 
+	/// Create the child process in vfork() mode, see setUseVFork().
+	SubProc runVFork();
+
+	/// Whether the child needs to join m_cgroup itself in runChild().
+	bool joinsCGroupManually() const;
+
 	void runChild(std::optional<Pipe> &error_pipe);
 
 	void reportPreExecErrorAndExit(Pipe &pipe,
@@ -390,6 +485,19 @@ protected: // data
 
 	/// Whether to forward errors occurring in child context to the parent
 	bool m_forward_child_errors = false;
+
+	/// Whether to use the lightweight vfork() style process creation
+	bool m_use_vfork = false;
+
+	/// CPU affinity for the child, if any
+	std::optional<CPUSet> m_affinity;
+	/// NUMA memory policy for the child, if any
+	std::optional<numa::MemPolicySettings> m_mem_policy;
+	/// cgroup2 directory to place the child into, if any
+	FileDescriptor m_cgroup;
+
+	/// Whether to create the child as a sibling of the current process (used by SpawnServer)
+	bool m_share_parent = false;
 };
 
 } // end ns
@@ -0,0 +1,178 @@
+#pragma once
+
+// C++
+#include <map>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// cosmos
+#include <cosmos/dso_export.h>
+#include <cosmos/io/Poller.hxx>
+#include <cosmos/proc/signal.hxx>
+#include <cosmos/proc/SubProc.hxx>
+#include <cosmos/proc/types.hxx>
+#include <cosmos/time/TimerFD.hxx>
+#include <cosmos/time/types.hxx>
+
+namespace cosmos {
+
+/// Supervises a large number of child processes using a single Poller.
+/**
+ * SubProc::waitTimed() is fine for waiting on an individual child process,
+ * but supervising thousands of children this way is not feasible. The
+ * ChildReaper takes ownership of SubProc instances via add() and registers
+ * their pidfds in a single, shared Poller. A call to wait() blocks until at
+ * least one of the children exits and then returns all children that exited
+ * in a batch. The exited children are reaped, i.e. their exit status is
+ * collected and the associated resources are freed.
+ *
+ * Optionally each child can be assigned a Deadline. When a deadline
+ * expires the configured signal is sent to the child, optionally followed by
+ * signal::KILL after a grace period. All deadlines are managed via a single
+ * MonotonicTimerFD that is also registered in the Poller, which is always
+ * armed for the closest pending deadline. Deadlines are only processed while
+ * a wait() call is active.
+ *
+ * Like for SubProc, all children need to be reaped before the ChildReaper is
+ * destroyed, otherwise the program is aborted. This can be achieved by
+ * calling killAll() followed by wait() calls until empty() returns `true`.
+ *
+ * This type is not thread safe.
+ **/
+class COSMOS_API ChildReaper {
+	// disallow copy/assignment due to the file descriptor members
+	ChildReaper(const ChildReaper&) = delete;
+	ChildReaper& operator=(const ChildReaper&) = delete;
+public: // types
+
+	/// Time limit for a child process.
+	struct Deadline {
+		/// Time, relative to the point of setting the deadline, after which `signal` is sent.
+		IntervalTime timeout;
+		/// The signal to send to the child once `timeout` expired.
+		Signal signal = signal::KILL;
+		/// Grace period after which signal::KILL is sent, if the child is still running.
+		std::optional<IntervalTime> kill_after;
+	};
+
+	/// Information about a child process reaped in wait().
+	struct Result {
+		/// The PID the child process had.
+		ProcessID pid = ProcessID::INVALID;
+		/// The final state of the child.
+		ChildState state;
+		/// Whether the deadline of the child expired before it exited.
+		bool deadline_expired = false;
+	};
+
+	using ResultVector = std::vector<Result>;
+
+public: // functions
+
+	/// Creates a ChildReaper ready for use.
+	/**
+	 * \param[in] max_events The maximum number of child exit events
+	 * processed by a single system call in wait().
+	 **/
+	explicit ChildReaper(const size_t max_events = 64);
+
+	/// Add a child process to be monitored.
+	/**
+	 * The ChildReaper takes over ownership of `proc`, which needs to be
+	 * running(), otherwise a UsageError is thrown. Its PID is returned,
+	 * which serves as a key for the other functions of this class.
+	 **/
+	ProcessID add(SubProc &&proc, const std::optional<Deadline> &deadline = {});
+
+	/// Set a new deadline for the given child, replacing any previous deadline.
+	void setDeadline(const ProcessID pid, const Deadline &deadline);
+
+	/// Remove any pending deadline for the given child.
+	void clearDeadline(const ProcessID pid);
+
+	/// Send a signal to the given child.
+	void kill(const ProcessID pid, const Signal signal);
+
+	/// Send a signal to all monitored children.
+	/**
+	 * Errors occurring while sending the signals are ignored, since
+	 * children that already exited cannot receive signals anymore.
+	 **/
+	void killAll(const Signal signal);
+
+	/// Returns whether the given child is currently monitored.
+	bool contains(const ProcessID pid) const {
+		return m_pids.find(pid) != m_pids.end();
+	}
+
+	/// Returns the number of currently monitored children.
+	size_t size() const {
+		return m_children.size();
+	}
+
+	/// Returns whether no children are monitored.
+	bool empty() const {
+		return m_children.empty();
+	}
+
+	/// Waits for monitored children to exit.
+	/**
+	 * Blocks until at least one of the monitored children exited or until
+	 * `timeout` expired. Pending deadlines are processed during the wait.
+	 * All exited children are reaped, removed from the ChildReaper and
+	 * stored in `results`, which is cleared beforehand. Reusing the same
+	 * `results` vector avoids repeated memory allocations.
+	 *
+	 * If no children are monitored then this returns immediately.
+	 **/
+	void wait(ResultVector &results, const std::optional<IntervalTime> timeout = {});
+
+protected: // types
+
+	using DeadlineMap = std::multimap<MonotonicTime, FileNum>;
+
+	/// Book keeping for a single monitored child.
+	struct Child {
+		SubProc proc;
+		/// The currently pending deadline, if any.
+		std::optional<DeadlineMap::iterator> deadline;
+		/// The signal to send once the pending deadline expires.
+		Signal signal = signal::KILL;
+		/// The grace period to apply after sending `signal`.
+		std::optional<IntervalTime> kill_after;
+		/// Whether a deadline of the child already expired.
+		bool expired = false;
+	};
+
+protected: // functions
+
+	Child& getChild(const ProcessID pid);
+
+	void addDeadline(Child &child, const MonotonicTime when);
+
+	void removeDeadline(Child &child);
+
+	/// Sends signals for all expired deadlines.
+	void processDeadlines();
+
+	/// Arms m_timer for the closest pending deadline.
+	void updateTimer();
+
+	void reap(const FileNum fd, ResultVector &results);
+
+protected: // data
+
+	Poller m_poller;
+	MonotonicTimerFD m_timer;
+	/// The time m_timer is currently armed for, if any.
+	std::optional<MonotonicTime> m_timer_expiry;
+	/// Children keyed by their pidfd, as reported by the Poller.
+	std::unordered_map<FileNum, Child> m_children;
+	/// Mapping of PIDs to pidfds.
+	std::unordered_map<ProcessID, FileNum> m_pids;
+	/// All pending deadlines ordered by expiry time.
+	DeadlineMap m_deadlines;
+};
+
+} // end ns
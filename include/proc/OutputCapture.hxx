@@ -0,0 +1,212 @@
+#pragma once
+
+// C++
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// cosmos
+#include <cosmos/dso_export.h>
+#include <cosmos/fs/FileDescriptor.hxx>
+#include <cosmos/io/Pipe.hxx>
+#include <cosmos/io/Poller.hxx>
+#include <cosmos/time/types.hxx>
+
+namespace cosmos {
+
+class ChildCloner;
+
+/// Collects stdout and stderr of many child processes in a single thread.
+/**
+ * Reading the output of a child process via a blocking read on a Pipe
+ * requires a dedicated thread per pipe, if multiple children run in
+ * parallel. An OutputCapture instead multiplexes the read ends of the stdout
+ * and stderr pipes of many children in a single Poller, without helper
+ * threads.
+ *
+ * Each captured stream is associated with a Target. A memory target collects
+ * the output in a std::string up to a configurable maximum size. Any excess
+ * data is still drained from the pipe, to prevent the child from blocking,
+ * but is discarded and the StreamData is marked as truncated. A file target
+ * forwards the output to a file descriptor using fs::splice(), without
+ * routing the data through userspace.
+ *
+ * The usage is as follows:
+ *
+ * - configure a ChildCloner and call prepare() to redirect its stdout
+ *   and/or stderr into new pipes.
+ * - run the child process.
+ * - call started() to close the write ends of the pipes in the current
+ *   process and to start monitoring the read ends. If the child could not
+ *   be started then call discard() instead.
+ * - call process() repeatedly until finished() returns `true` for the
+ *   child.
+ * - retrieve the captured data via take().
+ *
+ * Note that the write ends of the pipes will be inherited by other child
+ * processes created between prepare() and started(). In this case the
+ * streams are only finished once these other children closed them, too.
+ * This is relevant in multi-threaded programs.
+ *
+ * This type is not thread safe.
+ **/
+class COSMOS_API OutputCapture {
+	// disallow copy/assignment due to the file descriptor members
+	OutputCapture(const OutputCapture&) = delete;
+	OutputCapture& operator=(const OutputCapture&) = delete;
+public: // types
+
+	/// Identifies the capture of a single child process.
+	using Handle = size_t;
+
+	/// Default memory limit per captured stream.
+	static constexpr size_t DEFAULT_MAX_MEMORY = 1024 * 1024;
+
+	/// Describes where captured output is supposed to go.
+	struct Target {
+		/// Maximum number of bytes kept in memory for a memory target.
+		size_t max_memory = DEFAULT_MAX_MEMORY;
+		/// If valid then output is forwarded to this file descriptor instead of memory.
+		/**
+		 * The file descriptor must not be opened with
+		 * OpenFlag::APPEND, see fs::splice(). Ownership stays with the
+		 * caller.
+		 **/
+		FileDescriptor file;
+
+		/// Returns a Target collecting up to `max_bytes` in memory.
+		static Target toMemory(const size_t max_bytes = DEFAULT_MAX_MEMORY) {
+			Target ret;
+			ret.max_memory = max_bytes;
+			return ret;
+		}
+
+		/// Returns a Target forwarding to the file descriptor `fd`.
+		static Target toFile(const FileDescriptor fd) {
+			Target ret;
+			ret.file = fd;
+			return ret;
+		}
+	};
+
+	/// The captured data of a single stream.
+	struct StreamData {
+		/// The data collected for memory targets.
+		std::string data;
+		/// Total number of bytes the child wrote to the stream.
+		size_t total = 0;
+		/// Whether data exceeding Target::max_memory has been discarded.
+		bool truncated = false;
+	};
+
+	/// The captured data of a child process, as returned from take().
+	struct Result {
+		StreamData out;
+		StreamData err;
+	};
+
+public: // functions
+
+	/// Creates an OutputCapture instance ready for use.
+	/**
+	 * \param[in] pipe_size If set then the buffer size of each newly
+	 * created pipe is increased to this value via
+	 * FileDescriptor::setPipeSize(). Larger buffers allow children to
+	 * write more data before blocking and reduce the number of wakeups.
+	 * Failure to change the size is ignored, since unprivileged processes
+	 * are limited by /proc/sys/fs/pipe-max-size.
+	 *
+	 * \param[in] max_events The maximum number of I/O events processed by
+	 * a single system call in process().
+	 **/
+	explicit OutputCapture(const std::optional<int> pipe_size = {}, const size_t max_events = 64);
+
+	/// Prepares capturing output of the child process to be created via `cloner`.
+	/**
+	 * For each stream for which a Target is passed a new Pipe is created
+	 * and its write end is configured as stdout/stderr in `cloner`. A
+	 * stream without Target is left untouched.
+	 *
+	 * The returned Handle is used to refer to this child's capture in the
+	 * other member functions.
+	 **/
+	Handle prepare(ChildCloner &cloner, const std::optional<Target> &out,
+			const std::optional<Target> &err = {});
+
+	/// Start monitoring the pipes of a child process created after prepare().
+	void started(const Handle handle);
+
+	/// Drop a capture from prepare(), if the child process could not be created.
+	void discard(const Handle handle);
+
+	/// Waits for and processes output of the monitored children.
+	/**
+	 * Blocks until output of any of the monitored children is available
+	 * or until `timeout` expired. All available output is processed,
+	 * possibly causing further children to be finished().
+	 *
+	 * Returns `false` if the timeout occurred or if there is nothing to
+	 * monitor, `true` otherwise.
+	 **/
+	bool process(const std::optional<IntervalTime> timeout = {});
+
+	/// Returns whether all streams of the given child reached end-of-file.
+	bool finished(const Handle handle) const;
+
+	/// Returns the number of children whose streams are still monitored.
+	size_t active() const {
+		return m_num_active;
+	}
+
+	/// Returns the captured data of the given child and forgets about it.
+	/**
+	 * If the child is not yet finished() then a UsageError is thrown.
+	 **/
+	Result take(const Handle handle);
+
+protected: // types
+
+	/// State of a single captured stream.
+	struct Channel {
+		/// The pipe for this stream, if it is captured at all.
+		std::optional<Pipe> pipe;
+		Target target;
+		StreamData result;
+		/// Whether the read end is currently monitored.
+		bool active = false;
+	};
+
+	/// State of all streams of a child.
+	struct Capture {
+		Channel out;
+		Channel err;
+		bool started = false;
+	};
+
+protected: // functions
+
+	void setupChannel(Channel &channel, const Target &target);
+
+	Capture& getCapture(const Handle handle);
+
+	/// Transfers available data from the given channel, returns `false` on EOF.
+	bool transfer(Channel &channel);
+
+	void finishChannel(Channel &channel);
+
+protected: // data
+
+	Poller m_poller;
+	std::optional<int> m_pipe_size;
+	Handle m_next_handle = 0;
+	size_t m_num_active = 0;
+	std::unordered_map<Handle, Capture> m_captures;
+	/// Maps pipe read ends to the owning capture and the stdout (`false`) or stderr (`true`) channel.
+	std::unordered_map<FileNum, std::pair<Handle, bool>> m_fds;
+	/// Scratch buffer for reading from pipes.
+	std::vector<char> m_buffer;
+};
+
+} // end ns
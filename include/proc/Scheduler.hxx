@@ -1,14 +1,19 @@
 #pragma once
 
 // Linux
+#include <linux/sched.h>
 #include <sched.h>
 
 // C++
+#include <chrono>
+#include <optional>
 #include <variant>
 
 // Cosmos
+#include <cosmos/BitMask.hxx>
 #include <cosmos/dso_export.h>
 #include <cosmos/proc/types.hxx>
+#include <cosmos/thread/thread.hxx>
 
 namespace cosmos {
 
@@ -27,13 +32,56 @@ enum class SchedulerPolicy : int {
 	INVALID     = -1
 };
 
+/// Flags influencing the behaviour of `sched_setattr()`.
+enum class SchedulerFlag : uint64_t {
+	/// Children created via fork() don't inherit privileged scheduling policies.
+	RESET_ON_FORK   = SCHED_FLAG_RESET_ON_FORK,
+	/// DEADLINE tasks may reclaim bandwidth unused by other tasks (GRUB algorithm).
+	RECLAIM         = SCHED_FLAG_RECLAIM,
+	/// DEADLINE tasks receive SIGXCPU when overrunning their runtime.
+	DL_OVERRUN      = SCHED_FLAG_DL_OVERRUN,
+	/// Apply the minimum utilization clamp value.
+	UTIL_CLAMP_MIN  = SCHED_FLAG_UTIL_CLAMP_MIN,
+	/// Apply the maximum utilization clamp value.
+	UTIL_CLAMP_MAX  = SCHED_FLAG_UTIL_CLAMP_MAX
+};
+
+using SchedulerFlags = BitMask<SchedulerFlag>;
+
 /// Base class for changing process scheduling options.
 /**
  * Specializations of this type can be used to create child processes with
  * adjusted scheduling settings or to adjust the scheduling settings or
  * existing processes.
+ *
+ * The settings are applied via the Linux specific `sched_setattr()` system
+ * call, which supports all policies and some settings common to all of them.
  **/
 class COSMOS_API SchedulerSettings {
+	// for preparing the settings ahead of a vfork() style clone or for a
+	// SpawnServer request
+	friend class ChildCloner;
+	friend class SpawnServer;
+	// for constructing settings from sched_getattr()
+	friend void load_scheduler_settings(SchedulerSettings &, const struct sched_attr &);
+public: // types
+
+	/// Utilization clamping range.
+	/**
+	 * Utilization values range from 0 to MAX_UTILIZATION, which
+	 * corresponds to a task running all the time on the most capable CPU.
+	 * The minimum value acts as a performance boost hint for CPU
+	 * frequency selection and task placement, the maximum value caps the
+	 * performance a task is supposed to receive.
+	 **/
+	struct UtilClamp {
+		unsigned min = 0;
+		unsigned max = 1024;
+	};
+
+	/// The maximum utilization value in UtilClamp.
+	static constexpr unsigned MAX_UTILIZATION = 1024;
+
 public: // functions
 
 	SchedulerSettings() {}
@@ -42,6 +90,8 @@ public: // functions
 			m_policy{policy}
 	{}
 
+	virtual ~SchedulerSettings() {}
+
 	SchedulerPolicy policy() const { return m_policy; }
 
 	/// Apply the current scheduler settings to the given process.
@@ -53,14 +103,56 @@ public: // functions
 	 **/
 	void apply(ProcessID pid) const;
 
+	/// Apply the current scheduler settings to the given thread.
+	/**
+	 * Scheduler settings are actually per-thread attributes on Linux.
+	 * This applies the settings only to the thread `tid`, other threads
+	 * of the process are unaffected. ThreadID::SELF refers to the calling
+	 * thread.
+	 **/
+	void apply(const ThreadID tid) const {
+		apply(as_pid(tid));
+	}
+
+	/// Sets a utilization clamping range (since Linux 5.3).
+	/**
+	 * This requires kernel support for utilization clamping
+	 * (CONFIG_UCLAMP_TASK), otherwise apply() fails with
+	 * Errno::OP_NOT_SUPPORTED. Increasing the minimum value may require
+	 * CAP_SYS_NICE.
+	 **/
+	void setUtilClamp(const UtilClamp clamp) { m_util_clamp = clamp; }
+
+	/// Don't change the utilization clamping range when applying settings.
+	void resetUtilClamp() { m_util_clamp.reset(); }
+
+	const std::optional<UtilClamp>& utilClamp() const { return m_util_clamp; }
+
+	/// Don't inherit privileged settings into child processes.
+	/**
+	 * If set then children created by the affected thread are reset to
+	 * the OTHER policy and a non-negative nice value. This is required for
+	 * DEADLINE tasks which want to create child processes.
+	 **/
+	void setResetOnFork(const bool reset) {
+		m_flags.set(SchedulerFlag::RESET_ON_FORK, reset);
+	}
+
+	bool resetOnFork() const { return m_flags[SchedulerFlag::RESET_ON_FORK]; }
+
 protected: // functions
 
 	/// Fill the given low level sched_attr struct with the current settings.
 	virtual void fillStruct(struct sched_attr &attr) const = 0;
 
+	/// Takes over the settings from the given low level sched_attr struct.
+	virtual void loadStruct(const struct sched_attr &attr);
+
 protected: // data
 
 	SchedulerPolicy m_policy = SchedulerPolicy::INVALID;
+	SchedulerFlags m_flags;
+	std::optional<UtilClamp> m_util_clamp;
 };
 
 /// "OTHER" Scheduling Policy Settings.
@@ -102,8 +194,14 @@ public: // functions
 
 protected: // functions
 
+	explicit OtherSchedulerSettings(const SchedulerPolicy policy) :
+			SchedulerSettings{policy}
+	{}
+
 	void fillStruct(struct sched_attr &attr) const override;
 
+	void loadStruct(const struct sched_attr &attr) override;
+
 protected: // data
 
 	/// A constant denoting an invalid nice value
@@ -143,6 +241,8 @@ protected: // functions
 
 	void fillStruct(struct sched_attr &attr) const override;
 
+	void loadStruct(const struct sched_attr &attr) override;
+
 protected: // data
 
 	int m_priority = 0;
@@ -182,10 +282,132 @@ public: // functions
 	{}
 };
 
+/// BATCH Scheduling Policy Settings.
+/**
+ * This is similar to the OTHER policy, but the scheduler assumes the
+ * process is CPU intensive and non-interactive. It receives a small
+ * scheduling penalty regarding wakeups, which is useful for throughput
+ * oriented background work. The nice value is considered like for the
+ * OTHER policy.
+ **/
+class COSMOS_API BatchSchedulerSettings :
+		public OtherSchedulerSettings {
+public: // functions
+
+	BatchSchedulerSettings() :
+			OtherSchedulerSettings{SchedulerPolicy::BATCH}
+	{}
+};
+
+/// IDLE Scheduling Policy Settings.
+/**
+ * Processes with this policy only receive CPU time if nothing else needs to
+ * run, their priority is even lower than that of OTHER processes with nice
+ * value 19.
+ **/
+class COSMOS_API IdleSchedulerSettings :
+		public SchedulerSettings {
+public: // functions
+
+	IdleSchedulerSettings() :
+			SchedulerSettings{SchedulerPolicy::IDLE}
+	{}
+
+protected: // functions
+
+	void fillStruct(struct sched_attr &attr) const override;
+};
+
+/// DEADLINE Scheduling Policy Settings.
+/**
+ * Deadline scheduling guarantees a task `runtime` amount of CPU time within
+ * every `period`, finished at the latest after `deadline` relative to the
+ * start of the period. This is suitable for periodic control loops with a
+ * known worst case execution time. DEADLINE tasks take precedence over all
+ * other policies.
+ *
+ * The kernel performs an admission test when applying the settings, which
+ * fails with Errno::BUSY if the requested bandwidth (runtime / period) is
+ * not available. The parameters need to fulfill `runtime <= deadline <=
+ * period` and `runtime` needs to be at least 1024 nanoseconds. If `period`
+ * is zero then it is considered equal to `deadline`.
+ *
+ * Applying this policy requires CAP_SYS_NICE. Tasks with a restricted CPU
+ * affinity cannot use it, neither can DEADLINE tasks create child
+ * processes, unless setResetOnFork() is used. To create a child process
+ * running with this policy use ChildCloner::setSchedulerSettings(), which
+ * applies the settings in the child process.
+ **/
+class COSMOS_API DeadlineSchedulerSettings :
+		public SchedulerSettings {
+public: // functions
+
+	DeadlineSchedulerSettings() :
+			SchedulerSettings{SchedulerPolicy::DEADLINE}
+	{}
+
+	DeadlineSchedulerSettings(const std::chrono::nanoseconds runtime,
+			const std::chrono::nanoseconds deadline,
+			const std::chrono::nanoseconds period = std::chrono::nanoseconds{0}) :
+			DeadlineSchedulerSettings{} {
+		setRuntime(runtime);
+		setDeadline(deadline);
+		setPeriod(period);
+	}
+
+	/// Sets the CPU time guaranteed in each period.
+	void setRuntime(const std::chrono::nanoseconds runtime) { m_runtime = runtime; }
+	/// Sets the time relative to the period start until which the runtime is granted.
+	void setDeadline(const std::chrono::nanoseconds deadline) { m_deadline = deadline; }
+	/// Sets the length of the period.
+	void setPeriod(const std::chrono::nanoseconds period) { m_period = period; }
+
+	auto runtime() const { return m_runtime; }
+	auto deadline() const { return m_deadline; }
+	auto period() const { return m_period; }
+
+	/// Allow to reclaim bandwidth not used by other DEADLINE tasks.
+	void setReclaim(const bool reclaim) {
+		m_flags.set(SchedulerFlag::RECLAIM, reclaim);
+	}
+
+	bool reclaim() const { return m_flags[SchedulerFlag::RECLAIM]; }
+
+	/// Receive SIGXCPU when the runtime of a period is exceeded.
+	void setOverrunSignal(const bool overrun) {
+		m_flags.set(SchedulerFlag::DL_OVERRUN, overrun);
+	}
+
+	bool overrunSignal() const { return m_flags[SchedulerFlag::DL_OVERRUN]; }
+
+protected: // functions
+
+	void fillStruct(struct sched_attr &attr) const override;
+
+	void loadStruct(const struct sched_attr &attr) override;
+
+protected: // data
+
+	std::chrono::nanoseconds m_runtime{0};
+	std::chrono::nanoseconds m_deadline{0};
+	std::chrono::nanoseconds m_period{0};
+};
+
 /// A variant that can hold any of the specialized SchedulerSettings types.
 using SchedulerSettingsVariant = std::variant<
 		OtherSchedulerSettings,
 		FifoSchedulerSettings,
-		RoundRobinSchedulerSettings>;
+		RoundRobinSchedulerSettings,
+		BatchSchedulerSettings,
+		IdleSchedulerSettings,
+		DeadlineSchedulerSettings>;
+
+/// Returns the current scheduler settings of the given process or thread.
+/**
+ * This uses the `sched_getattr()` system call. If `pid` is zero then the
+ * settings of the calling thread are returned. If the operation fails then
+ * an ApiError is thrown.
+ **/
+COSMOS_API SchedulerSettingsVariant get_scheduler_settings(const ProcessID pid = ProcessID::SELF);
 
 } // end ns
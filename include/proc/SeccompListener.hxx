@@ -0,0 +1,260 @@
+#pragma once
+
+// C++
+#include <optional>
+#include <stdint.h>
+
+// Linux
+#include <linux/seccomp.h>
+
+// cosmos
+#include <cosmos/dso_export.h>
+#include <cosmos/error/errno.hxx>
+#include <cosmos/fs/FDFile.hxx>
+#include <cosmos/memory.hxx>
+#include <cosmos/net/unix/UnixConnection.hxx>
+#include <cosmos/proc/ptrace.hxx>
+#include <cosmos/proc/types.hxx>
+#include <cosmos/utils.hxx>
+
+/**
+ * @file
+ *
+ * Support for supervising seccomp::Action::USER_NOTIF system calls from user
+ * space (see `man 2 seccomp_unotify`).
+ **/
+
+namespace cosmos::seccomp {
+
+/// A system call reported via a seccomp Listener.
+/**
+ * This wraps the `struct seccomp_notif` data structure. It describes a
+ * system call that has been stopped due to a seccomp::Result::notify()
+ * filter result. The target thread remains blocked until a Response for the
+ * notification is sent via Listener::respond().
+ *
+ * Note that the system call arguments are raw register values. Pointer
+ * arguments refer to the address space of the target process, which can be
+ * accessed e.g. via Tracee::readMemory(). Since the target can modify its
+ * memory concurrently, such data must not be trusted for security decisions.
+ **/
+class Notification {
+public: // functions
+
+	/// Creates a zero-initialized Notification.
+	Notification() {
+		clear();
+	}
+
+	/// Leaves the underlying data structure uninitialized.
+	Notification(const no_init_t) {}
+
+	void clear() {
+		zero_object(m_raw);
+	}
+
+	/// Returns the unique ID of the notification, used to match a Response.
+	uint64_t id() const { return m_raw.id; }
+
+	/// Returns the ID of the thread that triggered the notification.
+	/**
+	 * The ID is relative to the PID namespace of the Listener and is
+	 * ProcessID::INVALID if the target is not visible there.
+	 **/
+	ProcessID pid() const {
+		return m_raw.pid == 0 ? ProcessID::INVALID : ProcessID{static_cast<pid_t>(m_raw.pid)};
+	}
+
+	/// Returns the system call number as found in `sys/syscall.h`.
+	long syscallNr() const { return m_raw.data.nr; }
+
+	/// Returns the system call ABI of the system call.
+	ptrace::Arch arch() const { return ptrace::Arch{m_raw.data.arch}; }
+
+	/// Returns the instruction pointer of the target at the time of the system call.
+	uint64_t instructionPointer() const { return m_raw.data.instruction_pointer; }
+
+	/// Returns the raw value of the system call argument at `index` (0 to 5).
+	uint64_t arg(const size_t index) const {
+		return m_raw.data.args[index];
+	}
+
+	const struct seccomp_notif* raw() const { return &m_raw; }
+	struct seccomp_notif* raw() { return &m_raw; }
+
+protected: // data
+
+	struct seccomp_notif m_raw;
+};
+
+/// The reply to a Notification.
+/**
+ * This wraps the `struct seccomp_notif_resp` data structure. A Response
+ * determines the outcome of the system call in the target thread, see the
+ * static factory functions for the available possibilities.
+ **/
+class Response {
+public: // functions
+
+	/// The system call is not executed but returns `value` to the target.
+	static Response success(const Notification &notif, const int64_t value = 0) {
+		Response ret{notif};
+		ret.m_raw.val = value;
+		return ret;
+	}
+
+	/// The system call is not executed but fails with the given error.
+	static Response error(const Notification &notif, const Errno err) {
+		Response ret{notif};
+		ret.m_raw.error = -to_integral(err);
+		return ret;
+	}
+
+	/// The system call is executed by the kernel as usual.
+	/**
+	 * This must be used with care: for pointer arguments the target may
+	 * have changed the pointed-to data between the inspection by the
+	 * supervisor and the actual execution (a TOCTOU race). This is only
+	 * safe for making decisions based on non-pointer arguments.
+	 **/
+	static Response cont(const Notification &notif) {
+		Response ret{notif};
+		ret.m_raw.flags = SECCOMP_USER_NOTIF_FLAG_CONTINUE;
+		return ret;
+	}
+
+	uint64_t id() const { return m_raw.id; }
+
+	const struct seccomp_notif_resp* raw() const { return &m_raw; }
+
+protected: // functions
+
+	explicit Response(const Notification &notif) {
+		zero_object(m_raw);
+		m_raw.id = notif.id();
+	}
+
+protected: // data
+
+	struct seccomp_notif_resp m_raw;
+};
+
+/// Wrapper around a seccomp user notification listener file descriptor.
+/**
+ * A listener file descriptor is obtained by installing a seccomp Filter with
+ * FilterFlag::NEW_LISTENER. System calls for which the filter returns
+ * Result::notify() are then forwarded to the listener and the calling thread
+ * blocks until a Response is sent. The supervising process can emulate
+ * system calls this way at a much lower cost than a ptrace() based
+ * supervisor, since only the selected system calls cause context switches.
+ *
+ * Typically the filter is installed in a child process, but supervised from
+ * the parent. The listener then needs to be passed to the parent via a UNIX
+ * domain socket, see send_listener() and receive_listener():
+ *
+ * \code
+ * auto [parent_end, child_end] = net::create_stream_socket_pair();
+ * seccomp::Filter filter;
+ * filter.set(SYS_openat, seccomp::Result::notify());
+ *
+ * cloner.setPostForkCB([&](const ChildCloner&) {
+ *     seccomp::send_listener(child_end, filter.install({seccomp::FilterFlag::NEW_LISTENER}));
+ * });
+ *
+ * auto proc = cloner.run();
+ * auto listener = seccomp::receive_listener(parent_end);
+ * \endcode
+ *
+ * The listener becomes readable when a notification is pending, thus fd()
+ * can be monitored via a Poller for MonitorFlag::INPUT. Once all processes
+ * using the filter have exited the file descriptor reports a hangup
+ * condition.
+ *
+ * Many operations of this class throw an ApiError with Errno::NO_ENTRY if
+ * the target thread has been interrupted or killed while a notification was
+ * pending. This is not a fatal condition for the Listener.
+ **/
+class COSMOS_API Listener :
+		protected FDFile {
+public: // functions
+
+	/// Creates an object without an associated listener.
+	Listener() = default;
+
+	/// Wraps the given listener file descriptor.
+	explicit Listener(const FileDescriptor fd, const AutoCloseFD auto_close = AutoCloseFD{true}) :
+			FDFile{fd, auto_close}
+	{}
+
+	Listener(Listener &&other) = default;
+	Listener& operator=(Listener &&other) = default;
+
+	using FDFile::close;
+	using FileBase::fd;
+	using FileBase::isOpen;
+
+	/// Receives the next pending notification into `notif`.
+	/**
+	 * This blocks until a notification arrives, unless fd() has been
+	 * reported as readable before.
+	 **/
+	void receive(Notification &notif);
+
+	/// Sends the response for a previously received notification.
+	void respond(const Response &resp);
+
+	/// Checks whether the notification is still pending.
+	/**
+	 * This needs to be checked after reading data from the target's
+	 * memory to ensure the data actually belongs to the notification
+	 * (i.e. the target was not killed and its PID reused meanwhile).
+	 **/
+	bool isValid(const Notification &notif);
+
+	/// Installs a copy of `fd` in the target process of `notif`.
+	/**
+	 * This allows to emulate system calls that return new file
+	 * descriptors like `openat()`. By default the lowest available file
+	 * descriptor number in the target is used, `target` selects a
+	 * specific number instead, replacing an existing file descriptor, if
+	 * necessary.
+	 *
+	 * The file descriptor number in the target process is returned. The
+	 * notification still needs to be responded to separately.
+	 **/
+	FileNum addFD(const Notification &notif, const FileDescriptor fd,
+			const CloseOnExec cloexec = CloseOnExec{true},
+			const std::optional<FileNum> target = {});
+
+	/// Installs a copy of `fd` in the target and uses it as the system call result.
+	/**
+	 * This atomically performs addFD() and respond(), returning the new
+	 * file descriptor number as result of the system call in the target.
+	 * This avoids races where the target could be interrupted between
+	 * both operations and leak the file descriptor.
+	 *
+	 * This is only supported since Linux 5.14.
+	 **/
+	FileNum respondWithFD(const Notification &notif, const FileDescriptor fd,
+			const CloseOnExec cloexec = CloseOnExec{true});
+};
+
+/// Sends a seccomp listener file descriptor to a supervisor process.
+/**
+ * This is intended for use in a ChildCloner post-fork callback after
+ * installing a Filter with FilterFlag::NEW_LISTENER. The `listener` is passed
+ * via a UnixRightsMessage and closed afterwards.
+ *
+ * Note that this must not be called if the filter already applies
+ * Result::notify() to `sendmsg()`, otherwise the process deadlocks.
+ **/
+COSMOS_API void send_listener(UnixConnection &conn, FileDescriptor listener);
+
+/// Receives a seccomp listener file descriptor sent via send_listener().
+/**
+ * If the peer closes the connection without sending a listener then a
+ * RuntimeError is thrown.
+ **/
+COSMOS_API Listener receive_listener(UnixConnection &conn);
+
+} // end ns
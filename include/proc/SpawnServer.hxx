@@ -0,0 +1,116 @@
+#pragma once
+
+// C++
+#include <string>
+
+// cosmos
+#include <cosmos/dso_export.h>
+#include <cosmos/net/unix/aux.hxx>
+#include <cosmos/net/unix/UnixConnection.hxx>
+#include <cosmos/proc/SubProc.hxx>
+#include <cosmos/thread/Mutex.hxx>
+
+namespace cosmos {
+
+class ChildCloner;
+
+/// Pre-forked helper process for creating child processes at a constant cost.
+/**
+ * Creating child processes from a large, multi-threaded process is costly:
+ * the kernel needs to duplicate the page tables and contends on the memory
+ * map lock with the other threads of the process. A SpawnServer avoids this
+ * by forking a small helper process (sometimes called a "zygote") early, via
+ * start(), while the process is still small. Later on spawn() requests are
+ * sent to the helper over a UNIX domain socket, which creates the actual
+ * child processes and passes a PidFD for each of them back via a
+ * UnixRightsMessage.
+ *
+ * The helper creates the children with CloneFlag::SHARE_PARENT, thus they
+ * become regular children of the current process. The returned SubProc
+ * objects can be used just like the ones returned from ChildCloner::run().
+ *
+ * The configuration of the ChildCloner passed to spawn() is transferred to
+ * the helper. This includes the executable, arguments, environment, working
+ * directory, scheduler settings, CPU affinity, NUMA memory policy, cgroup
+ * and all file descriptors to be inherited.
+ * The latter are transferred via the socket and keep their numbers in the
+ * child process, as documented for ChildCloner::addInheritFD(). Post fork
+ * callbacks cannot be transferred to another process and are thus not
+ * supported, neither is ChildCloner::setForwardChildErrors(). Pre-execve()
+ * errors in the child are reported via the ExitStatus conventions documented
+ * at ChildCloner::run().
+ *
+ * Note that the helper does not see changes to the current process made
+ * after start(), like a change of the working directory or of environment
+ * variables, if the child is supposed to inherit them.
+ *
+ * spawn() is thread safe, concurrent requests are serialized. When running
+ * on Valgrind no helper is started, since its process creation lacks the
+ * necessary clone3() support. spawn() then creates child processes
+ * directly.
+ **/
+class COSMOS_API SpawnServer {
+public: // functions
+
+	SpawnServer() = default;
+
+	/// Stops the helper process, if still running.
+	~SpawnServer();
+
+	SpawnServer(const SpawnServer&) = delete;
+	SpawnServer& operator=(const SpawnServer&) = delete;
+
+	/// Fork the helper process.
+	/**
+	 * This should be called as early as possible, while the current
+	 * process is still small and single threaded.
+	 **/
+	void start();
+
+	/// Stop the helper process and wait for it to exit.
+	/**
+	 * Child processes already created are not affected by this.
+	 **/
+	void stop();
+
+	/// Returns whether the helper process is running.
+	bool running() const {
+		return m_helper.running();
+	}
+
+	/// Create a new child process as configured in `cloner`.
+	/**
+	 * If the helper process is not running then the child process is
+	 * created directly in the current process. This is also the case if
+	 * the helper process exited unexpectedly, it is reaped then and
+	 * running() returns `false` afterwards.
+	 *
+	 * A UsageError is thrown if `cloner` is configured in a way that is
+	 * not supported, see the class documentation. If the helper fails to
+	 * create the child process then the original error is rethrown as an
+	 * ApiError or RuntimeError.
+	 **/
+	SubProc spawn(const ChildCloner &cloner);
+
+protected: // functions
+
+	/// Main loop of the helper process.
+	static void serve(UnixConnection &conn);
+
+	/// Serialize the configuration of `cloner`, collecting the file descriptors to transfer in `fds`.
+	static std::string encodeRequest(const ChildCloner &cloner, UnixRightsMessage::FileNumVector &fds);
+
+	/// Create a child process from a request received in serve() (helper context).
+	static SubProc runRequest(const std::string &payload, const UnixRightsMessage::FileNumVector &fds);
+
+protected: // data
+
+	/// Serializes spawn requests.
+	Mutex m_lock;
+	/// Connection to the helper process.
+	UnixConnection m_conn;
+	/// The helper process.
+	SubProc m_helper;
+};
+
+} // end ns
@@ -81,6 +81,9 @@ public: // functions
 	 * \return The exit status if the child exited. Nothing if the timeout
 	 * occurred.
 	 *
+	 * For supervising many child processes at once use ChildReaper
+	 * instead.
+	 *
 	 * \see wait()
 	 **/
 	std::optional<ChildState> waitTimed(const IntervalTime max,
@@ -107,6 +110,7 @@ public: // functions
 protected: // functions
 
 	friend class ChildCloner;
+	friend class SpawnServer;
 
 	/// Wraps the given process ID and pidfd.
 	SubProc(const ProcessID pid, const PidFD pidfd) :
@@ -0,0 +1,185 @@
+#pragma once
+
+// C++
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// cosmos
+#include <cosmos/dso_export.h>
+#include <cosmos/proc/CPUSet.hxx>
+
+namespace cosmos {
+
+/// CPU, cache and NUMA topology of the system.
+/**
+ * This type parses the CPU and NUMA node information found in sysfs below
+ * `/sys/devices/system/{cpu,node}` once during construction and provides it
+ * in a compact form. It is intended as a basis for placing threads and
+ * processes sensibly via CPUSet and the affinity APIs, e.g. to pin one
+ * worker per physical core, to keep cooperating threads on CPUs sharing a
+ * cache or to avoid CPUs reserved for isolated workloads.
+ *
+ * Only online CPUs are considered. Information that is not available on the
+ * current system (e.g. missing cache information in some virtual machines,
+ * or no NUMA support) is left empty, it does not cause an error. If the list
+ * of online CPUs cannot be determined then a RuntimeError is thrown.
+ *
+ * The sysfs root directory can be passed to the constructor to parse a copy
+ * of the sysfs hierarchy, e.g. for testing purposes.
+ **/
+class COSMOS_API Topology {
+public: // types
+
+	/// The default location of the CPU and node information.
+	static constexpr std::string_view DEFAULT_SYSFS_ROOT = "/sys/devices/system";
+
+	/// Types of caches.
+	enum class CacheType {
+		DATA,
+		INSTRUCTION,
+		UNIFIED,
+		UNKNOWN
+	};
+
+	/// Information about a single CPU cache.
+	/**
+	 * Each cache appears only once in Topology::caches(), even if it is
+	 * shared by multiple CPUs.
+	 **/
+	struct Cache {
+		/// Cache level starting at 1.
+		unsigned level = 0;
+		CacheType type = CacheType::UNKNOWN;
+		/// Cache size in bytes.
+		size_t size = 0;
+		/// Cache line size in bytes.
+		size_t line_size = 0;
+		/// Number of ways of associativity.
+		unsigned ways = 0;
+		/// The online CPUs sharing this cache.
+		CPUSet shared_cpus;
+	};
+
+	/// Information about a single online CPU.
+	struct CPU {
+		/// The logical CPU number as used in CPUSet.
+		unsigned nr = 0;
+		/// The physical package (socket) ID, or -1 if unknown.
+		int package = -1;
+		/// The core ID within the package, or -1 if unknown.
+		int core = -1;
+		/// The NUMA node the CPU belongs to, if known.
+		std::optional<unsigned> node;
+		/// The hardware threads of the same core, including this CPU.
+		CPUSet smt_siblings;
+		/// The CPUs of the same physical package, including this CPU.
+		CPUSet package_cpus;
+		/// Indices into Topology::caches() for the caches used by this CPU.
+		std::vector<size_t> caches;
+	};
+
+	/// Information about a single online NUMA node.
+	struct Node {
+		/// The NUMA node number.
+		unsigned nr = 0;
+		/// The online CPUs belonging to this node.
+		CPUSet cpus;
+		/// Distances to all NUMA nodes, in the order of Topology::nodes().
+		std::vector<unsigned> distances;
+	};
+
+public: // functions
+
+	/// Parses the topology from the given sysfs location.
+	explicit Topology(const std::string_view sysfs_root = DEFAULT_SYSFS_ROOT);
+
+	/// Returns the set of online CPUs.
+	const CPUSet& online() const {
+		return m_online;
+	}
+
+	/// Returns the CPUs isolated from the scheduler via `isolcpus=`.
+	const CPUSet& isolated() const {
+		return m_isolated;
+	}
+
+	/// Returns the CPUs running in adaptive-ticks mode via `nohz_full=`.
+	const CPUSet& nohzFull() const {
+		return m_nohz_full;
+	}
+
+	/// Returns the online CPUs that are neither isolated nor nohz_full.
+	/**
+	 * These are the CPUs suitable for general purpose housekeeping work.
+	 **/
+	CPUSet housekeeping() const {
+		return m_online - m_isolated - m_nohz_full;
+	}
+
+	/// Returns the information about all online CPUs in ascending order.
+	const std::vector<CPU>& cpus() const {
+		return m_cpus;
+	}
+
+	/// Returns the information for the given online CPU.
+	/**
+	 * If `nr` is not an online CPU then a UsageError is thrown.
+	 **/
+	const CPU& cpu(const unsigned nr) const;
+
+	/// Returns all distinct caches of the online CPUs.
+	const std::vector<Cache>& caches() const {
+		return m_caches;
+	}
+
+	/// Returns the online NUMA nodes in ascending order.
+	/**
+	 * On systems without NUMA support this is empty.
+	 **/
+	const std::vector<Node>& nodes() const {
+		return m_nodes;
+	}
+
+	/// Returns the distance between the given NUMA nodes, if known.
+	/**
+	 * The distance is a relative measure of memory access latency as
+	 * reported by the firmware. Local accesses are typically reported as
+	 * 10.
+	 **/
+	std::optional<unsigned> distance(const unsigned from, const unsigned to) const;
+
+	/// Returns one CPU per physical core.
+	/**
+	 * For each core the lowest numbered SMT sibling is selected. This is
+	 * useful for pinning one compute bound worker per core, avoiding the
+	 * contention between hardware threads of the same core.
+	 **/
+	CPUSet primaryThreads() const;
+
+	/// Returns the CPUs sharing the data or unified cache of the given level with `cpu`.
+	/**
+	 * If the cache is unknown then an empty set is returned.
+	 **/
+	CPUSet cacheSharers(const unsigned cpu, const unsigned level) const;
+
+protected: // functions
+
+	void parseCPU(const std::string &base, CPU &cpu);
+
+	void parseCaches(const std::string &base, CPU &cpu);
+
+	void parseNodes(const std::string &base);
+
+protected: // data
+
+	CPUSet m_online;
+	CPUSet m_isolated;
+	CPUSet m_nohz_full;
+	std::vector<CPU> m_cpus;
+	std::vector<Cache> m_caches;
+	std::vector<Node> m_nodes;
+};
+
+} // end ns
@@ -2,6 +2,8 @@
 
 // C++
 #include <optional>
+#include <string>
+#include <utility>
 #include <vector>
 
 // cosmos
@@ -186,6 +188,73 @@ public: // functions
 		this->request(ptrace::Request::POKEDATA, addr, value);
 	}
 
+	/// Read a block of data from the tracee's memory.
+	/**
+	 * This reads `iovec.leftBytes()` bytes from the contiguous range of
+	 * the tracee's memory starting at `addr` and scatters them into the
+	 * local memory regions described by `iovec`. Compared to peekData()
+	 * arbitrary amounts of data are transferred in a single system call
+	 * (`process_vm_readv()`). If the kernel lacks support for this system
+	 * call then `/proc/<pid>/mem` is accessed instead.
+	 *
+	 * The tracee does not need to be in a ptrace-stop for this, but the
+	 * caller needs ptrace access permissions for the process.
+	 *
+	 * The kernel accepts at most IOV_MAX (1024) `iovec` entries per
+	 * system call. Larger vectors are transferred in several system calls
+	 * of IOV_MAX entries each.
+	 *
+	 * A partial read occurs if only the beginning of the range is mapped
+	 * in the tracee. `iovec` is updated like for
+	 * StreamIO::read(ReadIOVector&) and the number of bytes transferred
+	 * is returned. If no data can be read at all then an ApiError is
+	 * thrown.
+	 **/
+	size_t readMemory(const void *addr, ReadIOVector &iovec) const;
+
+	/// Read a block of data from the tracee's memory into `buf`.
+	/**
+	 * \see readMemory(const void*, ReadIOVector&) const
+	 **/
+	size_t readMemory(const void *addr, void *buf, const size_t length) const {
+		ReadIOVector iovec;
+		iovec.emplace_back(buf, length);
+		return readMemory(addr, iovec);
+	}
+
+	/// Write a block of data into the tracee's memory.
+	/**
+	 * This is the counterpart of readMemory() based on
+	 * `process_vm_writev()`. This system call cannot write to read-only
+	 * mappings like program code. In this case, or if the system call is
+	 * not supported, `/proc/<pid>/mem` is written to instead, which
+	 * allows to modify read-only mappings, like pokeData() does.
+	 **/
+	size_t writeMemory(void *addr, WriteIOVector &iovec);
+
+	/// Write a block of data from `buf` into the tracee's memory.
+	/**
+	 * \see writeMemory(void*, WriteIOVector&)
+	 **/
+	size_t writeMemory(void *addr, const void *buf, const size_t length) {
+		WriteIOVector iovec;
+		iovec.emplace_back(buf, length);
+		return writeMemory(addr, iovec);
+	}
+
+	/// Read a null terminated string from the tracee's memory.
+	/**
+	 * The string is read in chunks that don't cross page boundaries,
+	 * since the page following the string's terminator might not be
+	 * mapped. For short strings this means only a single system call is
+	 * needed.
+	 *
+	 * At most `max_len` bytes are read. If no terminator is found until
+	 * then, the truncated string is returned. If the memory at `addr`
+	 * cannot be read then an ApiError is thrown.
+	 **/
+	std::string readString(const char *addr, const size_t max_len = 4096) const;
+
 	/// Read one word of data from the tracee's user area.
 	/**
 	 * The user area refers to the kernel's `struct user` which contains
@@ -416,6 +485,24 @@ public: // functions
 
 protected: // functions
 
+	/// Transfers `iovec` from/to the remote range at `addr` in batches of up to IOV_MAX entries.
+	/**
+	 * `vm_func` wraps `process_vm_readv()` or `process_vm_writev()`.
+	 * `iovec` is updated with the bytes transferred. Returns the number
+	 * of bytes transferred and the error of a failed system call, if
+	 * any.
+	 **/
+	template <typename IOVEC, typename VM_FUNC>
+	std::pair<size_t, Errno> processVMIO(IOVEC &iovec, const uintptr_t addr, VM_FUNC vm_func) const;
+
+	/// Fallback for readMemory() using `/proc/<pid>/mem`.
+	size_t readProcMem(const void *addr, ReadIOVector &iovec) const;
+
+	/// Fallback for writeMemory() using `/proc/<pid>/mem`.
+	size_t writeProcMem(void *addr, WriteIOVector &iovec);
+
+	std::string procMemPath() const;
+
 	/// Returns the current event message for a ptrace-event-stop.
 	/**
 	 * The interpretation of the returned value depends on the
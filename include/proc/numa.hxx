@@ -0,0 +1,98 @@
+#pragma once
+
+// Linux
+#include <linux/mempolicy.h>
+
+// C++
+#include <vector>
+
+// cosmos
+#include <cosmos/BitMask.hxx>
+#include <cosmos/dso_export.h>
+
+/**
+ * @file
+ *
+ * NUMA memory placement policies (see `man 2 set_mempolicy`).
+ **/
+
+namespace cosmos::numa {
+
+/// Available NUMA memory policy modes.
+enum class MemPolicy : int {
+	/// Use the policy of the enclosing scope (process default: allocate on the local node).
+	DEFAULT        = MPOL_DEFAULT,
+	/// Prefer allocations on the single node given, fall back to others.
+	PREFERRED      = MPOL_PREFERRED,
+	/// Strictly allocate from the given nodes only.
+	BIND           = MPOL_BIND,
+	/// Interleave allocations page by page across the given nodes.
+	INTERLEAVE     = MPOL_INTERLEAVE,
+	/// Allocate on the node of the CPU that triggers the allocation.
+	LOCAL          = MPOL_LOCAL,
+	/// Prefer allocations on any of the given nodes, fall back to others (since Linux 5.15).
+	PREFERRED_MANY = MPOL_PREFERRED_MANY
+};
+
+/// Optional mode flags for MemPolicy.
+enum class MemPolicyFlag : unsigned {
+	/// Don't remap the node numbers when the process's allowed nodes change.
+	STATIC_NODES   = MPOL_F_STATIC_NODES,
+	/// Interpret node numbers relative to the process's allowed nodes.
+	RELATIVE_NODES = MPOL_F_RELATIVE_NODES
+};
+
+using MemPolicyFlags = BitMask<MemPolicyFlag>;
+
+/// Flags for bind().
+enum class BindFlag : unsigned {
+	/// Fail if existing pages in the range don't follow the policy.
+	STRICT   = MPOL_MF_STRICT,
+	/// Move existing pages of the process in the range to conform to the policy.
+	MOVE     = MPOL_MF_MOVE,
+	/// Move all pages in the range, even shared ones (requires CAP_SYS_NICE).
+	MOVE_ALL = MPOL_MF_MOVE_ALL
+};
+
+using BindFlags = BitMask<BindFlag>;
+
+/// Combined NUMA memory policy settings.
+struct COSMOS_API MemPolicySettings {
+	MemPolicy policy = MemPolicy::DEFAULT;
+	MemPolicyFlags flags;
+	/// The NUMA node numbers the policy refers to, must be empty for DEFAULT and LOCAL.
+	std::vector<unsigned> nodes;
+
+	/// Returns the node numbers as a bit mask suitable for the system calls.
+	std::vector<unsigned long> nodeMask() const;
+
+	/// Returns the `maxnode` system call parameter for the given node mask.
+	static unsigned long maxNode(const std::vector<unsigned long> &mask);
+
+	/// Returns the mode value combined from `policy` and `flags`.
+	int rawMode() const {
+		return static_cast<int>(policy) | static_cast<int>(flags.raw());
+	}
+};
+
+/// Sets the NUMA memory policy of the calling thread.
+/**
+ * The policy applies to all future memory allocations of the calling thread
+ * that are not covered by a more specific policy set via bind(). It is
+ * inherited by child processes and threads and preserved across
+ * `execve()`.
+ *
+ * On systems without NUMA support an ApiError with Errno::NO_SYS is thrown.
+ **/
+COSMOS_API void set_mem_policy(const MemPolicySettings &settings);
+
+/// Sets the NUMA memory policy for an address range.
+/**
+ * This is a wrapper around `mbind()`. `addr` needs to be page aligned. The
+ * policy only applies to pages allocated afterwards, unless `flags` request
+ * moving existing pages.
+ **/
+COSMOS_API void bind(void *addr, const size_t length, const MemPolicySettings &settings,
+		const BindFlags flags = BindFlags{});
+
+} // end ns
@@ -12,6 +12,7 @@
 #include <cosmos/creds.hxx>
 #include <cosmos/dso_export.h>
 #include <cosmos/fs/DirFD.hxx>
+#include <cosmos/proc/CPUSet.hxx>
 #include <cosmos/proc/PidFD.hxx>
 #include <cosmos/proc/SigInfo.hxx>
 #include <cosmos/proc/types.hxx>
@@ -342,6 +343,33 @@ SessionID get_own_session_id();
 /// Returns the Session ID of the process identifier by `pid`.
 SessionID get_session_of(const ProcessID pid);
 
+/// Returns the set of CPUs the given process is allowed to run on.
+/**
+ * For multi-threaded processes this returns the affinity of the main thread
+ * for a ProcessID. Pass `ProcessID::SELF` to query the calling thread.
+ **/
+CPUSet get_affinity(const ProcessID pid = ProcessID::SELF);
+
+/// Restricts the given process to run only on the CPUs in `cpus`.
+/**
+ * This is a wrapper around `sched_setaffinity()`. Only the thread
+ * identified by `pid` is affected, for the calling thread pass
+ * `ProcessID::SELF`. The affinity is inherited by child processes and
+ * threads created afterwards and is preserved across `execve()`.
+ *
+ * If `cpus` contains no CPU that is currently online and allowed by the
+ * caller's cpuset cgroup then an ApiError with Errno::INVALID_ARG is thrown.
+ * Changing the affinity of other users' processes requires CAP_SYS_NICE.
+ **/
+void set_affinity(const CPUSet &cpus, const ProcessID pid = ProcessID::SELF);
+
+/// Returns the number of the CPU the calling thread is currently running on.
+/**
+ * The result can be outdated already when this function returns, unless
+ * the thread's affinity is restricted to a single CPU.
+ **/
+unsigned get_current_cpu();
+
 /// Fork the current process to create a child process.
 /**
  * This creates a copy of the current process to act as a child process. The
@@ -0,0 +1,259 @@
+#pragma once
+
+// C++
+#include <bit>
+#include <initializer_list>
+#include <map>
+#include <optional>
+#include <vector>
+#include <stdint.h>
+
+// Linux
+#include <linux/seccomp.h>
+
+// cosmos
+#include <cosmos/BitMask.hxx>
+#include <cosmos/compiler.hxx>
+#include <cosmos/dso_export.h>
+#include <cosmos/error/errno.hxx>
+#include <cosmos/fs/FileDescriptor.hxx>
+#include <cosmos/proc/ptrace.hxx>
+#include <cosmos/utils.hxx>
+
+// seccomp instruction, see linux/filter.h
+struct sock_filter;
+
+/**
+ * @file
+ *
+ * Support for seccomp system call filters (see `man 2 seccomp`).
+ **/
+
+namespace cosmos::seccomp {
+
+/// The system call ABI of the current process, if known to ptrace::Arch.
+/**
+ * On architectures that are not covered by ptrace::Arch this is empty and
+ * Filter requires an explicit architecture argument.
+ **/
+constexpr inline std::optional<ptrace::Arch> NATIVE_ARCH = []() -> std::optional<ptrace::Arch> {
+	constexpr bool little_endian = std::endian::native == std::endian::little;
+
+	if (arch::X86_64)
+		return ptrace::Arch::X86_64;
+	else if (arch::I386)
+		return ptrace::Arch::I386;
+	else if (arch::AARCH64 && little_endian)
+		return ptrace::Arch::AARCH64;
+	else if (arch::ARM)
+		return little_endian ? ptrace::Arch::ARM : ptrace::Arch::ARMEB;
+	else if (arch::PPC64)
+		return little_endian ? ptrace::Arch::PPC64LE : ptrace::Arch::PPC64;
+	else if (arch::PPC && !little_endian)
+		return ptrace::Arch::PPC;
+	else if (arch::MIPS64 && !little_endian)
+		return ptrace::Arch::MIPS64;
+	else if (arch::MIPS && !little_endian)
+		return ptrace::Arch::MIPS;
+
+	return std::nullopt;
+}();
+
+/// Actions a seccomp filter can take for a system call.
+/**
+ * If multiple filters are installed, then the action with the highest
+ * precedence wins. The enum values are listed in decreasing order of
+ * precedence.
+ **/
+enum class Action : uint32_t {
+	/// Kill the complete process as if by an unhandled SIGSYS.
+	KILL_PROCESS = SECCOMP_RET_KILL_PROCESS,
+	/// Kill the calling thread as if by an unhandled SIGSYS.
+	KILL_THREAD  = SECCOMP_RET_KILL_THREAD,
+	/// Send a SIGSYS signal to the calling thread, the system call is not executed.
+	TRAP         = SECCOMP_RET_TRAP,
+	/// Fail the system call with the errno value from the Result data.
+	ERRNO        = SECCOMP_RET_ERRNO,
+	/// Forward the system call to a user space supervisor process.
+	USER_NOTIF   = SECCOMP_RET_USER_NOTIF,
+	/// Report a ptrace::Event::SECCOMP stop to the tracer, if any.
+	/**
+	 * Without a tracer the system call fails with Errno::NO_SYS.
+	 **/
+	TRACE        = SECCOMP_RET_TRACE,
+	/// Allow the system call but log it.
+	LOG          = SECCOMP_RET_LOG,
+	/// Allow the system call.
+	ALLOW        = SECCOMP_RET_ALLOW
+};
+
+/// Flags used when installing a seccomp Filter.
+enum class FilterFlag : unsigned {
+	/// Install the filter for all threads of the process.
+	TSYNC              = SECCOMP_FILTER_FLAG_TSYNC,
+	/// Log all actions except ALLOW.
+	LOG                = SECCOMP_FILTER_FLAG_LOG,
+	/// Disable speculative store bypass mitigation.
+	SPEC_ALLOW         = SECCOMP_FILTER_FLAG_SPEC_ALLOW,
+	/// Return a listener file descriptor for Action::USER_NOTIF (since Linux 5.0).
+	NEW_LISTENER       = SECCOMP_FILTER_FLAG_NEW_LISTENER,
+	/// Return ESRCH instead of a thread ID on TSYNC failures (since Linux 5.7).
+	TSYNC_ESRCH        = SECCOMP_FILTER_FLAG_TSYNC_ESRCH,
+#ifdef SECCOMP_FILTER_FLAG_WAIT_KILLABLE_RECV
+	/// Only deliver fatal signals while waiting for USER_NOTIF replies (since Linux 5.19).
+	WAIT_KILLABLE_RECV = SECCOMP_FILTER_FLAG_WAIT_KILLABLE_RECV
+#endif
+};
+
+using FilterFlags = BitMask<FilterFlag>;
+
+/// The result of a seccomp filter for a system call.
+/**
+ * This combines an Action with 16 bits of Action specific data.
+ **/
+class Result {
+public: // functions
+
+	explicit constexpr Result(const Action action, const uint16_t data = 0) :
+			m_action{action}, m_data{data}
+	{}
+
+	static constexpr Result allow() { return Result{Action::ALLOW}; }
+	static constexpr Result log() { return Result{Action::LOG}; }
+	static constexpr Result killProcess() { return Result{Action::KILL_PROCESS}; }
+	static constexpr Result killThread() { return Result{Action::KILL_THREAD}; }
+	static constexpr Result notify() { return Result{Action::USER_NOTIF}; }
+
+	/// Send SIGSYS, `data` is reported in the SigInfo's `si_errno` field.
+	static constexpr Result trap(const uint16_t data = 0) {
+		return Result{Action::TRAP, data};
+	}
+
+	/// Fail the system call with the given error code.
+	static constexpr Result error(const Errno err) {
+		return Result{Action::ERRNO, static_cast<uint16_t>(to_integral(err))};
+	}
+
+	/// Stop the tracee, `data` is available via Tracee::getSeccompRetDataEventMsg().
+	static constexpr Result trace(const uint16_t data = 0) {
+		return Result{Action::TRACE, data};
+	}
+
+	Action action() const { return m_action; }
+
+	uint16_t data() const { return m_data; }
+
+	/// Returns the raw filter return value.
+	constexpr uint32_t raw() const {
+		return to_integral(m_action) | m_data;
+	}
+
+	bool operator==(const Result &other) const {
+		return raw() == other.raw();
+	}
+
+	bool operator!=(const Result &other) const {
+		return !(*this == other);
+	}
+
+protected: // data
+
+	Action m_action;
+	uint16_t m_data;
+};
+
+/// Builder for seccomp BPF system call filters.
+/**
+ * A Filter maps system call numbers onto a Result. System calls without a
+ * specific rule receive the default Result. System call numbers are the ABI
+ * specific ones found in `sys/syscall.h` (like `SYS_openat`). Since these
+ * numbers differ between ABIs the filter first checks that the system call
+ * uses the expected ABI. System calls from other ABIs (e.g. 32-bit system
+ * calls on 64-bit x86, or x32 system calls) receive the bad ABI result, by
+ * default Result::killProcess().
+ *
+ * Filters are inherited by child processes and preserved across `execve()`.
+ * Once installed they cannot be removed anymore. To restrict a child process
+ * the filter is typically installed in the post fork callback of a
+ * ChildCloner:
+ *
+ * \code
+ * seccomp::Filter filter;
+ * filter.set({SYS_openat, SYS_execve}, seccomp::Result::trace());
+ * cloner.setPostForkCB([&filter](const ChildCloner&) {
+ *     filter.install();
+ * });
+ * \endcode
+ *
+ * In combination with ptrace::Opt::TRACESECCOMP only the system calls
+ * with Result::trace() cause ptrace stops, instead of all system calls as
+ * with Tracee::RestartMode::SYSCALL.
+ **/
+class COSMOS_API Filter {
+public: // functions
+
+	/// Creates a filter for system calls of the given ABI.
+	/**
+	 * If no `arch` is given and NATIVE_ARCH is unknown on the current
+	 * architecture then a UsageError is thrown.
+	 **/
+	explicit Filter(const Result default_result = Result::allow(),
+			const std::optional<ptrace::Arch> arch = NATIVE_ARCH);
+
+	/// Sets the Result for system call number `nr`, replacing any previous rule.
+	Filter& set(const long nr, const Result result) {
+		m_rules.insert_or_assign(nr, result);
+		return *this;
+	}
+
+	/// Sets the same Result for all the given system call numbers.
+	Filter& set(const std::initializer_list<long> nrs, const Result result) {
+		for (const auto nr: nrs) {
+			set(nr, result);
+		}
+		return *this;
+	}
+
+	/// Removes the rule for system call `nr`, the default Result applies again.
+	void reset(const long nr) {
+		m_rules.erase(nr);
+	}
+
+	/// Sets the Result for system calls without a specific rule.
+	void setDefault(const Result result) { m_default = result; }
+
+	/// Sets the Result for system calls using an unexpected ABI.
+	void setBadArchResult(const Result result) { m_bad_arch = result; }
+
+	/// Sets whether install() enables the no_new_privs process attribute.
+	/**
+	 * Unprivileged processes can only install seccomp filters once the
+	 * no_new_privs attribute is set, see prctl::set_no_new_privs(). By
+	 * default install() does this automatically. Processes with
+	 * CAP_SYS_ADMIN may disable this.
+	 **/
+	void setNoNewPrivs(const bool on) { m_no_new_privs = on; }
+
+	/// Returns the compiled BPF program for this filter.
+	std::vector<struct sock_filter> program() const;
+
+	/// Installs the filter for the calling thread.
+	/**
+	 * If the operation fails then an ApiError is thrown. If
+	 * FilterFlag::NEW_LISTENER is passed in `flags` then the returned
+	 * file descriptor is the seccomp user notification listener, which
+	 * needs to be closed by the caller. Otherwise an invalid file
+	 * descriptor is returned.
+	 **/
+	FileDescriptor install(const FilterFlags flags = FilterFlags{}) const;
+
+protected: // data
+
+	std::map<long, Result> m_rules;
+	Result m_default;
+	Result m_bad_arch = Result::killProcess();
+	ptrace::Arch m_arch;
+	bool m_no_new_privs = true;
+};
+
+} // end ns
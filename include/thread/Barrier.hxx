@@ -0,0 +1,71 @@
+#pragma once
+
+// C++
+#include <stdint.h>
+
+// cosmos
+#include <cosmos/dso_export.h>
+#include <cosmos/error/UsageError.hxx>
+#include <cosmos/thread/futex.hxx>
+
+namespace cosmos {
+
+/// A reusable synchronization point for a fixed number of threads.
+/**
+ * Each of the participating threads calls arriveAndWait(), which blocks
+ * until all threads arrived. Then all of them are released and the Barrier
+ * is ready for the next phase. This is similar to `pthread_barrier_t` and
+ * `std::barrier`, but based on futex words.
+ *
+ * Arriving threads spin for a short time before going to sleep, since in
+ * data parallel processing the phases typically finish at nearly the same
+ * time. The last arriving thread only performs a wake system call if
+ * threads are actually sleeping.
+ *
+ * If ProcessShared is set during construction then the object can be placed
+ * in shared memory, like FutexMutex.
+ **/
+class COSMOS_API Barrier {
+	// disallow copy/assignment
+	Barrier(const Barrier&) = delete;
+	Barrier& operator=(const Barrier&) = delete;
+
+public: // functions
+
+	explicit Barrier(const uint32_t count, const ProcessShared shared = ProcessShared{false}) :
+			m_count{count},
+			m_shared{shared} {
+		if (count == 0) {
+			throw UsageError{"Barrier count needs to be non-zero"};
+		}
+	}
+
+	/// Arrive at the barrier and wait for all other threads to arrive.
+	/**
+	 * \return `true` for exactly one of the threads of each phase (the
+	 *         last one to arrive), `false` for all others. This can be
+	 *         used to perform serial work between phases.
+	 **/
+	bool arriveAndWait();
+
+	/// Returns the number of participating threads.
+	uint32_t count() const { return m_count; }
+
+	/// Returns the number of completed phases (wraps around).
+	uint32_t phase() const {
+		return m_phase.load(std::memory_order_acquire);
+	}
+
+protected: // data
+
+	const uint32_t m_count;
+	const ProcessShared m_shared;
+	/// Number of threads arrived in the current phase.
+	futex::Word m_arrived{0};
+	/// The phase number, which is the futex word waiters sleep on.
+	futex::Word m_phase{0};
+	/// Number of threads sleeping on m_phase.
+	futex::Word m_sleepers{0};
+};
+
+} // end ns
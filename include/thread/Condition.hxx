@@ -5,6 +5,8 @@
 
 // C++
 #include <cassert>
+#include <memory>
+#include <string_view>
 
 // cosmos
 #include <cosmos/thread/Mutex.hxx>
@@ -29,6 +31,17 @@ namespace cosmos {
  * - A condition can experience "spurious wakeups" i.e. it will be signaled
  *   but the program state did not actually change. Therefore you always need
  *   to check after wakeup whether the condition actually is as expected.
+ *
+ * If the associated Mutex uses Mutex::Option::PROCESS_SHARED then the
+ * Condition is process shared as well. Both objects then need to be placed in
+ * shared memory, e.g. a MemFile mapped with MapType::SHARED, which needs to be
+ * mapped at the same address in all processes (like a mapping inherited via
+ * fork()), since the Condition refers to its Mutex by address.
+ *
+ * If the associated Mutex uses Mutex::Option::ROBUST and its owner died then
+ * wait() and waitTimed() throw an ApiError with Errno::OWNER_DEAD. The Mutex
+ * is owned by the caller in this case and needs to be recovered as described
+ * in Mutex::LockResult::OWNER_DIED.
  **/
 class COSMOS_API Condition {
 	// disallow copy-assignment
@@ -69,11 +82,14 @@ public: // functions
 	 * Upon return the Mutex will again be owned by the caller.
 	 **/
 	void wait() const {
-		auto res = ::pthread_cond_wait(&m_pcond, &(m_lock.m_pmutex));
-
-		if (auto err = Errno{res}; err != Errno::NO_ERROR) {
-			throw ApiError{"pthread_cond_wait()", Errno{err}};
+		if constexpr (COSMOS_LOCK_STATS) {
+			if (m_stats) [[unlikely]] {
+				waitInstrumented();
+				return;
+			}
 		}
+
+		waitPlain();
 	}
 
 	/// Wait for the Condition to be signaled with timeout.
@@ -87,13 +103,13 @@ public: // functions
 	 * \return Whether a timeout or a signal occurred.
 	 **/
 	WaitTimedRes waitTimed(const MonotonicTime ts) const {
-		auto res = ::pthread_cond_timedwait(&m_pcond, &(m_lock.m_pmutex), &ts);
-
-		switch(Errno{res}) {
-		default: throw ApiError{"pthread_cond_timedwait()", Errno{res}};
-		case Errno::NO_ERROR: return WaitTimedRes::SIGNALED;
-		case Errno::TIMEDOUT: return WaitTimedRes::TIMED_OUT;
+		if constexpr (COSMOS_LOCK_STATS) {
+			if (m_stats) [[unlikely]] {
+				return waitTimedInstrumented(ts);
+			}
 		}
+
+		return waitTimedPlain(ts);
 	}
 
 	/// Signal and unblock one waiting thread.
@@ -131,11 +147,48 @@ public: // functions
 
 	Mutex& mutex() { return m_lock; }
 
+	/// Enables wait statistics for this Condition.
+	/**
+	 * Each wait is accounted as a contention, the wait time being the
+	 * time spent until wakeup. Like for the Mutex, a UsageError is
+	 * thrown if the associated Mutex is process shared. \see
+	 * Mutex::instrument().
+	 **/
+	void instrument(const std::string_view name = {});
+
+	/// Returns the attached LockStats, if any.
+	const LockStats* stats() const { return m_stats.get(); }
+
+protected: // functions
+
+	void waitPlain() const {
+		auto res = ::pthread_cond_wait(&m_pcond, &(m_lock.m_pmutex));
+
+		if (auto err = Errno{res}; err != Errno::NO_ERROR) {
+			throw ApiError{"pthread_cond_wait()", Errno{err}};
+		}
+	}
+
+	WaitTimedRes waitTimedPlain(const MonotonicTime ts) const {
+		auto res = ::pthread_cond_timedwait(&m_pcond, &(m_lock.m_pmutex), &ts);
+
+		switch(Errno{res}) {
+		default: throw ApiError{"pthread_cond_timedwait()", Errno{res}};
+		case Errno::NO_ERROR: return WaitTimedRes::SIGNALED;
+		case Errno::TIMEDOUT: return WaitTimedRes::TIMED_OUT;
+		}
+	}
+
+	void waitInstrumented() const;
+
+	WaitTimedRes waitTimedInstrumented(const MonotonicTime ts) const;
+
 protected: // data
 
 	// mutable to allow const semantics in wait*()
 	mutable pthread_cond_t m_pcond;
 	Mutex &m_lock;
+	std::unique_ptr<LockStats> m_stats;
 };
 
 /// An aggregate of a Mutex and a Condition coupled together for typical Condition usage.
@@ -147,6 +200,18 @@ public: // functions
 	ConditionMutex() :
 		Condition{static_cast<Mutex&>(*this)}
 	{}
+
+	/// Create the aggregate with the given special Mutex properties.
+	explicit ConditionMutex(const Mutex::Options options) :
+		Mutex{options},
+		Condition{static_cast<Mutex&>(*this)}
+	{}
+
+	/// Enables statistics for both the Mutex and the Condition using the same name.
+	void instrument(const std::string_view name = {}) {
+		Mutex::instrument(name);
+		Condition::instrument(name);
+	}
 };
 
 } // end ns
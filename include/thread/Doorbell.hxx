@@ -0,0 +1,52 @@
+#pragma once
+
+// cosmos
+#include <cosmos/dso_export.h>
+#include <cosmos/fs/FileDescriptor.hxx>
+#include <cosmos/io/EventFile.hxx>
+
+namespace cosmos {
+
+/// A non-blocking EventFile for announcing the availability of new data.
+/**
+ * A Doorbell is used together with lock-free data structures like SPSCRing
+ * and MPMCRing. These rings ring() the doorbell when they transition from
+ * empty to non-empty. A consumer can thus monitor fd() for input in a Poller
+ * alongside other file descriptors like sockets.
+ *
+ * When the doorbell becomes readable the consumer needs to acknowledge() it
+ * first and then drain the associated rings until they are empty. Draining
+ * first and acknowledging afterwards would lose notifications for data that
+ * arrives in between.
+ *
+ * A single Doorbell can be shared between multiple rings.
+ **/
+class COSMOS_API Doorbell {
+	// disallow copy/assignment
+	Doorbell(const Doorbell&) = delete;
+	Doorbell& operator=(const Doorbell&) = delete;
+
+public: // functions
+
+	Doorbell() :
+			m_event{EventFile::Counter{0},
+				EventFile::Flags{EventFile::Flag::CLOSE_ON_EXEC, EventFile::Flag::NONBLOCK}}
+	{}
+
+	/// Makes fd() readable.
+	void ring() {
+		m_event.signal();
+	}
+
+	/// Resets the doorbell, returns whether it has been rung since the last call.
+	bool acknowledge();
+
+	/// The file descriptor to monitor for input.
+	FileDescriptor fd() const { return m_event.fd(); }
+
+protected: // data
+
+	EventFile m_event;
+};
+
+} // end ns
@@ -0,0 +1,145 @@
+#pragma once
+
+// cosmos
+#include <cosmos/dso_export.h>
+#include <cosmos/thread/Condition.hxx>
+#include <cosmos/thread/FutexMutex.hxx>
+#include <cosmos/thread/futex.hxx>
+#include <cosmos/time/types.hxx>
+
+namespace cosmos {
+
+/// A lightweight condition variable for use with FutexMutex.
+/**
+ * This is the futex based counterpart of Condition. The semantics are the
+ * same, with these differences:
+ *
+ * - the FutexMutex is passed to each wait operation instead of being bound
+ *   to the object during construction. This allows both objects to be
+ *   placed independently in shared memory (where pointers between objects
+ *   are not valid in all processes). The same mutex needs to be used by all
+ *   waiters concurrently, though.
+ * - broadcast() with a FutexMutex argument wakes up only a single waiter and
+ *   moves the others over to the mutex. This way they are woken up one by
+ *   one as the mutex becomes available, instead of all of them contending
+ *   for the mutex at once.
+ *
+ * The condition consists of a 32-bit sequence counter that is incremented
+ * on each signal and a counter of waiting threads, which allows to skip the
+ * wake system call if nobody is waiting. Spurious wakeups are possible,
+ * always re-check the program state after wakeup.
+ *
+ * Both the condition and the mutex need to use the same ProcessShared
+ * setting.
+ **/
+class COSMOS_API FutexCondition {
+	// disallow copy/assignment
+	FutexCondition(const FutexCondition&) = delete;
+	FutexCondition& operator=(const FutexCondition&) = delete;
+
+public: // types
+
+	using WaitTimedRes = Condition::WaitTimedRes;
+
+public: // functions
+
+	explicit FutexCondition(const ProcessShared shared = ProcessShared{false}) :
+			m_shared{shared}
+	{}
+
+	/// Wait for the condition to be signaled.
+	/**
+	 * `mutex` needs to be locked by the caller. It is unlocked while
+	 * waiting and will be locked again upon return.
+	 **/
+	void wait(const FutexMutex &mutex) const;
+
+	/// Wait for the condition to be signaled with timeout.
+	/**
+	 * This is like wait() but waits at most until the given absolute time
+	 * has been reached. `mutex` is locked again upon return in any case.
+	 **/
+	WaitTimedRes waitTimed(const FutexMutex &mutex, const MonotonicTime ts) const;
+
+	/// Signal and unblock one waiting thread.
+	void signal() {
+		if (advance()) {
+			futex::wake(m_seq, 1, m_shared);
+		}
+	}
+
+	/// Signal and unblock all waiting threads.
+	void broadcast() {
+		if (advance()) {
+			futex::wake_all(m_seq, m_shared);
+		}
+	}
+
+	/// Signal all waiting threads and requeue them onto `mutex`.
+	/**
+	 * Only a single waiter is woken up directly. The others are woken one
+	 * after another as `mutex` is unlocked. `mutex` should be the one the
+	 * waiters are using.
+	 **/
+	void broadcast(const FutexMutex &mutex);
+
+	bool isShared() const { return m_shared; }
+
+protected: // functions
+
+	/// Increments the sequence counter and returns whether there are waiters.
+	bool advance() {
+		// pairs with the increment of m_waiters in wait(): either we
+		// see the waiter here, or the waiter sees the new sequence.
+		m_seq.fetch_add(1, std::memory_order_seq_cst);
+		return m_waiters.load(std::memory_order_seq_cst) != 0;
+	}
+
+	/// Samples the sequence counter and registers the caller as a waiter.
+	uint32_t enterWait() const {
+		m_waiters.fetch_add(1, std::memory_order_seq_cst);
+		return m_seq.load(std::memory_order_seq_cst);
+	}
+
+	void leaveWait() const {
+		m_waiters.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+protected: // data
+
+	futex::Word m_seq{0};
+	// mutable to allow const semantics in wait*() like in Condition
+	mutable futex::Word m_waiters{0};
+	const ProcessShared m_shared;
+};
+
+/// An aggregate of a FutexMutex and a FutexCondition coupled together.
+/**
+ * This is the counterpart of ConditionMutex.
+ **/
+class FutexConditionMutex :
+		public FutexMutex,
+		public FutexCondition {
+public: // functions
+
+	explicit FutexConditionMutex(const ProcessShared shared = ProcessShared{false}) :
+			FutexMutex{shared},
+			FutexCondition{shared}
+	{}
+
+	void wait() const {
+		FutexCondition::wait(*this);
+	}
+
+	WaitTimedRes waitTimed(const MonotonicTime ts) const {
+		return FutexCondition::waitTimed(*this, ts);
+	}
+
+	void broadcast() {
+		FutexCondition::broadcast(static_cast<FutexMutex&>(*this));
+	}
+
+	bool isShared() const { return FutexMutex::isShared(); }
+};
+
+} // end ns
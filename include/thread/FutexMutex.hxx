@@ -0,0 +1,135 @@
+#pragma once
+
+// C++
+#include <cassert>
+
+// cosmos
+#include <cosmos/dso_export.h>
+#include <cosmos/thread/futex.hxx>
+#include <cosmos/utils.hxx>
+
+namespace cosmos {
+
+// fwd. decl.
+class FutexCondition;
+
+/// A lightweight non-recursive mutex based on a single futex word.
+/**
+ * This is an alternative to the pthread based Mutex. The complete state is
+ * kept in a 4 byte integer, thus the object can be embedded densely into
+ * data structures. Uncontended lock() and unlock() operations consist only of
+ * a single atomic instruction each. Only when threads need to sleep the
+ * kernel is involved.
+ *
+ * If the lock is held by another thread then lock() spins for a short time
+ * before going to sleep, since critical sections are typically short and
+ * sleeping is expensive. Spinning is skipped if other waiters are already
+ * sleeping or if only a single CPU is available, since it would only burn
+ * CPU time in these cases.
+ *
+ * If ProcessShared is set during construction then the object can be placed
+ * in shared memory (e.g. a MemFile mapped with MapType::SHARED) to
+ * synchronize multiple processes. The process that creates the mapping needs
+ * to construct the object via placement new, the other processes use it
+ * as is.
+ *
+ * There is no error checking like in Mutex in debug mode. The lock also
+ * does not track its owner. Unlocking a mutex owned by another thread is not
+ * detected. To avoid false sharing between frequently used locks and
+ * unrelated data consider using `alignas(CACHE_LINE_SIZE)`.
+ **/
+class COSMOS_API FutexMutex {
+	// disallow copy/assignment
+	FutexMutex(const FutexMutex&) = delete;
+	FutexMutex& operator=(const FutexMutex&) = delete;
+
+	// for wait operations
+	friend class FutexCondition;
+
+public: // functions
+
+	explicit FutexMutex(const ProcessShared shared = ProcessShared{false}) :
+			m_word{shared ? SHARED : UNLOCKED}
+	{}
+
+	/// Attempt to lock the mutex without blocking.
+	/**
+	 * \return Whether the lock has been acquired.
+	 **/
+	bool tryLock() const {
+		auto expected = flags();
+		return m_word.compare_exchange_strong(expected, flags() | LOCKED,
+				std::memory_order_acquire, std::memory_order_relaxed);
+	}
+
+	void lock() const {
+		if (!tryLock()) {
+			lockSlow();
+		}
+	}
+
+	void unlock() const {
+		const auto prev = m_word.fetch_sub(1, std::memory_order_release);
+		assert((prev & STATE_MASK) != UNLOCKED);
+
+		if ((prev & STATE_MASK) == CONTENDED) {
+			wakeWaiter();
+		}
+	}
+
+	/// Returns whether the mutex is currently locked by some thread.
+	bool isLocked() const {
+		return (m_word.load(std::memory_order_relaxed) & STATE_MASK) != UNLOCKED;
+	}
+
+	bool isShared() const {
+		return (flags() & SHARED) != 0;
+	}
+
+protected: // types
+
+	static constexpr uint32_t UNLOCKED = 0;
+	/// Locked and there are no sleeping waiters.
+	static constexpr uint32_t LOCKED = 1;
+	/// Locked and there are (potentially) sleeping waiters.
+	static constexpr uint32_t CONTENDED = 2;
+	static constexpr uint32_t STATE_MASK = 0x3;
+	/// Constant flag bit for ProcessShared mode.
+	static constexpr uint32_t SHARED = 1U << 31;
+
+protected: // functions
+
+	uint32_t flags() const {
+		return m_word.load(std::memory_order_relaxed) & SHARED;
+	}
+
+	ProcessShared shared() const {
+		return ProcessShared{isShared()};
+	}
+
+	void lockSlow() const;
+
+	/// Lock the mutex assuming that other threads are sleeping on it.
+	void lockContended() const;
+
+	void wakeWaiter() const;
+
+protected: // data
+
+	// mutable to allow const lock/unlock semantics like in Mutex.
+	mutable futex::Word m_word;
+};
+
+static_assert(sizeof(FutexMutex) == sizeof(uint32_t));
+
+/// A mutex guard object that locks a FutexMutex for the lifetime of the guard object.
+struct FutexMutexGuard :
+		public ResourceGuard<const FutexMutex&> {
+
+	explicit FutexMutexGuard(const FutexMutex &m) :
+			ResourceGuard{m, [](const FutexMutex &_m) { _m.unlock(); }} {
+		m.lock();
+	}
+};
+
+} // end ns
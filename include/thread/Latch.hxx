@@ -0,0 +1,89 @@
+#pragma once
+
+// C++
+#include <optional>
+#include <stdint.h>
+
+// cosmos
+#include <cosmos/dso_export.h>
+#include <cosmos/thread/futex.hxx>
+#include <cosmos/time/types.hxx>
+
+namespace cosmos {
+
+/// A single-use countdown synchronization primitive.
+/**
+ * A Latch is initialized with a counter value. Threads decrement the
+ * counter via countDown() and other threads can wait() for it to reach
+ * zero. Once zero the Latch stays open, it cannot be reused. This is
+ * similar to `std::latch`, but based on a single futex word.
+ *
+ * Waiting threads spin for a short time before going to sleep. The
+ * countDown() that opens the Latch only performs a wake system call if
+ * threads are actually sleeping.
+ *
+ * If ProcessShared is set during construction then the object can be placed
+ * in shared memory, like FutexMutex.
+ **/
+class COSMOS_API Latch {
+	// disallow copy/assignment
+	Latch(const Latch&) = delete;
+	Latch& operator=(const Latch&) = delete;
+
+public: // functions
+
+	explicit Latch(const uint32_t count, const ProcessShared shared = ProcessShared{false}) :
+			m_count{count},
+			m_shared{shared}
+	{}
+
+	/// Decrements the counter by `n`, opening the Latch if it reaches zero.
+	/**
+	 * Decrementing the counter below zero is a usage error, which is
+	 * not detected.
+	 **/
+	void countDown(const uint32_t n = 1);
+
+	/// Returns whether the counter reached zero.
+	bool tryWait() const {
+		return m_count.load(std::memory_order_acquire) == 0;
+	}
+
+	/// Blocks until the counter reached zero.
+	void wait() const {
+		if (!tryWait()) {
+			waitSlow({});
+		}
+	}
+
+	/// Like wait() but gives up once the absolute time `ts` is reached.
+	/**
+	 * \return Whether the counter reached zero.
+	 **/
+	bool waitTimed(const MonotonicTime ts) const {
+		return tryWait() || waitSlow(ts);
+	}
+
+	/// Decrements the counter by `n` and waits for it to reach zero.
+	void arriveAndWait(const uint32_t n = 1) {
+		countDown(n);
+		wait();
+	}
+
+	/// Returns the current counter value.
+	uint32_t value() const {
+		return m_count.load(std::memory_order_relaxed);
+	}
+
+protected: // functions
+
+	bool waitSlow(const std::optional<MonotonicTime> ts) const;
+
+protected: // data
+
+	futex::Word m_count;
+	mutable futex::Word m_waiters{0};
+	const ProcessShared m_shared;
+};
+
+} // end ns
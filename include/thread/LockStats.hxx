@@ -0,0 +1,173 @@
+#pragma once
+
+// C++
+#include <array>
+#include <atomic>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <stdint.h>
+
+// cosmos
+#include <cosmos/dso_export.h>
+#include <cosmos/memory.hxx>
+
+/**
+ * Whether the inline lock functions of Mutex, RWLock and Condition check for
+ * attached LockStats. Define this to 0 to compile the check out of all call
+ * sites. instrument() still works but has no effect then.
+ *
+ * This is a whole-program setting: it changes the bodies of inline
+ * functions, thus libcosmos and all code including these headers need to
+ * be built with the same value, otherwise the one definition rule is
+ * violated. The `lockstats=0` build setting defines it for libcosmos
+ * itself, applications need to define it in the same way.
+ **/
+#ifndef COSMOS_LOCK_STATS
+#	define COSMOS_LOCK_STATS 1
+#endif
+
+namespace cosmos {
+
+/// Contention statistics for a single lock object.
+/**
+ * LockStats are attached to Mutex, RWLock or Condition objects via their
+ * `instrument()` member functions. Instrumented locks first attempt a
+ * non-blocking acquire. Only if this fails the time spent blocking is
+ * measured, thus the overhead for uncontended acquires is a single counter
+ * increment.
+ *
+ * Counters are kept in a small number of cache line aligned shards. Each
+ * thread is assigned to one shard, which avoids most of the cache line
+ * bouncing a single set of counters would cause. The shards are merged on
+ * demand in summary().
+ *
+ * Wait times are recorded in a histogram of power-of-two nanosecond
+ * buckets: bucket `i` counts waits in the range [2^(i-1), 2^i)
+ * nanoseconds, the last bucket also counts all longer waits.
+ *
+ * All LockStats are registered globally while they exist. The functions in
+ * the `lock_stats` namespace allow to collect, dump and globally disable
+ * them.
+ **/
+class COSMOS_API LockStats {
+	// disallow copy/assignment
+	LockStats(const LockStats&) = delete;
+	LockStats& operator=(const LockStats&) = delete;
+
+public: // types
+
+	enum class Kind {
+		MUTEX,
+		RWLOCK,
+		CONDITION
+	};
+
+	static constexpr size_t BUCKETS = 32;
+
+	/// Merged statistics of a LockStats object.
+	struct Summary {
+		std::string name;
+		Kind kind = Kind::MUTEX;
+		/// Number of acquires, or waits for a Condition.
+		uint64_t acquisitions = 0;
+		/// Number of acquires that needed to block, or waits for a Condition.
+		uint64_t contentions = 0;
+		/// Total time spent blocking in nanoseconds.
+		uint64_t wait_ns = 0;
+		/// Longest time spent blocking in nanoseconds.
+		uint64_t max_wait_ns = 0;
+		std::array<uint64_t, BUCKETS> histogram{};
+
+		/// Returns an upper bound of the given wait time percentile in nanoseconds.
+		/**
+		 * `percent` is in the range [0.0, 100.0]. The result is the
+		 * upper bound of the histogram bucket the percentile falls into.
+		 **/
+		uint64_t percentile(const double percent) const;
+	};
+
+public: // functions
+
+	/// Creates and registers a new LockStats object.
+	LockStats(const Kind kind, const std::string_view name);
+
+	~LockStats();
+
+	const std::string& name() const { return m_name; }
+
+	Kind kind() const { return m_kind; }
+
+	/// Accounts an acquisition that did not need to block.
+	void countAcquire() {
+		shard().acquisitions.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/// Accounts an acquisition that blocked for `wait_ns` nanoseconds.
+	void countContention(const uint64_t wait_ns);
+
+	/// Returns all shards merged into a single Summary.
+	Summary summary() const;
+
+	/// Resets all counters to zero.
+	void reset();
+
+	/// Returns the current CLOCK_MONOTONIC time in nanoseconds.
+	static uint64_t now();
+
+protected: // types
+
+	struct alignas(CACHE_LINE_SIZE) Shard {
+		std::atomic<uint64_t> acquisitions{0};
+		std::atomic<uint64_t> contentions{0};
+		std::atomic<uint64_t> wait_ns{0};
+		std::atomic<uint64_t> max_wait_ns{0};
+		std::array<std::atomic<uint64_t>, BUCKETS> histogram{};
+	};
+
+	static constexpr size_t SHARDS = 16;
+
+protected: // functions
+
+	/// Returns the shard of the calling thread.
+	Shard& shard() {
+		return m_shards[shardIndex()];
+	}
+
+	static size_t shardIndex();
+
+protected: // data
+
+	const Kind m_kind;
+	const std::string m_name;
+	std::array<Shard, SHARDS> m_shards;
+};
+
+/// Global control over all existing LockStats.
+namespace lock_stats {
+
+/// Enable or disable recording for all instrumented locks.
+/**
+ * Recording is enabled by default. While disabled, instrumented locks
+ * behave like plain ones, apart from an additional function call.
+ **/
+COSMOS_API void set_enabled(const bool enabled);
+
+COSMOS_API bool is_enabled();
+
+/// Returns summaries of all existing LockStats, most contended first.
+/**
+ * Locks are sorted by total wait time, then by number of contentions.
+ **/
+COSMOS_API std::vector<LockStats::Summary> collect();
+
+/// Writes a table of the `max` most contended locks to `out`.
+COSMOS_API void dump(std::ostream &out, const size_t max = 10);
+
+/// Resets the counters of all existing LockStats.
+COSMOS_API void reset_all();
+
+} // end ns
+
+} // end ns
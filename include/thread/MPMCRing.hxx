@@ -0,0 +1,231 @@
+#pragma once
+
+// C++
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <utility>
+
+// cosmos
+#include <cosmos/error/UsageError.hxx>
+#include <cosmos/memory.hxx>
+#include <cosmos/thread/Doorbell.hxx>
+
+namespace cosmos {
+
+/// A bounded lock-free multi-producer multi-consumer ring buffer.
+/**
+ * Any number of threads may concurrently push() and pop() elements. Neither
+ * side ever blocks, full or empty conditions are reported via the return
+ * values.
+ *
+ * The implementation follows Dmitry Vyukov's bounded MPMC queue: each slot
+ * carries a sequence number that tells whether it is ready for the producer
+ * or the consumer claiming the current position. Producers and consumers
+ * claim positions by compare-and-swap on separate, cache line aligned
+ * indices and never touch the other side's index in the fast path. Batch
+ * operations claim a range of ready slots with a single compare-and-swap.
+ *
+ * The Doorbell semantics are the same as with SPSCRing: it is rung whenever
+ * a producer observes a transition from empty to non-empty. With multiple
+ * consumers more than one of them may wake up for a single ring.
+ *
+ * The capacity must be a power of two of at least two. Elements are default
+ * constructed upfront and move assigned during push and pop.
+ **/
+template <typename T>
+requires std::default_initializable<T> && std::movable<T>
+class MPMCRing {
+	// disallow copy/assignment
+	MPMCRing(const MPMCRing&) = delete;
+	MPMCRing& operator=(const MPMCRing&) = delete;
+
+public: // functions
+
+	explicit MPMCRing(const size_t capacity, Doorbell *doorbell = nullptr) :
+			m_mask{capacity - 1},
+			m_slots{std::make_unique<Slot[]>(capacity)},
+			m_doorbell{doorbell} {
+		if (capacity < 2 || !std::has_single_bit(capacity)) {
+			throw UsageError{"MPMCRing capacity needs to be a power of two >= 2"};
+		}
+
+		for (size_t pos = 0; pos < capacity; pos++) {
+			m_slots[pos].seq.store(pos, std::memory_order_relaxed);
+		}
+	}
+
+	/// Adds `item` to the ring, returns false if the ring is full.
+	bool push(T &&item) {
+		return pushBatch(std::span<T>{&item, 1}) == 1;
+	}
+
+	bool push(const T &item) {
+		T copy{item};
+		return push(std::move(copy));
+	}
+
+	/// Moves as many elements from `items` into the ring as possible.
+	/**
+	 * Returns the number of elements that have been moved, which is less
+	 * than `items.size()` if the ring becomes full or other producers
+	 * compete for the same slots.
+	 **/
+	size_t pushBatch(std::span<T> items) {
+		if (items.empty())
+			return 0;
+
+		auto pos = m_enqueue_pos.load(std::memory_order_relaxed);
+		size_t count;
+
+		while (true) {
+			count = countReady(pos, 0, items.size());
+
+			if (count != 0) {
+				if (m_enqueue_pos.compare_exchange_weak(pos, pos + count,
+							std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (seqDiff(at(pos).seq.load(std::memory_order_acquire), pos) < 0) {
+				// the consumer of the previous round did not free the slot yet
+				return 0;
+			} else {
+				// another producer claimed the slot
+				pos = m_enqueue_pos.load(std::memory_order_relaxed);
+			}
+		}
+
+		for (size_t i = 0; i < count; i++) {
+			auto &slot = at(pos + i);
+			slot.value = std::move(items[i]);
+			slot.seq.store(pos + i + 1, std::memory_order_release);
+		}
+
+		if (m_doorbell) {
+			// pairs with the compare-and-swap in popBatch(): either the
+			// consumer sees the published slot or we see that it
+			// drained the ring.
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (m_dequeue_pos.load(std::memory_order_relaxed) == pos) {
+				m_doorbell->ring();
+			}
+		}
+
+		return count;
+	}
+
+	/// Removes the oldest element into `item`, returns false if the ring is empty.
+	bool pop(T &item) {
+		return popBatch(std::span<T>{&item, 1}) == 1;
+	}
+
+	/// Moves up to `items.size()` of the oldest elements into `items`.
+	/**
+	 * Returns the number of elements that have been moved, zero if the
+	 * ring is empty.
+	 **/
+	size_t popBatch(std::span<T> items) {
+		if (items.empty())
+			return 0;
+
+		auto pos = m_dequeue_pos.load(std::memory_order_relaxed);
+		size_t count;
+
+		while (true) {
+			count = countReady(pos, 1, items.size());
+
+			if (count != 0) {
+				if (m_dequeue_pos.compare_exchange_weak(pos, pos + count,
+							std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (seqDiff(at(pos).seq.load(std::memory_order_acquire), pos + 1) < 0) {
+				if (!m_doorbell || !confirmEmpty(pos)) {
+					return 0;
+				}
+			} else {
+				// another consumer claimed the slot
+				pos = m_dequeue_pos.load(std::memory_order_relaxed);
+			}
+		}
+
+		for (size_t i = 0; i < count; i++) {
+			auto &slot = at(pos + i);
+			items[i] = std::move(slot.value);
+			slot.seq.store(pos + i + m_mask + 1, std::memory_order_release);
+		}
+
+		return count;
+	}
+
+	size_t capacity() const { return m_mask + 1; }
+
+	/// Returns the number of elements, which may be outdated when it returns.
+	size_t sizeApprox() const {
+		const auto head = m_dequeue_pos.load(std::memory_order_acquire);
+		const auto tail = m_enqueue_pos.load(std::memory_order_acquire);
+		return tail >= head ? tail - head : 0;
+	}
+
+	bool emptyApprox() const { return sizeApprox() == 0; }
+
+protected: // types
+
+	struct Slot {
+		std::atomic<size_t> seq;
+		T value;
+	};
+
+protected: // functions
+
+	Slot& at(const size_t pos) { return m_slots[pos & m_mask]; }
+
+	static std::ptrdiff_t seqDiff(const size_t seq, const size_t expected) {
+		return static_cast<std::ptrdiff_t>(seq - expected);
+	}
+
+	/// Counts consecutive slots starting at `pos` whose seq equals their position plus `offset`.
+	size_t countReady(const size_t pos, const size_t offset, const size_t max) {
+		size_t count = 0;
+
+		while (count < max && count <= m_mask &&
+				at(pos + count).seq.load(std::memory_order_acquire) == pos + count + offset) {
+			count++;
+		}
+
+		return count;
+	}
+
+	/// Makes sure a producer rings the doorbell if the ring is empty at `pos`.
+	/**
+	 * Returns true if the ring is not empty anymore and `pos` has been
+	 * updated to retry the pop. Otherwise the ring was still empty after
+	 * a full memory barrier.
+	 **/
+	bool confirmEmpty(size_t &pos) {
+		// the RMW makes the empty index visible before our check below
+		// in a way that producers can't miss.
+		if (!m_dequeue_pos.compare_exchange_strong(pos, pos, std::memory_order_seq_cst)) {
+			return true;
+		}
+
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		return at(pos).seq.load(std::memory_order_acquire) == pos + 1;
+	}
+
+protected: // data
+
+	/// Position for the next push.
+	alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_enqueue_pos{0};
+	/// Position for the next pop.
+	alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_dequeue_pos{0};
+	/// Read-only data shared by all threads.
+	alignas(CACHE_LINE_SIZE) const size_t m_mask;
+	std::unique_ptr<Slot[]> m_slots;
+	Doorbell *m_doorbell = nullptr;
+};
+
+} // end ns
@@ -5,10 +5,14 @@
 
 // C++
 #include <cassert>
+#include <memory>
+#include <string_view>
 
 // cosmos
+#include <cosmos/BitMask.hxx>
 #include <cosmos/dso_export.h>
 #include <cosmos/error/ApiError.hxx>
+#include <cosmos/thread/LockStats.hxx>
 #include <cosmos/utils.hxx>
 
 namespace cosmos {
@@ -21,12 +25,66 @@ class Condition;
  * Only the most basic operations are implemented by now. For more details
  * about the semantics refer to `man pthread_mutex_init` and `man
  * pthread_mutex_destroy`.
+ *
+ * Special mutex properties like priority inheritance, robustness or process
+ * shared operation can be selected via Options during construction.
  **/
 class COSMOS_API Mutex {
 	// disallow copy/assignment
 	Mutex(const Mutex&) = delete;
 	Mutex& operator=(const Mutex&) = delete;
 
+public: // types
+
+	/// Special properties to be applied to a Mutex during construction.
+	enum class Option : unsigned {
+		/// Use the `PTHREAD_PRIO_INHERIT` protocol.
+		/**
+		 * While a thread holds the mutex and higher priority threads
+		 * are blocked on it, the owner executes with the highest
+		 * priority of the blocked threads. This avoids priority
+		 * inversion when realtime threads (e.g. using
+		 * FifoSchedulerSettings) share locks with lower priority
+		 * threads.
+		 **/
+		PRIO_INHERIT   = 1 << 0,
+		/// Make the mutex robust against owners terminating while holding it.
+		/**
+		 * If the owner of the mutex terminates without unlocking it
+		 * then the next locker acquires the lock and is informed about
+		 * this instead of blocking forever. lockRobust() reports this
+		 * as LockResult::OWNER_DIED. lock() reports it by throwing an
+		 * ApiError with Errno::OWNER_DEAD, while the lock is held by
+		 * the caller nonetheless. In both cases the mutex needs to be
+		 * recovered as described for LockResult::OWNER_DIED.
+		 **/
+		ROBUST         = 1 << 1,
+		/// Allow to use the mutex from multiple processes.
+		/**
+		 * The Mutex object needs to be placed in memory shared between
+		 * the processes, like a MemFile mapped with MapType::SHARED.
+		 **/
+		PROCESS_SHARED = 1 << 2,
+	};
+
+	using Options = BitMask<Option>;
+
+	/// Result of lockRobust().
+	enum class LockResult {
+		/// The lock was acquired regularly.
+		ACQUIRED,
+		/// The lock was acquired but its previous owner died while holding it.
+		/**
+		 * The caller owns the lock but the protected data may be in an
+		 * inconsistent state. After restoring the data makeConsistent()
+		 * needs to be called before unlocking the Mutex. If the Mutex
+		 * is unlocked without doing so, then it becomes permanently
+		 * unusable and further lock attempts fail with
+		 * Errno::NOT_RECOVERABLE.
+		 **/
+		OWNER_DIED
+	};
+
 public: // functions
 
 	/// Create a non-recursive Mutex.
@@ -39,6 +97,14 @@ public: // functions
 	 **/
 	Mutex();
 
+	/// Create a non-recursive Mutex with the given special properties.
+	/**
+	 * A Mutex using Option::PROCESS_SHARED needs to be constructed via
+	 * placement new in the shared memory by one of the participating
+	 * processes. Such mutexes cannot be instrumented, see instrument().
+	 **/
+	explicit Mutex(const Options options);
+
 	~Mutex() {
 		const auto destroy_res = ::pthread_mutex_destroy(&m_pmutex);
 
@@ -47,13 +113,38 @@ public: // functions
 	}
 
 	void lock() const {
-		const auto lock_res = ::pthread_mutex_lock(&m_pmutex);
-
-		if (lock_res) {
-			throw ApiError{"pthread_mutex_lock()", Errno{lock_res}};
+		if constexpr (COSMOS_LOCK_STATS) {
+			if (m_stats) [[unlikely]] {
+				lockInstrumented();
+				return;
+			}
 		}
+
+		lockPlain();
 	}
 
+	/// Lock a Mutex created with Option::ROBUST.
+	/**
+	 * If the previous owner died while holding the lock then this returns
+	 * LockResult::OWNER_DIED. Regular lock() can also be used with robust
+	 * mutexes, but it reports this situation by throwing an ApiError with
+	 * Errno::OWNER_DEAD, while the lock is held by the caller
+	 * nonetheless. This function reports it as a regular return value
+	 * instead.
+	 *
+	 * If the mutex has become unrecoverable then an ApiError with
+	 * Errno::NOT_RECOVERABLE is thrown.
+	 **/
+	[[nodiscard]] LockResult lockRobust() const;
+
+	/// Mark the state protected by a robust Mutex as consistent again.
+	/**
+	 * This is to be called by the owner of the lock after
+	 * lockRobust() returned LockResult::OWNER_DIED and the protected
+	 * data has been restored.
+	 **/
+	void makeConsistent() const;
+
 	void unlock() const {
 		const int unlock_res = ::pthread_mutex_unlock(&m_pmutex);
 
@@ -62,10 +153,44 @@ public: // functions
 		}
 	}
 
+	/// Enables contention statistics for this Mutex.
+	/**
+	 * This attaches a LockStats object using the given name, which
+	 * becomes visible in lock_stats::collect(). This must be called before
+	 * the Mutex is used concurrently. Calling it again resets the
+	 * statistics.
+	 *
+	 * The LockStats object is allocated on the heap of the calling
+	 * process. For a Mutex created with Option::PROCESS_SHARED other
+	 * processes would access a foreign heap pointer, thus a UsageError
+	 * is thrown in this case.
+	 **/
+	void instrument(const std::string_view name = {});
+
+	/// Returns the attached LockStats, if any.
+	const LockStats* stats() const { return m_stats.get(); }
+
+	/// Returns the special properties the Mutex has been created with.
+	Options options() const { return m_options; }
+
+protected: // functions
+
+	void lockPlain() const {
+		const auto lock_res = ::pthread_mutex_lock(&m_pmutex);
+
+		if (lock_res) {
+			throw ApiError{"pthread_mutex_lock()", Errno{lock_res}};
+		}
+	}
+
+	void lockInstrumented() const;
+
 protected: // data
 
 	// make that mutable to make const lock/unlock semantics possible
 	mutable pthread_mutex_t m_pmutex;
+	std::unique_ptr<LockStats> m_stats;
+	Options m_options;
 
 	// Condition needs access to our handle
 	friend class Condition;
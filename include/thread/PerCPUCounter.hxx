@@ -0,0 +1,76 @@
+#pragma once
+
+// C++
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+
+// cosmos
+#include <cosmos/dso_export.h>
+#include <cosmos/memory.hxx>
+
+namespace cosmos {
+
+/// A scalable statistics counter with one slot per CPU.
+/**
+ * A single atomic counter that is updated by many threads on many CPUs
+ * becomes a bottleneck, since its cache line needs to move between the CPUs
+ * for every update. This counter keeps a separate, cache line aligned slot
+ * for every possible CPU instead. Updates only touch the slot of the CPU the
+ * caller is running on, value() sums up all slots.
+ *
+ * If restartable sequences are available (see rseq::has_percpu_ops()) then
+ * updates are plain additions protected by an rseq critical section, no
+ * atomic instructions are involved. Otherwise the current CPU is determined
+ * via rseq::current_cpu() and the slot is updated atomically, which is still
+ * mostly free of contention.
+ *
+ * value() is not a consistent snapshot if updates happen concurrently, but
+ * every completed update is reflected in it.
+ **/
+class COSMOS_API PerCPUCounter {
+	// disallow copy/assignment
+	PerCPUCounter(const PerCPUCounter&) = delete;
+	PerCPUCounter& operator=(const PerCPUCounter&) = delete;
+
+public: // functions
+
+	/// Creates a counter with a slot for each possible CPU number, see rseq::possible_cpu_slots().
+	PerCPUCounter();
+
+	/// Adds `value` to the counter.
+	void add(const int64_t value);
+
+	void increment() { add(1); }
+
+	void decrement() { add(-1); }
+
+	/// Returns the sum of all per-CPU slots.
+	int64_t value() const;
+
+	/// Sets all slots to zero.
+	/**
+	 * Updates that happen concurrently may or may not be lost.
+	 **/
+	void reset();
+
+	/// Returns whether updates use rseq critical sections.
+	bool usesRSeq() const { return m_use_rseq; }
+
+	/// Returns the number of per-CPU slots.
+	size_t slots() const { return m_num_slots; }
+
+protected: // types
+
+	struct alignas(CACHE_LINE_SIZE) Slot {
+		std::atomic<int64_t> value{0};
+	};
+
+protected: // data
+
+	size_t m_num_slots = 0;
+	std::unique_ptr<Slot[]> m_slots;
+	bool m_use_rseq = false;
+};
+
+} // end ns
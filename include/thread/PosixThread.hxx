@@ -7,6 +7,7 @@
 #include <string_view>
 
 // cosmos
+#include <cosmos/thread/ThreadAttributes.hxx>
 #include <cosmos/thread/pthread.hxx>
 #include <cosmos/time/types.hxx>
 
@@ -97,6 +98,21 @@ public: // functions
 	 **/
 	explicit PosixThread(Entry entry, const std::string_view name = {});
 
+	/// Creates a thread with custom ThreadAttributes running in the provided PosixEntry function.
+	/**
+	 * \see PosixThread(PosixEntry, pthread::ThreadArg, const string_view)
+	 * \see ThreadAttributes
+	 **/
+	PosixThread(PosixEntry entry, pthread::ThreadArg arg,
+			const ThreadAttributes &attrs, const std::string_view name = {});
+
+	/// Creates a thread with custom ThreadAttributes running in the provided simple Entry function.
+	/**
+	 * \see PosixThread(PosixEntry, pthread::ThreadArg, const string_view)
+	 * \see ThreadAttributes
+	 **/
+	PosixThread(Entry entry, const ThreadAttributes &attrs, const std::string_view name = {});
+
 	PosixThread(PosixThread &&other) noexcept;
 
 	PosixThread& operator=(PosixThread &&other) noexcept;
@@ -194,6 +210,16 @@ public: // functions
 		pthread::kill(id(), sig);
 	}
 
+	/// Wrapper around cosmos::pthread::set_affinity().
+	void setAffinity(const CPUSet &cpus) {
+		pthread::set_affinity(id(), cpus);
+	}
+
+	/// Wrapper around cosmos::pthread::get_affinity().
+	CPUSet getAffinity() const {
+		return pthread::get_affinity(id());
+	}
+
 protected: // functions
 
 	std::string buildName(const std::string_view name, size_t nr) const;
@@ -0,0 +1,251 @@
+#pragma once
+
+// C++
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <stdint.h>
+
+// cosmos
+#include <cosmos/dso_export.h>
+#include <cosmos/memory.hxx>
+#include <cosmos/thread/FutexMutex.hxx>
+#include <cosmos/thread/membarrier.hxx>
+
+/**
+ * @file
+ *
+ * Read-copy-update (RCU) style publication of read-mostly data based on
+ * quiescent state based reclamation (QSBR).
+ *
+ * Writers create a modified copy of a data structure and atomically publish
+ * it via RCUPointer. Readers access the currently published object without
+ * any locking or writes to shared memory. The previous object is only
+ * reclaimed once all registered reader threads passed a quiescent state,
+ * i.e. a point where they are guaranteed to hold no references to RCU
+ * protected objects anymore.
+ **/
+
+namespace cosmos {
+
+/// Tracks reader threads and deferred reclamation for RCU protected objects.
+/**
+ * Each thread that reads RCU protected data needs to register a Reader with
+ * the domain. The reader thread needs to regularly report quiescent states
+ * via Reader::quiescent(), for example once per iteration of its main
+ * loop. A reader that blocks for a longer time (e.g. in Poller::wait())
+ * should go offline() beforehand, so that it doesn't hold back
+ * reclamation.
+ *
+ * The domain maintains a global epoch counter. A quiescent state copies the
+ * current epoch into the reader's private, cache line aligned slot. Writers
+ * advance the epoch and check the reader slots for whether all readers
+ * passed the new epoch. Readers never write to memory that is written by
+ * other threads.
+ *
+ * The domain needs to outlive all Readers and RCUPointers associated with
+ * it.
+ **/
+class COSMOS_API RCUDomain {
+	// disallow copy/assignment
+	RCUDomain(const RCUDomain&) = delete;
+	RCUDomain& operator=(const RCUDomain&) = delete;
+
+protected: // types
+
+	/// Epoch value of offline readers.
+	static constexpr uint64_t OFFLINE = 0;
+
+	/// Per reader state, exclusively written by the reader thread.
+	struct alignas(CACHE_LINE_SIZE) Slot {
+		std::atomic<uint64_t> epoch{OFFLINE};
+	};
+
+	/// An object waiting for reclamation.
+	struct Retired {
+		void *obj;
+		void (*deleter)(void*);
+		/// The epoch all readers need to reach before reclamation.
+		uint64_t epoch;
+	};
+
+public: // types
+
+	/// Registration of a reader thread with an RCUDomain.
+	/**
+	 * The object should be created and used by the reader thread only.
+	 * Initially the reader is online.
+	 **/
+	class COSMOS_API Reader {
+		// disallow copy/assignment
+		Reader(const Reader&) = delete;
+		Reader& operator=(const Reader&) = delete;
+
+	public: // functions
+
+		explicit Reader(RCUDomain &domain);
+
+		~Reader();
+
+		/// Report that no RCU protected objects are referenced anymore.
+		/**
+		 * Pointers obtained from RCUPointer::read() before this call
+		 * must not be used afterwards.
+		 **/
+		void quiescent() {
+			m_slot->epoch.store(
+				m_domain.m_epoch.load(std::memory_order_acquire),
+				std::memory_order_release);
+		}
+
+		/// Stop participating in RCU until online() is called.
+		/**
+		 * This is an extended quiescent state. No RCU protected
+		 * objects may be accessed while offline.
+		 **/
+		void offline() {
+			m_slot->epoch.store(OFFLINE, std::memory_order_release);
+		}
+
+		/// Start participating in RCU again after offline().
+		void online() {
+			m_slot->epoch.store(
+				m_domain.m_epoch.load(std::memory_order_acquire),
+				std::memory_order_relaxed);
+			// the store needs to be visible before RCU data is read,
+			// pairs with the heavy fence on the writer side.
+			membarrier::light_fence();
+		}
+
+		bool isOnline() const {
+			return m_slot->epoch.load(std::memory_order_relaxed) != OFFLINE;
+		}
+
+	protected: // data
+
+		RCUDomain &m_domain;
+		Slot *m_slot = nullptr;
+	};
+
+public: // functions
+
+	RCUDomain() {
+		// allows readers to use cheap asymmetric fences
+		membarrier::register_private_expedited();
+	}
+
+	/// Reclaims all pending objects.
+	/**
+	 * No Readers may be registered anymore at this point.
+	 **/
+	~RCUDomain();
+
+	/// Wait until all online readers passed a quiescent state.
+	/**
+	 * When this returns then all objects retired before the call have
+	 * been reclaimed. This must not be called by an online reader of this
+	 * domain, since it would wait for itself.
+	 **/
+	void synchronize();
+
+	/// Reclaim `obj` via `delete` once all readers passed a quiescent state.
+	/**
+	 * This does not block. Objects for which this is already the case
+	 * are reclaimed during this call.
+	 **/
+	template <typename T>
+	void retire(const T *obj) {
+		retire(const_cast<T*>(obj), [](void *p) { delete static_cast<T*>(p); });
+	}
+
+	/// Reclaim `obj` via `deleter` once all readers passed a quiescent state.
+	void retire(void *obj, void (*deleter)(void*));
+
+	/// Reclaim all retired objects that are no longer referenced by readers.
+	/**
+	 * \return The number of objects still pending reclamation.
+	 **/
+	size_t collect();
+
+	/// Returns the number of objects pending reclamation.
+	size_t pending() const;
+
+protected: // functions
+
+	Slot* registerReader();
+
+	void unregisterReader(Slot *slot);
+
+	/// Returns the smallest epoch of all online readers (or UINT64_MAX).
+	uint64_t minReaderEpoch() const;
+
+	/// Reclaims retired objects with m_lock held.
+	size_t collectLocked();
+
+protected: // data
+
+	/// The current global epoch, written by writers only.
+	alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_epoch{1};
+	/// Protects m_slots and m_retired.
+	alignas(CACHE_LINE_SIZE) FutexMutex m_lock;
+	std::vector<std::unique_ptr<Slot>> m_slots;
+	std::vector<Retired> m_retired;
+};
+
+/// A pointer to an RCU protected, immutable object of type T.
+/**
+ * Readers obtain the current object via read(), which is a plain atomic
+ * load. The object may be used until the reader reports its next quiescent
+ * state via RCUDomain::Reader::quiescent().
+ *
+ * Writers publish a new object via update(), which retires the previous one
+ * in the associated RCUDomain. Objects are never modified after
+ * publication. Concurrent writers need to be serialized by the caller if
+ * the new object is derived from the current one.
+ **/
+template <typename T>
+class RCUPointer {
+	// disallow copy/assignment
+	RCUPointer(const RCUPointer&) = delete;
+	RCUPointer& operator=(const RCUPointer&) = delete;
+
+public: // functions
+
+	explicit RCUPointer(RCUDomain &domain, std::unique_ptr<const T> initial = {}) :
+			m_domain{domain},
+			m_ptr{initial.release()}
+	{}
+
+	/// Deletes the current object, no readers may access it anymore.
+	~RCUPointer() {
+		delete m_ptr.load(std::memory_order_relaxed);
+	}
+
+	/// Returns the currently published object, may be nullptr.
+	const T* read() const {
+		return m_ptr.load(std::memory_order_acquire);
+	}
+
+	/// Publish `next`, the previous object is reclaimed in the background.
+	void update(std::unique_ptr<const T> next) {
+		if (auto old = m_ptr.exchange(next.release(), std::memory_order_seq_cst); old) {
+			m_domain.retire(old);
+		}
+	}
+
+	/// Publish `next` and wait for the previous object to be reclaimed.
+	/**
+	 * \see RCUDomain::synchronize().
+	 **/
+	void updateSync(std::unique_ptr<const T> next) {
+		update(std::move(next));
+		m_domain.synchronize();
+	}
+
+protected: // data
+
+	RCUDomain &m_domain;
+	std::atomic<const T*> m_ptr;
+};
+
+} // end ns
@@ -5,9 +5,13 @@
 
 // C++
 #include <cassert>
+#include <memory>
+#include <string_view>
 
 // cosmos
+#include <cosmos/dso_export.h>
 #include <cosmos/error/ApiError.hxx>
+#include <cosmos/thread/LockStats.hxx>
 #include <cosmos/utils.hxx>
 
 namespace cosmos {
@@ -21,7 +25,7 @@ namespace cosmos {
  * Only the most basic operations are provided by now. For more information
  * please refer to the POSIX man pages.
  **/
-class RWLock {
+class COSMOS_API RWLock {
 	// forbid copy-assignment
 	RWLock(const RWLock&) = delete;
 	RWLock& operator=(const RWLock&) = delete;
@@ -41,15 +45,25 @@ public: // functions
 	}
 
 	void readlock() const {
-		if (::pthread_rwlock_rdlock(&m_prwlock) != 0) {
-			throw ApiError{"pthread_rwlock_rdlock()"};
+		if constexpr (COSMOS_LOCK_STATS) {
+			if (m_stats) [[unlikely]] {
+				readlockInstrumented();
+				return;
+			}
 		}
+
+		readlockPlain();
 	}
 
 	void writelock() const {
-		if (::pthread_rwlock_wrlock(&m_prwlock) != 0) {
-			throw ApiError{"pthread_rwlock_wrlock()"};
+		if constexpr (COSMOS_LOCK_STATS) {
+			if (m_stats) [[unlikely]] {
+				writelockInstrumented();
+				return;
+			}
 		}
+
+		writelockPlain();
 	}
 
 	/// Unlock a previously obtained read or write lock
@@ -59,10 +73,41 @@ public: // functions
 		}
 	}
 
+	/// Enables contention statistics for this RWLock.
+	/**
+	 * \see Mutex::instrument(). Read and write locks are accounted
+	 * together.
+	 **/
+	void instrument(const std::string_view name = {}) {
+		m_stats = std::make_unique<LockStats>(LockStats::Kind::RWLOCK, name);
+	}
+
+	/// Returns the attached LockStats, if any.
+	const LockStats* stats() const { return m_stats.get(); }
+
+protected: // functions
+
+	void readlockPlain() const {
+		if (::pthread_rwlock_rdlock(&m_prwlock) != 0) {
+			throw ApiError{"pthread_rwlock_rdlock()"};
+		}
+	}
+
+	void writelockPlain() const {
+		if (::pthread_rwlock_wrlock(&m_prwlock) != 0) {
+			throw ApiError{"pthread_rwlock_wrlock()"};
+		}
+	}
+
+	void readlockInstrumented() const;
+
+	void writelockInstrumented() const;
+
 protected: // data
 
 	// make that mutable to make const lock/unlock semantics possible
 	mutable pthread_rwlock_t m_prwlock;
+	std::unique_ptr<LockStats> m_stats;
 };
 
 /// A lock-guard object that locks an RWLock for reading until it is destroyed.
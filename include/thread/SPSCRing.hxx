@@ -0,0 +1,174 @@
+#pragma once
+
+// C++
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <memory>
+#include <span>
+#include <utility>
+
+// cosmos
+#include <cosmos/error/UsageError.hxx>
+#include <cosmos/memory.hxx>
+#include <cosmos/thread/Doorbell.hxx>
+
+namespace cosmos {
+
+/// A bounded lock-free single-producer single-consumer ring buffer.
+/**
+ * Exactly one thread may act as producer (calling push() and pushBatch())
+ * and exactly one thread may act as consumer (calling pop() and popBatch())
+ * at any time. Neither side ever blocks, full or empty conditions are
+ * reported via the return values.
+ *
+ * The producer and consumer indices live on separate cache lines. Each side
+ * additionally caches the last seen index of the other side, so that the
+ * shared cache lines are only touched when the ring appears full or empty.
+ * Batch operations publish many elements with a single index update.
+ *
+ * If a Doorbell is passed during construction then it is rung whenever the
+ * producer observes a transition from empty to non-empty. This allows the
+ * consumer to sleep in Poller::wait(), see Doorbell for the protocol to
+ * follow. Without a Doorbell no additional overhead is incurred.
+ *
+ * The capacity must be a power of two. Elements are default constructed
+ * upfront and move assigned during push and pop.
+ **/
+template <typename T>
+requires std::default_initializable<T> && std::movable<T>
+class SPSCRing {
+	// disallow copy/assignment
+	SPSCRing(const SPSCRing&) = delete;
+	SPSCRing& operator=(const SPSCRing&) = delete;
+
+public: // functions
+
+	explicit SPSCRing(const size_t capacity, Doorbell *doorbell = nullptr) :
+			m_mask{capacity - 1},
+			m_slots{std::make_unique<T[]>(capacity)},
+			m_doorbell{doorbell} {
+		if (!std::has_single_bit(capacity)) {
+			throw UsageError{"SPSCRing capacity needs to be a power of two"};
+		}
+	}
+
+	/// Adds `item` to the ring, returns false if the ring is full.
+	bool push(T &&item) {
+		return pushBatch(std::span<T>{&item, 1}) == 1;
+	}
+
+	bool push(const T &item) {
+		T copy{item};
+		return push(std::move(copy));
+	}
+
+	/// Moves as many elements from `items` into the ring as possible.
+	/**
+	 * Returns the number of elements that have been moved, which is less
+	 * than `items.size()` if the ring becomes full.
+	 **/
+	size_t pushBatch(std::span<T> items) {
+		const auto tail = m_tail.load(std::memory_order_relaxed);
+
+		if (freeSlots(tail) < items.size()) {
+			m_cached_head = m_head.load(std::memory_order_acquire);
+		}
+
+		const auto count = std::min(items.size(), freeSlots(tail));
+
+		if (count == 0)
+			return 0;
+
+		for (size_t i = 0; i < count; i++) {
+			at(tail + i) = std::move(items[i]);
+		}
+
+		m_tail.store(tail + count, std::memory_order_release);
+
+		if (m_doorbell) {
+			// pairs with the fence in popBatch(): either the consumer
+			// sees the new tail or we see that it drained the ring.
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (m_head.load(std::memory_order_relaxed) == tail) {
+				m_doorbell->ring();
+			}
+		}
+
+		return count;
+	}
+
+	/// Removes the oldest element into `item`, returns false if the ring is empty.
+	bool pop(T &item) {
+		return popBatch(std::span<T>{&item, 1}) == 1;
+	}
+
+	/// Moves up to `items.size()` of the oldest elements into `items`.
+	/**
+	 * Returns the number of elements that have been moved, zero if the
+	 * ring is empty.
+	 **/
+	size_t popBatch(std::span<T> items) {
+		const auto head = m_head.load(std::memory_order_relaxed);
+
+		if (usedSlots(head) < items.size()) {
+			if (m_doorbell && usedSlots(head) == 0) {
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+			}
+			m_cached_tail = m_tail.load(std::memory_order_acquire);
+		}
+
+		const auto count = std::min(items.size(), usedSlots(head));
+
+		if (count == 0)
+			return 0;
+
+		for (size_t i = 0; i < count; i++) {
+			items[i] = std::move(at(head + i));
+		}
+
+		m_head.store(head + count, std::memory_order_release);
+		return count;
+	}
+
+	size_t capacity() const { return m_mask + 1; }
+
+	/// Returns the number of elements, which may be outdated when it returns.
+	size_t sizeApprox() const {
+		const auto head = m_head.load(std::memory_order_acquire);
+		const auto tail = m_tail.load(std::memory_order_acquire);
+		return tail >= head ? tail - head : 0;
+	}
+
+	bool emptyApprox() const { return sizeApprox() == 0; }
+
+protected: // functions
+
+	T& at(const size_t index) { return m_slots[index & m_mask]; }
+
+	size_t freeSlots(const size_t tail) const {
+		return capacity() - (tail - m_cached_head);
+	}
+
+	size_t usedSlots(const size_t head) const {
+		return m_cached_tail - head;
+	}
+
+protected: // data
+
+	/// Consumer side: index of the next element to pop.
+	alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_head{0};
+	/// Consumer side: last seen value of m_tail.
+	size_t m_cached_tail = 0;
+	/// Producer side: index of the next element to push.
+	alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_tail{0};
+	/// Producer side: last seen value of m_head.
+	size_t m_cached_head = 0;
+	/// Read-only data shared by both sides.
+	alignas(CACHE_LINE_SIZE) const size_t m_mask;
+	std::unique_ptr<T[]> m_slots;
+	Doorbell *m_doorbell = nullptr;
+};
+
+} // end ns
@@ -0,0 +1,89 @@
+#pragma once
+
+// cosmos
+#include <cosmos/dso_export.h>
+#include <cosmos/thread/futex.hxx>
+#include <cosmos/time/types.hxx>
+
+namespace cosmos {
+
+/// A futex based counting semaphore.
+/**
+ * The semaphore maintains a counter of available resources. post() increases
+ * the counter, wait() blocks until the counter is non-zero and then
+ * decrements it.
+ *
+ * The counter and the number of sleeping waiters are kept next to each
+ * other, so that post() can skip the wake() system call if nobody is
+ * waiting. Both fit into a single cache line. To avoid false sharing with
+ * unrelated data consider using `alignas(CACHE_LINE_SIZE)`.
+ *
+ * If ProcessShared is set during construction then the object can be placed
+ * in shared memory to synchronize multiple processes, like FutexMutex.
+ **/
+class COSMOS_API Semaphore {
+	// disallow copy/assignment
+	Semaphore(const Semaphore&) = delete;
+	Semaphore& operator=(const Semaphore&) = delete;
+
+public: // functions
+
+	explicit Semaphore(const uint32_t initial = 0, const ProcessShared shared = ProcessShared{false}) :
+			m_value{initial},
+			m_shared{shared}
+	{}
+
+	/// Increments the counter by `count`, waking up waiters as necessary.
+	void post(const uint32_t count = 1);
+
+	/// Decrements the counter, blocking until it is non-zero.
+	void wait() {
+		if (!tryWait()) {
+			waitSlow({});
+		}
+	}
+
+	/// Like wait() but gives up once the absolute time `ts` is reached.
+	/**
+	 * \return Whether the counter has been decremented.
+	 **/
+	bool waitTimed(const MonotonicTime ts) {
+		return tryWait() || waitSlow(ts);
+	}
+
+	/// Decrements the counter if it is non-zero without blocking.
+	/**
+	 * \return Whether the counter has been decremented.
+	 **/
+	bool tryWait() {
+		auto value = m_value.load(std::memory_order_relaxed);
+
+		while (value != 0) {
+			if (m_value.compare_exchange_weak(value, value - 1,
+						std::memory_order_acquire, std::memory_order_relaxed)) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/// Returns the current counter value.
+	uint32_t value() const {
+		return m_value.load(std::memory_order_relaxed);
+	}
+
+	bool isShared() const { return m_shared; }
+
+protected: // functions
+
+	bool waitSlow(const std::optional<MonotonicTime> ts);
+
+protected: // data
+
+	futex::Word m_value;
+	futex::Word m_waiters{0};
+	const ProcessShared m_shared;
+};
+
+} // end ns
@@ -0,0 +1,140 @@
+#pragma once
+
+// C++
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <stdint.h>
+
+// cosmos
+#include <cosmos/memory.hxx>
+#include <cosmos/thread/futex.hxx>
+
+namespace cosmos {
+
+/// A sequence lock protecting a small, trivially copyable value.
+/**
+ * This is a read-mostly synchronization mechanism. In contrast to RWLock,
+ * readers never write to shared memory. They only read a sequence counter
+ * before and after copying the value and retry if a writer was active in
+ * between. Therefore many readers on many CPUs don't cause cache line
+ * bouncing, while writers are never starved by readers.
+ *
+ * This is only suitable for small values, since readers copy the complete
+ * value, possibly multiple times. Larger data structures are better
+ * published via RCUPointer.
+ *
+ * Concurrent writers are serialized among each other via the sequence
+ * counter, they spin while another writer is active. Writes should thus be
+ * short and rare.
+ *
+ * To avoid data races in the sense of the C++ memory model, the value is
+ * stored as an array of relaxed atomic words. Due to this no locking
+ * instructions are involved for accessing the value, but it can only be
+ * read and written as a whole via load() and store().
+ **/
+template <typename T>
+requires std::is_trivially_copyable_v<T>
+class SeqLock {
+	// disallow copy/assignment
+	SeqLock(const SeqLock&) = delete;
+	SeqLock& operator=(const SeqLock&) = delete;
+
+protected: // types
+
+	using Word = uint64_t;
+
+	static constexpr size_t WORDS = (sizeof(T) + sizeof(Word) - 1) / sizeof(Word);
+
+	using Buffer = std::array<Word, WORDS>;
+
+public: // functions
+
+	explicit SeqLock(const T &initial = T{}) {
+		storeWords(initial);
+	}
+
+	/// Returns a consistent copy of the current value.
+	T load() const {
+		Buffer buf;
+
+		while (true) {
+			const auto seq = m_seq.load(std::memory_order_acquire);
+
+			if (seq & 1) {
+				// a writer is active
+				futex::cpu_relax();
+				continue;
+			}
+
+			for (size_t i = 0; i < WORDS; i++) {
+				buf[i] = m_data[i].load(std::memory_order_relaxed);
+			}
+
+			// keep the data loads from moving past the sequence check
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			if (m_seq.load(std::memory_order_relaxed) == seq) {
+				break;
+			}
+		}
+
+		return fromBuffer(buf);
+	}
+
+	/// Replaces the current value by `value`.
+	void store(const T &value) {
+		auto seq = m_seq.load(std::memory_order_relaxed);
+
+		while (true) {
+			if (seq & 1) {
+				futex::cpu_relax();
+				seq = m_seq.load(std::memory_order_relaxed);
+			} else if (m_seq.compare_exchange_weak(seq, seq + 1,
+						std::memory_order_acquire,
+						std::memory_order_relaxed)) {
+				break;
+			}
+		}
+
+		// keep the data stores from moving before the odd sequence
+		std::atomic_thread_fence(std::memory_order_release);
+
+		storeWords(value);
+
+		m_seq.store(seq + 2, std::memory_order_release);
+	}
+
+	/// Returns the number of completed store() operations.
+	size_t version() const {
+		return m_seq.load(std::memory_order_acquire) / 2;
+	}
+
+protected: // functions
+
+	void storeWords(const T &value) {
+		Buffer buf{};
+		std::memcpy(buf.data(), &value, sizeof(T));
+
+		for (size_t i = 0; i < WORDS; i++) {
+			m_data[i].store(buf[i], std::memory_order_relaxed);
+		}
+	}
+
+	static T fromBuffer(const Buffer &buf) {
+		std::array<std::byte, sizeof(T)> bytes;
+		std::memcpy(bytes.data(), buf.data(), sizeof(T));
+		return std::bit_cast<T>(bytes);
+	}
+
+protected: // data
+
+	/// Even if no writer is active, odd while a writer is active.
+	alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_seq{0};
+	std::array<std::atomic<Word>, WORDS> m_data;
+};
+
+} // end ns
@@ -0,0 +1,153 @@
+#pragma once
+
+// POSIX
+#include <pthread.h>
+
+// C++
+#include <optional>
+
+// cosmos
+#include <cosmos/dso_export.h>
+#include <cosmos/proc/CPUSet.hxx>
+#include <cosmos/proc/Scheduler.hxx>
+
+namespace cosmos {
+
+// fwd. decl.
+class Mapping;
+
+/// Creation attributes for PosixThread.
+/**
+ * By default a thread is created with the default attributes of the C
+ * library. On glibc this means an 8 MiB stack (or the RLIMIT_STACK soft
+ * limit), which is faulted in lazily, and the scheduling settings and CPU
+ * affinity of the creating thread.
+ *
+ * This type allows to tune these properties before a thread starts to run.
+ * Only the properties explicitly set are changed, everything else is left
+ * at the defaults. The same object can be used to create any number of
+ * threads.
+ *
+ * Stack size, guard size, a caller provided stack and the CPU affinity are
+ * applied via `pthread_attr_t` at creation time. Scheduler settings and
+ * stack pre-faulting are applied in the context of the new thread before
+ * it enters its entry function. The creating thread waits for this to
+ * complete, so that any errors are reported from the PosixThread
+ * constructor.
+ **/
+class COSMOS_API ThreadAttributes {
+public: // functions
+
+	/// Sets the size of the stack to allocate for the thread.
+	/**
+	 * The size needs to be at least `PTHREAD_STACK_MIN` bytes, it is
+	 * rounded up to the page size. Smaller stacks reduce memory
+	 * consumption and speed up thread creation if many threads are used.
+	 **/
+	ThreadAttributes& setStackSize(const size_t bytes) {
+		m_stack_size = bytes;
+		return *this;
+	}
+
+	/// Sets the size of the guard area at the end of the stack.
+	/**
+	 * The guard area is an inaccessible memory region that protects
+	 * against stack overflows. The glibc default is one page. A size of
+	 * zero disables the guard area.
+	 *
+	 * This setting is ignored if a caller provided stack is used.
+	 **/
+	ThreadAttributes& setGuardSize(const size_t bytes) {
+		m_guard_size = bytes;
+		return *this;
+	}
+
+	/// Use the given memory region as stack for the thread.
+	/**
+	 * The memory needs to stay valid until the thread has been joined.
+	 * Each thread needs its own stack, an object with a caller provided
+	 * stack can thus only be used to create a single running thread at a
+	 * time. The caller is responsible for guard areas, if desired.
+	 *
+	 * This is useful e.g. to place the stack into a huge page Mapping.
+	 **/
+	ThreadAttributes& setStack(void *addr, const size_t size) {
+		m_stack_addr = addr;
+		m_stack_size = size;
+		return *this;
+	}
+
+	/// Use the complete memory of the given Mapping as thread stack.
+	/**
+	 * \see setStack(void*, const size_t).
+	 **/
+	ThreadAttributes& setStack(Mapping &mapping);
+
+	/// Pre-fault and lock the complete stack of the thread in memory.
+	/**
+	 * This uses mem::lock() on the stack range, which avoids page faults
+	 * during thread execution, at the expense of having the complete
+	 * stack resident in memory. This is typically used for realtime
+	 * threads. Locking memory is subject to RLIMIT_MEMLOCK and
+	 * CAP_IPC_LOCK.
+	 **/
+	ThreadAttributes& setPrefaultStack(const bool prefault) {
+		m_prefault_stack = prefault;
+		return *this;
+	}
+
+	/// Sets the initial CPU affinity of the thread.
+	ThreadAttributes& setAffinity(const CPUSet &cpus) {
+		m_affinity = cpus;
+		return *this;
+	}
+
+	/// Sets the scheduler settings the thread starts with.
+	/**
+	 * \see SchedulerSettings::apply().
+	 **/
+	template <typename SCHED_SETTING>
+	ThreadAttributes& setSchedulerSettings(const SCHED_SETTING &ss) {
+		m_sched_settings = ss;
+		return *this;
+	}
+
+	const std::optional<size_t>& stackSize() const { return m_stack_size; }
+	const std::optional<size_t>& guardSize() const { return m_guard_size; }
+	void* stackAddr() const { return m_stack_addr; }
+	bool prefaultStack() const { return m_prefault_stack; }
+	const std::optional<CPUSet>& affinity() const { return m_affinity; }
+	const std::optional<SchedulerSettingsVariant>& schedulerSettings() const {
+		return m_sched_settings;
+	}
+
+	/// Returns whether some settings need to be applied in the new thread's context.
+	bool needsThreadSetup() const {
+		return m_prefault_stack || m_sched_settings.has_value();
+	}
+
+	/// Fills the given pthread attribute object with the current settings.
+	/**
+	 * `attr` needs to be initialized already. On error an ApiError is
+	 * thrown.
+	 **/
+	void fill(pthread_attr_t &attr) const;
+
+	/// Applies the settings that need to be applied in the new thread's context.
+	/**
+	 * This is to be called by the new thread itself. On error an
+	 * ApiError is thrown.
+	 **/
+	void applyInThread() const;
+
+protected: // data
+
+	std::optional<size_t> m_stack_size;
+	std::optional<size_t> m_guard_size;
+	void *m_stack_addr = nullptr;
+	bool m_prefault_stack = false;
+	std::optional<CPUSet> m_affinity;
+	std::optional<SchedulerSettingsVariant> m_sched_settings;
+};
+
+} // end ns
@@ -0,0 +1,251 @@
+#pragma once
+
+// C++
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+
+// cosmos
+#include <cosmos/dso_export.h>
+#include <cosmos/memory.hxx>
+#include <cosmos/thread/FutexMutex.hxx>
+#include <cosmos/thread/PosixThread.hxx>
+#include <cosmos/thread/futex.hxx>
+
+namespace cosmos {
+
+/// A work-stealing pool of worker threads for executing short tasks.
+/**
+ * The pool runs a fixed number of PosixThread workers. Each worker owns a
+ * Chase-Lev work-stealing deque: tasks submitted from within a worker
+ * (i.e. from a running task) are pushed to the worker's own deque without
+ * any locking. The owner takes tasks from the bottom of its deque (LIFO,
+ * which is cache friendly for recursively split work) while idle workers
+ * steal from the top of other workers' deques (FIFO).
+ *
+ * Tasks submitted from outside of the pool are distributed round-robin to
+ * per-worker inboxes, each protected by its own FutexMutex. There is no
+ * central queue or lock that all threads contend for.
+ *
+ * Idle workers park on a futex after finding no work anywhere. Submitting a
+ * task only causes a wake system call if workers are actually parked.
+ *
+ * Tasks are arbitrary `void ()` callables. Callables that are trivially
+ * copyable and fit into Task::INLINE_SIZE bytes (like lambdas capturing a
+ * few pointers or integers) are stored inline without any heap
+ * allocation. Other callables are moved to the heap.
+ *
+ * Tasks should not throw exceptions. If they do, the exception is reported
+ * on stderr and otherwise ignored. The order of execution of tasks is not
+ * defined.
+ *
+ * Upon destruction the pool finishes all pending tasks before the workers
+ * are joined.
+ **/
+class COSMOS_API ThreadPool {
+	// disallow copy/assignment
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+public: // types
+
+	/// Type erased callable stored in fixed size, trivially copyable memory.
+	class Task {
+	public: // data
+
+		/// Maximum size of callables stored inline.
+		static constexpr size_t INLINE_SIZE = 7 * sizeof(uint64_t);
+
+	public: // functions
+
+		Task() = default;
+
+		template <typename FUNC>
+		requires (!std::is_same_v<std::decay_t<FUNC>, Task>)
+		explicit Task(FUNC &&func) {
+			using F = std::decay_t<FUNC>;
+
+			if constexpr (std::is_trivially_copyable_v<F> &&
+					sizeof(F) <= INLINE_SIZE &&
+					alignof(F) <= alignof(uint64_t)) {
+				new (m_storage) F{std::forward<FUNC>(func)};
+				m_invoke = [](Task &task) {
+					(*std::launder(reinterpret_cast<F*>(task.m_storage)))();
+				};
+			} else {
+				auto heap = new F{std::forward<FUNC>(func)};
+				std::memcpy(m_storage, &heap, sizeof(heap));
+				m_invoke = [](Task &task) {
+					F *fn;
+					std::memcpy(&fn, task.m_storage, sizeof(fn));
+					std::unique_ptr<F> owner{fn};
+					(*fn)();
+				};
+			}
+		}
+
+		/// Runs the task, this must only happen once.
+		void operator()() {
+			m_invoke(*this);
+		}
+
+		bool valid() const { return m_invoke != nullptr; }
+
+	protected: // data
+
+		void (*m_invoke)(Task&) = nullptr;
+		alignas(uint64_t) unsigned char m_storage[INLINE_SIZE];
+	};
+
+	static_assert(std::is_trivially_copyable_v<Task>);
+	static_assert(sizeof(Task) == 8 * sizeof(uint64_t));
+
+	/// Settings for ThreadPool construction.
+	struct Settings {
+		/// The number of worker threads, zero means one per usable CPU.
+		size_t workers = 0;
+		/// The prefix for worker thread names, the worker index is appended.
+		std::string name = "pool";
+		/// Pin each worker to a single CPU of the process's affinity mask.
+		bool pin_cpus = false;
+	};
+
+public: // functions
+
+	/// Starts the pool's worker threads.
+	explicit ThreadPool(const Settings &settings);
+
+	/// Starts a pool with default Settings.
+	ThreadPool() : ThreadPool{Settings{}} {}
+
+	/// Finishes all pending tasks and joins the workers.
+	~ThreadPool();
+
+	/// Submits `func` for execution on one of the workers.
+	template <typename FUNC>
+	void submit(FUNC &&func) {
+		submitTask(Task{std::forward<FUNC>(func)});
+	}
+
+	/// Submits a prepared Task for execution.
+	void submitTask(const Task &task);
+
+	/// Blocks until all tasks submitted so far have been completed.
+	/**
+	 * This must not be called from within a task, since it would wait
+	 * for itself.
+	 **/
+	void waitIdle();
+
+	size_t numWorkers() const { return m_workers.size(); }
+
+	/// Returns the index of the calling worker thread, if it belongs to this pool.
+	std::optional<size_t> currentWorker() const;
+
+protected: // types
+
+	struct Worker;
+
+	/// Chase-Lev work-stealing deque of Tasks.
+	/**
+	 * Only the owning worker calls push() and take(), any thread may call
+	 * steal(). Tasks are stored in slots of atomic words to avoid data
+	 * races between a stealer reading a slot and the owner overwriting
+	 * it after a wrap around.
+	 **/
+	class WorkDeque {
+	public: // functions
+
+		WorkDeque();
+		~WorkDeque();
+
+		void push(const Task &task);
+
+		bool take(Task &task);
+
+		bool steal(Task &task);
+
+		bool seemsEmpty() const {
+			return m_bottom.load(std::memory_order_relaxed) <=
+				m_top.load(std::memory_order_relaxed);
+		}
+
+	protected: // types
+
+		struct Slot {
+			std::atomic<uint64_t> words[sizeof(Task) / sizeof(uint64_t)];
+
+			void store(const Task &task);
+			Task load() const;
+		};
+
+		struct Buffer {
+			explicit Buffer(const size_t capacity) :
+					mask{capacity - 1},
+					slots{new Slot[capacity]}
+			{}
+
+			Slot& at(const int64_t index) const {
+				return slots[static_cast<size_t>(index) & mask];
+			}
+
+			const size_t mask;
+			std::unique_ptr<Slot[]> slots;
+		};
+
+	protected: // functions
+
+		Buffer* grow(Buffer *old, const int64_t bottom, const int64_t top);
+
+	protected: // data
+
+		alignas(CACHE_LINE_SIZE) std::atomic<int64_t> m_top{0};
+		alignas(CACHE_LINE_SIZE) std::atomic<int64_t> m_bottom{0};
+		std::atomic<Buffer*> m_buffer;
+		/// Old buffers, kept alive since stealers might still access them.
+		std::vector<std::unique_ptr<Buffer>> m_buffers;
+	};
+
+protected: // functions
+
+	/// Returns the Worker of the calling thread, if it is a pool worker at all.
+	static Worker*& callingWorker();
+
+	void run(Worker &worker);
+
+	bool findTask(Worker &worker, Task &task);
+
+	bool stealTask(Worker &worker, Task &task);
+
+	void runTask(Worker &worker, Task &task);
+
+	void park(Worker &worker);
+
+	void wakeWorker();
+
+	/// Lets the workers finish all pending tasks and joins them.
+	void stopWorkers();
+
+	size_t pendingTasks() const;
+
+protected: // data
+
+	std::vector<std::unique_ptr<Worker>> m_workers;
+	std::vector<PosixThread> m_threads;
+	/// Event counter workers park on.
+	alignas(CACHE_LINE_SIZE) futex::Word m_wake_epoch{0};
+	std::atomic<uint32_t> m_parked{0};
+	std::atomic<bool> m_stop{false};
+	/// Event counter waitIdle() waits on.
+	alignas(CACHE_LINE_SIZE) futex::Word m_idle_epoch{0};
+	std::atomic<uint32_t> m_idle_waiters{0};
+};
+
+} // end ns
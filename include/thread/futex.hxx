@@ -0,0 +1,129 @@
+#pragma once
+
+// C++
+#include <atomic>
+#include <climits>
+#include <optional>
+#include <vector>
+#include <stdint.h>
+
+// cosmos
+#include <cosmos/dso_export.h>
+#include <cosmos/time/types.hxx>
+#include <cosmos/utils.hxx>
+
+/**
+ * @file
+ *
+ * Low level wrappers around the Linux futex system calls (see `man 2 futex`).
+ *
+ * A futex is a 32-bit integer in user space memory that threads can wait on
+ * in the kernel until another thread wakes them up. Typically the integer
+ * represents the state of a higher level synchronization primitive like
+ * FutexMutex, FutexCondition or Semaphore, which are implemented on top of
+ * these functions.
+ **/
+
+namespace cosmos {
+
+/// Strong boolean type to select process shared futex operation.
+/**
+ * Futexes that are placed in memory shared between processes (e.g. a
+ * MemFile mapped with MapType::SHARED) need to be operated in process shared
+ * mode. Process private futexes are cheaper for the kernel to handle.
+ **/
+using ProcessShared = NamedBool<struct process_shared_t, false>;
+
+namespace futex {
+
+/// The futex word type.
+using Word = std::atomic<uint32_t>;
+
+static_assert(Word::is_always_lock_free, "futex words need to be lock-free for use in shared memory");
+static_assert(sizeof(Word) == sizeof(uint32_t));
+
+/// Wait on `word` as long as it contains `expected`.
+/**
+ * If `word` does not contain `expected` at the time of the call then this
+ * returns immediately. Otherwise the caller sleeps until another thread
+ * calls wake() on `word`, a signal is received, or the absolute `timeout`
+ * expires.
+ *
+ * Spurious wakeups are possible, the caller needs to re-check its
+ * condition after return.
+ *
+ * \return `false` if the timeout expired, `true` otherwise.
+ **/
+COSMOS_API bool wait(const Word &word, const uint32_t expected,
+		const ProcessShared shared = ProcessShared{false},
+		const std::optional<MonotonicTime> timeout = {});
+
+/// Wakes up to `count` threads waiting on `word`.
+/**
+ * \return The number of threads that have been woken up.
+ **/
+COSMOS_API size_t wake(const Word &word, const int count = 1,
+		const ProcessShared shared = ProcessShared{false});
+
+/// Wakes all threads waiting on `word`.
+inline size_t wake_all(const Word &word, const ProcessShared shared = ProcessShared{false}) {
+	return wake(word, INT_MAX, shared);
+}
+
+/// Wakes up to `count` waiters on `word` and moves the rest to `target`.
+/**
+ * Up to `max_requeue` of the remaining waiters on `word` are moved over to
+ * wait on `target` instead. This avoids a "thundering herd" when many
+ * threads are woken up but only one of them can make progress, like in
+ * FutexCondition::broadcast().
+ *
+ * If `word` no longer contains `expected` then nothing happens and `false` is
+ * returned. The caller should re-evaluate its state in this case.
+ **/
+COSMOS_API bool requeue(const Word &word, const uint32_t expected, const int count,
+		const Word &target, const int max_requeue = INT_MAX,
+		const ProcessShared shared = ProcessShared{false});
+
+/// An entry for wait_multiple().
+struct WaitEntry {
+	const Word *word = nullptr;
+	uint32_t expected = 0;
+	ProcessShared shared = ProcessShared{false};
+};
+
+/// Wait on multiple futexes at once.
+/**
+ * This wraps the `futex_waitv()` system call (since Linux 5.16). The caller
+ * sleeps until one of the futex words in `entries` is woken up. At most 128
+ * entries are supported.
+ *
+ * \return The index of the entry that has been woken up. If one of the words
+ * did not contain its expected value, a signal was received or the timeout
+ * expired then nothing is returned and the caller needs to re-check its
+ * state.
+ **/
+COSMOS_API std::optional<size_t> wait_multiple(const std::vector<WaitEntry> &entries,
+		const std::optional<MonotonicTime> timeout = {});
+
+/// Returns the number of iterations to spin before going to sleep on a futex.
+/**
+ * Spinning only makes sense if the thread we're waiting for can run in
+ * parallel, thus this returns zero on single CPU systems.
+ **/
+COSMOS_API size_t spin_limit();
+
+/// Hint to the CPU that the caller is spinning in a busy loop.
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+	asm volatile("yield" ::: "memory");
+#elif defined(__powerpc__)
+	asm volatile("or 27,27,27" ::: "memory");
+#else
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+} // end ns
+} // end ns
@@ -0,0 +1,117 @@
+#pragma once
+
+// Linux
+#include <linux/membarrier.h>
+
+// C++
+#include <atomic>
+
+// cosmos
+#include <cosmos/BitMask.hxx>
+#include <cosmos/dso_export.h>
+
+/**
+ * @file
+ *
+ * Wrappers around the Linux membarrier system call (see `man 2 membarrier`)
+ * and asymmetric memory fences built on top of it.
+ *
+ * Some synchronization schemes (like hazard pointers or epoch based
+ * reclamation) require a full memory fence on the reader side, to order a
+ * store announcing the reader against subsequent loads of shared data. On
+ * the hot path of readers this fence is expensive. The membarrier system
+ * call allows to move the cost to the (rare) writer side: the writer issues
+ * a membarrier which causes a full memory barrier on all CPUs currently
+ * running threads of the process. Readers then only need a compiler barrier
+ * to prevent reordering by the compiler.
+ **/
+
+namespace cosmos::membarrier {
+
+/// Commands supported by the membarrier system call.
+enum class Command : int {
+	GLOBAL                               = MEMBARRIER_CMD_GLOBAL,
+	GLOBAL_EXPEDITED                     = MEMBARRIER_CMD_GLOBAL_EXPEDITED,
+	REGISTER_GLOBAL_EXPEDITED            = MEMBARRIER_CMD_REGISTER_GLOBAL_EXPEDITED,
+	PRIVATE_EXPEDITED                    = MEMBARRIER_CMD_PRIVATE_EXPEDITED,
+	REGISTER_PRIVATE_EXPEDITED           = MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED,
+	PRIVATE_EXPEDITED_SYNC_CORE          = MEMBARRIER_CMD_PRIVATE_EXPEDITED_SYNC_CORE,
+	REGISTER_PRIVATE_EXPEDITED_SYNC_CORE = MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED_SYNC_CORE,
+};
+
+/// A set of Command values as returned from query().
+using Commands = BitMask<Command>;
+
+/// Returns the set of commands supported by the kernel.
+/**
+ * Throws an ApiError if the system call is not available at all.
+ **/
+COSMOS_API Commands query();
+
+/// Executes the given membarrier command.
+/**
+ * Throws an ApiError on error, e.g. if `cmd` is an expedited command and
+ * the process did not register for it before.
+ **/
+COSMOS_API void run(const Command cmd);
+
+namespace detail {
+
+/// State of the process wide PRIVATE_EXPEDITED registration.
+enum class State : int {
+	UNKNOWN,
+	EXPEDITED,
+	FALLBACK
+};
+
+extern COSMOS_API std::atomic<State> state;
+
+} // end ns
+
+/// Registers the process for Command::PRIVATE_EXPEDITED.
+/**
+ * This is performed only once per process, further calls return the
+ * cached result. The registration is also done implicitly by the first
+ * heavy_fence(). Calling this early avoids the initial light_fence() calls
+ * falling back to full memory fences.
+ *
+ * \return Whether expedited private membarriers are available. If not then
+ *         light_fence() and heavy_fence() fall back to full memory fences.
+ **/
+COSMOS_API bool register_private_expedited();
+
+/// Returns whether register_private_expedited() succeeded before.
+inline bool has_private_expedited() {
+	return detail::state.load(std::memory_order_relaxed) == detail::State::EXPEDITED;
+}
+
+/// The cheap reader side of an asymmetric memory fence.
+/**
+ * Together with heavy_fence() this behaves like a pair of
+ * `std::atomic_thread_fence(std::memory_order_seq_cst)`: either the memory
+ * accesses preceding light_fence() are visible to the code following
+ * heavy_fence(), or the memory accesses preceding heavy_fence() are visible
+ * to the code following light_fence().
+ *
+ * If the process is registered for expedited membarriers then this is
+ * only a compiler barrier, otherwise a full memory fence.
+ **/
+inline void light_fence() {
+	if (has_private_expedited()) {
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+	} else {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+	}
+}
+
+/// The expensive writer side of an asymmetric memory fence.
+/**
+ * This issues a Command::PRIVATE_EXPEDITED membarrier, which interrupts
+ * all CPUs currently running threads of the calling process. This costs
+ * in the order of microseconds and should only be used on slow paths.
+ *
+ * \see light_fence().
+ **/
+COSMOS_API void heavy_fence();
+
+} // end ns
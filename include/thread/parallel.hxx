@@ -0,0 +1,138 @@
+#pragma once
+
+// C++
+#include <functional>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// cosmos
+#include <cosmos/dso_export.h>
+#include <cosmos/memory.hxx>
+#include <cosmos/thread/ThreadAttributes.hxx>
+
+/**
+ * @file
+ *
+ * Helpers for data parallel processing of index ranges.
+ *
+ * parallel_for() and parallel_reduce() split an index range over a number
+ * of PosixThreads. The calling thread participates in the processing, thus
+ * `threads - 1` additional threads are created for the duration of the
+ * call. This is intended for coarse grained phases of processing, where the
+ * thread creation overhead is negligible compared to the work done.
+ **/
+
+namespace cosmos::parallel {
+
+/// How the index range is distributed over the participating threads.
+enum class Schedule {
+	/// Each thread processes one contiguous range of equal size.
+	/**
+	 * This has the least overhead and is best if all elements need the
+	 * same processing time.
+	 **/
+	STATIC,
+	/// Threads start with equal ranges but steal work from others when done.
+	/**
+	 * Each thread processes its range in chunks of `grain` elements. A
+	 * thread that finished its range takes over the upper half of the
+	 * remaining range of another thread. This balances the load if
+	 * processing times differ between elements or if some threads are
+	 * slowed down by other load on the system.
+	 **/
+	WORK_STEALING
+};
+
+/// Settings for parallel_for() and parallel_reduce().
+struct Settings {
+	/// The number of threads to use including the caller, zero for one per usable CPU.
+	size_t threads = 0;
+	Schedule schedule = Schedule::STATIC;
+	/// The chunk size for Schedule::WORK_STEALING, zero for automatic selection.
+	size_t grain = 0;
+	/// Optional attributes for the additional threads.
+	std::optional<ThreadAttributes> attrs;
+};
+
+/// Function processing the subrange [first, last) on behalf of the given worker number.
+using ChunkFunc = std::function<void (size_t worker, size_t first, size_t last)>;
+
+/// Returns the number of threads that are used for the given Settings.
+/**
+ * For `settings.threads == 0` this is the number of CPUs the caller is
+ * allowed to run on.
+ **/
+COSMOS_API size_t num_threads(const Settings &settings = {});
+
+/// Runs `func` on chunks of the range [begin, end) in parallel.
+/**
+ * This is the type erased base of parallel_for() and parallel_reduce(). It
+ * returns once all chunks have been processed. If `func` throws an
+ * exception then the remaining work is skipped as far as possible and the
+ * first exception caught is rethrown in the caller's context.
+ *
+ * `func` receives worker numbers smaller than num_threads(settings). If a
+ * worker thread cannot be created then the already running workers are
+ * joined and an exception is thrown.
+ **/
+COSMOS_API void run_chunks(const size_t begin, const size_t end,
+		const ChunkFunc &func, const Settings &settings = {});
+
+/// Calls `func(index)` for each index in [begin, end) in parallel.
+template <typename FUNC>
+requires std::invocable<FUNC&, size_t>
+void parallel_for(const size_t begin, const size_t end, FUNC &&func,
+		const Settings &settings = {}) {
+	run_chunks(begin, end, [&func](size_t, size_t first, size_t last) {
+		for (size_t index = first; index < last; index++) {
+			func(index);
+		}
+	}, settings);
+}
+
+/// Reduces the results of `map(index)` for each index in [begin, end) in parallel.
+/**
+ * Each thread accumulates its results starting with `identity` via
+ * `reduce(acc, map(index))`. The per-thread results are finally combined
+ * via `reduce` in the calling thread. The order in which elements are
+ * combined is unspecified, `reduce` thus needs to be associative and
+ * commutative.
+ **/
+template <typename T, typename MAP, typename REDUCE>
+requires std::invocable<MAP&, size_t> &&
+	std::is_convertible_v<std::invoke_result_t<REDUCE&, T, std::invoke_result_t<MAP&, size_t>>, T>
+T parallel_reduce(const size_t begin, const size_t end, const T identity,
+		MAP &&map, REDUCE &&reduce, const Settings &settings = {}) {
+
+	/// Per worker result on a separate cache line.
+	struct alignas(CACHE_LINE_SIZE) Partial {
+		T value;
+	};
+
+	// determine the thread count only once, it can change between calls
+	// to num_threads() if the CPU affinity changes.
+	Settings fixed = settings;
+	fixed.threads = num_threads(settings);
+
+	std::vector<Partial> partials(fixed.threads, Partial{identity});
+
+	run_chunks(begin, end, [&](size_t worker, size_t first, size_t last) {
+		auto &acc = partials[worker].value;
+		for (size_t index = first; index < last; index++) {
+			acc = reduce(std::move(acc), map(index));
+		}
+	}, fixed);
+
+	T ret = identity;
+
+	for (auto &partial: partials) {
+		ret = reduce(std::move(ret), std::move(partial.value));
+	}
+
+	return ret;
+}
+
+} // end ns
@@ -8,6 +8,7 @@
 
 // cosmos
 #include <cosmos/dso_export.h>
+#include <cosmos/proc/CPUSet.hxx>
 #include <cosmos/proc/types.hxx>
 
 /**
@@ -69,6 +70,17 @@ ID COSMOS_API get_id();
  **/
 void kill(const ID thread, const Signal sig);
 
+/// Restricts the given POSIX thread to run only on the CPUs in `cpus`.
+/**
+ * This is the thread specific variant of cosmos::proc::set_affinity(),
+ * wrapping `pthread_setaffinity_np()`. Threads created by `thread`
+ * afterwards inherit the setting.
+ **/
+COSMOS_API void set_affinity(const ID thread, const CPUSet &cpus);
+
+/// Returns the set of CPUs the given POSIX thread is allowed to run on.
+COSMOS_API CPUSet get_affinity(const ID thread);
+
 /// Ends execution of the calling thread.
 /**
  * The calling thread will not return. The provided `val` will be available
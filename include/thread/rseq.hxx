@@ -0,0 +1,95 @@
+#pragma once
+
+// Linux
+#include <sys/rseq.h>
+
+// C++
+#include <atomic>
+#include <stdint.h>
+
+// cosmos
+#include <cosmos/dso_export.h>
+#include <cosmos/proc/process.hxx>
+
+/**
+ * @file
+ *
+ * Access to restartable sequences (rseq, see `man 2 rseq`).
+ *
+ * With rseq the kernel maintains a small per-thread data structure in user
+ * space that contains the CPU the thread is currently running on. Reading
+ * it costs a single memory access instead of a system call. Additionally
+ * short critical sections can be registered, which are restarted by the
+ * kernel if the thread is preempted, migrated or interrupted by a signal.
+ * This allows to operate on per-CPU data without atomic instructions.
+ *
+ * Glibc (since version 2.35) registers an rseq area for every thread
+ * automatically, unless disabled via the `glibc.pthread.rseq=0` tunable.
+ * libcosmos only uses this area, it does not register one on its own.
+ **/
+
+namespace cosmos::rseq {
+
+/// Returns whether the rseq area is registered for all threads.
+inline bool is_available() {
+	return __rseq_size != 0;
+}
+
+/// Returns the rseq area of the calling thread, or nullptr if unavailable.
+inline const volatile struct ::rseq* area() {
+	if (!is_available())
+		return nullptr;
+
+	auto tp = static_cast<const char*>(__builtin_thread_pointer());
+	return reinterpret_cast<const volatile struct ::rseq*>(tp + __rseq_offset);
+}
+
+/// Returns the number of the CPU the calling thread is currently running on.
+/**
+ * This is read from the rseq area if available, otherwise
+ * proc::get_current_cpu() is used as a fallback. The result can be outdated
+ * already when this function returns.
+ **/
+inline unsigned current_cpu() {
+	if (auto rs = area(); rs) {
+		if (const auto cpu = static_cast<int32_t>(rs->cpu_id); cpu >= 0) {
+			return static_cast<unsigned>(cpu);
+		}
+	}
+
+	return proc::get_current_cpu();
+}
+
+/// Returns whether per-CPU operations via rseq critical sections are supported.
+/**
+ * This requires an rseq area and an implementation of the critical
+ * sections for the current architecture, currently only x86_64.
+ **/
+COSMOS_API bool has_percpu_ops();
+
+/// Returns the number of slots needed to index per-CPU data by CPU number.
+/**
+ * This is the highest possible CPU number in the system plus one, as
+ * found in `/sys/devices/system/cpu/possible`. CPU numbers can be sparse,
+ * thus this can be larger than the number of CPUs. If the file can't be
+ * read then `get_nprocs_conf()` is used as a fallback.
+ **/
+COSMOS_API size_t possible_cpu_slots();
+
+/// Adds `value` to the `slots` entry of the current CPU.
+/**
+ * `slots` points to the first of `num_slots` integers, each located
+ * `stride` bytes apart. `num_slots` needs to be at least
+ * possible_cpu_slots(), otherwise a UsageError can be thrown.
+ *
+ * If has_percpu_ops() returns `true` then the addition is performed without
+ * atomic instructions via an rseq critical section that is retried if the
+ * caller is migrated or preempted meanwhile. Otherwise an atomic addition
+ * on the slot of the current CPU is performed. Since rseq availability is
+ * the same for all threads of a process, both variants are never mixed on
+ * the same slots.
+ **/
+COSMOS_API void percpu_add(std::atomic<int64_t> *slots, const size_t stride,
+		const size_t num_slots, const int64_t value);
+
+} // end ns
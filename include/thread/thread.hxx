@@ -35,6 +35,13 @@ namespace thread {
 /// Returns the Linux low-level thread ID of the caller.
 ThreadID COSMOS_API get_tid();
 
+/// Returns the number of the CPU the calling thread is currently running on.
+/**
+ * In contrast to proc::get_current_cpu() this does not require a system
+ * call if restartable sequences are available. \see rseq::current_cpu().
+ **/
+unsigned COSMOS_API get_cpu();
+
 /// Returns whether the calling thread is this process's main thread.
 /**
  * In Linux terms this is also called the thread group leader.
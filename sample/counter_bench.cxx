@@ -0,0 +1,94 @@
+// C++
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Cosmos
+#include <cosmos/main.hxx>
+#include <cosmos/thread/PerCPUCounter.hxx>
+#include <cosmos/thread/PosixThread.hxx>
+#include <cosmos/time/Clock.hxx>
+
+/// Compares a global atomic counter with PerCPUCounter.
+/**
+ * 1 to MAX-THREADS threads increment a shared counter in a tight loop, the
+ * aggregate increment rate is reported.
+ **/
+class CounterBench :
+		public cosmos::MainContainerArgs {
+protected:
+
+	/// Runs `threads` threads calling `inc` `increments` times each, returns the elapsed nanoseconds.
+	static size_t run(const size_t threads, const size_t increments, std::function<void ()> inc) {
+		std::vector<cosmos::PosixThread> workers;
+		const cosmos::MonotonicClock clock;
+		const auto start = clock.now();
+
+		for (size_t nr = 0; nr < threads; nr++) {
+			workers.emplace_back([&inc, increments]() {
+				for (size_t i = 0; i < increments; i++) {
+					inc();
+				}
+			});
+		}
+
+		for (auto &worker: workers) {
+			worker.join();
+		}
+
+		const auto elapsed = clock.now() - start;
+		return static_cast<size_t>(elapsed.tv_sec) * 1000 * 1000 * 1000 +
+			static_cast<size_t>(elapsed.tv_nsec);
+	}
+
+	static void report(const std::string_view label, const size_t threads,
+			const size_t increments, const size_t ns) {
+		const auto total = threads * increments;
+		std::cout << std::setw(20) << std::left << label << std::right
+			<< std::setw(4) << threads << " threads "
+			<< std::setw(10) << (total * 1000 / std::max(ns, size_t{1})) << " Mincrements/s\n";
+	}
+
+	cosmos::ExitStatus main(const std::string_view argv0, const cosmos::StringViewVector &args) override {
+		size_t increments = 5000000;
+		size_t max_threads = 64;
+
+		if (args.size() > 2) {
+			std::cerr << "usage: " << argv0 << " [INCREMENTS-PER-THREAD] [MAX-THREADS]\n";
+			return cosmos::ExitStatus::FAILURE;
+		}
+
+		if (args.size() > 0)
+			increments = std::stoul(std::string{args[0]});
+		if (args.size() > 1)
+			max_threads = std::stoul(std::string{args[1]});
+
+		std::cout << "per-CPU counter uses rseq: " << std::boolalpha
+			<< cosmos::PerCPUCounter{}.usesRSeq() << "\n\n";
+
+		for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+			std::atomic<int64_t> global{0};
+			cosmos::PerCPUCounter percpu;
+
+			report("std::atomic", threads, increments, run(threads, increments,
+				[&global]() { global.fetch_add(1, std::memory_order_relaxed); }));
+			report("PerCPUCounter", threads, increments, run(threads, increments,
+				[&percpu]() { percpu.increment(); }));
+
+			if (percpu.value() != static_cast<int64_t>(threads * increments)) {
+				std::cerr << "PerCPUCounter lost increments!\n";
+				return cosmos::ExitStatus::FAILURE;
+			}
+		}
+
+		return cosmos::ExitStatus::SUCCESS;
+	}
+};
+
+int main(const int argc, const char **argv) {
+	return cosmos::main<CounterBench>(argc, argv);
+}
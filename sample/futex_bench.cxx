@@ -0,0 +1,151 @@
+// C++
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Cosmos
+#include <cosmos/main.hxx>
+#include <cosmos/memory.hxx>
+#include <cosmos/thread/Condition.hxx>
+#include <cosmos/thread/FutexCondition.hxx>
+#include <cosmos/thread/FutexMutex.hxx>
+#include <cosmos/thread/Mutex.hxx>
+#include <cosmos/thread/PosixThread.hxx>
+#include <cosmos/thread/Semaphore.hxx>
+#include <cosmos/time/Clock.hxx>
+
+/// Compares the futex based synchronization primitives with the pthread wrappers.
+/**
+ * Two workloads are run for 2 to MAX-THREADS threads (doubling each time):
+ *
+ * - lock: all threads increment a shared counter in a tiny critical section,
+ *   comparing Mutex with FutexMutex.
+ * - handoff: half of the threads produce tokens, the other half consume
+ *   them, comparing a ConditionMutex protected counter with a FutexCondition
+ *   protected counter and a Semaphore.
+ *
+ * The average time per operation is reported in nanoseconds.
+ **/
+class FutexBench :
+		public cosmos::MainContainerArgs {
+protected:
+
+	/// Runs `func` in `threads` threads and returns the elapsed nanoseconds.
+	static size_t runThreads(const size_t threads, std::function<void (size_t)> func) {
+		std::vector<cosmos::PosixThread> workers;
+		const cosmos::MonotonicClock clock;
+		const auto start = clock.now();
+
+		for (size_t nr = 0; nr < threads; nr++) {
+			workers.emplace_back([func, nr]() { func(nr); });
+		}
+
+		for (auto &worker: workers) {
+			worker.join();
+		}
+
+		const auto elapsed = clock.now() - start;
+		return static_cast<size_t>(elapsed.tv_sec) * 1000 * 1000 * 1000 +
+			static_cast<size_t>(elapsed.tv_nsec);
+	}
+
+	template <typename LOCK, typename GUARD>
+	static size_t lockBench(const size_t threads, const size_t rounds) {
+		struct alignas(cosmos::CACHE_LINE_SIZE) {
+			LOCK lock;
+			size_t counter = 0;
+		} data;
+
+		return runThreads(threads, [&data, rounds](size_t) {
+			for (size_t round = 0; round < rounds; round++) {
+				GUARD guard{data.lock};
+				data.counter++;
+			}
+		});
+	}
+
+	/// Handoff via a counter protected by a mutex and a condition.
+	template <typename COND>
+	static size_t conditionBench(const size_t threads, const size_t rounds) {
+		COND cond;
+		size_t tokens = 0;
+
+		return runThreads(threads, [&](size_t nr) {
+			const bool producer = nr % 2 == 0;
+
+			for (size_t round = 0; round < rounds; round++) {
+				cond.lock();
+				if (producer) {
+					tokens++;
+					cond.signal();
+				} else {
+					while (tokens == 0) {
+						cond.wait();
+					}
+					tokens--;
+				}
+				cond.unlock();
+			}
+		});
+	}
+
+	static size_t semaphoreBench(const size_t threads, const size_t rounds) {
+		cosmos::Semaphore sem;
+
+		return runThreads(threads, [&](size_t nr) {
+			const bool producer = nr % 2 == 0;
+
+			for (size_t round = 0; round < rounds; round++) {
+				if (producer) {
+					sem.post();
+				} else {
+					sem.wait();
+				}
+			}
+		});
+	}
+
+	static void report(const std::string_view label, const size_t threads,
+			const size_t rounds, const size_t ns) {
+		std::cout << std::setw(16) << std::left << label << std::right
+			<< std::setw(4) << threads << " threads: "
+			<< std::setw(8) << (ns / (threads * rounds)) << " ns/op\n";
+	}
+
+	cosmos::ExitStatus main(const std::string_view argv0, const cosmos::StringViewVector &args) override {
+		size_t max_threads = 64;
+		size_t rounds = 100000;
+
+		if (args.size() > 2) {
+			std::cerr << "usage: " << argv0 << " [MAX-THREADS] [ROUNDS]\n";
+			return cosmos::ExitStatus::FAILURE;
+		}
+
+		if (args.size() > 0)
+			max_threads = std::stoul(std::string{args[0]});
+		if (args.size() > 1)
+			rounds = std::stoul(std::string{args[1]});
+
+		for (size_t threads = 2; threads <= max_threads; threads *= 2) {
+			report("Mutex", threads, rounds,
+					lockBench<cosmos::Mutex, cosmos::MutexGuard>(threads, rounds));
+			report("FutexMutex", threads, rounds,
+					lockBench<cosmos::FutexMutex, cosmos::FutexMutexGuard>(threads, rounds));
+			report("Condition", threads, rounds,
+					conditionBench<cosmos::ConditionMutex>(threads, rounds));
+			report("FutexCondition", threads, rounds,
+					conditionBench<cosmos::FutexConditionMutex>(threads, rounds));
+			report("Semaphore", threads, rounds,
+					semaphoreBench(threads, rounds));
+			std::cout << "\n";
+		}
+
+		return cosmos::ExitStatus::SUCCESS;
+	}
+};
+
+int main(const int argc, const char **argv) {
+	return cosmos::main<FutexBench>(argc, argv);
+}
@@ -0,0 +1,171 @@
+// C++
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Cosmos
+#include <cosmos/main.hxx>
+#include <cosmos/thread/PosixThread.hxx>
+#include <cosmos/thread/RCU.hxx>
+#include <cosmos/thread/RWLock.hxx>
+#include <cosmos/thread/SeqLock.hxx>
+#include <cosmos/time/Clock.hxx>
+#include <cosmos/time/time.hxx>
+
+/// Compares read-mostly data access via RWLock, SeqLock and RCUPointer.
+/**
+ * A growing number of reader threads looks up a small configuration record
+ * in a tight loop, while a single writer replaces it once per millisecond.
+ * The aggregate lookup throughput of all readers is reported.
+ *
+ * With RWLock each lookup writes to the lock word, so its cache line
+ * bounces between all CPUs. SeqLock and RCU readers only read shared
+ * memory and should scale with the number of readers.
+ **/
+class ReadMostlyBench :
+		public cosmos::MainContainerArgs {
+protected:
+
+	struct Config {
+		size_t generation = 0;
+		size_t limit = 0;
+		size_t timeout = 0;
+	};
+
+	/// Runs `readers` threads performing `lookups` each, returns the elapsed nanoseconds.
+	static size_t run(const size_t readers, const size_t lookups,
+			std::function<size_t (size_t)> read, std::function<void (size_t)> write) {
+		std::vector<cosmos::PosixThread> threads;
+		std::atomic<bool> done{false};
+		std::atomic<size_t> finished{0};
+		const cosmos::MonotonicClock clock;
+		const auto start = clock.now();
+
+		for (size_t nr = 0; nr < readers; nr++) {
+			threads.emplace_back([&read, &finished, lookups]() {
+				// prevent the lookups from being optimized away
+				volatile size_t sink = read(lookups);
+				(void)sink;
+				finished++;
+			});
+		}
+
+		cosmos::PosixThread writer{[&]() {
+			for (size_t gen = 1; !done; gen++) {
+				write(gen);
+				cosmos::time::sleep(std::chrono::milliseconds{1});
+			}
+		}};
+
+		for (auto &thread: threads) {
+			thread.join();
+		}
+
+		const auto elapsed = clock.now() - start;
+		done = true;
+		writer.join();
+
+		return static_cast<size_t>(elapsed.tv_sec) * 1000 * 1000 * 1000 +
+			static_cast<size_t>(elapsed.tv_nsec);
+	}
+
+	static size_t benchRWLock(const size_t readers, const size_t lookups) {
+		cosmos::RWLock lock;
+		Config config;
+
+		return run(readers, lookups,
+			[&](size_t num) {
+				size_t sum = 0;
+				for (size_t i = 0; i < num; i++) {
+					cosmos::ReadLockGuard g{lock};
+					sum += config.limit + config.timeout;
+				}
+				return sum;
+			},
+			[&](size_t gen) {
+				cosmos::WriteLockGuard g{lock};
+				config = Config{gen, gen, gen};
+			});
+	}
+
+	static size_t benchSeqLock(const size_t readers, const size_t lookups) {
+		cosmos::SeqLock<Config> lock;
+
+		return run(readers, lookups,
+			[&](size_t num) {
+				size_t sum = 0;
+				for (size_t i = 0; i < num; i++) {
+					const auto config = lock.load();
+					sum += config.limit + config.timeout;
+				}
+				return sum;
+			},
+			[&](size_t gen) {
+				lock.store(Config{gen, gen, gen});
+			});
+	}
+
+	static size_t benchRCU(const size_t readers, const size_t lookups) {
+		cosmos::RCUDomain domain;
+		cosmos::RCUPointer<Config> ptr{domain, std::make_unique<Config>()};
+
+		return run(readers, lookups,
+			[&](size_t num) {
+				cosmos::RCUDomain::Reader reader{domain};
+				size_t sum = 0;
+				for (size_t i = 0; i < num; i++) {
+					const auto config = ptr.read();
+					sum += config->limit + config->timeout;
+					// a real application would do this once per event loop iteration
+					if (i % 64 == 0)
+						reader.quiescent();
+				}
+				return sum;
+			},
+			[&](size_t gen) {
+				ptr.update(std::make_unique<Config>(Config{gen, gen, gen}));
+			});
+	}
+
+	static void report(const std::string_view label, const size_t readers,
+			const size_t lookups, const size_t ns) {
+		const auto total = readers * lookups;
+		std::cout << std::setw(10) << std::left << label << std::right
+			<< std::setw(4) << readers << " readers "
+			<< std::setw(10) << (total * 1000 / std::max(ns, size_t{1})) << " Mlookups/s\n";
+	}
+
+	cosmos::ExitStatus main(const std::string_view argv0, const cosmos::StringViewVector &args) override {
+		size_t lookups = 2000000;
+		size_t max_readers = 64;
+
+		if (args.size() > 2) {
+			std::cerr << "usage: " << argv0 << " [LOOKUPS-PER-READER] [MAX-READERS]\n";
+			return cosmos::ExitStatus::FAILURE;
+		}
+
+		if (args.size() > 0)
+			lookups = std::stoul(std::string{args[0]});
+		if (args.size() > 1)
+			max_readers = std::stoul(std::string{args[1]});
+
+		for (size_t readers = 1; readers <= max_readers; readers *= 2) {
+			report("RWLock", readers, lookups, benchRWLock(readers, lookups));
+			report("SeqLock", readers, lookups, benchSeqLock(readers, lookups));
+			report("RCU", readers, lookups, benchRCU(readers, lookups));
+			std::cout << "\n";
+		}
+
+		return cosmos::ExitStatus::SUCCESS;
+	}
+};
+
+int main(const int argc, const char **argv) {
+	return cosmos::main<ReadMostlyBench>(argc, argv);
+}
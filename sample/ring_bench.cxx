@@ -0,0 +1,227 @@
+// C++
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Cosmos
+#include <cosmos/main.hxx>
+#include <cosmos/thread/Condition.hxx>
+#include <cosmos/thread/MPMCRing.hxx>
+#include <cosmos/thread/PosixThread.hxx>
+#include <cosmos/thread/SPSCRing.hxx>
+#include <cosmos/time/Clock.hxx>
+
+/// Compares the lock-free rings with a Mutex and Condition protected queue.
+/**
+ * Two workloads are run:
+ *
+ * - throughput: one producer passes ITEMS integers to one consumer, either
+ *   one at a time or in batches of 32 elements. For MPMCRing and the locked
+ *   queue additionally two producers and two consumers are used.
+ * - latency: two threads pass a single token back and forth via two queues,
+ *   the round trip time is reported.
+ *
+ * The ring based variants spin (with yield) when a queue is full or empty,
+ * the locked queue waits on its condition.
+ **/
+class RingBench :
+		public cosmos::MainContainerArgs {
+protected:
+
+	static constexpr size_t CAPACITY = 1024;
+	static constexpr size_t BATCH = 32;
+
+	/// The traditional approach the rings should be replacing.
+	class LockedQueue {
+	public:
+		explicit LockedQueue(size_t capacity) : m_capacity{capacity} {}
+
+		void push(size_t item) {
+			cosmos::MutexGuard g{m_cond};
+			while (m_queue.size() >= m_capacity)
+				m_cond.wait();
+			m_queue.push_back(item);
+			m_cond.broadcast();
+		}
+
+		size_t pop() {
+			cosmos::MutexGuard g{m_cond};
+			while (m_queue.empty())
+				m_cond.wait();
+			const auto ret = m_queue.front();
+			m_queue.pop_front();
+			m_cond.broadcast();
+			return ret;
+		}
+
+	protected:
+		cosmos::ConditionMutex m_cond;
+		std::deque<size_t> m_queue;
+		const size_t m_capacity;
+	};
+
+	template <typename RING>
+	static void pushAll(RING &ring, const size_t items, const size_t batch) {
+		std::vector<size_t> buf(batch);
+
+		for (size_t sent = 0; sent < items;) {
+			const auto count = std::min(batch, items - sent);
+			for (size_t i = 0; i < count; i++)
+				buf[i] = sent + i;
+			size_t done = 0;
+			while (done < count) {
+				const auto pushed = ring.pushBatch(std::span{buf.data() + done, count - done});
+				if (pushed == 0)
+					std::this_thread::yield();
+				done += pushed;
+			}
+			sent += count;
+		}
+	}
+
+	template <typename RING>
+	static void popAll(RING &ring, const size_t items, const size_t batch) {
+		std::vector<size_t> buf(batch);
+
+		for (size_t received = 0; received < items;) {
+			const auto count = ring.popBatch(std::span{buf.data(), std::min(batch, items - received)});
+			if (count == 0)
+				std::this_thread::yield();
+			received += count;
+		}
+	}
+
+	/// Runs producers and consumers, returns the elapsed nanoseconds.
+	static size_t runPairs(const size_t pairs, const size_t items,
+			std::function<void (size_t)> produce, std::function<void (size_t)> consume) {
+		std::vector<cosmos::PosixThread> threads;
+		const cosmos::MonotonicClock clock;
+		const auto start = clock.now();
+
+		for (size_t nr = 0; nr < pairs; nr++) {
+			threads.emplace_back([produce, items, pairs]() { produce(items / pairs); });
+			threads.emplace_back([consume, items, pairs]() { consume(items / pairs); });
+		}
+
+		for (auto &thread: threads) {
+			thread.join();
+		}
+
+		return toNs(clock.now() - start);
+	}
+
+	static size_t toNs(const cosmos::MonotonicTime elapsed) {
+		return static_cast<size_t>(elapsed.tv_sec) * 1000 * 1000 * 1000 +
+			static_cast<size_t>(elapsed.tv_nsec);
+	}
+
+	template <typename RING>
+	static size_t ringThroughput(const size_t pairs, const size_t items, const size_t batch) {
+		RING ring{CAPACITY};
+		return runPairs(pairs, items,
+			[&ring, batch](size_t num) { pushAll(ring, num, batch); },
+			[&ring, batch](size_t num) { popAll(ring, num, batch); });
+	}
+
+	static size_t lockedThroughput(const size_t pairs, const size_t items) {
+		LockedQueue queue{CAPACITY};
+		return runPairs(pairs, items,
+			[&queue](size_t num) { for (size_t i = 0; i < num; i++) queue.push(i); },
+			[&queue](size_t num) { for (size_t i = 0; i < num; i++) queue.pop(); });
+	}
+
+	template <typename RING>
+	static void send(RING &ring, size_t token) {
+		while (!ring.push(std::move(token)))
+			std::this_thread::yield();
+	}
+
+	static void send(LockedQueue &queue, size_t token) {
+		queue.push(token);
+	}
+
+	template <typename RING>
+	static size_t receive(RING &ring) {
+		size_t token;
+		while (!ring.pop(token))
+			std::this_thread::yield();
+		return token;
+	}
+
+	static size_t receive(LockedQueue &queue) {
+		return queue.pop();
+	}
+
+	/// Passes a token back and forth `rounds` times, returns the elapsed nanoseconds.
+	template <typename QUEUE>
+	static size_t pingPong(const size_t rounds) {
+		QUEUE ping{CAPACITY};
+		QUEUE pong{CAPACITY};
+
+		return runPairs(1, rounds,
+			[&ping, &pong](size_t num) {
+				for (size_t i = 0; i < num; i++) {
+					send(ping, i);
+					receive(pong);
+				}
+			},
+			[&ping, &pong](size_t num) {
+				for (size_t i = 0; i < num; i++) {
+					send(pong, receive(ping));
+				}
+			});
+	}
+
+	static void report(const std::string_view label, const size_t items, const size_t ns) {
+		std::cout << std::setw(28) << std::left << label << std::right
+			<< std::setw(8) << (ns / items) << " ns/item "
+			<< std::setw(10) << (items * 1000 / std::max(ns, size_t{1})) << " Mitems/s\n";
+	}
+
+	static void reportLatency(const std::string_view label, const size_t rounds, const size_t ns) {
+		std::cout << std::setw(28) << std::left << label << std::right
+			<< std::setw(8) << (ns / rounds) << " ns/round trip\n";
+	}
+
+	cosmos::ExitStatus main(const std::string_view argv0, const cosmos::StringViewVector &args) override {
+		size_t items = 10000000;
+
+		if (args.size() > 1) {
+			std::cerr << "usage: " << argv0 << " [ITEMS]\n";
+			return cosmos::ExitStatus::FAILURE;
+		}
+
+		if (args.size() > 0)
+			items = std::stoul(std::string{args[0]});
+
+		using SPSC = cosmos::SPSCRing<size_t>;
+		using MPMC = cosmos::MPMCRing<size_t>;
+
+		std::cout << "throughput\n\n";
+		report("SPSCRing 1:1", items, ringThroughput<SPSC>(1, items, 1));
+		report("SPSCRing 1:1 batched", items, ringThroughput<SPSC>(1, items, BATCH));
+		report("MPMCRing 1:1", items, ringThroughput<MPMC>(1, items, 1));
+		report("MPMCRing 1:1 batched", items, ringThroughput<MPMC>(1, items, BATCH));
+		report("MPMCRing 2:2", items, ringThroughput<MPMC>(2, items, 1));
+		report("MPMCRing 2:2 batched", items, ringThroughput<MPMC>(2, items, BATCH));
+		report("Mutex+Condition 1:1", items, lockedThroughput(1, items));
+		report("Mutex+Condition 2:2", items, lockedThroughput(2, items));
+
+		std::cout << "\nround trip latency\n\n";
+		const auto rounds = items / 10;
+		reportLatency("SPSCRing", rounds, pingPong<SPSC>(rounds));
+		reportLatency("MPMCRing", rounds, pingPong<MPMC>(rounds));
+		reportLatency("Mutex+Condition", rounds, pingPong<LockedQueue>(rounds));
+
+		return cosmos::ExitStatus::SUCCESS;
+	}
+};
+
+int main(const int argc, const char **argv) {
+	return cosmos::main<RingBench>(argc, argv);
+}
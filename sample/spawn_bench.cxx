@@ -0,0 +1,73 @@
+// C++
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Cosmos
+#include <cosmos/main.hxx>
+#include <cosmos/proc/ChildCloner.hxx>
+#include <cosmos/proc/SpawnServer.hxx>
+#include <cosmos/proc/SubProc.hxx>
+#include <cosmos/string.hxx>
+#include <cosmos/time/StopWatch.hxx>
+
+/// Compares the latency of different child process creation strategies.
+/**
+ * A SpawnServer is started first, then the parent process grows its resident
+ * memory to a configurable size. Then child processes running `true` are
+ * created repeatedly in both modes of ChildCloner and via the SpawnServer.
+ * With growing RSS the regular mode becomes slower, since the page tables
+ * need to be copied, while vfork mode and the SpawnServer stay constant.
+ **/
+class SpawnBench :
+		public cosmos::MainContainerArgs {
+protected:
+
+	cosmos::ExitStatus main(const std::string_view argv0, const cosmos::StringViewVector &args) override {
+		size_t rss_mb = 1024;
+		size_t rounds = 200;
+
+		if (args.size() > 2) {
+			std::cerr << "usage: " << argv0 << " [RSS-MB] [ROUNDS]\n";
+			return cosmos::ExitStatus::FAILURE;
+		}
+
+		if (args.size() > 0)
+			rss_mb = std::stoul(std::string{args[0]});
+		if (args.size() > 1)
+			rounds = std::stoul(std::string{args[1]});
+
+		cosmos::SpawnServer server;
+		server.start();
+
+		// touch every page so that it is actually resident
+		std::vector<char> ballast(rss_mb * 1024 * 1024);
+		std::memset(ballast.data(), 1, ballast.size());
+
+		std::cout << "parent RSS ballast: " << rss_mb << " MiB, " << rounds << " rounds\n";
+
+		for (const std::string_view mode: {"fork  ", "vfork ", "server"}) {
+			cosmos::ChildCloner cloner{{"true"}};
+			cloner.setUseVFork(mode == "vfork ");
+			const bool use_server = mode == "server";
+			cosmos::MonotonicStopWatch watch{cosmos::MonotonicStopWatch::InitialMark{true}};
+
+			for (size_t round = 0; round < rounds; round++) {
+				auto proc = use_server ? server.spawn(cloner) : cloner.run();
+				(void)proc.wait();
+			}
+
+			const auto elapsed = watch.elapsedMs();
+
+			std::cout << mode << " mode: "
+				<< (elapsed * 1000 / rounds) << " µs per spawn+wait\n";
+		}
+
+		return cosmos::ExitStatus::SUCCESS;
+	}
+};
+
+int main(const int argc, const char **argv) {
+	return cosmos::main<SpawnBench>(argc, argv);
+}
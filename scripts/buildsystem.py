@@ -507,6 +507,9 @@ def initSCons(project, rtti=True, deflibtype='shared'):
     if evalBool(ARGUMENTS.get('release', '0')):
         env.Append(CCFLAGS='-DNDEBUG')
 
+    if not evalBool(ARGUMENTS.get('lockstats', '1')):
+        env.Append(CCFLAGS='-DCOSMOS_LOCK_STATS=0')
+
     if not rtti:
         env.Append(CXXFLAGS=['-fno-rtti'])
 
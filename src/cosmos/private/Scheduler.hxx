@@ -23,6 +23,9 @@ struct sched_attr {
 	uint64_t sched_runtime;
 	uint64_t sched_deadline;
 	uint64_t sched_period;
+	/* Utilization clamping, since Linux 5.3 */
+	uint32_t sched_util_min;
+	uint32_t sched_util_max;
 };
 
 } // end ns
@@ -0,0 +1,184 @@
+// C++
+#include <algorithm>
+
+// Linux
+#include <fcntl.h>
+#include <limits.h>
+
+// cosmos
+#include <cosmos/error/ApiError.hxx>
+#include <cosmos/fs/AppendLog.hxx>
+#include <cosmos/utils.hxx>
+
+namespace cosmos {
+
+AppendLog::AppendLog(File &&file, const SyncMode mode) :
+		m_file{std::move(file)},
+		m_sync_mode{mode} {
+	m_tail = m_file.seekFromEnd(0);
+	m_flush_offset = m_tail;
+	m_writeback_offset = m_tail;
+}
+
+off_t AppendLog::append(const void *data, const size_t length) {
+	MutexGuard g{m_cond};
+
+	if (m_error) {
+		std::rethrow_exception(m_error);
+	}
+
+	const auto offset = m_tail;
+	m_queue.push_back(OutputMemoryRegion{data, length});
+	m_tail += static_cast<off_t>(length);
+	m_stats.records++;
+	m_stats.bytes += length;
+
+	waitFor(++m_enqueued);
+
+	return offset;
+}
+
+void AppendLog::waitFor(const size_t seq) {
+	while (m_completed < seq) {
+		if (m_error) {
+			std::rethrow_exception(m_error);
+		} else if (m_flushing) {
+			m_cond.wait();
+			continue;
+		}
+
+		// become the flusher for everything queued so far
+		m_flushing = true;
+		WriteIOVector batch;
+		batch.swap(m_queue);
+		const auto batch_end = m_enqueued;
+		const auto offset = m_flush_offset;
+		m_flush_offset = m_tail;
+		m_stats.batches++;
+		const auto writeback_threshold = m_writeback_threshold;
+		std::exception_ptr error;
+
+		{
+			MutexReverseGuard rg{m_cond};
+
+			try {
+				const auto end = writeBatch(batch, offset);
+				checkWriteback(end, writeback_threshold);
+			} catch (...) {
+				error = std::current_exception();
+			}
+		}
+
+		m_flushing = false;
+
+		if (m_queue.empty()) {
+			// reuse the allocated capacity
+			batch.clear();
+			m_queue.swap(batch);
+		}
+
+		if (error) {
+			m_error = error;
+		} else {
+			m_completed = batch_end;
+		}
+
+		m_cond.broadcast();
+	}
+}
+
+off_t AppendLog::writeBatch(WriteIOVector &batch, off_t offset) {
+	using ReadWriteFlag = File::ReadWriteFlag;
+	using ReadWriteFlags = File::ReadWriteFlags;
+	const auto flags = m_sync_mode == SyncMode::DSYNC_WRITE ?
+		ReadWriteFlags{ReadWriteFlag::DSYNC} : ReadWriteFlags{};
+	auto pos = batch.begin();
+
+	// the kernel doesn't accept more than IOV_MAX entries at once
+	while (pos != batch.end()) {
+		const auto num = std::min<size_t>(IOV_MAX, batch.end() - pos);
+		WriteIOVector chunk;
+		chunk.assign(pos, pos + num);
+		pos += num;
+
+		while (true) {
+			const auto left = chunk.leftBytes();
+			const bool done = m_file.writeAtPos(chunk, offset, flags);
+			offset += static_cast<off_t>(left - chunk.leftBytes());
+
+			if (done)
+				break;
+		}
+	}
+
+	if (m_sync_mode == SyncMode::DATA_SYNC) {
+		m_file.fd().dataSync();
+	}
+
+	return offset;
+}
+
+void AppendLog::checkWriteback(const off_t end, const size_t threshold) {
+	// only the flusher calls this, thus no locking is needed for m_writeback_offset
+	if (threshold == 0)
+		return;
+
+	const auto pending = end - m_writeback_offset;
+
+	if (static_cast<size_t>(pending) < threshold)
+		return;
+
+	if (::sync_file_range(to_integral(m_file.fd().raw()),
+				m_writeback_offset, pending, SYNC_FILE_RANGE_WRITE) != 0) {
+		throw ApiError{"sync_file_range()"};
+	}
+
+	m_writeback_offset = end;
+}
+
+void AppendLog::sync() {
+	{
+		MutexGuard g{m_cond};
+
+		if (m_error) {
+			std::rethrow_exception(m_error);
+		}
+
+		waitFor(m_enqueued);
+	}
+
+	// every batch is synced anyway
+	if (m_sync_mode != SyncMode::NONE)
+		return;
+
+	m_file.fd().dataSync();
+}
+
+void AppendLog::preallocate(const off_t length) {
+	off_t offset;
+
+	{
+		MutexGuard g{m_cond};
+		offset = m_tail;
+	}
+
+	m_file.fd().allocate(offset, length,
+			FileDescriptor::AllocateFlags{FileDescriptor::AllocateFlag::KEEP_SIZE});
+}
+
+void AppendLog::setWritebackThreshold(const size_t bytes) {
+	MutexGuard g{m_cond};
+	m_writeback_threshold = bytes;
+}
+
+off_t AppendLog::tail() const {
+	MutexGuard g{m_cond};
+	return m_tail;
+}
+
+AppendLog::Stats AppendLog::stats() const {
+	MutexGuard g{m_cond};
+	return m_stats;
+}
+
+} // end ns
@@ -0,0 +1,125 @@
+// C++
+#include <format>
+
+// Linux
+#include <sys/stat.h>
+#include <unistd.h>
+
+// cosmos
+#include <cosmos/error/ApiError.hxx>
+#include <cosmos/error/UsageError.hxx>
+#include <cosmos/fs/DirectFile.hxx>
+#include <cosmos/memory.hxx>
+#include <cosmos/utils.hxx>
+
+namespace cosmos {
+
+namespace {
+
+	bool is_multiple(const uintptr_t value, const size_t align) {
+		return (value & (align - 1)) == 0;
+	}
+
+	template <typename IOVEC>
+	void check_iovec(const DirectFile &file, const IOVEC &iovec, const off_t offset) {
+		const auto &align = file.alignment();
+
+		if (offset != -1 && !is_multiple(static_cast<uintptr_t>(offset), align.offset)) {
+			throw UsageError{std::format("direct I/O offset {} is not aligned to {}", offset, align.offset)};
+		}
+
+		for (const auto &region: iovec) {
+			const auto base = reinterpret_cast<uintptr_t>(region.getBase());
+
+			if (!is_multiple(base, align.memory) || !is_multiple(region.getLength(), align.offset)) {
+				throw UsageError{"direct I/O vector entry is not properly aligned"};
+			}
+		}
+	}
+
+} // end anon ns
+
+void DirectFile::open(const SysString path, const OpenMode mode,
+		const OpenFlags flags, const std::optional<FileMode> fmode) {
+	File::open(path, mode, flags | OpenFlags{OpenFlag::DIRECT}, fmode);
+	queryAlignment();
+}
+
+void DirectFile::open(const DirFD dir_fd, const SysString path, const OpenMode mode,
+		const OpenFlags flags, const std::optional<FileMode> fmode) {
+	File::open(dir_fd, path, mode, flags | OpenFlags{OpenFlag::DIRECT}, fmode);
+	queryAlignment();
+}
+
+void DirectFile::open(const FileDescriptor fd, const AutoCloseFD auto_close) {
+	auto [_, flags] = fd.getStatusFlags();
+
+	if (!flags[OpenFlag::DIRECT]) {
+		flags.set(OpenFlag::DIRECT);
+		FileDescriptor{fd}.setStatusFlags(flags);
+	}
+
+	File::open(fd, auto_close);
+	queryAlignment();
+}
+
+void DirectFile::queryAlignment() {
+	struct statx stx;
+
+	const auto res = ::statx(to_integral(m_fd.raw()), "", AT_EMPTY_PATH, STATX_DIOALIGN, &stx);
+
+	if (res != 0) {
+		close();
+		throw ApiError{"statx(STATX_DIOALIGN)"};
+	}
+
+	if ((stx.stx_mask & STATX_DIOALIGN) == 0 || stx.stx_dio_mem_align == 0) {
+		/*
+		 * No information available. The page size is a multiple of
+		 * the logical block size on all practical setups, thus it
+		 * is a safe choice.
+		 */
+		const auto page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+		m_alignment = Alignment{page_size, page_size};
+	} else {
+		m_alignment = Alignment{stx.stx_dio_mem_align, stx.stx_dio_offset_align};
+	}
+}
+
+AlignedBuffer DirectFile::allocateBuffer(const size_t size) const {
+	if (!isOpen()) {
+		throw UsageError{"attempt to allocate direct I/O buffer without open file"};
+	}
+
+	return AlignedBuffer{alignedLength(size), m_alignment.memory};
+}
+
+bool DirectFile::isAligned(const void *buf, const size_t length, const off_t offset) const {
+	return is_multiple(reinterpret_cast<uintptr_t>(buf), m_alignment.memory) &&
+		is_multiple(length, m_alignment.offset) &&
+		is_multiple(static_cast<uintptr_t>(offset), m_alignment.offset);
+}
+
+void DirectFile::checkAligned(const void *buf, const size_t length, const off_t offset) const {
+	if (!isOpen()) {
+		throw UsageError{"no direct I/O file currently open"};
+	} else if (!is_multiple(reinterpret_cast<uintptr_t>(buf), m_alignment.memory)) {
+		throw UsageError{std::format("direct I/O buffer is not aligned to {}", m_alignment.memory)};
+	} else if (!is_multiple(length, m_alignment.offset)) {
+		throw UsageError{std::format("direct I/O length {} is not aligned to {}", length, m_alignment.offset)};
+	} else if (!is_multiple(static_cast<uintptr_t>(offset), m_alignment.offset)) {
+		throw UsageError{std::format("direct I/O offset {} is not aligned to {}", offset, m_alignment.offset)};
+	}
+}
+
+bool DirectFile::readAligned(ReadIOVector &iovec, off_t offset, const ReadWriteFlags flags) {
+	check_iovec(*this, iovec, offset);
+	return readAtPos(iovec, offset, flags);
+}
+
+bool DirectFile::writeAligned(WriteIOVector &iovec, off_t offset, const ReadWriteFlags flags) {
+	check_iovec(*this, iovec, offset);
+	return writeAtPos(iovec, offset, flags);
+}
+
+} // end ns
@@ -0,0 +1,235 @@
+// C++
+#include <cstring>
+
+// Linux
+#include <unistd.h>
+
+// cosmos
+#include <cosmos/error/ApiError.hxx>
+#include <cosmos/error/RuntimeError.hxx>
+#include <cosmos/fs/FANotify.hxx>
+#include <cosmos/utils.hxx>
+
+namespace cosmos {
+
+namespace {
+
+	void close_raw_fd(int &fd) {
+		if (fd >= 0) {
+			::close(fd);
+			fd = FAN_NOFD;
+		}
+	}
+
+} // end anon ns
+
+/*
+ * FANotify::FileID
+ */
+
+bool FANotify::FileID::operator==(const FileHandle &other) const {
+	if (!other.valid())
+		return false;
+
+	const auto theirs = other.raw();
+
+	return handle->handle_type == theirs->handle_type &&
+		handle->handle_bytes == theirs->handle_bytes &&
+		std::memcmp(handle->f_handle, theirs->f_handle, handle->handle_bytes) == 0;
+}
+
+/*
+ * FANotify::Event
+ */
+
+FileDescriptor FANotify::Event::takeFD() const {
+	FileDescriptor ret{FileNum{m_ev->fd}};
+	m_ev->fd = FAN_NOFD;
+	return ret;
+}
+
+const struct fanotify_event_info_header* FANotify::Event::findInfo(const InfoType type) const {
+	const auto base = reinterpret_cast<const uint8_t*>(m_ev);
+	const auto end = base + m_ev->event_len;
+
+	for (auto pos = base + m_ev->metadata_len; pos + sizeof(fanotify_event_info_header) <= end; ) {
+		auto header = reinterpret_cast<const fanotify_event_info_header*>(pos);
+
+		if (header->info_type == to_integral(type))
+			return header;
+		else if (header->len == 0)
+			break;
+
+		pos += header->len;
+	}
+
+	return nullptr;
+}
+
+std::optional<FANotify::FileID> FANotify::Event::findFileID(const InfoType type) const {
+	auto header = findInfo(type);
+	if (!header)
+		return std::nullopt;
+
+	auto info = reinterpret_cast<const fanotify_event_info_fid*>(header);
+	FileID ret;
+	std::memcpy(&ret.fsid, &info->fsid, sizeof(ret.fsid));
+	ret.handle = reinterpret_cast<const struct file_handle*>(info->handle);
+	return ret;
+}
+
+std::optional<FANotify::FileID> FANotify::Event::dirID(const InfoType type) const {
+	if (auto ret = findFileID(type); ret) {
+		return ret;
+	} else if (type == InfoType::DFID_NAME) {
+		// REPORT_DIR_FID without REPORT_NAME
+		return findFileID(InfoType::DFID);
+	}
+
+	return std::nullopt;
+}
+
+std::string_view FANotify::Event::name(const InfoType type) const {
+	auto id = findFileID(type);
+	if (!id)
+		return {};
+
+	// the null terminated name follows directly after the file handle
+	auto name = reinterpret_cast<const char*>(id->handle->f_handle) + id->handle->handle_bytes;
+	return std::string_view{name};
+}
+
+std::optional<FileNum> FANotify::Event::pidFD() const {
+	auto header = findInfo(InfoType::PIDFD);
+	if (!header)
+		return std::nullopt;
+
+	auto info = reinterpret_cast<const fanotify_event_info_pidfd*>(header);
+
+	if (info->pidfd < 0)
+		return std::nullopt;
+
+	return FileNum{info->pidfd};
+}
+
+std::optional<FileNum> FANotify::Event::takePidFD() const {
+	auto ret = pidFD();
+
+	if (ret) {
+		// the event data lives in the mutable buffer of FANotify
+		auto info = const_cast<fanotify_event_info_pidfd*>(
+				reinterpret_cast<const fanotify_event_info_pidfd*>(findInfo(InfoType::PIDFD)));
+		info->pidfd = FAN_NOPIDFD;
+	}
+
+	return ret;
+}
+
+std::optional<std::pair<Errno, size_t>> FANotify::Event::fsError() const {
+	auto header = findInfo(InfoType::ERROR);
+	if (!header)
+		return std::nullopt;
+
+	auto info = reinterpret_cast<const fanotify_event_info_error*>(header);
+
+	return std::make_pair(Errno{info->error}, static_cast<size_t>(info->error_count));
+}
+
+/*
+ * FANotify
+ */
+
+FANotify::FANotify(const InitFlags flags, const OpenMode event_mode,
+		const OpenFlags event_flags, const size_t io_buffer_size) :
+		m_io_buffer_size{io_buffer_size} {
+	const auto fd = ::fanotify_init(flags.raw(), to_integral(event_mode) | event_flags.raw());
+
+	if (fd == -1) {
+		throw ApiError{"fanotify_init()"};
+	}
+
+	m_notify_file = File{FileDescriptor{FileNum{fd}}, AutoCloseFD{true}};
+	m_buffer.reserve(io_buffer_size);
+}
+
+FANotify::~FANotify() {
+	// don't leak file descriptors of events that haven't been processed
+	if (m_current) {
+		closeEventFDs(*m_current);
+	}
+
+	while (m_offset < m_buffer.size()) {
+		closeEventFDs(m_offset);
+		m_offset += reinterpret_cast<const fanotify_event_metadata*>(m_buffer.data() + m_offset)->event_len;
+	}
+}
+
+void FANotify::mark(const unsigned int action, const DirFD dir_fd, const SysString path,
+		const EventTypes mask, const MarkType type, const MarkFlags flags) {
+	const auto res = ::fanotify_mark(to_integral(m_notify_file.fd().raw()),
+			action | to_integral(type) | flags.raw(),
+			mask.raw(),
+			to_integral(dir_fd.raw()),
+			path.empty() ? nullptr : path.raw());
+
+	if (res != 0) {
+		throw ApiError{"fanotify_mark()"};
+	}
+}
+
+void FANotify::flushMarks(const MarkType type) {
+	mark(FAN_MARK_FLUSH, AT_CWD, SysString{}, EventTypes{}, type, MarkFlags{});
+}
+
+void FANotify::closeEventFDs(const size_t offset) {
+	Event event{reinterpret_cast<struct fanotify_event_metadata*>(m_buffer.data() + offset)};
+
+	close_raw_fd(event.m_ev->fd);
+
+	if (auto pidfd = event.takePidFD(); pidfd) {
+		int raw = to_integral(*pidfd);
+		close_raw_fd(raw);
+	}
+}
+
+FANotify::Event FANotify::readEvent() {
+	if (m_current) {
+		closeEventFDs(*m_current);
+		m_current.reset();
+	}
+
+	if (m_offset >= m_buffer.size()) {
+		/* we need to read in a new batch of events */
+		m_buffer.resize(m_io_buffer_size);
+		/* in case read() throws this leaves us in a reentrant state */
+		m_offset = m_io_buffer_size;
+		const auto read = m_notify_file.read(m_buffer.data(), m_buffer.size());
+		m_offset = 0;
+		m_buffer.resize(read);
+	}
+
+	auto event = reinterpret_cast<struct fanotify_event_metadata*>(m_buffer.data() + m_offset);
+
+	if (event->vers != FANOTIFY_METADATA_VERSION) {
+		m_offset = m_buffer.size();
+		throw RuntimeError{"fanotify event metadata version mismatch"};
+	}
+
+	m_current = m_offset;
+	m_offset += event->event_len;
+
+	return Event{event};
+}
+
+std::optional<FANotify::Event> FANotify::tryReadEvent() {
+	try {
+		return readEvent();
+	} catch (const ApiError &ex) {
+		if (ex.errnum() == Errno::AGAIN)
+			return std::nullopt;
+
+		throw;
+	}
+}
+
+} // end ns
@@ -145,8 +145,8 @@ FileDescriptor::SealFlags FileDescriptor::getSeals() const {
 int FileDescriptor::getPipeSize() const {
 	const auto res = this->fcntl(F_GETPIPE_SZ);
 
-	if (res != 0) {
-		throw ApiError{"fcntl(F_GETPIP_SZ)"};
+	if (res == -1) {
+		throw ApiError{"fcntl(F_GETPIPE_SZ)"};
 	}
 
 	return res;
@@ -155,8 +155,8 @@ int FileDescriptor::getPipeSize() const {
 int FileDescriptor::setPipeSize(const int new_size) {
 	const auto res = this->fcntl(F_SETPIPE_SZ, new_size);
 
-	if (res != 0) {
-		throw ApiError{"fcntl(F_SETPIP_SZ)"};
+	if (res == -1) {
+		throw ApiError{"fcntl(F_SETPIPE_SZ)"};
 	}
 
 	return res;
@@ -346,6 +346,18 @@ void FileDescriptor::setAdvice(off_t offset, off_t size, const AccessAdvice advi
 	}
 }
 
+void FileDescriptor::allocate(off_t offset, off_t length, const AllocateFlags flags) {
+	if (::fallocate(to_integral(m_fd), flags.raw(), offset, length) != 0) {
+		throw ApiError{"fallocate()"};
+	}
+}
+
+void FileDescriptor::readAhead(off_t offset, size_t count) {
+	if (::readahead(to_integral(m_fd), offset, count) != 0) {
+		throw ApiError{"readahead()"};
+	}
+}
+
 FileDescriptor stdout(FileNum::STDOUT);
 FileDescriptor stderr(FileNum::STDERR);
 FileDescriptor stdin(FileNum::STDIN);
@@ -0,0 +1,52 @@
+// C++
+#include <cstring>
+
+// cosmos
+#include <cosmos/error/ApiError.hxx>
+#include <cosmos/error/UsageError.hxx>
+#include <cosmos/fs/FileHandle.hxx>
+#include <cosmos/utils.hxx>
+
+namespace cosmos {
+
+FileHandle::FileHandle(const struct file_handle &raw) {
+	m_data.resize(sizeof(raw) + raw.handle_bytes);
+	std::memcpy(m_data.data(), &raw, m_data.size());
+}
+
+FileHandle::FileHandle(const DirFD dir_fd, const SysString path, const FollowSymlinks follow) {
+	int flags = follow ? AT_SYMLINK_FOLLOW : 0;
+	if (path.empty())
+		flags |= AT_EMPTY_PATH;
+
+	/* start with the maximum size supported by the kernel, this avoids
+	 * an extra system call for querying the required size */
+	m_data.resize(sizeof(struct file_handle) + MAX_HANDLE_SZ);
+	auto fh = reinterpret_cast<struct file_handle*>(m_data.data());
+	fh->handle_bytes = MAX_HANDLE_SZ;
+	int mount_id;
+
+	if (::name_to_handle_at(to_integral(dir_fd.raw()), path.raw(), fh, &mount_id, flags) != 0) {
+		throw ApiError{"name_to_handle_at()"};
+	}
+
+	m_data.resize(sizeof(struct file_handle) + fh->handle_bytes);
+}
+
+FileDescriptor FileHandle::open(const FileDescriptor mount_fd, const OpenMode mode, const OpenFlags flags) const {
+	if (!valid()) {
+		throw UsageError{"attempt to open an empty FileHandle"};
+	}
+
+	// the system call wants a non-const pointer, but doesn't modify the data
+	auto fh = const_cast<struct file_handle*>(raw());
+	const auto fd = ::open_by_handle_at(to_integral(mount_fd.raw()), fh, to_integral(mode) | flags.raw());
+
+	if (fd == -1) {
+		throw ApiError{"open_by_handle_at()"};
+	}
+
+	return FileDescriptor{FileNum{fd}};
+}
+
+} // end ns
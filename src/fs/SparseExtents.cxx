@@ -0,0 +1,52 @@
+// cosmos
+#include <cosmos/error/ApiError.hxx>
+#include <cosmos/error/errno.hxx>
+#include <cosmos/fs/SparseExtents.hxx>
+#include <cosmos/io/StreamIO.hxx>
+
+namespace cosmos {
+
+namespace {
+
+	/// Seeks to the next position of `type` at or after `offset`.
+	/**
+	 * Returns std::nullopt if no such position exists beyond `offset`.
+	 **/
+	std::optional<off_t> seek_next(StreamIO &io, const StreamIO::SeekType type, const off_t offset) {
+		try {
+			return io.seek(type, offset);
+		} catch (const ApiError &ex) {
+			if (ex.errnum() == Errno::NXIO) {
+				return std::nullopt;
+			}
+
+			throw;
+		}
+	}
+
+} // end anon ns
+
+std::optional<SparseExtents::Extent> SparseExtents::nextExtent() {
+	StreamIO io{m_fd};
+
+	const auto data = seek_next(io, StreamIO::SeekType::DATA, m_pos);
+
+	if (!data) {
+		// no more data beyond m_pos
+		return std::nullopt;
+	}
+
+	// the end-of-file always counts as a hole, thus this always succeeds
+	// unless the file is truncated concurrently
+	const auto hole = seek_next(io, StreamIO::SeekType::HOLE, *data);
+
+	if (!hole) {
+		return std::nullopt;
+	}
+
+	m_pos = *hole;
+
+	return Extent{*data, *hole - *data};
+}
+
+} // end ns
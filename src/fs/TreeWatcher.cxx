@@ -0,0 +1,436 @@
+// C++
+#include <algorithm>
+
+// cosmos
+#include <cosmos/error/ApiError.hxx>
+#include <cosmos/fs/DirStream.hxx>
+#include <cosmos/fs/FileStatus.hxx>
+#include <cosmos/fs/TreeWatcher.hxx>
+
+namespace cosmos {
+
+namespace {
+
+	/// Events that are always needed to keep track of the tree structure.
+	constexpr INotify::EventTypes TREE_EVENTS{
+		INotify::EventType::CREATE,
+		INotify::EventType::MOVED_FROM,
+		INotify::EventType::MOVED_TO,
+		INotify::EventType::DELETE_SELF
+	};
+
+	constexpr INotify::WatchFlags WATCH_FLAGS{
+		INotify::WatchFlag::ONLY_DIR,
+		INotify::WatchFlag::DONT_FOLLOW
+	};
+
+	void append_path(std::string &path, const std::string_view name) {
+		if (path.empty() || path.back() != '/')
+			path.push_back('/');
+		path.append(name);
+	}
+
+} // end anon ns
+
+TreeWatcher::TreeWatcher(const EventTypes mask, const IntervalTime window, const size_t max_pending) :
+		m_inotify{64 * 1024, {INotify::InitFlag::NONBLOCK, INotify::InitFlag::CLOEXEC}},
+		m_mask{mask},
+		m_watch_mask{mask | TREE_EVENTS},
+		m_window{window},
+		m_max_pending{max_pending} {
+}
+
+void TreeWatcher::addTree(const std::string_view root) {
+	std::string path{root};
+
+	while (path.size() > 1 && path.back() == '/')
+		path.pop_back();
+
+	if (auto id = addNode(WatchID::INVALID, path, path); id) {
+		m_roots.push_back(*id);
+		scanDir(*id, path, {});
+	}
+}
+
+std::optional<TreeWatcher::WatchID> TreeWatcher::addNode(
+		const WatchID parent, std::string name, const std::string &path) {
+	const auto id = m_inotify.addWatch(path, m_watch_mask, WATCH_FLAGS);
+
+	auto [it, inserted] = m_nodes.try_emplace(id);
+
+	if (!inserted) {
+		// already known e.g. seen both during a scan and via CREATE
+		return std::nullopt;
+	}
+
+	auto &node = it->second;
+	node.parent = parent;
+	node.name = std::move(name);
+
+	if (parent != WatchID::INVALID) {
+		m_nodes[parent].children.push_back(id);
+	}
+
+	return id;
+}
+
+void TreeWatcher::scanDir(const WatchID id, const std::string &path, const EventTypes report) {
+	/* walk iteratively, deep trees shouldn't exhaust the stack */
+	std::vector<std::pair<WatchID, std::string>> todo;
+	todo.emplace_back(id, path);
+
+	while (!todo.empty()) {
+		auto [dir_id, dir_path] = std::move(todo.back());
+		todo.pop_back();
+
+		DirStream stream;
+
+		try {
+			stream.open(dir_path);
+		} catch (const ApiError &) {
+			// vanished in the meantime, the events will tell
+			continue;
+		}
+
+		for (const auto entry: stream) {
+			if (entry.isDotEntry())
+				continue;
+
+			bool is_dir = entry.type() == DirEntry::Type::DIRECTORY;
+
+			if (entry.type() == DirEntry::Type::UNKNOWN) {
+				try {
+					is_dir = FileStatus{stream.fd(), entry.name()}.type().isDirectory();
+				} catch (const ApiError &) {
+					continue;
+				}
+			}
+
+			auto entry_path = dir_path;
+			append_path(entry_path, entry.view());
+
+			if (report.any()) {
+				queueChange(std::string{entry_path}, report, is_dir);
+			}
+
+			if (!is_dir)
+				continue;
+
+			try {
+				if (auto child = addNode(dir_id, std::string{entry.view()}, entry_path); child) {
+					todo.emplace_back(*child, std::move(entry_path));
+				}
+			} catch (const ApiError &) {
+				// vanished or not accessible
+			}
+		}
+	}
+}
+
+size_t TreeWatcher::readEvents() {
+	size_t count = 0;
+
+	while (auto event = m_inotify.tryReadEvent()) {
+		processEvent(*event);
+		count++;
+	}
+
+	resolveMoves();
+
+	return count;
+}
+
+void TreeWatcher::processEvent(const INotify::Event &event) {
+	using enum INotify::EventType;
+	using EventFlag = INotify::EventFlag;
+
+	const auto flags = event.flags();
+
+	if (flags[EventFlag::OVERFLOW]) {
+		requestRescan();
+		resync();
+		return;
+	}
+
+	const auto id = event.id();
+
+	if (!m_nodes.contains(id)) {
+		// stale event for a watch we already dropped
+		return;
+	}
+
+	if (flags[EventFlag::IGNORED]) {
+		dropSubtree(id, false);
+		return;
+	}
+
+	const auto types = event.event();
+	const auto name = event.name();
+	const bool is_dir = flags[EventFlag::ISDIR];
+	auto full_path = path(id);
+
+	if (!name.empty()) {
+		append_path(full_path, name);
+	}
+
+	if (is_dir && !name.empty()) {
+		if (types[MOVED_FROM]) {
+			if (const auto child = findChild(id, name); child != WatchID::INVALID) {
+				m_move_sources.push_back(MoveSource{event.cookie(), child});
+			}
+		} else if (types[MOVED_TO]) {
+			auto it = std::find_if(
+					m_move_sources.begin(), m_move_sources.end(),
+					[&event](const MoveSource &src) {
+						return src.cookie == event.cookie();
+					});
+
+			if (it != m_move_sources.end()) {
+				// a rename within the watched trees, simply relink
+				const auto moved = it->id;
+				m_move_sources.erase(it);
+				unlinkFromParent(moved);
+				auto &node = m_nodes[moved];
+				node.parent = id;
+				node.name = name;
+				m_nodes[id].children.push_back(moved);
+			} else {
+				try {
+					if (auto child = addNode(id, std::string{name}, full_path); child) {
+						scanDir(*child, full_path, EventTypes{m_mask}.limit({MOVED_TO}));
+					}
+				} catch (const ApiError &) {
+					// moved away again already
+				}
+			}
+		} else if (types[CREATE]) {
+			try {
+				if (auto child = addNode(id, std::string{name}, full_path); child) {
+					scanDir(*child, full_path, EventTypes{m_mask}.limit({CREATE}));
+				}
+			} catch (const ApiError &) {
+				// removed again already
+			}
+		}
+	}
+
+	if (auto reported = EventTypes{types}.limit(m_mask); reported.any()) {
+		queueChange(std::move(full_path), reported, is_dir);
+	}
+}
+
+void TreeWatcher::resolveMoves() {
+	/*
+	 * MOVED_FROM events without a matching MOVED_TO event in the same
+	 * batch mean that the directory left the watched trees.
+	 */
+	for (const auto &src: m_move_sources) {
+		if (m_nodes.contains(src.id)) {
+			dropSubtree(src.id, true);
+		}
+	}
+
+	m_move_sources.clear();
+}
+
+void TreeWatcher::dropSubtree(const WatchID id, const bool remove_watches) {
+	unlinkFromParent(id);
+
+	std::vector<WatchID> todo{id};
+
+	while (!todo.empty()) {
+		const auto cur = todo.back();
+		todo.pop_back();
+
+		auto it = m_nodes.find(cur);
+		if (it == m_nodes.end())
+			continue;
+
+		todo.insert(todo.end(), it->second.children.begin(), it->second.children.end());
+		m_nodes.erase(it);
+
+		if (remove_watches) {
+			try {
+				m_inotify.removeWatch(cur);
+			} catch (const ApiError &) {
+				// already gone on kernel side
+			}
+		}
+	}
+
+	if (auto it = std::find(m_roots.begin(), m_roots.end(), id); it != m_roots.end()) {
+		m_roots.erase(it);
+	}
+}
+
+void TreeWatcher::unlinkFromParent(const WatchID id) {
+	const auto node = m_nodes.find(id);
+	if (node == m_nodes.end() || node->second.parent == WatchID::INVALID)
+		return;
+
+	auto parent = m_nodes.find(node->second.parent);
+	if (parent == m_nodes.end())
+		return;
+
+	auto &children = parent->second.children;
+
+	if (auto it = std::find(children.begin(), children.end(), id); it != children.end()) {
+		// order is irrelevant, avoid shifting elements
+		*it = children.back();
+		children.pop_back();
+	}
+}
+
+TreeWatcher::WatchID TreeWatcher::findChild(const WatchID parent, const std::string_view name) const {
+	const auto it = m_nodes.find(parent);
+	if (it == m_nodes.end())
+		return WatchID::INVALID;
+
+	for (const auto child: it->second.children) {
+		if (auto node = m_nodes.find(child); node != m_nodes.end() && node->second.name == name) {
+			return child;
+		}
+	}
+
+	return WatchID::INVALID;
+}
+
+std::string TreeWatcher::path(const WatchID id) const {
+	std::vector<const std::string*> components;
+
+	for (auto it = m_nodes.find(id); it != m_nodes.end(); it = m_nodes.find(it->second.parent)) {
+		components.push_back(&it->second.name);
+	}
+
+	std::string ret;
+
+	if (components.empty())
+		return ret;
+
+	ret = *components.back();
+	components.pop_back();
+
+	while (!components.empty()) {
+		append_path(ret, *components.back());
+		components.pop_back();
+	}
+
+	return ret;
+}
+
+void TreeWatcher::queueChange(std::string &&path, const EventTypes events, const bool is_dir) {
+	if (auto it = m_pending_index.find(path); it != m_pending_index.end()) {
+		auto &change = m_pending[it->second - m_pending_base].change;
+		change.events.set(events);
+		change.is_dir = is_dir;
+		return;
+	}
+
+	if (m_pending.size() >= m_max_pending) {
+		requestRescan();
+		return;
+	}
+
+	m_pending_index[path] = m_pending_base + m_pending.size();
+	m_pending.push_back(Pending{
+		Change{std::move(path), events, is_dir, false},
+		m_clock.now() + MonotonicTime{m_window}
+	});
+}
+
+void TreeWatcher::requestRescan() {
+	m_pending.clear();
+	m_pending_index.clear();
+	m_pending_base = 0;
+	m_rescan_pending = true;
+}
+
+void TreeWatcher::resync() {
+	/*
+	 * Events have been lost, thus the watch table may be out of date.
+	 * Walk all roots again. Adding a watch for an inode that is already
+	 * watched returns the existing WatchID, thus watches for directories
+	 * that still exist are kept. Watches that are no longer found are
+	 * removed afterwards.
+	 */
+	std::vector<std::string> root_paths;
+
+	for (const auto root: m_roots) {
+		root_paths.push_back(path(root));
+	}
+
+	auto old_nodes = std::move(m_nodes);
+	m_nodes.clear();
+	m_roots.clear();
+	m_move_sources.clear();
+
+	for (const auto &root: root_paths) {
+		try {
+			addTree(root);
+		} catch (const ApiError &) {
+			// the root itself is gone
+		}
+	}
+
+	for (const auto &[id, _]: old_nodes) {
+		if (m_nodes.contains(id))
+			continue;
+
+		try {
+			m_inotify.removeWatch(id);
+		} catch (const ApiError &) {
+			// already gone on kernel side
+		}
+	}
+}
+
+TreeWatcher::ChangeList TreeWatcher::takeChanges(const bool flush) {
+	ChangeList ret;
+
+	if (m_rescan_pending) {
+		for (const auto root: m_roots) {
+			ret.push_back(Change{path(root), {}, true, true});
+		}
+		m_rescan_pending = false;
+	}
+
+	if (m_pending.empty())
+		return ret;
+
+	const auto now = m_clock.now();
+
+	while (!m_pending.empty()) {
+		auto &front = m_pending.front();
+
+		if (!flush && now < front.due)
+			break;
+
+		m_pending_index.erase(front.change.path);
+		ret.push_back(std::move(front.change));
+		m_pending.pop_front();
+		m_pending_base++;
+	}
+
+	if (m_pending.empty()) {
+		m_pending_base = 0;
+	}
+
+	return ret;
+}
+
+std::optional<IntervalTime> TreeWatcher::nextTimeout() const {
+	if (m_rescan_pending)
+		return IntervalTime{0};
+	else if (m_pending.empty())
+		return std::nullopt;
+
+	const auto now = m_clock.now();
+	const auto due = m_pending.front().due;
+
+	if (due <= now)
+		return IntervalTime{0};
+
+	return IntervalTime{due - now};
+}
+
+} // end ns
@@ -18,6 +18,7 @@
 #include <cosmos/error/InternalError.hxx>
 #include <cosmos/error/RuntimeError.hxx>
 #include <cosmos/error/UsageError.hxx>
+#include <cosmos/error/WouldBlock.hxx>
 #include <cosmos/formatting.hxx>
 #include <cosmos/fs/DirIterator.hxx>
 #include <cosmos/fs/DirStream.hxx>
@@ -26,6 +27,7 @@
 #include <cosmos/fs/FileStatus.hxx>
 #include <cosmos/fs/filesystem.hxx>
 #include <cosmos/fs/path.hxx>
+#include <cosmos/private/cosmos.hxx>
 #include <cosmos/proc/process.hxx>
 #include <cosmos/string.hxx>
 #include <cosmos/utils.hxx>
@@ -616,6 +618,28 @@ size_t copy_file_range(
 	return copy_file_range(fd_in, nullptr, fd_out, nullptr, len);
 }
 
+size_t splice(
+		const FileDescriptor fd_in, const FileDescriptor fd_out,
+		const size_t len, const SpliceFlags flags) {
+	while (true) {
+		const auto res = ::splice(
+				to_integral(fd_in.raw()), nullptr,
+				to_integral(fd_out.raw()), nullptr,
+				len, flags.raw());
+
+		if (res < 0) {
+			if (const auto error = get_errno(); auto_restart_syscalls && error == Errno::INTERRUPTED)
+				continue;
+			else if (in_list(error, {Errno::AGAIN, Errno::WOULD_BLOCK}))
+				throw WouldBlock{"splice()"};
+
+			throw ApiError{"splice()"};
+		}
+
+		return static_cast<size_t>(res);
+	}
+}
+
 size_t copy_file_range(CopyFileRangeParameters &pars) {
 	auto copied = copy_file_range(
 		pars.in,  pars.off_in  ? &pars.off_in.value()  : nullptr,
@@ -0,0 +1,92 @@
+// C++
+#include <charconv>
+
+// cosmos
+#include <cosmos/error/RuntimeError.hxx>
+#include <cosmos/proc/CPUSet.hxx>
+#include <cosmos/string.hxx>
+
+namespace cosmos {
+
+namespace {
+
+unsigned parse_cpu(const std::string_view str, const std::string_view list) {
+	unsigned ret = 0;
+	const auto end = str.data() + str.size();
+	const auto [ptr, ec] = std::from_chars(str.data(), end, ret);
+
+	if (ec != std::errc{} || ptr != end || ret >= CPUSet::MAX_CPUS) {
+		throw RuntimeError{"invalid CPU list: " + std::string{list}};
+	}
+
+	return ret;
+}
+
+} // end anon ns
+
+CPUSet CPUSet::fromList(const std::string_view list) {
+	CPUSet ret;
+	const auto stripped_list = stripped(list);
+
+	for (const auto &range: split(stripped_list, ",")) {
+		const auto dash = range.find('-');
+
+		if (dash == range.npos) {
+			ret.set(parse_cpu(range, list));
+			continue;
+		}
+
+		const auto first = parse_cpu(std::string_view{range}.substr(0, dash), list);
+		const auto last = parse_cpu(std::string_view{range}.substr(dash + 1), list);
+
+		if (first > last) {
+			throw RuntimeError{"invalid CPU list: " + std::string{list}};
+		}
+
+		for (auto cpu = first; cpu <= last; cpu++) {
+			ret.set(cpu);
+		}
+	}
+
+	return ret;
+}
+
+std::string CPUSet::toList() const {
+	std::string ret;
+	const auto list = cpus();
+
+	for (size_t pos = 0; pos < list.size(); pos++) {
+		const auto first = list[pos];
+
+		// find the end of a contiguous range
+		while (pos + 1 < list.size() && list[pos + 1] == list[pos] + 1) {
+			pos++;
+		}
+
+		if (!ret.empty())
+			ret += ",";
+
+		ret += std::to_string(first);
+
+		if (list[pos] != first) {
+			ret += "-" + std::to_string(list[pos]);
+		}
+	}
+
+	return ret;
+}
+
+std::vector<unsigned> CPUSet::cpus() const {
+	std::vector<unsigned> ret;
+	const auto num = count();
+
+	for (unsigned cpu = 0; cpu < MAX_CPUS && ret.size() < num; cpu++) {
+		if (isSet(cpu)) {
+			ret.push_back(cpu);
+		}
+	}
+
+	return ret;
+}
+
+} // end ns
@@ -1,12 +1,17 @@
 // Linux
+#include <fcntl.h>
 #include <sched.h>
+#include <signal.h>
 #include <sys/resource.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <unistd.h>
 
 // C++
+#include <array>
 #include <iostream>
 #include <format>
+#include <vector>
 
 // cosmos
 #include <cosmos/error/ApiError.hxx>
@@ -23,6 +28,8 @@
 #include <cosmos/private/Scheduler.hxx>
 #include <cosmos/proc/ChildCloner.hxx>
 #include <cosmos/proc/clone.hxx>
+#include <cosmos/proc/Mapping.hxx>
+#include <cosmos/proc/numa.hxx>
 #include <cosmos/proc/ProcessFile.hxx>
 #include <cosmos/proc/process.hxx>
 #include <cosmos/proc/SigSet.hxx>
@@ -75,6 +82,154 @@ void print_child_error(const std::string_view context, const std::string_view er
 	std::cerr << "[" << proc::get_own_pid() << "]" << context << ": " << error << std::endl;
 }
 
+/// Minimum stack size for the child process in ChildCloner::runVFork().
+/*
+ * execvpe() places a copy of the path to try on the stack and, for scripts
+ * without shebang line, a copy of the argument vector. The latter is
+ * accounted for separately.
+ */
+constexpr size_t VFORK_STACK_SIZE = 64 * 1024;
+
+/// Data shared between parent and child in ChildCloner::runVFork().
+/*
+ * Everything the child needs is prepared by the parent, the child only
+ * performs async-signal-safe system calls using this data. Since the address
+ * space is shared, the child reports errors back by writing into this
+ * structure.
+ */
+struct VForkContext {
+	char **argv = nullptr;
+	char **envp = nullptr;
+	const char *cwd = nullptr;
+	/// redirection FDs for stdin, stdout and stderr, or -1 for none.
+	std::array<int, 3> redirects = {-1, -1, -1};
+	const FileDescriptor *inherit_fds = nullptr;
+	size_t num_inherit_fds = 0;
+	bool apply_sched = false;
+	struct sched_attr sched;
+	const cpu_set_t *affinity = nullptr;
+	bool apply_mem_policy = false;
+	int mem_mode = 0;
+	const unsigned long *node_mask = nullptr;
+	unsigned long max_node = 0;
+	/// cgroup2 directory to join, or -1 for none.
+	int cgroup_fd = -1;
+	/// whether joining the cgroup failed, which is always reported.
+	bool cgroup_failed = false;
+	/// errno value of a failed step in the child, if any.
+	int error = 0;
+	/// the system call that failed in the child.
+	const char *failed_call = nullptr;
+};
+
+[[noreturn]] void vfork_fail(VForkContext &ctx, const char *call,
+		const ExitStatus status = ExitStatus::PRE_EXEC_ERROR) {
+	ctx.error = errno;
+	ctx.failed_call = call;
+	::_exit(to_integral(status));
+}
+
+int vfork_child(void *arg) {
+	auto &ctx = *reinterpret_cast<VForkContext*>(arg);
+
+	/*
+	 * We share the parent's memory, but not its signal dispositions. Any
+	 * custom handlers must not run in this context, since they could
+	 * corrupt the parent's state. All signals are still blocked at this
+	 * point (see runVFork()).
+	 */
+	struct sigaction action;
+	for (int sig = 1; sig < NSIG; sig++) {
+		// this fails for KILL, STOP and signals reserved by libc
+		if (::sigaction(sig, nullptr, &action) != 0)
+			continue;
+		else if (action.sa_handler == SIG_IGN || action.sa_handler == SIG_DFL)
+			continue;
+
+		action.sa_handler = SIG_DFL;
+		action.sa_flags = 0;
+		::sigemptyset(&action.sa_mask);
+		(void)::sigaction(sig, &action, nullptr);
+	}
+
+	if (ctx.apply_sched) {
+		// treat this as non-critical, like in ChildCloner::postFork()
+		(void)::syscall(__NR_sched_setattr, 0, &ctx.sched, 0);
+	}
+
+	if (ctx.affinity) {
+		// non-critical, too
+		(void)::sched_setaffinity(0, sizeof(cpu_set_t), ctx.affinity);
+	}
+
+	if (ctx.apply_mem_policy) {
+		// non-critical, too
+		(void)::syscall(SYS_set_mempolicy, ctx.mem_mode, ctx.node_mask, ctx.max_node);
+	}
+
+	if (ctx.cgroup_fd != -1) {
+		// writing "0" moves the calling process into the cgroup
+		const auto procs = ::openat(ctx.cgroup_fd, "cgroup.procs", O_WRONLY | O_CLOEXEC);
+		if (procs == -1) {
+			ctx.cgroup_failed = true;
+			vfork_fail(ctx, "openat(cgroup.procs)");
+		} else if (::write(procs, "0", 1) != 1) {
+			ctx.cgroup_failed = true;
+			vfork_fail(ctx, "write(cgroup.procs)");
+		}
+		(void)::close(procs);
+	}
+
+	sigset_t mask;
+	::sigemptyset(&mask);
+	if (::sigprocmask(SIG_SETMASK, &mask, nullptr) != 0) {
+		vfork_fail(ctx, "sigprocmask()");
+	}
+
+	if (ctx.cwd && ::chdir(ctx.cwd) != 0) {
+		vfork_fail(ctx, "chdir()");
+	}
+
+	// this fails with EINVAL on kernels older than 5.11, we can live with that
+	(void)::close_range(3, ~0U, CLOSE_RANGE_CLOEXEC);
+
+	// use the same order as ChildCloner::postFork()
+	for (const auto orig: {STDOUT_FILENO, STDERR_FILENO, STDIN_FILENO}) {
+		const auto redirect = ctx.redirects[orig];
+
+		if (redirect == -1) {
+			continue;
+		} else if (redirect == orig) {
+			if (::fcntl(orig, F_SETFD, 0) != 0) {
+				vfork_fail(ctx, "fcntl(F_SETFD)");
+			}
+		} else if (::dup2(redirect, orig) == -1) {
+			vfork_fail(ctx, "dup2()");
+		}
+	}
+
+	for (size_t i = 0; i < ctx.num_inherit_fds; i++) {
+		if (::fcntl(to_integral(ctx.inherit_fds[i].raw()), F_SETFD, 0) != 0) {
+			vfork_fail(ctx, "fcntl(F_SETFD)");
+		}
+	}
+
+	::execvpe(ctx.argv[0], ctx.argv, ctx.envp);
+
+	switch (Errno{errno}) {
+		case Errno::LINK_LOOP:
+		case Errno::NAME_TOO_LONG:
+		case Errno::NO_ENTRY:
+		case Errno::NOT_A_DIR:
+			vfork_fail(ctx, "execvpe()", ExitStatus::PROG_NOT_FOUND);
+		case Errno::NOT_EXECUTABLE:
+		case Errno::ACCESS:
+			vfork_fail(ctx, "execvpe()", ExitStatus::PROG_NOT_EXECUTABLE);
+		default:
+			vfork_fail(ctx, "execvpe()");
+	}
+}
+
 } // end anon ns
 
 void ChildCloner::verifyArgs() {
@@ -89,14 +244,25 @@ void ChildCloner::verifyArgs() {
 			"attempted to run a sub process w/o specifying an executable path and/or argv0"
 		};
 	}
+
+	if (m_use_vfork && m_post_fork_cb) {
+		throw UsageError{
+			"post fork callbacks are not supported in vfork mode"
+		};
+	}
 }
 
 SubProc ChildCloner::run() {
 	verifyArgs();
 
+	if (m_use_vfork && !cosmos::running_on_valgrind) {
+		return runVFork();
+	}
+
 	std::optional<Pipe> error_pipe;
 
-	if (m_forward_child_errors) {
+	// failing to join the cgroup is always reported, see setCGroup()
+	if (m_forward_child_errors || joinsCGroupManually()) {
 		error_pipe = std::make_optional(Pipe{});
 	}
 
@@ -207,6 +373,19 @@ std::optional<SubProc> ChildCloner::runClone3() {
 	clone_args.setPidFD(&pidfd);
 	clone_args.setFlags({CloneFlag::CLEAR_SIGHAND, CloneFlag::PIDFD});
 
+	if (m_share_parent) {
+		clone_args.setFlag(CloneFlag::SHARE_PARENT);
+		// clone3() fails with EINVAL if CLONE_PARENT is combined
+		// with a non-zero exit_signal. The kernel then uses the
+		// exit signal of the calling process's thread group leader
+		// for the child, and delivers it to our parent.
+		clone_args.setExitSignal(Signal{SignalNr::NONE});
+	}
+
+	if (m_cgroup.valid()) {
+		clone_args.setCGroup(m_cgroup);
+	}
+
 	if (auto pid = proc::clone(clone_args); pid != std::nullopt) {
 		// parent process with child pid
 		return SubProc{*pid, pidfd};
@@ -215,6 +394,111 @@ std::optional<SubProc> ChildCloner::runClone3() {
 	}
 }
 
+SubProc ChildCloner::runVFork() {
+	auto argv = setup_argv(m_argv);
+	std::optional<CStringVector> envp;
+	if (m_env) {
+		envp = setup_env(m_env.value());
+	}
+
+	VForkContext ctx;
+	// see proc::exec() regarding the const_cast
+	ctx.argv = const_cast<char**>(argv.data());
+	ctx.envp = const_cast<char**>(envp ? envp->data() : environ);
+	ctx.cwd = m_cwd.empty() ? nullptr : m_cwd.c_str();
+	ctx.inherit_fds = m_inherit_fds.data();
+	ctx.num_inherit_fds = m_inherit_fds.size();
+
+	for (const auto &[orig, redirect]: {
+			std::make_pair(cosmos::stdin, m_stdin),
+			std::make_pair(cosmos::stdout, m_stdout),
+			std::make_pair(cosmos::stderr, m_stderr)}) {
+		if (redirect.valid()) {
+			ctx.redirects[to_integral(orig.raw())] = to_integral(redirect.raw());
+		}
+	}
+
+	if (m_sched_settings) {
+		std::visit([&ctx](auto &&sched_settings) {
+			const SchedulerSettings &base = sched_settings;
+			base.fillStruct(ctx.sched);
+		}, *m_sched_settings);
+		ctx.apply_sched = true;
+	}
+
+	if (m_affinity) {
+		ctx.affinity = m_affinity->raw();
+	}
+
+	// needs to stay alive until the child is done
+	std::vector<unsigned long> node_mask;
+
+	if (m_mem_policy) {
+		node_mask = m_mem_policy->nodeMask();
+		ctx.apply_mem_policy = true;
+		ctx.mem_mode = m_mem_policy->rawMode();
+		ctx.node_mask = node_mask.empty() ? nullptr : node_mask.data();
+		ctx.max_node = numa::MemPolicySettings::maxNode(node_mask);
+	}
+
+	if (m_cgroup.valid()) {
+		ctx.cgroup_fd = to_integral(m_cgroup.raw());
+	}
+
+	const auto page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+	const auto min_size = VFORK_STACK_SIZE + argv.size() * sizeof(char*);
+	// add an extra guard page at the bottom to catch stack overflows
+	const auto stack_size = (min_size + page_size - 1) / page_size * page_size + page_size;
+
+	Mapping stack{stack_size, mem::MapSettings{
+		mem::MapType::PRIVATE,
+		mem::AccessFlags{mem::AccessFlag::READ, mem::AccessFlag::WRITE},
+		mem::MapFlags{mem::MapFlag::ANONYMOUS, mem::MapFlag::STACK}
+	}};
+	mem::protect(stack.addr(), page_size, mem::AccessFlags{});
+	auto stack_top = reinterpret_cast<char*>(stack.addr()) + stack_size;
+
+	/*
+	 * Block all signals while the child shares our memory, otherwise a
+	 * signal handler could run in the child before it resets the signal
+	 * dispositions. The child unblocks all signals once this is done.
+	 */
+	SigSet old_mask;
+	signal::set_sigmask(SigSet{SigSet::filled}, &old_mask);
+
+	int flags = CLONE_VM | CLONE_VFORK | CLONE_PIDFD;
+
+	if (m_share_parent) {
+		// the exit signal is ignored for CLONE_PARENT, the kernel uses
+		// the one of the calling process's thread group leader.
+		flags |= CLONE_PARENT;
+	} else {
+		flags |= SIGCHLD;
+	}
+
+	int pidfd = -1;
+	// with CLONE_VFORK this only returns after the child called
+	// execve() or exited.
+	const auto pid = ::clone(&vfork_child, stack_top, flags, &ctx, &pidfd);
+	const auto clone_error = get_errno();
+
+	signal::set_sigmask(old_mask);
+
+	if (pid == -1) {
+		throw ApiError{"clone()", clone_error};
+	}
+
+	SubProc proc{ProcessID{pid}, PidFD{FileNum{pidfd}}};
+
+	// failing to join the cgroup is always reported, see setCGroup()
+	if (ctx.error != 0 && (m_forward_child_errors || ctx.cgroup_failed)) {
+		(void)proc.wait();
+		throw ApiError{ctx.failed_call, Errno{ctx.error}};
+	}
+
+	return proc;
+}
+
 void ChildCloner::runChild(std::optional<Pipe> &error_pipe) {
 	try {
 		if (error_pipe) {
@@ -231,6 +515,23 @@ void ChildCloner::runChild(std::optional<Pipe> &error_pipe) {
 			error_pipe->closeReadEnd();
 		}
 
+		if (joinsCGroupManually()) {
+			// clone2() has no CLONE_INTO_CGROUP, join the cgroup
+			// manually. This needs to happen before anything else
+			// for resource limits to apply.
+			try {
+				joinCGroup();
+			} catch (const ApiError &e) {
+				reportPreExecErrorAndExit(*error_pipe,
+						e.errnum(), e.what());
+			}
+
+			if (!m_forward_child_errors) {
+				// closes the write end, which signals success
+				error_pipe.reset();
+			}
+		}
+
 		postFork();
 
 		if (m_allow_no_exe) {
@@ -368,6 +669,22 @@ void ChildCloner::postFork() {
 		}
 	}
 
+	if (m_affinity) {
+		try {
+			proc::set_affinity(*m_affinity);
+		} catch (const std::exception &ex) {
+			print_child_error("sched_setaffinity", ex.what());
+		}
+	}
+
+	if (m_mem_policy) {
+		try {
+			numa::set_mem_policy(*m_mem_policy);
+		} catch (const std::exception &ex) {
+			print_child_error("set_mempolicy", ex.what());
+		}
+	}
+
 	resetSignals();
 
 	if (!m_cwd.empty()) {
@@ -387,6 +704,16 @@ void ChildCloner::postFork() {
 	}
 }
 
+bool ChildCloner::joinsCGroupManually() const {
+	return m_cgroup.valid() && cosmos::running_on_valgrind;
+}
+
+void ChildCloner::joinCGroup() {
+	File procs{DirFD{m_cgroup.raw()}, "cgroup.procs", OpenMode::WRITE_ONLY, OpenFlags{OpenFlag::CLOEXEC}};
+	// writing "0" moves the calling process into the cgroup
+	procs.writeAll(std::string_view{"0"});
+}
+
 void ChildCloner::redirectFD(FileDescriptor orig, FileDescriptor redirect) {
 	if (redirect.invalid())
 		return;
@@ -0,0 +1,228 @@
+// cosmos
+#include <cosmos/error/ApiError.hxx>
+#include <cosmos/error/UsageError.hxx>
+#include <cosmos/error/WouldBlock.hxx>
+#include <cosmos/proc/ChildReaper.hxx>
+#include <cosmos/proc/process.hxx>
+#include <cosmos/proc/signal.hxx>
+#include <cosmos/time/Clock.hxx>
+
+namespace cosmos {
+
+namespace {
+
+MonotonicTime to_monotonic(const IntervalTime interval) {
+	return MonotonicTime{static_cast<const timespec&>(interval)};
+}
+
+} // end anon ns
+
+ChildReaper::ChildReaper(const size_t max_events) :
+		m_poller{max_events},
+		m_timer{MonotonicTimerFD::CreateFlags{
+			MonotonicTimerFD::CreateFlag::CLOEXEC,
+			MonotonicTimerFD::CreateFlag::NONBLOCK}} {
+	m_poller.addFD(m_timer.fd(), {Poller::MonitorFlag::INPUT});
+}
+
+ProcessID ChildReaper::add(SubProc &&proc, const std::optional<Deadline> &deadline) {
+	if (!proc.running()) {
+		throw UsageError{"attempt to add SubProc without running child"};
+	}
+
+	const auto pid = proc.pid();
+	const auto fd = proc.pidFD().raw();
+
+	m_poller.addFD(proc.pidFD(), {Poller::MonitorFlag::INPUT});
+
+	m_children[fd].proc = std::move(proc);
+	m_pids[pid] = fd;
+
+	if (deadline) {
+		setDeadline(pid, *deadline);
+	}
+
+	return pid;
+}
+
+ChildReaper::Child& ChildReaper::getChild(const ProcessID pid) {
+	auto it = m_pids.find(pid);
+
+	if (it == m_pids.end()) {
+		throw UsageError{"no such child process in ChildReaper"};
+	}
+
+	return m_children[it->second];
+}
+
+void ChildReaper::setDeadline(const ProcessID pid, const Deadline &deadline) {
+	auto &child = getChild(pid);
+
+	removeDeadline(child);
+
+	child.signal = deadline.signal;
+	child.kill_after = deadline.kill_after;
+
+	addDeadline(child, MonotonicClock{}.now() + to_monotonic(deadline.timeout));
+	updateTimer();
+}
+
+void ChildReaper::clearDeadline(const ProcessID pid) {
+	removeDeadline(getChild(pid));
+	updateTimer();
+}
+
+void ChildReaper::kill(const ProcessID pid, const Signal signal) {
+	getChild(pid).proc.kill(signal);
+}
+
+void ChildReaper::killAll(const Signal signal) {
+	for (auto &pair: m_children) {
+		try {
+			pair.second.proc.kill(signal);
+		} catch (const ApiError &) {
+			// the child might have exited already
+		}
+	}
+}
+
+void ChildReaper::addDeadline(Child &child, const MonotonicTime when) {
+	child.deadline = m_deadlines.insert(std::make_pair(when, child.proc.pidFD().raw()));
+}
+
+void ChildReaper::removeDeadline(Child &child) {
+	if (child.deadline) {
+		m_deadlines.erase(*child.deadline);
+		child.deadline.reset();
+	}
+}
+
+void ChildReaper::processDeadlines() {
+	try {
+		(void)m_timer.wait();
+	} catch (const WouldBlock &) {
+		// the timer was rearmed in the meantime
+	}
+
+	const auto now = MonotonicClock{}.now();
+
+	while (!m_deadlines.empty() && m_deadlines.begin()->first <= now) {
+		auto &child = m_children[m_deadlines.begin()->second];
+		m_deadlines.erase(m_deadlines.begin());
+		child.deadline.reset();
+		child.expired = true;
+
+		try {
+			child.proc.kill(child.signal);
+		} catch (const ApiError &) {
+			// the child exited in the meantime, it will be reaped
+			// in wait().
+			continue;
+		}
+
+		if (child.kill_after && child.signal != signal::KILL) {
+			child.signal = signal::KILL;
+			addDeadline(child, now + to_monotonic(*child.kill_after));
+		}
+	}
+
+	// the timer expired, thus it is no longer armed
+	m_timer_expiry.reset();
+	updateTimer();
+}
+
+void ChildReaper::updateTimer() {
+	if (m_deadlines.empty()) {
+		if (m_timer_expiry) {
+			m_timer.disarm();
+			m_timer_expiry.reset();
+		}
+		return;
+	}
+
+	const auto &next = m_deadlines.begin()->first;
+
+	if (m_timer_expiry && *m_timer_expiry == next) {
+		return;
+	}
+
+	MonotonicTimerFD::TimerSpec spec;
+	spec.initial() = next;
+	m_timer.setTime(spec, MonotonicTimerFD::StartFlags{MonotonicTimerFD::StartFlag::ABSTIME});
+	m_timer_expiry = next;
+}
+
+void ChildReaper::reap(const FileNum fd, ResultVector &results) {
+	auto it = m_children.find(fd);
+
+	if (it == m_children.end()) {
+		// should not happen, ignore stale events
+		return;
+	}
+
+	auto &child = it->second;
+	Result result;
+
+	result.pid = child.proc.pid();
+	result.deadline_expired = child.expired;
+
+	removeDeadline(child);
+
+	/*
+	 * Closing the pidfd does not reliably end monitoring: other children
+	 * that are currently between fork() and execve() still hold copies of
+	 * it, thus remove it explicitly.
+	 */
+	m_poller.delFD(child.proc.pidFD());
+	// the pidfd is readable, so the child exited and this does not block
+	result.state = child.proc.wait();
+
+	m_pids.erase(result.pid);
+	m_children.erase(it);
+
+	results.push_back(result);
+}
+
+void ChildReaper::wait(ResultVector &results, const std::optional<IntervalTime> timeout) {
+	results.clear();
+
+	if (empty())
+		return;
+
+	std::optional<MonotonicTime> end;
+	std::optional<IntervalTime> left = timeout;
+
+	if (timeout) {
+		end = MonotonicClock{}.now() + to_monotonic(*timeout);
+	}
+
+	while (true) {
+		for (const auto &event: m_poller.wait(left)) {
+			const auto fd = event.fd();
+
+			if (fd == m_timer.fd()) {
+				processDeadlines();
+			} else {
+				reap(fd.raw(), results);
+			}
+		}
+
+		updateTimer();
+
+		if (!results.empty() || empty()) {
+			return;
+		}
+
+		if (end) {
+			const auto now = MonotonicClock{}.now();
+
+			if (*end <= now) {
+				return;
+			}
+
+			left = IntervalTime{static_cast<const timespec&>(*end - now)};
+		}
+	}
+}
+
+} // end ns
@@ -0,0 +1,235 @@
+// C++
+#include <algorithm>
+
+// Linux
+#include <unistd.h>
+
+// cosmos
+#include <cosmos/error/ApiError.hxx>
+#include <cosmos/error/errno.hxx>
+#include <cosmos/error/UsageError.hxx>
+#include <cosmos/error/WouldBlock.hxx>
+#include <cosmos/fs/filesystem.hxx>
+#include <cosmos/proc/ChildCloner.hxx>
+#include <cosmos/proc/OutputCapture.hxx>
+#include <cosmos/utils.hxx>
+
+namespace cosmos {
+
+namespace {
+
+/// Size of the scratch buffer used for reading pipes into memory.
+constexpr size_t READ_CHUNK_SIZE = 64 * 1024;
+
+/// Maximum number of bytes forwarded by a single splice() call.
+constexpr size_t SPLICE_CHUNK_SIZE = 1024 * 1024;
+
+} // end anon ns
+
+OutputCapture::OutputCapture(const std::optional<int> pipe_size, const size_t max_events) :
+		m_poller{max_events},
+		m_pipe_size{pipe_size},
+		m_buffer(READ_CHUNK_SIZE) {
+}
+
+void OutputCapture::setupChannel(Channel &channel, const Target &target) {
+	channel.pipe.emplace();
+	channel.target = target;
+
+	auto read_end = channel.pipe->readEnd();
+
+	if (m_pipe_size) {
+		try {
+			(void)read_end.setPipeSize(*m_pipe_size);
+		} catch (const ApiError &) {
+			// this is only an optimization, e.g. unprivileged
+			// processes cannot exceed /proc/sys/fs/pipe-max-size.
+		}
+	}
+
+	// we never want to block on a single child's pipe
+	read_end.setStatusFlags(OpenFlags{OpenFlag::NONBLOCK});
+}
+
+OutputCapture::Handle OutputCapture::prepare(ChildCloner &cloner,
+		const std::optional<Target> &out, const std::optional<Target> &err) {
+	const auto handle = m_next_handle++;
+	auto &capture = m_captures[handle];
+
+	try {
+		if (out) {
+			setupChannel(capture.out, *out);
+			cloner.setStdOut(capture.out.pipe->writeEnd());
+		}
+
+		if (err) {
+			setupChannel(capture.err, *err);
+			cloner.setStdErr(capture.err.pipe->writeEnd());
+		}
+	} catch (...) {
+		m_captures.erase(handle);
+		throw;
+	}
+
+	return handle;
+}
+
+OutputCapture::Capture& OutputCapture::getCapture(const Handle handle) {
+	auto it = m_captures.find(handle);
+
+	if (it == m_captures.end()) {
+		throw UsageError{"invalid OutputCapture handle"};
+	}
+
+	return it->second;
+}
+
+void OutputCapture::started(const Handle handle) {
+	auto &capture = getCapture(handle);
+
+	if (capture.started) {
+		throw UsageError{"OutputCapture::started() called twice"};
+	}
+
+	capture.started = true;
+	bool any_active = false;
+
+	for (auto [channel, is_err]: {
+			std::make_pair(&capture.out, false),
+			std::make_pair(&capture.err, true)}) {
+		if (!channel->pipe)
+			continue;
+
+		// the child owns the write end now, otherwise we'd never see EOF
+		channel->pipe->closeWriteEnd();
+
+		const auto read_end = channel->pipe->readEnd();
+		m_poller.addFD(read_end, {Poller::MonitorFlag::INPUT});
+		m_fds[read_end.raw()] = std::make_pair(handle, is_err);
+		channel->active = true;
+		any_active = true;
+	}
+
+	if (any_active) {
+		m_num_active++;
+	}
+}
+
+void OutputCapture::discard(const Handle handle) {
+	auto &capture = getCapture(handle);
+
+	if (capture.started && !finished(handle)) {
+		m_num_active--;
+	}
+
+	for (auto *channel: {&capture.out, &capture.err}) {
+		if (channel->active) {
+			finishChannel(*channel);
+		}
+	}
+
+	m_captures.erase(handle);
+}
+
+void OutputCapture::finishChannel(Channel &channel) {
+	const auto read_end = channel.pipe->readEnd();
+	m_poller.delFD(read_end);
+	m_fds.erase(read_end.raw());
+	channel.pipe->closeReadEnd();
+	channel.active = false;
+}
+
+bool OutputCapture::transfer(Channel &channel) {
+	const auto read_end = channel.pipe->readEnd();
+	auto &result = channel.result;
+
+	try {
+		if (channel.target.file.valid()) {
+			const auto spliced = fs::splice(
+					read_end, channel.target.file,
+					SPLICE_CHUNK_SIZE, fs::SpliceFlags{fs::SpliceFlag::MOVE});
+			result.total += spliced;
+			return spliced != 0;
+		}
+
+		const auto bytes = ::read(to_integral(read_end.raw()), m_buffer.data(), m_buffer.size());
+
+		if (bytes < 0) {
+			if (in_list(get_errno(), {Errno::AGAIN, Errno::WOULD_BLOCK, Errno::INTERRUPTED}))
+				// try again in the next round
+				return true;
+			throw ApiError{"read()"};
+		}
+
+		const auto len = static_cast<size_t>(bytes);
+		const auto left = channel.target.max_memory - std::min(channel.target.max_memory, result.data.size());
+
+		result.data.append(m_buffer.data(), std::min(len, left));
+		result.total += len;
+
+		if (len > left) {
+			// keep draining the pipe, but drop the data
+			result.truncated = true;
+		}
+
+		return len != 0;
+	} catch (const WouldBlock &) {
+		return true;
+	}
+}
+
+bool OutputCapture::process(const std::optional<IntervalTime> timeout) {
+	if (m_fds.empty()) {
+		return false;
+	}
+
+	const auto events = m_poller.wait(timeout);
+
+	for (const auto &event: events) {
+		auto it = m_fds.find(event.fd().raw());
+
+		if (it == m_fds.end())
+			// already finished in this round
+			continue;
+
+		const auto [handle, is_err] = it->second;
+		auto &capture = m_captures[handle];
+		auto &channel = is_err ? capture.err : capture.out;
+
+		if (!transfer(channel)) {
+			finishChannel(channel);
+
+			if (finished(handle)) {
+				m_num_active--;
+			}
+		}
+	}
+
+	return !events.empty();
+}
+
+bool OutputCapture::finished(const Handle handle) const {
+	auto it = m_captures.find(handle);
+
+	if (it == m_captures.end()) {
+		throw UsageError{"invalid OutputCapture handle"};
+	}
+
+	const auto &capture = it->second;
+
+	return capture.started && !capture.out.active && !capture.err.active;
+}
+
+OutputCapture::Result OutputCapture::take(const Handle handle) {
+	if (!finished(handle)) {
+		throw UsageError{"attempt to take() unfinished OutputCapture"};
+	}
+
+	auto &capture = getCapture(handle);
+	Result ret{std::move(capture.out.result), std::move(capture.err.result)};
+	m_captures.erase(handle);
+
+	return ret;
+}
+
+} // end ns
@@ -1,9 +1,11 @@
 // Cosmos
 #include <cosmos/error/ApiError.hxx>
+#include <cosmos/error/RuntimeError.hxx>
 #include <cosmos/error/UsageError.hxx>
 #include <cosmos/private/Scheduler.hxx>
 #include <cosmos/proc/Scheduler.hxx>
 #include <cosmos/memory.hxx>
+#include <cosmos/utils.hxx>
 
 // Linux
 #include <sys/syscall.h>
@@ -12,6 +14,24 @@ namespace cosmos {
 
 constexpr int OtherSchedulerSettings::INVALID_NICE_PRIO = OtherSchedulerSettings::maxNiceValue() + 1;
 
+namespace {
+
+/// The first sched_attr version containing the utilization clamp fields.
+constexpr uint32_t SCHED_ATTR_SIZE_VER1 = 56;
+
+/// The flags we take over from sched_getattr().
+const SchedulerFlags LOADED_FLAGS{
+	SchedulerFlag::RESET_ON_FORK,
+	SchedulerFlag::RECLAIM,
+	SchedulerFlag::DL_OVERRUN
+};
+
+} // end anon ns
+
+void load_scheduler_settings(SchedulerSettings &settings, const sched_attr &attr) {
+	settings.loadStruct(attr);
+}
+
 void SchedulerSettings::apply(ProcessID pid) const {
 	struct sched_attr attrs;
 	this->fillStruct(attrs);
@@ -22,7 +42,7 @@ void SchedulerSettings::apply(ProcessID pid) const {
 	//
 	// the POSIX interface sched_setscheduler is probably available, but
 	// only supports the priority property and FIFO/RR, nothing else.
-	if (::syscall(__NR_sched_setattr, pid, &attrs, 0) != 0) {
+	if (::syscall(__NR_sched_setattr, to_integral(pid), &attrs, 0) != 0) {
 		throw ApiError{"sched_setattr()"};
 	}
 }
@@ -54,6 +74,28 @@ void SchedulerSettings::fillStruct(sched_attr &attr) const {
 	zero_object(attr);
 	attr.size = sizeof(attr);
 	attr.sched_policy = static_cast<int>(m_policy);
+	attr.sched_flags = m_flags.raw();
+
+	if (m_util_clamp) {
+		attr.sched_flags |= SchedulerFlags{
+			SchedulerFlag::UTIL_CLAMP_MIN, SchedulerFlag::UTIL_CLAMP_MAX}.raw();
+		attr.sched_util_min = m_util_clamp->min;
+		attr.sched_util_max = m_util_clamp->max;
+	}
+}
+
+void SchedulerSettings::loadStruct(const sched_attr &attr) {
+	m_flags = SchedulerFlags{attr.sched_flags} & LOADED_FLAGS;
+
+	// older kernels don't report the utilization clamp fields, also
+	// only report non-default clamp values, to avoid errors when
+	// applying loaded settings on kernels without util clamp support.
+	if (attr.size >= SCHED_ATTR_SIZE_VER1 &&
+			(attr.sched_util_min != 0 || attr.sched_util_max != MAX_UTILIZATION)) {
+		m_util_clamp = UtilClamp{attr.sched_util_min, attr.sched_util_max};
+	} else {
+		m_util_clamp.reset();
+	}
 }
 
 void OtherSchedulerSettings::fillStruct(sched_attr &attr) const {
@@ -61,9 +103,62 @@ void OtherSchedulerSettings::fillStruct(sched_attr &attr) const {
 	attr.sched_nice = m_nice_prio;
 }
 
+void OtherSchedulerSettings::loadStruct(const sched_attr &attr) {
+	SchedulerSettings::loadStruct(attr);
+	m_nice_prio = attr.sched_nice;
+}
+
 void RealTimeSchedulerSettings::fillStruct(sched_attr &attr) const {
 	SchedulerSettings::fillStruct(attr);
 	attr.sched_priority = m_priority;
 }
 
+void RealTimeSchedulerSettings::loadStruct(const sched_attr &attr) {
+	SchedulerSettings::loadStruct(attr);
+	m_priority = static_cast<int>(attr.sched_priority);
+}
+
+void IdleSchedulerSettings::fillStruct(sched_attr &attr) const {
+	SchedulerSettings::fillStruct(attr);
+}
+
+void DeadlineSchedulerSettings::fillStruct(sched_attr &attr) const {
+	SchedulerSettings::fillStruct(attr);
+	attr.sched_runtime = static_cast<uint64_t>(m_runtime.count());
+	attr.sched_deadline = static_cast<uint64_t>(m_deadline.count());
+	attr.sched_period = static_cast<uint64_t>(m_period.count());
+}
+
+void DeadlineSchedulerSettings::loadStruct(const sched_attr &attr) {
+	SchedulerSettings::loadStruct(attr);
+	m_runtime = std::chrono::nanoseconds{attr.sched_runtime};
+	m_deadline = std::chrono::nanoseconds{attr.sched_deadline};
+	m_period = std::chrono::nanoseconds{attr.sched_period};
+}
+
+SchedulerSettingsVariant get_scheduler_settings(const ProcessID pid) {
+	struct sched_attr attr;
+	zero_object(attr);
+
+	// like sched_setattr() there's no wrapper for this in glibc
+	if (::syscall(__NR_sched_getattr, to_integral(pid), &attr, sizeof(attr), 0) != 0) {
+		throw ApiError{"sched_getattr()"};
+	}
+
+	auto load = [&attr]<typename SETTINGS>(SETTINGS &&settings) -> SchedulerSettingsVariant {
+		load_scheduler_settings(settings, attr);
+		return settings;
+	};
+
+	switch (SchedulerPolicy{static_cast<int>(attr.sched_policy)}) {
+		case SchedulerPolicy::OTHER: return load(OtherSchedulerSettings{});
+		case SchedulerPolicy::FIFO: return load(FifoSchedulerSettings{});
+		case SchedulerPolicy::ROUND_ROBIN: return load(RoundRobinSchedulerSettings{});
+		case SchedulerPolicy::BATCH: return load(BatchSchedulerSettings{});
+		case SchedulerPolicy::IDLE: return load(IdleSchedulerSettings{});
+		case SchedulerPolicy::DEADLINE: return load(DeadlineSchedulerSettings{});
+		default: throw RuntimeError{"sched_getattr() returned unknown policy"};
+	}
+}
+
 } // end ns
@@ -0,0 +1,144 @@
+// Linux
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+
+// cosmos
+#include <cosmos/error/ApiError.hxx>
+#include <cosmos/error/RuntimeError.hxx>
+#include <cosmos/net/message_header.hxx>
+#include <cosmos/net/unix/aux.hxx>
+#include <cosmos/proc/SeccompListener.hxx>
+
+namespace cosmos::seccomp {
+
+void Listener::receive(Notification &notif) {
+	// the kernel requires the structure to be zeroed
+	notif.clear();
+
+	if (::ioctl(to_integral(m_fd.raw()), SECCOMP_IOCTL_NOTIF_RECV, notif.raw()) != 0) {
+		throw ApiError{"ioctl(SECCOMP_IOCTL_NOTIF_RECV)"};
+	}
+}
+
+void Listener::respond(const Response &resp) {
+	if (::ioctl(to_integral(m_fd.raw()), SECCOMP_IOCTL_NOTIF_SEND, resp.raw()) != 0) {
+		throw ApiError{"ioctl(SECCOMP_IOCTL_NOTIF_SEND)"};
+	}
+}
+
+bool Listener::isValid(const Notification &notif) {
+	auto id = notif.id();
+
+	if (::ioctl(to_integral(m_fd.raw()), SECCOMP_IOCTL_NOTIF_ID_VALID, &id) == 0) {
+		return true;
+	} else if (get_errno() == Errno::NO_ENTRY) {
+		return false;
+	}
+
+	throw ApiError{"ioctl(SECCOMP_IOCTL_NOTIF_ID_VALID)"};
+}
+
+namespace {
+
+FileNum add_fd(const FileDescriptor listener, struct seccomp_notif_addfd &addfd) {
+	const auto res = ::ioctl(to_integral(listener.raw()), SECCOMP_IOCTL_NOTIF_ADDFD, &addfd);
+
+	if (res < 0) {
+		throw ApiError{"ioctl(SECCOMP_IOCTL_NOTIF_ADDFD)"};
+	}
+
+	return FileNum{res};
+}
+
+struct seccomp_notif_addfd make_addfd(const Notification &notif, const FileDescriptor fd,
+		const CloseOnExec cloexec) {
+	struct seccomp_notif_addfd addfd;
+	zero_object(addfd);
+	addfd.id = notif.id();
+	addfd.srcfd = static_cast<uint32_t>(to_integral(fd.raw()));
+	addfd.newfd_flags = cloexec ? O_CLOEXEC : 0;
+	return addfd;
+}
+
+} // end anon ns
+
+FileNum Listener::addFD(const Notification &notif, const FileDescriptor fd,
+		const CloseOnExec cloexec, const std::optional<FileNum> target) {
+	auto addfd = make_addfd(notif, fd, cloexec);
+
+	if (target) {
+		addfd.flags = SECCOMP_ADDFD_FLAG_SETFD;
+		addfd.newfd = static_cast<uint32_t>(to_integral(*target));
+	}
+
+	return add_fd(m_fd, addfd);
+}
+
+FileNum Listener::respondWithFD(const Notification &notif, const FileDescriptor fd,
+		const CloseOnExec cloexec) {
+	auto addfd = make_addfd(notif, fd, cloexec);
+	addfd.flags = SECCOMP_ADDFD_FLAG_SEND;
+
+	return add_fd(m_fd, addfd);
+}
+
+void send_listener(UnixConnection &conn, FileDescriptor listener) {
+	// at least one byte of payload is needed for stream sockets
+	const char payload = '\0';
+	SendMessageHeader msg;
+	// don't get killed by SIGPIPE if the supervisor is gone
+	msg.setIOFlags(MessageFlags{MessageFlag::NO_SIGNAL});
+	msg.iovec.push_back(OutputMemoryRegion{&payload, sizeof(payload)});
+
+	UnixRightsMessage rights;
+	rights.addFD(listener.raw());
+	msg.control_msg = rights.serialize();
+
+	try {
+		conn.sendMessage(msg);
+	} catch (...) {
+		listener.close();
+		throw;
+	}
+
+	listener.close();
+}
+
+Listener receive_listener(UnixConnection &conn) {
+	char payload;
+	ReceiveMessageHeader msg;
+	msg.setControlBufferSize(CMSG_SPACE(sizeof(FileNum)));
+	msg.iovec.push_back(InputMemoryRegion{&payload, sizeof(payload)});
+
+	conn.receiveMessage(msg);
+
+	Listener ret;
+
+	for (const auto &ctrl_msg: msg) {
+		if (ctrl_msg.asUnixMessage() != UnixMessage::RIGHTS)
+			continue;
+
+		UnixRightsMessage rights;
+		rights.deserialize(ctrl_msg);
+		UnixRightsMessage::FileNumVector fds;
+		rights.takeFDs(fds);
+
+		for (const auto fd: fds) {
+			if (ret.isOpen()) {
+				// unexpected extra descriptors
+				FileDescriptor{fd}.close();
+			} else {
+				ret = Listener{FileDescriptor{fd}};
+			}
+		}
+	}
+
+	if (!ret.isOpen()) {
+		throw RuntimeError{"no seccomp listener received"};
+	}
+
+	return ret;
+}
+
+} // end ns
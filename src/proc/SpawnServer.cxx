@@ -0,0 +1,596 @@
+// C++
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+// Linux
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// cosmos
+#include <cosmos/BitMask.hxx>
+#include <cosmos/error/ApiError.hxx>
+#include <cosmos/error/RuntimeError.hxx>
+#include <cosmos/error/UsageError.hxx>
+#include <cosmos/formatting.hxx>
+#include <cosmos/net/network.hxx>
+#include <cosmos/private/cosmos.hxx>
+#include <cosmos/private/Scheduler.hxx>
+#include <cosmos/proc/ChildCloner.hxx>
+#include <cosmos/proc/process.hxx>
+#include <cosmos/proc/SpawnServer.hxx>
+#include <cosmos/utils.hxx>
+
+namespace cosmos {
+
+namespace {
+
+/// Header preceding each spawn request on the wire.
+struct RequestHeader {
+	/// Number of payload bytes following the header.
+	uint32_t length = 0;
+	/// Number of file descriptors attached to the request.
+	uint32_t num_fds = 0;
+};
+
+/// Header preceding each reply to a spawn request on the wire.
+struct ReplyHeader {
+	enum class Status : uint32_t {
+		OK,
+		API_ERROR,
+		OTHER_ERROR
+	};
+
+	Status status = Status::OK;
+	/// The error code for Status::API_ERROR.
+	Errno error = Errno::NO_ERROR;
+	/// The PID of the new child for Status::OK, its pidfd is attached.
+	ProcessID pid = ProcessID::INVALID;
+	/// Length of the error message following the header.
+	uint32_t length = 0;
+};
+
+/// Optional parts of a spawn request.
+enum class RequestFlag : uint32_t {
+	HAVE_ENV       = 1 << 0,
+	HAVE_SCHED     = 1 << 1,
+	HAVE_STDIN     = 1 << 2,
+	HAVE_STDOUT    = 1 << 3,
+	HAVE_STDERR    = 1 << 4,
+	HAVE_AFFINITY  = 1 << 5,
+	HAVE_MEMPOLICY = 1 << 6,
+	HAVE_CGROUP    = 1 << 7
+};
+
+using RequestFlags = BitMask<RequestFlag>;
+
+/// Serializes spawn requests into a flat buffer.
+class Encoder {
+public:
+	void addRaw(const void *data, const size_t length) {
+		m_data.append(reinterpret_cast<const char*>(data), length);
+	}
+
+	void addInt(const uint32_t val) {
+		addRaw(&val, sizeof(val));
+	}
+
+	void addString(const std::string_view str) {
+		addInt(static_cast<uint32_t>(str.size()));
+		addRaw(str.data(), str.size());
+	}
+
+	void addStrings(const StringVector &strs) {
+		addInt(static_cast<uint32_t>(strs.size()));
+		for (const auto &str: strs) {
+			addString(str);
+		}
+	}
+
+	const std::string& data() const {
+		return m_data;
+	}
+
+protected:
+	std::string m_data;
+};
+
+/// Deserializes spawn requests produced by Encoder.
+class Decoder {
+public:
+	explicit Decoder(const std::string &data) :
+			m_data{data} {}
+
+	void getRaw(void *out, const size_t length) {
+		checkLeft(length);
+		std::memcpy(out, m_data.data() + m_pos, length);
+		m_pos += length;
+	}
+
+	uint32_t getInt() {
+		uint32_t ret;
+		getRaw(&ret, sizeof(ret));
+		return ret;
+	}
+
+	std::string getString() {
+		const auto length = getInt();
+		checkLeft(length);
+		auto ret = m_data.substr(m_pos, length);
+		m_pos += length;
+		return ret;
+	}
+
+	StringVector getStrings() {
+		StringVector ret;
+		for (auto num = getInt(); num != 0; num--) {
+			ret.push_back(getString());
+		}
+		return ret;
+	}
+
+protected:
+	void checkLeft(const size_t length) const {
+		if (m_data.size() - m_pos < length) {
+			throw RuntimeError{"truncated spawn request"};
+		}
+	}
+
+protected:
+	const std::string &m_data;
+	size_t m_pos = 0;
+};
+
+/// Owner of file descriptors received from the peer, closes them unless taken.
+class ReceivedFDs {
+public:
+	~ReceivedFDs() {
+		for (auto fd: m_fds) {
+			try {
+				FileDescriptor{fd}.close();
+			} catch (...) {}
+		}
+	}
+
+	UnixRightsMessage::FileNumVector& fds() {
+		return m_fds;
+	}
+
+	FileNum take(const size_t index) {
+		const auto ret = m_fds.at(index);
+		m_fds.erase(m_fds.begin() + index);
+		return ret;
+	}
+
+protected:
+	UnixRightsMessage::FileNumVector m_fds;
+};
+
+/// Send `header` followed by `payload` and optionally the file descriptors in `fds`.
+template <typename HEADER>
+void send_message(UnixConnection &conn, const HEADER &header, const std::string_view payload,
+		const UnixRightsMessage::FileNumVector &fds = {}) {
+	SendMessageHeader msg;
+	// don't get killed by SIGPIPE if the peer is gone
+	msg.setIOFlags(MessageFlags{MessageFlag::NO_SIGNAL});
+	msg.iovec.push_back(OutputMemoryRegion{&header, sizeof(header)});
+
+	if (!payload.empty()) {
+		msg.iovec.push_back(OutputMemoryRegion{payload.data(), payload.size()});
+	}
+
+	if (!fds.empty()) {
+		UnixRightsMessage rights;
+		for (const auto fd: fds) {
+			rights.addFD(fd);
+		}
+		msg.control_msg = rights.serialize();
+	}
+
+	// partial sends are possible, the control message is only sent once
+	while (msg.iovec.leftBytes() != 0) {
+		conn.sendMessage(msg);
+	}
+}
+
+/// Receive a header of type HEADER and any file descriptors attached to it.
+/**
+ * Returns `false` if the peer closed the connection.
+ **/
+template <typename HEADER>
+bool receive_header(UnixConnection &conn, HEADER &header, ReceivedFDs &fds) {
+	ReceiveMessageHeader msg;
+	msg.setControlBufferSize(CMSG_SPACE(sizeof(FileNum) * UnixRightsMessage::MAX_FDS));
+	msg.iovec.push_back(InputMemoryRegion{&header, sizeof(header)});
+
+	conn.receiveMessage(msg);
+
+	const auto left = msg.iovec.leftBytes();
+
+	if (left == sizeof(header)) {
+		return false;
+	}
+
+	for (const auto &ctrl_msg: msg) {
+		if (ctrl_msg.asUnixMessage() == UnixMessage::RIGHTS) {
+			UnixRightsMessage rights;
+			rights.deserialize(ctrl_msg);
+			UnixRightsMessage::FileNumVector received;
+			rights.takeFDs(received);
+			fds.fds().insert(fds.fds().end(), received.begin(), received.end());
+		}
+	}
+
+	if (msg.flags()[MessageFlag::CTL_WAS_TRUNCATED]) {
+		throw RuntimeError{"spawn server control message was truncated"};
+	}
+
+	if (left != 0) {
+		conn.readAll(reinterpret_cast<char*>(&header) + sizeof(header) - left, left);
+	}
+
+	return true;
+}
+
+/// Returns whether `error` indicates that the peer closed the connection.
+bool peer_gone(const ApiError &error) {
+	switch (error.errnum()) {
+		case Errno::BROKEN_PIPE:
+		case Errno::CONN_RESET:
+			return true;
+		default:
+			return false;
+	}
+}
+
+/// Send a spawn request to the helper and receive its reply.
+/**
+ * Returns `false` if the helper process is gone. In this case the request
+ * has not been processed and can safely be retried.
+ **/
+bool exchange(UnixConnection &conn, const RequestHeader &request, const std::string_view payload,
+		const UnixRightsMessage::FileNumVector &fds,
+		ReplyHeader &reply, ReceivedFDs &received, std::string &message) {
+	try {
+		send_message(conn, request, payload, fds);
+
+		if (!receive_header(conn, reply, received)) {
+			return false;
+		}
+	} catch (const ApiError &ex) {
+		if (peer_gone(ex))
+			return false;
+		throw;
+	}
+
+	message.resize(reply.length);
+
+	try {
+		conn.readAll(message.data(), message.size());
+	} catch (const ApiError &ex) {
+		if (peer_gone(ex))
+			return false;
+		throw;
+	} catch (const RuntimeError &) {
+		// unexpected EOF, a message is only sent for failed requests
+		return false;
+	}
+
+	return true;
+}
+
+} // end anon ns
+
+SpawnServer::~SpawnServer() {
+	try {
+		stop();
+	} catch (const std::exception &ex) {
+		std::cerr << "WARNING: failed to stop SpawnServer: " << ex.what() << "\n";
+	}
+}
+
+void SpawnServer::start() {
+	if (running()) {
+		throw UsageError{"SpawnServer is already running"};
+	} else if (cosmos::running_on_valgrind) {
+		// the helper can only create siblings via clone3(), see class docs.
+		return;
+	}
+
+	auto sockets = net::create_stream_socket_pair();
+	auto &parent_end = sockets.first;
+	auto &helper_end = sockets.second;
+
+	ChildCloner cloner;
+	cloner.setNoExe();
+	cloner.setPostForkCB([&parent_end, &helper_end](const ChildCloner&) {
+		parent_end.close();
+		serve(helper_end);
+	});
+
+	m_helper = cloner.run();
+	helper_end.close();
+	m_conn = std::move(parent_end);
+}
+
+void SpawnServer::stop() {
+	if (!running())
+		return;
+
+	// this causes the helper to exit
+	m_conn.close();
+	(void)m_helper.wait();
+}
+
+SubProc SpawnServer::spawn(const ChildCloner &cloner) {
+	UnixRightsMessage::FileNumVector fds;
+	const auto payload = encodeRequest(cloner, fds);
+
+	MutexGuard g{m_lock};
+
+	if (!running()) {
+		ChildCloner copy{cloner};
+		return copy.run();
+	}
+
+	const RequestHeader request{static_cast<uint32_t>(payload.size()), static_cast<uint32_t>(fds.size())};
+	ReplyHeader reply;
+	ReceivedFDs received;
+	std::string message;
+
+	if (!exchange(m_conn, request, payload, fds, reply, received, message)) {
+		// the helper is gone, reap it and create the child directly
+		stop();
+		ChildCloner copy{cloner};
+		return copy.run();
+	}
+
+	switch (reply.status) {
+		case ReplyHeader::Status::OK:
+			if (received.fds().size() != 1) {
+				throw RuntimeError{"SpawnServer reply lacks child pidfd"};
+			}
+			return SubProc{reply.pid, PidFD{received.take(0)}};
+		case ReplyHeader::Status::API_ERROR: {
+			// the message was already generated in the helper
+			ApiError error{"", reply.error};
+			error.setMessage(message);
+			throw error;
+		}
+		default:
+			throw RuntimeError{message};
+	}
+}
+
+void SpawnServer::serve(UnixConnection &conn) {
+	while (true) {
+		RequestHeader request;
+		ReceivedFDs fds;
+
+		if (!receive_header(conn, request, fds)) {
+			// the parent closed the connection
+			return;
+		}
+
+		std::string payload;
+		payload.resize(request.length);
+		conn.readAll(payload.data(), payload.size());
+
+		ReplyHeader reply;
+		std::string message;
+		SubProc proc;
+
+		try {
+			if (fds.fds().size() != request.num_fds) {
+				throw RuntimeError{"spawn request with mismatching number of FDs"};
+			}
+
+			proc = runRequest(payload, fds.fds());
+			reply.pid = proc.pid();
+		} catch (const ApiError &ex) {
+			reply.status = ReplyHeader::Status::API_ERROR;
+			reply.error = ex.errnum();
+			message = ex.what();
+		} catch (const std::exception &ex) {
+			reply.status = ReplyHeader::Status::OTHER_ERROR;
+			message = ex.what();
+		}
+
+		reply.length = static_cast<uint32_t>(message.size());
+
+		try {
+			if (proc.running()) {
+				send_message(conn, reply, message, {proc.pidFD().raw()});
+			} else {
+				send_message(conn, reply, message);
+			}
+		} catch (...) {
+			proc.reset();
+			throw;
+		}
+
+		// the child is our sibling, the parent takes care of it
+		proc.reset();
+	}
+}
+
+std::string SpawnServer::encodeRequest(const ChildCloner &cloner, UnixRightsMessage::FileNumVector &fds) {
+	if (cloner.m_allow_no_exe || cloner.m_post_fork_cb) {
+		throw UsageError{"SpawnServer does not support post fork callbacks"};
+	} else if (cloner.m_forward_child_errors) {
+		throw UsageError{"SpawnServer does not support forwarding child errors"};
+	} else if (!cloner.hasExe() || cloner.m_argv.empty()) {
+		throw UsageError{
+			"attempted to spawn a sub process w/o specifying an executable path and/or argv0"
+		};
+	}
+
+	RequestFlags flags;
+
+	if (cloner.m_env)
+		flags.set(RequestFlag::HAVE_ENV);
+	if (cloner.m_sched_settings)
+		flags.set(RequestFlag::HAVE_SCHED);
+	if (cloner.m_affinity)
+		flags.set(RequestFlag::HAVE_AFFINITY);
+	if (cloner.m_mem_policy)
+		flags.set(RequestFlag::HAVE_MEMPOLICY);
+
+	for (const auto &[fd, flag]: {
+			std::make_pair(cloner.m_stdin, RequestFlag::HAVE_STDIN),
+			std::make_pair(cloner.m_stdout, RequestFlag::HAVE_STDOUT),
+			std::make_pair(cloner.m_stderr, RequestFlag::HAVE_STDERR)}) {
+		if (fd.valid()) {
+			flags.set(flag);
+			fds.push_back(fd.raw());
+		}
+	}
+
+	if (cloner.m_cgroup.valid()) {
+		flags.set(RequestFlag::HAVE_CGROUP);
+		fds.push_back(cloner.m_cgroup.raw());
+	}
+
+	Encoder enc;
+	enc.addInt(flags.raw());
+	enc.addString(cloner.m_executable);
+	enc.addStrings(cloner.m_argv);
+
+	if (cloner.m_env) {
+		enc.addStrings(*cloner.m_env);
+	}
+
+	enc.addString(cloner.m_cwd);
+
+	if (cloner.m_sched_settings) {
+		struct sched_attr attr;
+		std::visit([&attr](auto &&sched_settings) {
+			const SchedulerSettings &base = sched_settings;
+			base.fillStruct(attr);
+		}, *cloner.m_sched_settings);
+		enc.addRaw(&attr, sizeof(attr));
+	}
+
+	if (cloner.m_affinity) {
+		enc.addRaw(cloner.m_affinity->raw(), CPUSet::size());
+	}
+
+	if (const auto &policy = cloner.m_mem_policy; policy) {
+		enc.addInt(static_cast<uint32_t>(policy->policy));
+		enc.addInt(policy->flags.raw());
+		enc.addInt(static_cast<uint32_t>(policy->nodes.size()));
+		for (const auto node: policy->nodes) {
+			enc.addInt(node);
+		}
+	}
+
+	enc.addInt(static_cast<uint32_t>(cloner.m_inherit_fds.size()));
+
+	for (const auto fd: cloner.m_inherit_fds) {
+		enc.addInt(static_cast<uint32_t>(to_integral(fd.raw())));
+		fds.push_back(fd.raw());
+	}
+
+	if (fds.size() > UnixRightsMessage::MAX_FDS) {
+		throw UsageError{"too many file descriptors for SpawnServer request"};
+	}
+
+	return enc.data();
+}
+
+SubProc SpawnServer::runRequest(const std::string &payload, const UnixRightsMessage::FileNumVector &fds) {
+	Decoder dec{payload};
+	const RequestFlags flags{dec.getInt()};
+	size_t next_fd = 0;
+
+	auto take_fd = [&fds, &next_fd]() {
+		if (next_fd >= fds.size()) {
+			throw RuntimeError{"spawn request lacks file descriptors"};
+		}
+		return FileDescriptor{fds[next_fd++]};
+	};
+
+	ChildCloner cloner;
+	// make the child a child of our parent, which sent the request
+	cloner.m_share_parent = true;
+
+	const auto exe = dec.getString();
+	cloner.setArgs(dec.getStrings());
+	cloner.m_executable = exe;
+
+	if (flags[RequestFlag::HAVE_ENV]) {
+		cloner.setEnv(dec.getStrings());
+	}
+
+	cloner.setCWD(dec.getString());
+
+	std::optional<struct sched_attr> sched;
+
+	if (flags[RequestFlag::HAVE_SCHED]) {
+		sched.emplace();
+		dec.getRaw(&*sched, sizeof(*sched));
+	}
+
+	if (flags[RequestFlag::HAVE_AFFINITY]) {
+		CPUSet cpus;
+		dec.getRaw(cpus.raw(), CPUSet::size());
+		cloner.setAffinity(cpus);
+	}
+
+	if (flags[RequestFlag::HAVE_MEMPOLICY]) {
+		numa::MemPolicySettings policy;
+		policy.policy = numa::MemPolicy{static_cast<int>(dec.getInt())};
+		policy.flags = numa::MemPolicyFlags{dec.getInt()};
+		for (auto num = dec.getInt(); num != 0; num--) {
+			policy.nodes.push_back(dec.getInt());
+		}
+		cloner.setMemPolicy(policy);
+	}
+
+	if (flags[RequestFlag::HAVE_STDIN])
+		cloner.setStdIn(take_fd());
+	if (flags[RequestFlag::HAVE_STDOUT])
+		cloner.setStdOut(take_fd());
+	if (flags[RequestFlag::HAVE_STDERR])
+		cloner.setStdErr(take_fd());
+	if (flags[RequestFlag::HAVE_CGROUP])
+		// applied via clone3() in the helper process already
+		cloner.setCGroup(take_fd());
+
+	std::vector<std::pair<FileDescriptor, FileNum>> inherit;
+	int highest = to_integral(FileNum::STDERR);
+
+	for (auto num = dec.getInt(); num != 0; num--) {
+		const auto target = static_cast<int>(dec.getInt());
+		inherit.emplace_back(take_fd(), FileNum{target});
+		highest = std::max(highest, target);
+	}
+
+	cloner.setPostForkCB([&inherit, &sched, highest](const ChildCloner&) {
+		if (sched && ::syscall(__NR_sched_setattr, 0, &*sched, 0) != 0) {
+			// treat this as non-critical, like in ChildCloner::postFork()
+			std::cerr << "[" << proc::get_own_pid() << "]sched_setattr: "
+				<< ApiError{"sched_setattr()"}.what() << std::endl;
+		}
+
+		/*
+		 * The received FDs have different numbers than in the parent.
+		 * First move them out of the way of the target numbers to
+		 * avoid overwriting FDs still to be processed.
+		 */
+		for (auto &entry: inherit) {
+			entry.first = entry.first.duplicate(FileNum{highest + 1});
+		}
+
+		for (const auto &[fd, target]: inherit) {
+			fd.duplicate(FileDescriptor{target}, CloseOnExec{false});
+		}
+	});
+
+	return cloner.run();
+}
+
+} // end ns
@@ -1,11 +1,16 @@
+// Linux
+#include <poll.h>
+
 // cosmos
 #include <cosmos/error/ApiError.hxx>
+#include <cosmos/error/errno.hxx>
 #include <cosmos/error/UsageError.hxx>
-#include <cosmos/io/Poller.hxx>
 #include <cosmos/private/cosmos.hxx>
 #include <cosmos/proc/process.hxx>
 #include <cosmos/proc/signal.hxx>
 #include <cosmos/proc/SubProc.hxx>
+#include <cosmos/time/Clock.hxx>
+#include <cosmos/utils.hxx>
 
 namespace cosmos {
 
@@ -53,12 +58,39 @@ ChildState SubProc::wait(const WaitFlags flags) {
 }
 
 std::optional<ChildState> SubProc::waitTimed(const IntervalTime max, const WaitFlags flags) {
-	Poller poller(8);
+	/*
+	 * For a single file descriptor a plain ppoll() is cheaper than
+	 * setting up a Poller, which requires three extra system calls. For
+	 * waiting on many children use ChildReaper instead.
+	 */
+	struct pollfd pfd{};
+	pfd.fd = to_integral(m_child_fd.raw());
+	pfd.events = POLLIN;
+
+	// restarts after signals must not extend the overall wait time
+	const auto end = MonotonicClock{}.now() + MonotonicTime{static_cast<const timespec&>(max)};
+	IntervalTime left = max;
+
+	while (true) {
+		const auto res = ::ppoll(&pfd, 1, &left, nullptr);
+
+		if (res < 0) {
+			if (auto_restart_syscalls && get_errno() == Errno::INTERRUPTED) {
+				const auto now = MonotonicClock{}.now();
 
-	poller.addFD(m_child_fd, {Poller::MonitorFlag::INPUT});
+				if (end <= now) {
+					return std::nullopt;
+				}
+
+				left = IntervalTime{static_cast<const timespec&>(end - now)};
+				continue;
+			}
+			throw ApiError{"ppoll()"};
+		} else if (res == 0) {
+			return std::nullopt;
+		}
 
-	if (poller.wait(max).empty()) {
-		return std::nullopt;
+		break;
 	}
 
 	return wait(flags);
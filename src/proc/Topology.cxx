@@ -0,0 +1,247 @@
+// C++
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+
+// cosmos
+#include <cosmos/error/RuntimeError.hxx>
+#include <cosmos/error/UsageError.hxx>
+#include <cosmos/proc/Topology.hxx>
+#include <cosmos/string.hxx>
+
+namespace cosmos {
+
+namespace {
+
+/// Returns the stripped first line of the given sysfs file, if it can be read.
+std::optional<std::string> read_attr(const std::string &path) {
+	std::ifstream file{path};
+	std::string line;
+
+	if (!file)
+		return std::nullopt;
+
+	// empty attributes like "isolated" are valid
+	std::getline(file, line);
+	strip(line);
+	return line;
+}
+
+template <typename INT>
+std::optional<INT> parse_int(const std::string_view str) {
+	INT ret{};
+	const auto end = str.data() + str.size();
+	const auto [ptr, ec] = std::from_chars(str.data(), end, ret);
+
+	if (ec != std::errc{} || ptr != end)
+		return std::nullopt;
+
+	return ret;
+}
+
+template <typename INT>
+std::optional<INT> read_int(const std::string &path) {
+	if (const auto val = read_attr(path); val) {
+		return parse_int<INT>(*val);
+	}
+
+	return std::nullopt;
+}
+
+/// Reads a CPU list file, missing files result in an empty set.
+CPUSet read_cpus(const std::string &path) {
+	const auto list = read_attr(path);
+
+	// nohz_full reports this if the feature is compiled in but unused
+	if (!list || *list == "(null)")
+		return CPUSet{};
+
+	return CPUSet::fromList(*list);
+}
+
+/// Parses cache sizes like "48K" or "2M".
+size_t parse_size(const std::string_view str) {
+	if (str.empty())
+		return 0;
+
+	size_t factor = 1;
+	auto number = str;
+
+	switch (str.back()) {
+		case 'K': factor = 1024; break;
+		case 'M': factor = 1024 * 1024; break;
+		case 'G': factor = 1024 * 1024 * 1024; break;
+		default: break;
+	}
+
+	if (factor != 1)
+		number.remove_suffix(1);
+
+	return parse_int<size_t>(number).value_or(0) * factor;
+}
+
+Topology::CacheType parse_cache_type(const std::string_view type) {
+	if (type == "Data")
+		return Topology::CacheType::DATA;
+	else if (type == "Instruction")
+		return Topology::CacheType::INSTRUCTION;
+	else if (type == "Unified")
+		return Topology::CacheType::UNIFIED;
+
+	return Topology::CacheType::UNKNOWN;
+}
+
+} // end anon ns
+
+Topology::Topology(const std::string_view sysfs_root) {
+	const std::string cpu_base = std::string{sysfs_root} + "/cpu";
+
+	const auto online = read_attr(cpu_base + "/online");
+
+	if (!online) {
+		throw RuntimeError{"failed to determine online CPUs from " + cpu_base};
+	}
+
+	m_online = CPUSet::fromList(*online);
+	m_isolated = read_cpus(cpu_base + "/isolated") & m_online;
+	m_nohz_full = read_cpus(cpu_base + "/nohz_full") & m_online;
+
+	for (const auto nr: m_online.cpus()) {
+		auto &cpu = m_cpus.emplace_back();
+		cpu.nr = nr;
+		parseCPU(cpu_base + "/cpu" + std::to_string(nr), cpu);
+	}
+
+	parseNodes(std::string{sysfs_root} + "/node");
+}
+
+void Topology::parseCPU(const std::string &base, CPU &cpu) {
+	const auto topo = base + "/topology";
+
+	cpu.package = read_int<int>(topo + "/physical_package_id").value_or(-1);
+	cpu.core = read_int<int>(topo + "/core_id").value_or(-1);
+	cpu.smt_siblings = read_cpus(topo + "/thread_siblings_list") & m_online;
+	cpu.package_cpus = read_cpus(topo + "/core_siblings_list") & m_online;
+
+	// without topology information the CPU is at least its own sibling
+	cpu.smt_siblings.set(cpu.nr);
+	cpu.package_cpus.set(cpu.nr);
+
+	parseCaches(base + "/cache", cpu);
+}
+
+void Topology::parseCaches(const std::string &base, CPU &cpu) {
+	for (unsigned index = 0; true; index++) {
+		const auto dir = base + "/index" + std::to_string(index);
+		const auto level = read_int<unsigned>(dir + "/level");
+
+		if (!level)
+			break;
+
+		Cache cache;
+		cache.level = *level;
+		cache.type = parse_cache_type(read_attr(dir + "/type").value_or(""));
+		cache.size = parse_size(read_attr(dir + "/size").value_or(""));
+		cache.line_size = read_int<size_t>(dir + "/coherency_line_size").value_or(0);
+		cache.ways = read_int<unsigned>(dir + "/ways_of_associativity").value_or(0);
+		cache.shared_cpus = read_cpus(dir + "/shared_cpu_list") & m_online;
+		cache.shared_cpus.set(cpu.nr);
+
+		// the same cache is reported for each CPU sharing it
+		auto it = std::find_if(m_caches.begin(), m_caches.end(), [&cache](const Cache &other) {
+			return other.level == cache.level &&
+				other.type == cache.type &&
+				other.shared_cpus == cache.shared_cpus;
+		});
+
+		if (it == m_caches.end()) {
+			m_caches.push_back(cache);
+			it = m_caches.end() - 1;
+		}
+
+		cpu.caches.push_back(static_cast<size_t>(it - m_caches.begin()));
+	}
+}
+
+void Topology::parseNodes(const std::string &base) {
+	const auto online = read_cpus(base + "/online");
+
+	// node numbers use the same list format as CPUs
+	for (const auto nr: online.cpus()) {
+		const auto dir = base + "/node" + std::to_string(nr);
+		auto &node = m_nodes.emplace_back();
+		node.nr = nr;
+		node.cpus = read_cpus(dir + "/cpulist") & m_online;
+
+		for (const auto &dist: split(read_attr(dir + "/distance").value_or(""), " ")) {
+			node.distances.push_back(parse_int<unsigned>(dist).value_or(0));
+		}
+
+		for (const auto cpu_nr: node.cpus.cpus()) {
+			auto it = std::find_if(m_cpus.begin(), m_cpus.end(), [cpu_nr](const CPU &cpu) {
+				return cpu.nr == cpu_nr;
+			});
+
+			if (it != m_cpus.end()) {
+				it->node = nr;
+			}
+		}
+	}
+}
+
+const Topology::CPU& Topology::cpu(const unsigned nr) const {
+	auto it = std::find_if(m_cpus.begin(), m_cpus.end(), [nr](const CPU &cpu) {
+		return cpu.nr == nr;
+	});
+
+	if (it == m_cpus.end()) {
+		throw UsageError{"not an online CPU: " + std::to_string(nr)};
+	}
+
+	return *it;
+}
+
+std::optional<unsigned> Topology::distance(const unsigned from, const unsigned to) const {
+	auto by_nr = [](const unsigned nr) {
+		return [nr](const Node &node) { return node.nr == nr; };
+	};
+
+	const auto from_it = std::find_if(m_nodes.begin(), m_nodes.end(), by_nr(from));
+	const auto to_it = std::find_if(m_nodes.begin(), m_nodes.end(), by_nr(to));
+
+	if (from_it == m_nodes.end() || to_it == m_nodes.end())
+		return std::nullopt;
+
+	const auto index = static_cast<size_t>(to_it - m_nodes.begin());
+
+	if (index >= from_it->distances.size())
+		return std::nullopt;
+
+	return from_it->distances[index];
+}
+
+CPUSet Topology::primaryThreads() const {
+	CPUSet ret;
+
+	for (const auto &cpu: m_cpus) {
+		if (cpu.smt_siblings.cpus().front() == cpu.nr) {
+			ret.set(cpu.nr);
+		}
+	}
+
+	return ret;
+}
+
+CPUSet Topology::cacheSharers(const unsigned nr, const unsigned level) const {
+	for (const auto index: cpu(nr).caches) {
+		const auto &cache = m_caches[index];
+
+		if (cache.level == level && cache.type != CacheType::INSTRUCTION) {
+			return cache.shared_cpus;
+		}
+	}
+
+	return CPUSet{};
+}
+
+} // end ns
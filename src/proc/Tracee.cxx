@@ -1,16 +1,183 @@
+// C++
+#include <algorithm>
+
 // cosmos
+#include "cosmos/error/ApiError.hxx"
+#include "cosmos/error/errno.hxx"
 #include "cosmos/error/RuntimeError.hxx"
+#include "cosmos/fs/File.hxx"
 #include "cosmos/proc/SigInfo.hxx"
 #include "cosmos/proc/Tracee.hxx"
 
 // Linux
+#include <limits.h>
 #include <linux/filter.h>
+#include <sys/uio.h>
+#include <unistd.h>
 #ifdef COSMOS_X86
 #	include <asm/ldt.h>
 #endif
 
 namespace cosmos {
 
+namespace {
+
+size_t page_size() {
+	static const auto size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+	return size;
+}
+
+/// Performs positional vector I/O on `/proc/<pid>/mem` until done or an error occurs.
+template <typename IOVEC, typename IO_FUNC>
+size_t proc_mem_io(IOVEC &iovec, const uintptr_t addr, IO_FUNC io_func) {
+	size_t done = 0;
+
+	while (iovec.leftBytes() != 0) {
+		const auto before = iovec.leftBytes();
+
+		try {
+			io_func(iovec, static_cast<off_t>(addr + done));
+		} catch (const ApiError &) {
+			// unmapped memory results in EIO, report a partial
+			// transfer if anything has been transferred at all
+			if (done == 0)
+				throw;
+			break;
+		}
+
+		const auto processed = before - iovec.leftBytes();
+
+		if (processed == 0)
+			break;
+
+		done += processed;
+	}
+
+	return done;
+}
+
+} // end anon ns
+
+template <typename IOVEC, typename VM_FUNC>
+std::pair<size_t, Errno> Tracee::processVMIO(IOVEC &iovec, const uintptr_t addr, VM_FUNC vm_func) const {
+	size_t done = 0;
+
+	for (size_t pos = 0; pos < iovec.size(); pos += IOV_MAX) {
+		// the kernel rejects more than IOV_MAX entries with EINVAL
+		const auto num = std::min<size_t>(IOV_MAX, iovec.size() - pos);
+		size_t length = 0;
+
+		for (size_t index = pos; index < pos + num; index++) {
+			length += iovec[index].getLength();
+		}
+
+		struct iovec remote{reinterpret_cast<void*>(addr + done), length};
+
+		const auto res = vm_func(iovec.raw() + pos, num, &remote);
+
+		if (res < 0) {
+			return {done, get_errno()};
+		}
+
+		iovec.update(static_cast<size_t>(res));
+		done += static_cast<size_t>(res);
+
+		if (static_cast<size_t>(res) != length) {
+			// partial transfer, the rest of the range is not mapped
+			break;
+		}
+	}
+
+	return {done, Errno::NO_ERROR};
+}
+
+std::string Tracee::procMemPath() const {
+	return "/proc/" + std::to_string(to_integral(m_pid)) + "/mem";
+}
+
+size_t Tracee::readMemory(const void *addr, ReadIOVector &iovec) const {
+	const auto [done, error] = processVMIO(iovec, reinterpret_cast<uintptr_t>(addr),
+			[this](const struct iovec *local, const size_t num, const struct iovec *remote) {
+				return ::process_vm_readv(to_integral(m_pid), local, num, remote, 1, 0);
+			});
+
+	if (error == Errno::NO_ERROR || done != 0) {
+		return done;
+	} else if (error == Errno::NO_SYS) {
+		return readProcMem(addr, iovec);
+	}
+
+	throw ApiError{"process_vm_readv()", error};
+}
+
+size_t Tracee::writeMemory(void *addr, WriteIOVector &iovec) {
+	const auto [done, error] = processVMIO(iovec, reinterpret_cast<uintptr_t>(addr),
+			[this](const struct iovec *local, const size_t num, const struct iovec *remote) {
+				return ::process_vm_writev(to_integral(m_pid), local, num, remote, 1, 0);
+			});
+
+	if (error == Errno::NO_ERROR) {
+		return done;
+	} else if (!in_list(error, {Errno::NO_SYS, Errno::FAULT})) {
+		if (done != 0)
+			return done;
+		throw ApiError{"process_vm_writev()", error};
+	}
+
+	// EFAULT also happens for read-only mappings, which
+	// /proc/<pid>/mem is able to write to
+	try {
+		return done + writeProcMem(reinterpret_cast<char*>(addr) + done, iovec);
+	} catch (const ApiError &) {
+		if (done == 0)
+			throw;
+		return done;
+	}
+}
+
+size_t Tracee::readProcMem(const void *addr, ReadIOVector &iovec) const {
+	File mem{procMemPath(), OpenMode::READ_ONLY};
+
+	return proc_mem_io(iovec, reinterpret_cast<uintptr_t>(addr),
+			[&mem](ReadIOVector &vec, const off_t offset) {
+				mem.readAtPos(vec, offset);
+			});
+}
+
+size_t Tracee::writeProcMem(void *addr, WriteIOVector &iovec) {
+	File mem{procMemPath(), OpenMode::WRITE_ONLY};
+
+	return proc_mem_io(iovec, reinterpret_cast<uintptr_t>(addr),
+			[&mem](WriteIOVector &vec, const off_t offset) {
+				mem.writeAtPos(vec, offset);
+			});
+}
+
+std::string Tracee::readString(const char *addr, const size_t max_len) const {
+	std::string ret;
+	const auto page = page_size();
+
+	while (ret.size() < max_len) {
+		const auto offset = ret.size();
+		const auto pos = reinterpret_cast<uintptr_t>(addr) + offset;
+		// never cross a page boundary, the next page might be unmapped
+		const auto chunk = std::min(page - pos % page, max_len - offset);
+
+		ret.resize(offset + chunk);
+		const auto bytes = readMemory(addr + offset, ret.data() + offset, chunk);
+		ret.resize(offset + bytes);
+
+		if (const auto nul = ret.find('\0', offset); nul != ret.npos) {
+			ret.resize(nul);
+			break;
+		} else if (bytes != chunk) {
+			break;
+		}
+	}
+
+	return ret;
+}
+
 void Tracee::getSeccompFilter(std::vector<struct sock_filter> &instructions, const unsigned long prog_index) const {
 
 	if (instructions.empty()) {
@@ -0,0 +1,65 @@
+// Linux
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// C++
+#include <climits>
+
+// cosmos
+#include <cosmos/error/ApiError.hxx>
+#include <cosmos/proc/numa.hxx>
+
+namespace cosmos::numa {
+
+namespace {
+
+constexpr size_t BITS_PER_LONG = sizeof(unsigned long) * CHAR_BIT;
+
+} // end anon ns
+
+unsigned long MemPolicySettings::maxNode(const std::vector<unsigned long> &mask) {
+	if (mask.empty())
+		return 0;
+
+	// the kernel only considers `maxnode - 1` bits
+	return mask.size() * BITS_PER_LONG + 1;
+}
+
+std::vector<unsigned long> MemPolicySettings::nodeMask() const {
+	std::vector<unsigned long> ret;
+
+	for (const auto node: nodes) {
+		const auto index = node / BITS_PER_LONG;
+
+		if (ret.size() <= index) {
+			ret.resize(index + 1);
+		}
+
+		ret[index] |= 1UL << (node % BITS_PER_LONG);
+	}
+
+	return ret;
+}
+
+void set_mem_policy(const MemPolicySettings &settings) {
+	const auto mask = settings.nodeMask();
+
+	if (::syscall(SYS_set_mempolicy, settings.rawMode(),
+				mask.empty() ? nullptr : mask.data(),
+				MemPolicySettings::maxNode(mask)) != 0) {
+		throw ApiError{"set_mempolicy()"};
+	}
+}
+
+void bind(void *addr, const size_t length, const MemPolicySettings &settings, const BindFlags flags) {
+	const auto mask = settings.nodeMask();
+
+	if (::syscall(SYS_mbind, addr, length, settings.rawMode(),
+				mask.empty() ? nullptr : mask.data(),
+				MemPolicySettings::maxNode(mask),
+				flags.raw()) != 0) {
+		throw ApiError{"mbind()"};
+	}
+}
+
+} // end ns
@@ -1,5 +1,6 @@
 // Linux
 #include <grp.h>
+#include <sched.h>
 #include <limits.h>
 #include <sys/fsuid.h>
 #include <sys/types.h>
@@ -236,6 +237,32 @@ SessionID get_session_of(const ProcessID pid) {
 	return ret;
 }
 
+CPUSet get_affinity(const ProcessID pid) {
+	CPUSet ret;
+
+	if (::sched_getaffinity(cosmos::to_integral(pid), ret.size(), ret.raw()) != 0) {
+		throw ApiError{"sched_getaffinity()"};
+	}
+
+	return ret;
+}
+
+void set_affinity(const CPUSet &cpus, const ProcessID pid) {
+	if (::sched_setaffinity(cosmos::to_integral(pid), cpus.size(), cpus.raw()) != 0) {
+		throw ApiError{"sched_setaffinity()"};
+	}
+}
+
+unsigned get_current_cpu() {
+	const auto res = ::sched_getcpu();
+
+	if (res < 0) {
+		throw ApiError{"sched_getcpu()"};
+	}
+
+	return static_cast<unsigned>(res);
+}
+
 namespace {
 
 	std::optional<ChildState> wait(const idtype_t wait_type, const id_t id, const WaitFlags flags) {
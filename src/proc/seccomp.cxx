@@ -0,0 +1,109 @@
+// C++
+#include <cstddef>
+#include <string>
+
+// Linux
+#include <linux/filter.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// cosmos
+#include <cosmos/error/ApiError.hxx>
+#include <cosmos/error/RuntimeError.hxx>
+#include <cosmos/error/UsageError.hxx>
+#include <cosmos/proc/prctl.hxx>
+#include <cosmos/proc/seccomp.hxx>
+
+namespace cosmos::seccomp {
+
+namespace {
+
+/// System call numbers of the x32 ABI on x86_64 have this bit set.
+constexpr uint32_t X32_SYSCALL_BIT = 0x40000000;
+
+struct sock_filter stmt(const uint16_t code, const uint32_t k) {
+	return BPF_STMT(code, k);
+}
+
+struct sock_filter jump(const uint16_t code, const uint32_t k, const uint8_t jt, const uint8_t jf) {
+	return BPF_JUMP(code, k, jt, jf);
+}
+
+struct sock_filter ret(const Result result) {
+	return stmt(BPF_RET | BPF_K, result.raw());
+}
+
+} // end anon ns
+
+Filter::Filter(const Result default_result, const std::optional<ptrace::Arch> arch) :
+		m_default{default_result} {
+	if (!arch) {
+		throw UsageError{"no native seccomp architecture known, an explicit one is required"};
+	}
+
+	m_arch = *arch;
+}
+
+std::vector<struct sock_filter> Filter::program() const {
+	std::vector<struct sock_filter> prog;
+
+	// verify the system call ABI, system call numbers are meaningless otherwise
+	prog.push_back(stmt(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, arch)));
+	prog.push_back(jump(BPF_JMP | BPF_JEQ | BPF_K, to_integral(m_arch), 1, 0));
+	prog.push_back(ret(m_bad_arch));
+
+	prog.push_back(stmt(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, nr)));
+
+	if (m_arch == ptrace::Arch::X86_64 && !arch::X32) {
+		// x32 system calls share the X86_64 arch value
+		prog.push_back(jump(BPF_JMP | BPF_JGE | BPF_K, X32_SYSCALL_BIT, 0, 1));
+		prog.push_back(ret(m_bad_arch));
+	}
+
+	for (const auto &[nr, result]: m_rules) {
+		if (result == m_default)
+			continue;
+		else if (nr < 0 || nr > UINT32_MAX) {
+			throw UsageError{"invalid system call number " + std::to_string(nr)};
+		}
+
+		prog.push_back(jump(BPF_JMP | BPF_JEQ | BPF_K, static_cast<uint32_t>(nr), 0, 1));
+		prog.push_back(ret(result));
+	}
+
+	prog.push_back(ret(m_default));
+
+	if (prog.size() > BPF_MAXINSNS) {
+		throw UsageError{"too many seccomp filter rules"};
+	}
+
+	return prog;
+}
+
+FileDescriptor Filter::install(const FilterFlags flags) const {
+	auto prog = program();
+
+	struct sock_fprog fprog;
+	fprog.len = static_cast<unsigned short>(prog.size());
+	fprog.filter = prog.data();
+
+	if (m_no_new_privs) {
+		prctl::set_no_new_privs();
+	}
+
+	// glibc has no wrapper for this
+	const auto res = ::syscall(SYS_seccomp, SECCOMP_SET_MODE_FILTER, flags.raw(), &fprog);
+
+	if (res < 0) {
+		throw ApiError{"seccomp(SET_MODE_FILTER)"};
+	} else if (flags[FilterFlag::NEW_LISTENER]) {
+		return FileDescriptor{FileNum{static_cast<int>(res)}};
+	} else if (res > 0) {
+		// with TSYNC this is the ID of a thread that could not be synchronized
+		throw RuntimeError{"failed to synchronize seccomp filter to thread " + std::to_string(res)};
+	}
+
+	return FileDescriptor{};
+}
+
+} // end ns
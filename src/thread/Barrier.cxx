@@ -0,0 +1,40 @@
+// cosmos
+#include <cosmos/thread/Barrier.hxx>
+
+namespace cosmos {
+
+bool Barrier::arriveAndWait() {
+	const auto phase = m_phase.load(std::memory_order_acquire);
+
+	if (m_arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == m_count) {
+		// last one to arrive, prepare the next phase and release the others
+		m_arrived.store(0, std::memory_order_relaxed);
+		m_phase.store(phase + 1, std::memory_order_seq_cst);
+
+		// pairs with the increment of m_sleepers below: either we see the
+		// sleeper here, or the sleeper sees the new phase.
+		if (m_sleepers.load(std::memory_order_seq_cst) != 0) {
+			futex::wake_all(m_phase, m_shared);
+		}
+
+		return true;
+	}
+
+	for (size_t spin = 0; spin < futex::spin_limit(); spin++) {
+		if (m_phase.load(std::memory_order_acquire) != phase)
+			return false;
+
+		futex::cpu_relax();
+	}
+
+	m_sleepers.fetch_add(1, std::memory_order_seq_cst);
+
+	while (m_phase.load(std::memory_order_seq_cst) == phase) {
+		futex::wait(m_phase, phase, m_shared);
+	}
+
+	m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+	return false;
+}
+
+} // end ns
@@ -1,4 +1,5 @@
 // Cosmos
+#include <cosmos/error/UsageError.hxx>
 #include <cosmos/thread/Condition.hxx>
 #include <cosmos/utils.hxx>
 
@@ -28,6 +29,14 @@ Condition::Condition(Mutex &lock) :
 			ApiError("pthread_condattr_setclock()", err);
 		}
 
+		if (lock.options()[Mutex::Option::PROCESS_SHARED]) {
+			res = pthread_condattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+
+			if (auto err = Errno{res}; err != Errno::NO_ERROR) {
+				throw ApiError{"pthread_condattr_setpshared()", err};
+			}
+		}
+
 		res = ::pthread_cond_init(&m_pcond, &attr);
 
 		if (auto err = Errno{res}; err != Errno::NO_ERROR) {
@@ -39,4 +48,34 @@ Condition::Condition(Mutex &lock) :
 	}
 }
 
+void Condition::instrument(const std::string_view name) {
+	if (m_lock.options()[Mutex::Option::PROCESS_SHARED]) {
+		throw UsageError{"cannot instrument a process shared Condition"};
+	}
+
+	m_stats = std::make_unique<LockStats>(LockStats::Kind::CONDITION, name);
+}
+
+void Condition::waitInstrumented() const {
+	if (!lock_stats::is_enabled()) {
+		waitPlain();
+		return;
+	}
+
+	const auto start = LockStats::now();
+	waitPlain();
+	m_stats->countContention(LockStats::now() - start);
+}
+
+Condition::WaitTimedRes Condition::waitTimedInstrumented(const MonotonicTime ts) const {
+	if (!lock_stats::is_enabled()) {
+		return waitTimedPlain(ts);
+	}
+
+	const auto start = LockStats::now();
+	const auto ret = waitTimedPlain(ts);
+	m_stats->countContention(LockStats::now() - start);
+	return ret;
+}
+
 } // end ns
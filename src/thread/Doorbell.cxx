@@ -0,0 +1,16 @@
+// cosmos
+#include <cosmos/error/WouldBlock.hxx>
+#include <cosmos/thread/Doorbell.hxx>
+
+namespace cosmos {
+
+bool Doorbell::acknowledge() {
+	try {
+		m_event.wait();
+		return true;
+	} catch (const WouldBlock &) {
+		return false;
+	}
+}
+
+} // end ns
@@ -0,0 +1,53 @@
+// C++
+#include <climits>
+
+// cosmos
+#include <cosmos/error/UsageError.hxx>
+#include <cosmos/thread/FutexCondition.hxx>
+
+namespace cosmos {
+
+void FutexCondition::wait(const FutexMutex &mutex) const {
+	// sample the sequence while still holding the mutex, a signal()
+	// after unlock() will change it and futex::wait() won't block.
+	const auto seq = enterWait();
+	mutex.unlock();
+	futex::wait(m_seq, seq, m_shared);
+	leaveWait();
+	// we might have been requeued onto the mutex by broadcast(), then
+	// other waiters may be sleeping on it.
+	mutex.lockContended();
+}
+
+FutexCondition::WaitTimedRes FutexCondition::waitTimed(
+		const FutexMutex &mutex, const MonotonicTime ts) const {
+	const auto seq = enterWait();
+	mutex.unlock();
+	const auto woken = futex::wait(m_seq, seq, m_shared, ts);
+	leaveWait();
+	mutex.lockContended();
+
+	return woken ? WaitTimedRes::SIGNALED : WaitTimedRes::TIMED_OUT;
+}
+
+void FutexCondition::broadcast(const FutexMutex &mutex) {
+	if (mutex.isShared() != m_shared) {
+		throw UsageError{"FutexCondition and FutexMutex differ in ProcessShared mode"};
+	}
+
+	if (!advance())
+		return;
+
+	const auto seq = m_seq.load(std::memory_order_relaxed);
+
+	/*
+	 * If the sequence changed meanwhile then another signal() or
+	 * broadcast() raced with us. Fall back to waking everybody in this
+	 * case, which is always correct.
+	 */
+	if (!futex::requeue(m_seq, seq, 1, mutex.m_word, INT_MAX, m_shared)) {
+		futex::wake_all(m_seq, m_shared);
+	}
+}
+
+} // end ns
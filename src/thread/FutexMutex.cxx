@@ -0,0 +1,52 @@
+// cosmos
+#include <cosmos/thread/FutexMutex.hxx>
+
+namespace cosmos {
+
+void FutexMutex::lockSlow() const {
+	const auto flags = this->flags();
+
+	for (size_t spin = 0; spin < futex::spin_limit(); spin++) {
+		const auto state = m_word.load(std::memory_order_relaxed) & STATE_MASK;
+
+		if (state == CONTENDED) {
+			// others are already sleeping, don't compete with them
+			break;
+		} else if (state == UNLOCKED && tryLock()) {
+			return;
+		}
+
+		futex::cpu_relax();
+	}
+
+	auto expected = flags;
+
+	if (m_word.compare_exchange_strong(expected, flags | LOCKED,
+				std::memory_order_acquire, std::memory_order_relaxed)) {
+		return;
+	}
+
+	lockContended();
+}
+
+void FutexMutex::lockContended() const {
+	const auto flags = this->flags();
+	const auto contended = flags | CONTENDED;
+
+	/*
+	 * Setting the contended state unconditionally is pessimistic, it can
+	 * cause a superfluous wake() in unlock(). It's the only way to make
+	 * sure that we're not missed by the current lock owner, though.
+	 */
+	while ((m_word.exchange(contended, std::memory_order_acquire) & STATE_MASK) != UNLOCKED) {
+		futex::wait(m_word, contended, shared());
+	}
+}
+
+void FutexMutex::wakeWaiter() const {
+	// unlock() decremented CONTENDED to LOCKED, fully unlock now
+	m_word.store(flags(), std::memory_order_release);
+	futex::wake(m_word, 1, shared());
+}
+
+} // end ns
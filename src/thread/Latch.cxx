@@ -0,0 +1,46 @@
+// cosmos
+#include <cosmos/thread/Latch.hxx>
+
+namespace cosmos {
+
+void Latch::countDown(const uint32_t n) {
+	const auto prev = m_count.fetch_sub(n, std::memory_order_seq_cst);
+
+	if (prev != n)
+		return;
+
+	// pairs with the increment of m_waiters in waitSlow(): either we see
+	// the waiter here, or the waiter sees the zero count.
+	if (m_waiters.load(std::memory_order_seq_cst) != 0) {
+		futex::wake_all(m_count, m_shared);
+	}
+}
+
+bool Latch::waitSlow(const std::optional<MonotonicTime> ts) const {
+	for (size_t spin = 0; spin < futex::spin_limit(); spin++) {
+		if (tryWait())
+			return true;
+
+		futex::cpu_relax();
+	}
+
+	m_waiters.fetch_add(1, std::memory_order_seq_cst);
+	bool opened = false;
+
+	while (true) {
+		const auto count = m_count.load(std::memory_order_seq_cst);
+
+		if (count == 0) {
+			opened = true;
+			break;
+		} else if (!futex::wait(m_count, count, m_shared, ts)) {
+			opened = tryWait();
+			break;
+		}
+	}
+
+	m_waiters.fetch_sub(1, std::memory_order_relaxed);
+	return opened;
+}
+
+} // end ns
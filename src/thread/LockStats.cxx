@@ -0,0 +1,226 @@
+// C++
+#include <algorithm>
+#include <bit>
+#include <iomanip>
+#include <ostream>
+
+// Linux
+#include <time.h>
+
+// cosmos
+#include <cosmos/thread/FutexMutex.hxx>
+#include <cosmos/thread/LockStats.hxx>
+
+namespace cosmos {
+
+namespace {
+
+std::atomic<bool> g_enabled{true};
+
+/// All existing LockStats objects.
+struct Registry {
+	// a FutexMutex since it doesn't need library initialization
+	FutexMutex lock;
+	std::vector<LockStats*> stats;
+};
+
+/// Returns the Registry, constructed on first use to support static lock objects.
+/**
+ * The Registry is intentionally leaked, static lock objects constructed
+ * before it would otherwise access it after its destruction at exit.
+ **/
+Registry& registry() {
+	static Registry &reg = *new Registry;
+	return reg;
+}
+
+std::atomic<size_t> g_next_shard{0};
+
+std::string_view to_label(const LockStats::Kind kind) {
+	switch (kind) {
+		case LockStats::Kind::MUTEX: return "mutex";
+		case LockStats::Kind::RWLOCK: return "rwlock";
+		case LockStats::Kind::CONDITION: return "condition";
+		default: return "???";
+	}
+}
+
+/// Formats a nanosecond duration in a human readable unit.
+std::string format_ns(const uint64_t ns) {
+	if (ns < 10 * 1000)
+		return std::to_string(ns) + "ns";
+	else if (ns < 10 * 1000 * 1000)
+		return std::to_string(ns / 1000) + "us";
+	else if (ns < 10ULL * 1000 * 1000 * 1000)
+		return std::to_string(ns / 1000 / 1000) + "ms";
+
+	return std::to_string(ns / 1000 / 1000 / 1000) + "s";
+}
+
+} // end anon ns
+
+uint64_t LockStats::Summary::percentile(const double percent) const {
+	if (contentions == 0)
+		return 0;
+
+	const auto wanted = static_cast<uint64_t>(static_cast<double>(contentions) * percent / 100.0);
+	uint64_t seen = 0;
+
+	for (size_t bucket = 0; bucket < BUCKETS; bucket++) {
+		seen += histogram[bucket];
+		if (seen >= wanted && seen != 0) {
+			return bucket == BUCKETS - 1 ? max_wait_ns : (uint64_t{1} << bucket);
+		}
+	}
+
+	return max_wait_ns;
+}
+
+LockStats::LockStats(const Kind kind, const std::string_view name) :
+		m_kind{kind},
+		m_name{name} {
+	auto &reg = registry();
+	FutexMutexGuard guard{reg.lock};
+	reg.stats.push_back(this);
+}
+
+LockStats::~LockStats() {
+	auto &reg = registry();
+	FutexMutexGuard guard{reg.lock};
+	std::erase(reg.stats, this);
+}
+
+size_t LockStats::shardIndex() {
+	thread_local const size_t index = g_next_shard.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+	return index;
+}
+
+uint64_t LockStats::now() {
+	struct timespec ts;
+	// this is served by the vDSO, thus doesn't need error handling
+	(void)::clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000 * 1000 * 1000 +
+		static_cast<uint64_t>(ts.tv_nsec);
+}
+
+void LockStats::countContention(const uint64_t wait_ns) {
+	auto &sh = shard();
+	const auto bucket = std::min(static_cast<size_t>(std::bit_width(wait_ns)), BUCKETS - 1);
+
+	sh.acquisitions.fetch_add(1, std::memory_order_relaxed);
+	sh.contentions.fetch_add(1, std::memory_order_relaxed);
+	sh.wait_ns.fetch_add(wait_ns, std::memory_order_relaxed);
+	sh.histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+
+	auto max = sh.max_wait_ns.load(std::memory_order_relaxed);
+	while (wait_ns > max &&
+			!sh.max_wait_ns.compare_exchange_weak(max, wait_ns, std::memory_order_relaxed)) {
+		;
+	}
+}
+
+LockStats::Summary LockStats::summary() const {
+	Summary ret;
+	ret.name = m_name;
+	ret.kind = m_kind;
+
+	for (const auto &sh: m_shards) {
+		ret.acquisitions += sh.acquisitions.load(std::memory_order_relaxed);
+		ret.contentions += sh.contentions.load(std::memory_order_relaxed);
+		ret.wait_ns += sh.wait_ns.load(std::memory_order_relaxed);
+		ret.max_wait_ns = std::max(ret.max_wait_ns, sh.max_wait_ns.load(std::memory_order_relaxed));
+
+		for (size_t bucket = 0; bucket < BUCKETS; bucket++) {
+			ret.histogram[bucket] += sh.histogram[bucket].load(std::memory_order_relaxed);
+		}
+	}
+
+	return ret;
+}
+
+void LockStats::reset() {
+	for (auto &sh: m_shards) {
+		sh.acquisitions.store(0, std::memory_order_relaxed);
+		sh.contentions.store(0, std::memory_order_relaxed);
+		sh.wait_ns.store(0, std::memory_order_relaxed);
+		sh.max_wait_ns.store(0, std::memory_order_relaxed);
+
+		for (auto &bucket: sh.histogram) {
+			bucket.store(0, std::memory_order_relaxed);
+		}
+	}
+}
+
+namespace lock_stats {
+
+void set_enabled(const bool enabled) {
+	g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool is_enabled() {
+	return g_enabled.load(std::memory_order_relaxed);
+}
+
+std::vector<LockStats::Summary> collect() {
+	std::vector<LockStats::Summary> ret;
+
+	{
+		auto &reg = registry();
+		FutexMutexGuard guard{reg.lock};
+		ret.reserve(reg.stats.size());
+
+		for (const auto stats: reg.stats) {
+			ret.push_back(stats->summary());
+		}
+	}
+
+	std::stable_sort(ret.begin(), ret.end(), [](const auto &a, const auto &b) {
+		if (a.wait_ns != b.wait_ns)
+			return a.wait_ns > b.wait_ns;
+		return a.contentions > b.contentions;
+	});
+
+	return ret;
+}
+
+void dump(std::ostream &out, const size_t max) {
+	const auto summaries = collect();
+
+	out << std::left
+		<< std::setw(24) << "name" << " " << std::setw(9) << "kind"
+		<< std::right
+		<< std::setw(12) << "acquired"
+		<< std::setw(12) << "contended"
+		<< std::setw(10) << "wait"
+		<< std::setw(10) << "max"
+		<< std::setw(10) << "p50"
+		<< std::setw(10) << "p99" << "\n";
+
+	for (size_t i = 0; i < std::min(max, summaries.size()); i++) {
+		const auto &summary = summaries[i];
+
+		out << std::left
+			<< std::setw(24) << (summary.name.empty() ? "<unnamed>" : summary.name) << " "
+			<< std::setw(9) << to_label(summary.kind)
+			<< std::right
+			<< std::setw(12) << summary.acquisitions
+			<< std::setw(12) << summary.contentions
+			<< std::setw(10) << format_ns(summary.wait_ns)
+			<< std::setw(10) << format_ns(summary.max_wait_ns)
+			<< std::setw(10) << format_ns(summary.percentile(50))
+			<< std::setw(10) << format_ns(summary.percentile(99)) << "\n";
+	}
+}
+
+void reset_all() {
+	auto &reg = registry();
+	FutexMutexGuard guard{reg.lock};
+
+	for (auto stats: reg.stats) {
+		stats->reset();
+	}
+}
+
+} // end ns
+
+} // end ns
@@ -13,6 +13,18 @@ constexpr bool DEBUG_MUTEX = true;
 constexpr bool DEBUG_MUTEX = false;
 #endif
 
+void check_attr_res(const int res, const char *call) {
+	if (auto err = Errno{res}; err != Errno::NO_ERROR) {
+		throw ApiError{call, err};
+	}
+}
+
+void set_debug_type(pthread_mutexattr_t &attr) {
+	check_attr_res(
+		::pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_ERRORCHECK),
+		"pthread_mutexattr_settype()");
+}
+
 /// A single pthread_mutexattr_t for constructing Mutexes
 class MutexAttr :
 		public Initable {
@@ -37,13 +49,7 @@ protected: // functions
 			ApiError("pthread_mutexattr_init()", err);
 		}
 
-		res = ::pthread_mutexattr_settype(
-			&m_attr, PTHREAD_MUTEX_ERRORCHECK
-		);
-
-		if (auto err = Errno{res}; err != Errno::NO_ERROR) {
-			throw ApiError{"pthread_mutexattr_settype()", err};
-		}
+		set_debug_type(m_attr);
 	}
 
 	void libExit() override {
@@ -68,4 +74,100 @@ Mutex::Mutex() {
 	}
 }
 
+Mutex::Mutex(const Options options) :
+		m_options{options} {
+	pthread_mutexattr_t attr;
+
+	check_attr_res(::pthread_mutexattr_init(&attr), "pthread_mutexattr_init()");
+
+	try {
+		if (DEBUG_MUTEX) {
+			set_debug_type(attr);
+		}
+
+		if (options[Option::PRIO_INHERIT]) {
+			check_attr_res(
+				::pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT),
+				"pthread_mutexattr_setprotocol()");
+		}
+
+		if (options[Option::ROBUST]) {
+			check_attr_res(
+				::pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST),
+				"pthread_mutexattr_setrobust()");
+		}
+
+		if (options[Option::PROCESS_SHARED]) {
+			check_attr_res(
+				::pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED),
+				"pthread_mutexattr_setpshared()");
+		}
+
+		check_attr_res(::pthread_mutex_init(&m_pmutex, &attr), "pthread_mutex_init()");
+	} catch (...) {
+		(void)::pthread_mutexattr_destroy(&attr);
+		throw;
+	}
+
+	(void)::pthread_mutexattr_destroy(&attr);
+}
+
+Mutex::LockResult Mutex::lockRobust() const {
+	int res = 0;
+
+	if (COSMOS_LOCK_STATS && m_stats && lock_stats::is_enabled()) {
+		res = ::pthread_mutex_trylock(&m_pmutex);
+
+		if (Errno{res} == Errno::BUSY) {
+			const auto start = LockStats::now();
+			res = ::pthread_mutex_lock(&m_pmutex);
+			m_stats->countContention(LockStats::now() - start);
+		} else {
+			m_stats->countAcquire();
+		}
+	} else {
+		res = ::pthread_mutex_lock(&m_pmutex);
+	}
+
+	switch (Errno{res}) {
+		case Errno::NO_ERROR: return LockResult::ACQUIRED;
+		case Errno::OWNER_DEAD: return LockResult::OWNER_DIED;
+		default: throw ApiError{"pthread_mutex_lock()", Errno{res}};
+	}
+}
+
+void Mutex::makeConsistent() const {
+	const auto res = ::pthread_mutex_consistent(&m_pmutex);
+
+	if (auto err = Errno{res}; err != Errno::NO_ERROR) {
+		throw ApiError{"pthread_mutex_consistent()", err};
+	}
+}
+
+void Mutex::instrument(const std::string_view name) {
+	if (m_options[Option::PROCESS_SHARED]) {
+		throw UsageError{"cannot instrument a process shared Mutex"};
+	}
+
+	m_stats = std::make_unique<LockStats>(LockStats::Kind::MUTEX, name);
+}
+
+void Mutex::lockInstrumented() const {
+	if (!lock_stats::is_enabled()) {
+		lockPlain();
+		return;
+	}
+
+	if (const auto res = ::pthread_mutex_trylock(&m_pmutex); res == 0) {
+		m_stats->countAcquire();
+		return;
+	} else if (Errno{res} != Errno::BUSY) {
+		throw ApiError{"pthread_mutex_trylock()", Errno{res}};
+	}
+
+	const auto start = LockStats::now();
+	lockPlain();
+	m_stats->countContention(LockStats::now() - start);
+}
+
 } // end ns
@@ -0,0 +1,38 @@
+// cosmos
+#include <cosmos/thread/PerCPUCounter.hxx>
+#include <cosmos/thread/rseq.hxx>
+
+namespace cosmos {
+
+PerCPUCounter::PerCPUCounter() :
+		m_num_slots{rseq::possible_cpu_slots()},
+		m_slots{std::make_unique<Slot[]>(m_num_slots)},
+		m_use_rseq{rseq::has_percpu_ops()} {
+}
+
+void PerCPUCounter::add(const int64_t value) {
+	if (m_use_rseq) {
+		rseq::percpu_add(&m_slots[0].value, sizeof(Slot), m_num_slots, value);
+	} else {
+		auto &slot = m_slots[rseq::current_cpu() % m_num_slots];
+		slot.value.fetch_add(value, std::memory_order_relaxed);
+	}
+}
+
+int64_t PerCPUCounter::value() const {
+	int64_t ret = 0;
+
+	for (size_t cpu = 0; cpu < m_num_slots; cpu++) {
+		ret += m_slots[cpu].value.load(std::memory_order_relaxed);
+	}
+
+	return ret;
+}
+
+void PerCPUCounter::reset() {
+	for (size_t cpu = 0; cpu < m_num_slots; cpu++) {
+		m_slots[cpu].value.store(0, std::memory_order_relaxed);
+	}
+}
+
+} // end ns
@@ -1,6 +1,7 @@
 // C++
 #include <atomic>
 #include <cstdlib>
+#include <exception>
 #include <iostream>
 #include <utility>
 #include <variant>
@@ -11,6 +12,7 @@
 #include <cosmos/formatting.hxx>
 #include <cosmos/private/cosmos.hxx>
 #include <cosmos/thread/PosixThread.hxx>
+#include <cosmos/thread/futex.hxx>
 
 using namespace cosmos::pthread;
 
@@ -20,11 +22,23 @@ namespace {
 
 	std::atomic<size_t> num_threads = 0;
 
+	/// State for applying ThreadAttributes in the context of a new thread.
+	/**
+	 * This lives on the creating thread's stack, which waits for
+	 * `done` to become non-zero.
+	 **/
+	struct Setup {
+		const ThreadAttributes &attrs;
+		futex::Word done{0};
+		std::exception_ptr error;
+	};
+
 	struct Context {
 		std::variant<PosixThread::PosixEntry, PosixThread::Entry> entry;
 		ThreadArg arg;
 		/* maximum size of PR_SET_NAME attribute */
 		char name[16] = {0};
+		Setup *setup = nullptr;
 	};
 
 	Context fetch_context(void *par) {
@@ -34,6 +48,22 @@ namespace {
 		return ret;
 	}
 
+	/// Applies thread attributes in the new thread, returns whether this succeeded.
+	bool run_setup(Setup &setup) {
+		try {
+			setup.attrs.applyInThread();
+		} catch (...) {
+			setup.error = std::current_exception();
+		}
+
+		const bool ok = !setup.error;
+		// the creator may return and invalidate `setup` as soon as
+		// `done` is set, the wake() only uses the address, though.
+		setup.done.store(1, std::memory_order_release);
+		futex::wake(setup.done);
+		return ok;
+	}
+
 	void* thread_entry(void *par) {
 
 		Context ctx = fetch_context(par);
@@ -42,6 +72,10 @@ namespace {
 			thread::set_name(ctx.name);
 		}
 
+		if (ctx.setup && !run_setup(*ctx.setup)) {
+			return nullptr;
+		}
+
 		if (std::holds_alternative<PosixThread::PosixEntry>(ctx.entry)) {
 			auto entry = std::get<PosixThread::PosixEntry>(ctx.entry);
 			auto ret = entry(ctx.arg);
@@ -54,7 +88,7 @@ namespace {
 	}
 
 	void create_thread(pthread_t &thread, Context *ctx,
-			const std::string_view name) {
+			const std::string_view name, const ThreadAttributes *attrs = nullptr) {
 
 		if (name.data() != nullptr) {
 			/* pass on the friendly name to the thread to apply in
@@ -67,17 +101,55 @@ namespace {
 			std::memcpy(ctx->name, name.data(), name_max);
 		}
 
+		pthread_attr_t attr;
+		std::optional<Setup> setup;
+
+		if (attrs) {
+			if (const auto res = ::pthread_attr_init(&attr); res != 0) {
+				delete ctx;
+				throw ApiError{"pthread_attr_init()", Errno{res}};
+			}
+
+			try {
+				attrs->fill(attr);
+			} catch (...) {
+				(void)::pthread_attr_destroy(&attr);
+				delete ctx;
+				throw;
+			}
+
+			if (attrs->needsThreadSetup()) {
+				setup.emplace(*attrs);
+				ctx->setup = &(*setup);
+			}
+		}
+
 		const auto res = ::pthread_create(
 			&thread,
-			nullptr /* keep default attributes */,
+			attrs ? &attr : nullptr,
 			&thread_entry,
 			reinterpret_cast<void*>(ctx)
 		);
 
+		if (attrs) {
+			(void)::pthread_attr_destroy(&attr);
+		}
+
 		if (const auto error = Errno{res}; error != Errno::NO_ERROR) {
+			delete ctx;
 			throw cosmos::ApiError("pthread_create()", error);
 		}
 
+		if (setup) {
+			while (setup->done.load(std::memory_order_acquire) == 0) {
+				futex::wait(setup->done, 0);
+			}
+
+			if (setup->error) {
+				(void)::pthread_join(thread, nullptr);
+				std::rethrow_exception(setup->error);
+			}
+		}
 	}
 } // end anon ns
 
@@ -102,6 +174,30 @@ PosixThread::PosixThread(Entry entry, const std::string_view name) :
 	}
 }
 
+PosixThread::PosixThread(PosixEntry entry, pthread::ThreadArg arg,
+		const ThreadAttributes &attrs, const std::string_view name) :
+		m_name{buildName(name, ++num_threads)} {
+
+	m_pthread = pthread_t{};
+	try {
+		create_thread(m_pthread.value(), new Context{entry, arg}, name, &attrs);
+	} catch(...) {
+		reset();
+		throw;
+	}
+}
+
+PosixThread::PosixThread(Entry entry, const ThreadAttributes &attrs, const std::string_view name) :
+		m_name{buildName(name, ++num_threads)} {
+	m_pthread = pthread_t{};
+	try {
+		create_thread(m_pthread.value(), new Context{entry, pthread::ThreadArg{0}}, name, &attrs);
+	} catch(...) {
+		reset();
+		throw;
+	}
+}
+
 PosixThread::PosixThread(PosixThread &&other) noexcept {
 	*this = std::move(other);
 }
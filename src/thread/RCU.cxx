@@ -0,0 +1,113 @@
+// C++
+#include <algorithm>
+#include <limits>
+
+// cosmos
+#include <cosmos/thread/RCU.hxx>
+#include <cosmos/thread/futex.hxx>
+#include <cosmos/time/time.hxx>
+
+namespace cosmos {
+
+RCUDomain::Reader::Reader(RCUDomain &domain) :
+		m_domain{domain},
+		m_slot{domain.registerReader()} {
+	online();
+}
+
+RCUDomain::Reader::~Reader() {
+	offline();
+	m_domain.unregisterReader(m_slot);
+}
+
+RCUDomain::~RCUDomain() {
+	for (auto &retired: m_retired) {
+		retired.deleter(retired.obj);
+	}
+}
+
+RCUDomain::Slot* RCUDomain::registerReader() {
+	FutexMutexGuard g{m_lock};
+	m_slots.emplace_back(std::make_unique<Slot>());
+	return m_slots.back().get();
+}
+
+void RCUDomain::unregisterReader(Slot *slot) {
+	FutexMutexGuard g{m_lock};
+	std::erase_if(m_slots, [slot](const auto &entry) { return entry.get() == slot; });
+	// the reader might have held back reclamation
+	collectLocked();
+}
+
+uint64_t RCUDomain::minReaderEpoch() const {
+	auto ret = std::numeric_limits<uint64_t>::max();
+
+	for (const auto &slot: m_slots) {
+		// the heavy fence issued after advancing the epoch pairs with
+		// the light fence in Reader::online()
+		const auto epoch = slot->epoch.load(std::memory_order_seq_cst);
+		if (epoch != OFFLINE) {
+			ret = std::min(ret, epoch);
+		}
+	}
+
+	return ret;
+}
+
+size_t RCUDomain::collectLocked() {
+	const auto min_epoch = minReaderEpoch();
+
+	std::erase_if(m_retired, [min_epoch](const Retired &retired) {
+		if (retired.epoch > min_epoch)
+			return false;
+
+		retired.deleter(retired.obj);
+		return true;
+	});
+
+	return m_retired.size();
+}
+
+size_t RCUDomain::collect() {
+	FutexMutexGuard g{m_lock};
+	return collectLocked();
+}
+
+size_t RCUDomain::pending() const {
+	FutexMutexGuard g{m_lock};
+	return m_retired.size();
+}
+
+void RCUDomain::retire(void *obj, void (*deleter)(void*)) {
+	const auto epoch = m_epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+	membarrier::heavy_fence();
+
+	FutexMutexGuard g{m_lock};
+	m_retired.push_back(Retired{obj, deleter, epoch});
+	collectLocked();
+}
+
+void RCUDomain::synchronize() {
+	const auto target = m_epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+	membarrier::heavy_fence();
+	size_t rounds = 0;
+
+	while (true) {
+		{
+			FutexMutexGuard g{m_lock};
+			if (minReaderEpoch() >= target) {
+				collectLocked();
+				return;
+			}
+		}
+
+		// readers report quiescent states at their own pace, back off
+		if (++rounds < 100) {
+			futex::cpu_relax();
+		} else {
+			time::sleep(std::chrono::microseconds{100});
+		}
+	}
+}
+
+} // end ns
@@ -0,0 +1,42 @@
+// cosmos
+#include <cosmos/thread/RWLock.hxx>
+
+namespace cosmos {
+
+void RWLock::readlockInstrumented() const {
+	if (!lock_stats::is_enabled()) {
+		readlockPlain();
+		return;
+	}
+
+	if (const auto res = ::pthread_rwlock_tryrdlock(&m_prwlock); res == 0) {
+		m_stats->countAcquire();
+		return;
+	} else if (Errno{res} != Errno::BUSY) {
+		throw ApiError{"pthread_rwlock_tryrdlock()", Errno{res}};
+	}
+
+	const auto start = LockStats::now();
+	readlockPlain();
+	m_stats->countContention(LockStats::now() - start);
+}
+
+void RWLock::writelockInstrumented() const {
+	if (!lock_stats::is_enabled()) {
+		writelockPlain();
+		return;
+	}
+
+	if (const auto res = ::pthread_rwlock_trywrlock(&m_prwlock); res == 0) {
+		m_stats->countAcquire();
+		return;
+	} else if (Errno{res} != Errno::BUSY) {
+		throw ApiError{"pthread_rwlock_trywrlock()", Errno{res}};
+	}
+
+	const auto start = LockStats::now();
+	writelockPlain();
+	m_stats->countContention(LockStats::now() - start);
+}
+
+} // end ns
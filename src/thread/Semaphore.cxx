@@ -0,0 +1,35 @@
+// C++
+#include <climits>
+
+// cosmos
+#include <cosmos/thread/Semaphore.hxx>
+
+namespace cosmos {
+
+void Semaphore::post(const uint32_t count) {
+	m_value.fetch_add(count, std::memory_order_seq_cst);
+
+	// pairs with the increment of m_waiters in waitSlow(): either we see
+	// the waiter here, or the waiter sees the new value.
+	if (m_waiters.load(std::memory_order_seq_cst) != 0) {
+		futex::wake(m_value, count > INT_MAX ? INT_MAX : static_cast<int>(count), m_shared);
+	}
+}
+
+bool Semaphore::waitSlow(const std::optional<MonotonicTime> ts) {
+	m_waiters.fetch_add(1, std::memory_order_seq_cst);
+	bool acquired = false;
+
+	while (!(acquired = tryWait())) {
+		if (!futex::wait(m_value, 0, m_shared, ts)) {
+			// one last try, we could have been posted right before the timeout
+			acquired = tryWait();
+			break;
+		}
+	}
+
+	m_waiters.fetch_sub(1, std::memory_order_relaxed);
+	return acquired;
+}
+
+} // end ns
@@ -0,0 +1,70 @@
+// cosmos
+#include <cosmos/error/ApiError.hxx>
+#include <cosmos/proc/Mapping.hxx>
+#include <cosmos/proc/mman.hxx>
+#include <cosmos/thread/ThreadAttributes.hxx>
+
+namespace cosmos {
+
+namespace {
+
+void check_attr_res(const int res, const char *call) {
+	if (auto err = Errno{res}; err != Errno::NO_ERROR) {
+		throw ApiError{call, err};
+	}
+}
+
+/// Locks the stack of the calling thread in memory.
+void lock_own_stack() {
+	pthread_attr_t attr;
+
+	check_attr_res(::pthread_getattr_np(::pthread_self(), &attr), "pthread_getattr_np()");
+
+	void *addr = nullptr;
+	size_t size = 0;
+	const auto res = ::pthread_attr_getstack(&attr, &addr, &size);
+	(void)::pthread_attr_destroy(&attr);
+	check_attr_res(res, "pthread_attr_getstack()");
+
+	mem::lock(addr, size);
+}
+
+} // end anon ns
+
+ThreadAttributes& ThreadAttributes::setStack(Mapping &mapping) {
+	return setStack(mapping.addr(), mapping.size());
+}
+
+void ThreadAttributes::fill(pthread_attr_t &attr) const {
+	if (m_stack_addr) {
+		check_attr_res(::pthread_attr_setstack(&attr, m_stack_addr, *m_stack_size),
+				"pthread_attr_setstack()");
+	} else if (m_stack_size) {
+		check_attr_res(::pthread_attr_setstacksize(&attr, *m_stack_size),
+				"pthread_attr_setstacksize()");
+	}
+
+	if (m_guard_size && !m_stack_addr) {
+		check_attr_res(::pthread_attr_setguardsize(&attr, *m_guard_size),
+				"pthread_attr_setguardsize()");
+	}
+
+	if (m_affinity) {
+		check_attr_res(::pthread_attr_setaffinity_np(&attr, m_affinity->size(), m_affinity->raw()),
+				"pthread_attr_setaffinity_np()");
+	}
+}
+
+void ThreadAttributes::applyInThread() const {
+	if (m_sched_settings) {
+		std::visit([](auto &&sched_settings) {
+			sched_settings.apply(ThreadID::SELF);
+		}, *m_sched_settings);
+	}
+
+	if (m_prefault_stack) {
+		lock_own_stack();
+	}
+}
+
+} // end ns
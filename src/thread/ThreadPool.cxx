@@ -0,0 +1,399 @@
+// C++
+#include <string>
+
+// cosmos
+#include <cosmos/error/RuntimeError.hxx>
+#include <cosmos/error/UsageError.hxx>
+#include <cosmos/private/cosmos.hxx>
+#include <cosmos/proc/CPUSet.hxx>
+#include <cosmos/proc/process.hxx>
+#include <cosmos/thread/ThreadPool.hxx>
+
+namespace cosmos {
+
+/// Per worker thread state.
+struct ThreadPool::Worker {
+	Worker(ThreadPool &p_pool, const size_t p_index) :
+			pool{p_pool}, index{p_index}, rng{p_index * 0x9e3779b97f4a7c15ULL + 1}
+	{}
+
+	/// Cheap xorshift random number for selecting steal victims.
+	size_t random() {
+		rng ^= rng << 13;
+		rng ^= rng >> 7;
+		rng ^= rng << 17;
+		return static_cast<size_t>(rng);
+	}
+
+	ThreadPool &pool;
+	const size_t index;
+	uint64_t rng;
+
+	WorkDeque deque;
+
+	/// Tasks submitted from outside of the pool.
+	alignas(CACHE_LINE_SIZE) FutexMutex inbox_lock;
+	std::vector<Task> inbox;
+	/// Number of tasks ever added to `inbox`, modified under `inbox_lock`.
+	std::atomic<uint64_t> inbox_submitted{0};
+
+	/// Swap buffer for draining `inbox` without allocations, owner only.
+	alignas(CACHE_LINE_SIZE) std::vector<Task> drained;
+	/// Number of tasks pushed to `deque` by the owner.
+	std::atomic<uint64_t> local_submitted{0};
+	/// Number of tasks executed by this worker.
+	std::atomic<uint64_t> completed{0};
+};
+
+namespace {
+
+/// Round-robin counter for distributing external submissions to inboxes.
+thread_local size_t t_next_inbox = 0;
+
+constexpr size_t INITIAL_DEQUE_CAPACITY = 256;
+
+} // end anon ns
+
+ThreadPool::Worker*& ThreadPool::callingWorker() {
+	thread_local Worker *worker = nullptr;
+	return worker;
+}
+
+void ThreadPool::WorkDeque::Slot::store(const Task &task) {
+	uint64_t raw[std::size(words)];
+	std::memcpy(raw, &task, sizeof(raw));
+
+	for (size_t i = 0; i < std::size(words); i++) {
+		words[i].store(raw[i], std::memory_order_relaxed);
+	}
+}
+
+ThreadPool::Task ThreadPool::WorkDeque::Slot::load() const {
+	uint64_t raw[std::size(words)];
+
+	for (size_t i = 0; i < std::size(words); i++) {
+		raw[i] = words[i].load(std::memory_order_relaxed);
+	}
+
+	Task ret;
+	std::memcpy(&ret, raw, sizeof(raw));
+	return ret;
+}
+
+ThreadPool::WorkDeque::WorkDeque() {
+	m_buffers.emplace_back(std::make_unique<Buffer>(INITIAL_DEQUE_CAPACITY));
+	m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+}
+
+ThreadPool::WorkDeque::~WorkDeque() {}
+
+/*
+ * The memory orderings follow "Correct and Efficient Work-Stealing for Weak
+ * Memory Models" (Lê, Pop, Cohen, Zappa Nardelli, 2013).
+ */
+
+void ThreadPool::WorkDeque::push(const Task &task) {
+	const auto bottom = m_bottom.load(std::memory_order_relaxed);
+	const auto top = m_top.load(std::memory_order_acquire);
+	auto buffer = m_buffer.load(std::memory_order_relaxed);
+
+	if (bottom - top > static_cast<int64_t>(buffer->mask)) {
+		buffer = grow(buffer, bottom, top);
+	}
+
+	buffer->at(bottom).store(task);
+	std::atomic_thread_fence(std::memory_order_release);
+	m_bottom.store(bottom + 1, std::memory_order_relaxed);
+}
+
+bool ThreadPool::WorkDeque::take(Task &task) {
+	const auto bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+	const auto buffer = m_buffer.load(std::memory_order_relaxed);
+	m_bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	auto top = m_top.load(std::memory_order_relaxed);
+
+	if (top > bottom) {
+		// empty
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return false;
+	}
+
+	task = buffer->at(bottom).load();
+
+	if (top != bottom) {
+		// more than one element left, no race with stealers possible
+		return true;
+	}
+
+	// the last element, race against stealers for it
+	const bool won = m_top.compare_exchange_strong(top, top + 1,
+			std::memory_order_seq_cst, std::memory_order_relaxed);
+	m_bottom.store(bottom + 1, std::memory_order_relaxed);
+	return won;
+}
+
+bool ThreadPool::WorkDeque::steal(Task &task) {
+	auto top = m_top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	const auto bottom = m_bottom.load(std::memory_order_acquire);
+
+	if (top >= bottom)
+		return false;
+
+	const auto buffer = m_buffer.load(std::memory_order_acquire);
+	task = buffer->at(top).load();
+
+	return m_top.compare_exchange_strong(top, top + 1,
+			std::memory_order_seq_cst, std::memory_order_relaxed);
+}
+
+ThreadPool::WorkDeque::Buffer* ThreadPool::WorkDeque::grow(
+		Buffer *old, const int64_t bottom, const int64_t top) {
+	auto bigger = std::make_unique<Buffer>((old->mask + 1) * 2);
+
+	for (auto index = top; index < bottom; index++) {
+		bigger->at(index).store(old->at(index).load());
+	}
+
+	auto ret = bigger.get();
+	m_buffers.push_back(std::move(bigger));
+	m_buffer.store(ret, std::memory_order_release);
+	return ret;
+}
+
+ThreadPool::ThreadPool(const Settings &settings) {
+	const auto cpus = proc::get_affinity().cpus();
+	const auto num_workers = settings.workers ? settings.workers : cpus.size();
+
+	if (num_workers == 0) {
+		throw UsageError{"ThreadPool needs at least one worker"};
+	}
+
+	for (size_t index = 0; index < num_workers; index++) {
+		m_workers.emplace_back(std::make_unique<Worker>(*this, index));
+	}
+
+	try {
+		for (auto &worker: m_workers) {
+			auto &thread = m_threads.emplace_back(
+					[this, &worker = *worker]() { run(worker); },
+					settings.name + std::to_string(worker->index));
+
+			if (settings.pin_cpus) {
+				thread.setAffinity(CPUSet{cpus[worker->index % cpus.size()]});
+			}
+		}
+	} catch (...) {
+		stopWorkers();
+		throw;
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	stopWorkers();
+}
+
+void ThreadPool::stopWorkers() {
+	m_stop.store(true, std::memory_order_seq_cst);
+	m_wake_epoch.fetch_add(1, std::memory_order_release);
+	futex::wake_all(m_wake_epoch);
+
+	for (auto &thread: m_threads) {
+		thread.join();
+	}
+
+	m_threads.clear();
+}
+
+void ThreadPool::submitTask(const Task &task) {
+	if (auto worker = callingWorker(); worker && &worker->pool == this) {
+		// account before publishing, see pendingTasks()
+		worker->local_submitted.fetch_add(1, std::memory_order_seq_cst);
+		worker->deque.push(task);
+	} else {
+		auto &target = *m_workers[t_next_inbox++ % m_workers.size()];
+		FutexMutexGuard guard{target.inbox_lock};
+		target.inbox_submitted.fetch_add(1, std::memory_order_seq_cst);
+		target.inbox.push_back(task);
+	}
+
+	wakeWorker();
+}
+
+void ThreadPool::wakeWorker() {
+	// pairs with the increment of m_parked in park(): either we see the
+	// parked worker, or it sees the new task.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (m_parked.load(std::memory_order_relaxed) != 0) {
+		m_wake_epoch.fetch_add(1, std::memory_order_release);
+		futex::wake(m_wake_epoch, 1);
+	}
+}
+
+std::optional<size_t> ThreadPool::currentWorker() const {
+	if (auto worker = callingWorker(); worker && &worker->pool == this) {
+		return worker->index;
+	}
+
+	return std::nullopt;
+}
+
+void ThreadPool::run(Worker &worker) {
+	callingWorker() = &worker;
+	worker.drained.reserve(INITIAL_DEQUE_CAPACITY);
+	Task task;
+
+	while (true) {
+		if (findTask(worker, task)) {
+			runTask(worker, task);
+		} else if (m_stop.load(std::memory_order_acquire)) {
+			break;
+		} else {
+			park(worker);
+		}
+	}
+
+	callingWorker() = nullptr;
+}
+
+bool ThreadPool::findTask(Worker &worker, Task &task) {
+	if (worker.deque.take(task))
+		return true;
+
+	{
+		FutexMutexGuard guard{worker.inbox_lock};
+		// swapping keeps both vectors' capacities, thus avoids allocations
+		worker.inbox.swap(worker.drained);
+	}
+
+	if (!worker.drained.empty()) {
+		for (const auto &pending: worker.drained) {
+			worker.deque.push(pending);
+		}
+		worker.drained.clear();
+
+		if (worker.deque.take(task))
+			return true;
+	}
+
+	return stealTask(worker, task);
+}
+
+bool ThreadPool::stealTask(Worker &worker, Task &task) {
+	const auto num_workers = m_workers.size();
+	const auto start = worker.random();
+
+	for (size_t i = 0; i < num_workers; i++) {
+		auto &victim = *m_workers[(start + i) % num_workers];
+
+		if (&victim == &worker)
+			continue;
+
+		// steal() fails if we lose a race against other thieves, retry
+		// as long as there are tasks left.
+		while (!victim.deque.seemsEmpty()) {
+			if (victim.deque.steal(task))
+				return true;
+		}
+
+		// the victim might be busy with a long running task
+		if (victim.inbox_lock.tryLock()) {
+			const bool found = !victim.inbox.empty();
+			if (found) {
+				task = victim.inbox.back();
+				victim.inbox.pop_back();
+			}
+			victim.inbox_lock.unlock();
+
+			if (found)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+void ThreadPool::runTask(Worker &worker, Task &task) {
+	try {
+		task();
+	} catch (const std::exception &ex) {
+		noncritical_error("ThreadPool task threw an exception", ex);
+	} catch (...) {
+		noncritical_error("ThreadPool task threw an exception",
+				RuntimeError{"unknown exception type"});
+	}
+
+	worker.completed.fetch_add(1, std::memory_order_seq_cst);
+}
+
+void ThreadPool::park(Worker &worker) {
+	const auto epoch = m_wake_epoch.load(std::memory_order_acquire);
+	m_parked.fetch_add(1, std::memory_order_seq_cst);
+
+	if (m_idle_waiters.load(std::memory_order_seq_cst) != 0) {
+		m_idle_epoch.fetch_add(1, std::memory_order_release);
+		futex::wake_all(m_idle_epoch);
+	}
+
+	// check again, a task could have been submitted before we became
+	// visible as parked.
+	Task task;
+	if (findTask(worker, task)) {
+		m_parked.fetch_sub(1, std::memory_order_relaxed);
+		runTask(worker, task);
+		return;
+	}
+
+	if (!m_stop.load(std::memory_order_acquire)) {
+		futex::wait(m_wake_epoch, epoch);
+	}
+
+	m_parked.fetch_sub(1, std::memory_order_relaxed);
+}
+
+size_t ThreadPool::pendingTasks() const {
+	/*
+	 * Each task is accounted as submitted before it is published. Reading
+	 * all completion counters before the submission counters thus never
+	 * yields more completed than submitted tasks.
+	 */
+	uint64_t completed = 0;
+	uint64_t submitted = 0;
+
+	for (const auto &worker: m_workers) {
+		completed += worker->completed.load(std::memory_order_seq_cst);
+	}
+
+	for (const auto &worker: m_workers) {
+		submitted += worker->local_submitted.load(std::memory_order_seq_cst);
+		submitted += worker->inbox_submitted.load(std::memory_order_seq_cst);
+	}
+
+	return static_cast<size_t>(submitted - completed);
+}
+
+void ThreadPool::waitIdle() {
+	if (currentWorker()) {
+		throw UsageError{"ThreadPool::waitIdle() called from a worker thread"};
+	}
+
+	while (true) {
+		const auto epoch = m_idle_epoch.load(std::memory_order_acquire);
+		m_idle_waiters.fetch_add(1, std::memory_order_seq_cst);
+
+		const bool idle = pendingTasks() == 0;
+
+		if (!idle) {
+			futex::wait(m_idle_epoch, epoch);
+		}
+
+		m_idle_waiters.fetch_sub(1, std::memory_order_relaxed);
+
+		if (idle)
+			return;
+	}
+}
+
+} // end ns
@@ -0,0 +1,125 @@
+// Linux
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <sys/sysinfo.h>
+#include <time.h>
+#include <unistd.h>
+
+// cosmos
+#include <cosmos/error/ApiError.hxx>
+#include <cosmos/error/UsageError.hxx>
+#include <cosmos/thread/futex.hxx>
+
+namespace cosmos::futex {
+
+namespace {
+
+int op_flags(const int op, const ProcessShared shared) {
+	return shared ? op : (op | FUTEX_PRIVATE_FLAG);
+}
+
+uint32_t* word_addr(const Word &word) {
+	// the kernel operates on the raw integer, which is fine for atomics
+	// that are lock-free.
+	return reinterpret_cast<uint32_t*>(const_cast<Word*>(&word));
+}
+
+long sys_futex(const Word &word, const int op, const uint32_t val,
+		const struct timespec *timeout, const Word *target, const uint32_t val3) {
+	return ::syscall(SYS_futex, word_addr(word), op, val, timeout,
+			target ? word_addr(*target) : nullptr, val3);
+}
+
+} // end anon ns
+
+bool wait(const Word &word, const uint32_t expected,
+		const ProcessShared shared, const std::optional<MonotonicTime> timeout) {
+	// FUTEX_WAIT uses relative timeouts, FUTEX_WAIT_BITSET absolute
+	// CLOCK_MONOTONIC ones, which are robust against repeated wakeups.
+	const auto res = sys_futex(word, op_flags(FUTEX_WAIT_BITSET, shared), expected,
+			timeout ? &(*timeout) : nullptr, nullptr, FUTEX_BITSET_MATCH_ANY);
+
+	if (res == 0)
+		return true;
+
+	switch (get_errno()) {
+		case Errno::AGAIN:
+		case Errno::INTERRUPTED:
+			return true;
+		case Errno::TIMEDOUT:
+			return false;
+		default:
+			throw ApiError{"futex(FUTEX_WAIT_BITSET)"};
+	}
+}
+
+size_t wake(const Word &word, const int count, const ProcessShared shared) {
+	const auto res = sys_futex(word, op_flags(FUTEX_WAKE, shared),
+			static_cast<uint32_t>(count), nullptr, nullptr, 0);
+
+	if (res < 0) {
+		throw ApiError{"futex(FUTEX_WAKE)"};
+	}
+
+	return static_cast<size_t>(res);
+}
+
+bool requeue(const Word &word, const uint32_t expected, const int count,
+		const Word &target, const int max_requeue, const ProcessShared shared) {
+	// the timeout parameter is reused for `val2` in this operation
+	const auto res = ::syscall(SYS_futex, word_addr(word), op_flags(FUTEX_CMP_REQUEUE, shared),
+			count, static_cast<long>(max_requeue), word_addr(target), expected);
+
+	if (res >= 0)
+		return true;
+	else if (get_errno() == Errno::AGAIN)
+		return false;
+
+	throw ApiError{"futex(FUTEX_CMP_REQUEUE)"};
+}
+
+std::optional<size_t> wait_multiple(const std::vector<WaitEntry> &entries,
+		const std::optional<MonotonicTime> timeout) {
+#ifdef SYS_futex_waitv
+	if (entries.size() > FUTEX_WAITV_MAX) {
+		throw UsageError{"too many futex wait entries"};
+	}
+
+	std::vector<struct futex_waitv> waiters;
+	waiters.reserve(entries.size());
+
+	for (const auto &entry: entries) {
+		struct futex_waitv waiter{};
+		waiter.val = entry.expected;
+		waiter.uaddr = reinterpret_cast<uintptr_t>(word_addr(*entry.word));
+		waiter.flags = entry.shared ? FUTEX_32 : (FUTEX_32 | FUTEX_PRIVATE_FLAG);
+		waiters.push_back(waiter);
+	}
+
+	const auto res = ::syscall(SYS_futex_waitv, waiters.data(), waiters.size(), 0,
+			timeout ? &(*timeout) : nullptr, to_integral(ClockType::MONOTONIC));
+
+	if (res >= 0)
+		return static_cast<size_t>(res);
+
+	switch (get_errno()) {
+		case Errno::AGAIN:
+		case Errno::INTERRUPTED:
+		case Errno::TIMEDOUT:
+			return std::nullopt;
+		default:
+			throw ApiError{"futex_waitv()"};
+	}
+#else
+	(void)entries;
+	(void)timeout;
+	throw ApiError{"futex_waitv()", Errno::NO_SYS};
+#endif
+}
+
+size_t spin_limit() {
+	static const size_t limit = ::get_nprocs() > 1 ? 100 : 0;
+	return limit;
+}
+
+} // end ns
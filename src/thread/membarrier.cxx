@@ -0,0 +1,66 @@
+// Linux
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// C++
+#include <mutex>
+
+// cosmos
+#include <cosmos/error/ApiError.hxx>
+#include <cosmos/thread/membarrier.hxx>
+
+namespace cosmos::membarrier {
+
+namespace detail {
+
+std::atomic<State> state = State::UNKNOWN;
+
+} // end ns
+
+namespace {
+
+long sys_membarrier(const int cmd) {
+	return ::syscall(SYS_membarrier, cmd, 0, 0);
+}
+
+} // end anon ns
+
+Commands query() {
+	const auto res = sys_membarrier(MEMBARRIER_CMD_QUERY);
+
+	if (res < 0) {
+		throw ApiError{"membarrier(MEMBARRIER_CMD_QUERY)"};
+	}
+
+	return Commands{static_cast<Commands::EnumBaseType>(res)};
+}
+
+void run(const Command cmd) {
+	if (sys_membarrier(static_cast<int>(cmd)) != 0) {
+		throw ApiError{"membarrier()"};
+	}
+}
+
+bool register_private_expedited() {
+	static std::once_flag once;
+
+	std::call_once(once, []() {
+		// readers may only rely on compiler barriers once the
+		// registration is complete, thus publish the state last.
+		const auto ok = sys_membarrier(MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED) == 0;
+		detail::state.store(ok ? detail::State::EXPEDITED : detail::State::FALLBACK);
+	});
+
+	return has_private_expedited();
+}
+
+void heavy_fence() {
+	if (register_private_expedited()) {
+		// this can't fail after successful registration
+		sys_membarrier(MEMBARRIER_CMD_PRIVATE_EXPEDITED);
+	} else {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+	}
+}
+
+} // end ns
@@ -0,0 +1,230 @@
+// C++
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+// cosmos
+#include <cosmos/error/RuntimeError.hxx>
+#include <cosmos/proc/process.hxx>
+#include <cosmos/thread/FutexMutex.hxx>
+#include <cosmos/thread/PosixThread.hxx>
+#include <cosmos/thread/parallel.hxx>
+
+namespace cosmos::parallel {
+
+namespace {
+
+/// Shared state of one run_chunks() invocation.
+class Job {
+public: // functions
+
+	Job(const size_t begin, const size_t end, const ChunkFunc &func,
+			const size_t threads, const size_t grain) :
+			m_func{func},
+			m_grain{grain},
+			m_num_ranges{threads},
+			m_ranges{std::make_unique<Range[]>(threads)} {
+		// distribute the range evenly, the first `extra` workers get one
+		// more element.
+		const auto total = end - begin;
+		const auto per_worker = total / threads;
+		const auto extra = total % threads;
+		size_t next = begin;
+
+		for (size_t worker = 0; worker < threads; worker++) {
+			auto &range = m_ranges[worker];
+			range.next = next;
+			next += per_worker + (worker < extra ? 1 : 0);
+			range.end = next;
+		}
+	}
+
+	void runStatic(const size_t worker) {
+		const auto &range = m_ranges[worker];
+
+		if (range.next == range.end)
+			return;
+
+		try {
+			m_func(worker, range.next, range.end);
+		} catch (...) {
+			setError(std::current_exception());
+		}
+	}
+
+	void runStealing(const size_t worker) {
+		try {
+			do {
+				while (auto chunk = takeChunk(worker)) {
+					if (m_aborted.load(std::memory_order_relaxed))
+						return;
+					m_func(worker, chunk->first, chunk->second);
+				}
+			} while (steal(worker));
+		} catch (...) {
+			setError(std::current_exception());
+		}
+	}
+
+	void rethrowError() {
+		if (m_error) {
+			std::rethrow_exception(m_error);
+		}
+	}
+
+protected: // types
+
+	/// The remaining part of the index range owned by one worker.
+	struct alignas(CACHE_LINE_SIZE) Range {
+		FutexMutex lock;
+		size_t next = 0;
+		size_t end = 0;
+	};
+
+	using Chunk = std::pair<size_t, size_t>;
+
+protected: // functions
+
+	/// Takes the next chunk of up to `m_grain` elements from the front of our own range.
+	std::optional<Chunk> takeChunk(const size_t worker) {
+		auto &range = m_ranges[worker];
+		FutexMutexGuard g{range.lock};
+
+		if (range.next == range.end)
+			return {};
+
+		const auto first = range.next;
+		range.next += std::min(m_grain, range.end - first);
+		return Chunk{first, range.next};
+	}
+
+	/// Moves the upper half of the remaining range of another worker into our own range.
+	/**
+	 * \return Whether any work has been stolen.
+	 **/
+	bool steal(const size_t worker) {
+		for (size_t offset = 1; offset < m_num_ranges; offset++) {
+			auto &victim = m_ranges[(worker + offset) % m_num_ranges];
+
+			size_t first, last;
+
+			{
+				FutexMutexGuard g{victim.lock};
+				const auto left = victim.end - victim.next;
+
+				if (left == 0)
+					continue;
+
+				// take the upper half, the victim continues at
+				// the front of its range.
+				first = victim.next + left / 2;
+				last = victim.end;
+				victim.end = first;
+			}
+
+			auto &own = m_ranges[worker];
+			FutexMutexGuard g{own.lock};
+			own.next = first;
+			own.end = last;
+			return true;
+		}
+
+		return false;
+	}
+
+	void setError(std::exception_ptr error) {
+		if (!m_aborted.exchange(true)) {
+			m_error = error;
+		}
+	}
+
+protected: // data
+
+	const ChunkFunc &m_func;
+	const size_t m_grain;
+	const size_t m_num_ranges;
+	std::unique_ptr<Range[]> m_ranges;
+	/// Set once a worker caught an exception.
+	std::atomic_bool m_aborted = false;
+	/// The first exception caught, only written by the worker that set m_aborted.
+	std::exception_ptr m_error;
+};
+
+} // end anon ns
+
+size_t num_threads(const Settings &settings) {
+	if (settings.threads != 0)
+		return settings.threads;
+
+	return std::max(proc::get_affinity().count(), size_t{1});
+}
+
+void run_chunks(const size_t begin, const size_t end,
+		const ChunkFunc &func, const Settings &settings) {
+	if (begin >= end)
+		return;
+
+	const auto total = end - begin;
+	// don't create workers that would have nothing to do
+	const auto threads = std::min(num_threads(settings), total);
+
+	if (threads == 1) {
+		func(0, begin, end);
+		return;
+	}
+
+	// by default split each worker's share into 16 chunks, which gives
+	// thieves something to take without locking for every element.
+	const auto grain = settings.grain != 0 ?
+		settings.grain : std::max(total / (threads * 16), size_t{1});
+
+	Job job{begin, end, func, threads, grain};
+	const bool stealing = settings.schedule == Schedule::WORK_STEALING;
+
+	auto run_worker = [&job, stealing](const size_t worker) {
+		if (stealing) {
+			job.runStealing(worker);
+		} else {
+			job.runStatic(worker);
+		}
+	};
+
+	std::vector<PosixThread> workers;
+	workers.reserve(threads - 1);
+
+	try {
+		for (size_t worker = 1; worker < threads; worker++) {
+			auto entry = [&run_worker, worker]() { run_worker(worker); };
+
+			if (settings.attrs) {
+				workers.emplace_back(entry, *settings.attrs);
+			} else {
+				workers.emplace_back(entry);
+			}
+
+			// this PosixThread constructor doesn't throw on error
+			if (!workers.back().joinable()) {
+				workers.pop_back();
+				throw RuntimeError{"failed to create parallel worker thread"};
+			}
+		}
+	} catch (...) {
+		// the workers that have been started still reference the Job
+		for (auto &thread: workers) {
+			thread.join();
+		}
+		throw;
+	}
+
+	// the caller participates as worker 0
+	run_worker(0);
+
+	for (auto &thread: workers) {
+		thread.join();
+	}
+
+	job.rethrowError();
+}
+
+} // end ns
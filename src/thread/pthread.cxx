@@ -29,4 +29,23 @@ void kill(const ID thread, const Signal sig) {
 	}
 }
 
+void set_affinity(const ID thread, const CPUSet &cpus) {
+	const auto res = ::pthread_setaffinity_np(thread.raw(), cpus.size(), cpus.raw());
+
+	if (const auto error = Errno{res}; error != Errno::NO_ERROR) {
+		throw ApiError{"pthread_setaffinity_np()", error};
+	}
+}
+
+CPUSet get_affinity(const ID thread) {
+	CPUSet ret;
+	const auto res = ::pthread_getaffinity_np(thread.raw(), ret.size(), ret.raw());
+
+	if (const auto error = Errno{res}; error != Errno::NO_ERROR) {
+		throw ApiError{"pthread_getaffinity_np()", error};
+	}
+
+	return ret;
+}
+
 } // end ns
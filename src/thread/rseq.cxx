@@ -0,0 +1,156 @@
+// Linux
+#include <sys/sysinfo.h>
+
+// C++
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+// cosmos
+#include <cosmos/error/UsageError.hxx>
+#include <cosmos/string.hxx>
+#include <cosmos/thread/rseq.hxx>
+
+namespace cosmos::rseq {
+
+namespace {
+
+std::atomic<int64_t>* slot_at(std::atomic<int64_t> *slots, const size_t stride, const size_t index) {
+	auto base = reinterpret_cast<char*>(slots);
+	return reinterpret_cast<std::atomic<int64_t>*>(base + stride * index);
+}
+
+#if defined(__x86_64__)
+
+/*
+ * The signature preceding the abort handler, needs to match the value glibc
+ * registered the rseq area with.
+ */
+#define COSMOS_RSEQ_SIG "0x53053053"
+
+/// Adds `value` to `*target` if the caller is (still) running on `cpu`.
+/**
+ * This is the x86_64 rseq critical section following the layout from the
+ * kernel's rseq selftests: a struct rseq_cs descriptor is placed into the
+ * `__rseq_cs` section and stored into the rseq area before the CPU check.
+ * The final `addq` is the commit instruction. If the kernel preempts us
+ * anywhere between the label 1 and 2 then it jumps to the abort handler
+ * at label 4 instead of continuing.
+ *
+ * \return `false` if the critical section was aborted or the caller is not
+ *         running on `cpu`.
+ **/
+bool add_on_cpu(int64_t *target, const int64_t value, const uint32_t cpu) {
+	__asm__ __volatile__ goto (
+		".pushsection __rseq_cs, \"aw\"\n\t"
+		".balign 32\n\t"
+		"3:\n\t"
+		// version, flags
+		".long 0x0, 0x0\n\t"
+		// start_ip, post_commit_offset, abort_ip
+		".quad 1f, (2f - 1f), 4f\n\t"
+		".popsection\n\t"
+		".pushsection __rseq_cs_ptr_array, \"aw\"\n\t"
+		".quad 3b\n\t"
+		".popsection\n\t"
+		// rseq->rseq_cs = &descriptor
+		"leaq 3b(%%rip), %%rax\n\t"
+		"movq %%rax, %%fs:8(%[rseq_offset])\n\t"
+		"1:\n\t"
+		// rseq->cpu_id == cpu
+		"cmpl %[cpu], %%fs:4(%[rseq_offset])\n\t"
+		"jnz 4f\n\t"
+		"addq %[value], %[target]\n\t"
+		"2:\n\t"
+		".pushsection __rseq_failure, \"ax\"\n\t"
+		// disassembler friendly signature: ud1 <sig>(%rip),%edi
+		".byte 0x0f, 0xb9, 0x3d\n\t"
+		".long " COSMOS_RSEQ_SIG "\n\t"
+		"4:\n\t"
+		"jmp %l[abort]\n\t"
+		".popsection\n\t"
+		: [target] "+m" (*target)
+		: [cpu] "r" (cpu),
+		  [rseq_offset] "r" (__rseq_offset),
+		  [value] "er" (value)
+		: "memory", "cc", "rax"
+		: abort
+	);
+
+	return true;
+abort:
+	return false;
+}
+
+#undef COSMOS_RSEQ_SIG
+
+#endif // __x86_64__
+
+} // end anon ns
+
+bool has_percpu_ops() {
+#if defined(__x86_64__)
+	return is_available();
+#else
+	return false;
+#endif
+}
+
+size_t possible_cpu_slots() {
+	static const size_t slots = []() -> size_t {
+		std::ifstream file{"/sys/devices/system/cpu/possible"};
+		std::string list;
+
+		// the list looks like "0-7" or "0,2-5", the last number is the highest
+		if (std::getline(file, list)) {
+			strip(list);
+			const auto sep = list.find_last_of(",-");
+			const auto last = std::string_view{list}.substr(sep == list.npos ? 0 : sep + 1);
+			size_t highest = 0;
+			const auto end = last.data() + last.size();
+
+			if (const auto [ptr, ec] = std::from_chars(last.data(), end, highest);
+					ec == std::errc{} && ptr == end) {
+				return highest + 1;
+			}
+		}
+
+		return static_cast<size_t>(std::max(::get_nprocs_conf(), 1));
+	}();
+
+	return slots;
+}
+
+void percpu_add(std::atomic<int64_t> *slots, const size_t stride,
+		const size_t num_slots, const int64_t value) {
+#if defined(__x86_64__)
+	if (auto rs = area(); rs) {
+		while (true) {
+			const auto cpu = rs->cpu_id;
+
+			if (cpu >= num_slots) {
+				// an atomic update of another slot would race
+				// with the rseq updates of its owner CPU
+				throw UsageError{"per-CPU slots don't cover all possible CPUs"};
+			}
+
+			auto slot = slot_at(slots, stride, cpu);
+
+			if (add_on_cpu(reinterpret_cast<int64_t*>(slot), value, cpu))
+				return;
+		}
+	}
+#endif
+
+	const auto cpu = current_cpu();
+
+	if (cpu >= num_slots) {
+		throw UsageError{"per-CPU slots don't cover all possible CPUs"};
+	}
+
+	slot_at(slots, stride, cpu)->fetch_add(value, std::memory_order_relaxed);
+}
+
+} // end ns
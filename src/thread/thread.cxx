@@ -5,6 +5,7 @@
 // cosmos
 #include <cosmos/proc/prctl.hxx>
 #include <cosmos/proc/process.hxx>
+#include <cosmos/thread/rseq.hxx>
 #include <cosmos/thread/thread.hxx>
 
 namespace cosmos::thread {
@@ -14,6 +15,10 @@ ThreadID get_tid() {
 	return static_cast<ThreadID>(syscall(SYS_gettid));
 }
 
+unsigned get_cpu() {
+	return rseq::current_cpu();
+}
+
 bool is_main_thread() {
 	return as_pid(get_tid()) == proc::get_own_pid();
 }
@@ -0,0 +1,209 @@
+// C++
+#include <iostream>
+#include <string>
+
+// cosmos
+#include <cosmos/error/ApiError.hxx>
+#include <cosmos/fs/Directory.hxx>
+#include <cosmos/fs/filesystem.hxx>
+#include <cosmos/proc/ChildCloner.hxx>
+#include <cosmos/proc/CPUSet.hxx>
+#include <cosmos/proc/numa.hxx>
+#include <cosmos/proc/OutputCapture.hxx>
+#include <cosmos/proc/process.hxx>
+#include <cosmos/proc/SpawnServer.hxx>
+#include <cosmos/proc/SubProc.hxx>
+#include <cosmos/thread/PosixThread.hxx>
+
+// Test
+#include "TestBase.hxx"
+
+class AffinityTest :
+		public cosmos::TestBase {
+
+	void runTests() override {
+		testCPUSet();
+		testProcess();
+		testThread();
+		testMemPolicy();
+		testChild();
+		testCGroup();
+	}
+
+	void testCPUSet() {
+		START_TEST("CPUSet");
+		cosmos::CPUSet set{0, 2, 5};
+
+		RUN_STEP("count", set.count() == 3);
+		RUN_STEP("is-set", set.isSet(2) && !set.isSet(1));
+		RUN_STEP("cpus", set.cpus() == std::vector<unsigned>({0, 2, 5}));
+
+		set.reset(2);
+		RUN_STEP("reset", !set.isSet(2) && set.count() == 2);
+
+		const cosmos::CPUSet other{5, 7};
+		RUN_STEP("intersection", (set & other) == cosmos::CPUSet{5});
+		RUN_STEP("union", (set | other) == cosmos::CPUSet({0, 5, 7}));
+
+		set.clear();
+		RUN_STEP("clear", set.empty());
+	}
+
+	void testProcess() {
+		START_TEST("process affinity");
+		const auto orig = cosmos::proc::get_affinity();
+		RUN_STEP("have-cpus", !orig.empty());
+
+		const auto first = orig.cpus().front();
+		cosmos::proc::set_affinity(cosmos::CPUSet{first});
+
+		RUN_STEP("affinity-applied", cosmos::proc::get_affinity() == cosmos::CPUSet{first});
+		RUN_STEP("running-on-cpu", cosmos::proc::get_current_cpu() == first);
+
+		cosmos::proc::set_affinity(orig);
+		RUN_STEP("affinity-restored", cosmos::proc::get_affinity() == orig);
+
+		EXPECT_EXCEPTION("empty-set-rejected", cosmos::proc::set_affinity(cosmos::CPUSet{}));
+	}
+
+	void testThread() {
+		START_TEST("thread affinity");
+		const auto orig = cosmos::proc::get_affinity();
+		const cosmos::CPUSet last{orig.cpus().back()};
+		unsigned cpu = cosmos::CPUSet::MAX_CPUS;
+
+		cosmos::PosixThread thread{[&cpu, &last]() {
+			// busy wait until the affinity has been set by the main thread
+			while (cosmos::proc::get_affinity() != last)
+				;
+			cpu = cosmos::proc::get_current_cpu();
+		}};
+
+		thread.setAffinity(last);
+		RUN_STEP("get-thread-affinity", thread.getAffinity() == last);
+		thread.join();
+
+		RUN_STEP("thread-on-cpu", last.isSet(cpu));
+		RUN_STEP("process-unaffected", cosmos::proc::get_affinity() == orig);
+	}
+
+	void testMemPolicy() {
+		START_TEST("NUMA memory policy");
+		cosmos::numa::MemPolicySettings settings;
+		settings.policy = cosmos::numa::MemPolicy::INTERLEAVE;
+		settings.nodes = {0};
+
+		RUN_STEP("node-mask", settings.nodeMask() == std::vector<unsigned long>{1});
+
+		try {
+			cosmos::numa::set_mem_policy(settings);
+			cosmos::numa::set_mem_policy(cosmos::numa::MemPolicySettings{});
+		} catch (const cosmos::ApiError &ex) {
+			// kernel without NUMA support
+			RUN_STEP("no-numa-support", ex.errnum() == cosmos::Errno::NO_SYS);
+		}
+	}
+
+	/// Runs a shell command in a child and returns its stdout.
+	std::string runChild(cosmos::ChildCloner &cloner, const std::string &cmd, cosmos::SpawnServer *server = nullptr) {
+		cosmos::OutputCapture capture;
+		cloner.setArgs({"/bin/sh", "-c", cmd});
+		auto handle = capture.prepare(cloner, cosmos::OutputCapture::Target::toMemory());
+		auto proc = server ? server->spawn(cloner) : cloner.run();
+		capture.started(handle);
+
+		while (capture.active() != 0) {
+			capture.process();
+		}
+
+		const auto res = proc.wait();
+		auto output = capture.take(handle);
+
+		if (!res.exitedSuccessfully()) {
+			return "<failed>";
+		}
+
+		return output.out.data;
+	}
+
+	void testChild() {
+		START_TEST("child process affinity");
+		const auto first = cosmos::proc::get_affinity().cpus().front();
+		const auto expected = "Cpus_allowed_list:\t" + std::to_string(first) + "\n";
+		const std::string cmd{"grep Cpus_allowed_list /proc/self/status"};
+
+		cosmos::ChildCloner cloner;
+		cloner.setAffinity(cosmos::CPUSet{first});
+
+		RUN_STEP("clone-affinity", runChild(cloner, cmd) == expected);
+
+		cloner.setUseVFork(true);
+		RUN_STEP("vfork-affinity", runChild(cloner, cmd) == expected);
+		cloner.setUseVFork(false);
+
+		cosmos::SpawnServer server;
+		server.start();
+		RUN_STEP("spawn-server-affinity", runChild(cloner, cmd, &server) == expected);
+		server.stop();
+	}
+
+	void testCGroup() {
+		START_TEST("child process cgroup");
+
+		{
+			// not a cgroup directory, placing the child must fail
+			cosmos::Directory not_cgroup{"/"};
+			cosmos::ChildCloner cloner{{"true"}};
+			cloner.setCGroup(not_cgroup.fd());
+
+			EXPECT_EXCEPTION("bad-cgroup-throws", cloner.run());
+
+			cloner.setUseVFork(true);
+			EXPECT_EXCEPTION("vfork-bad-cgroup-throws", cloner.run());
+		}
+
+		std::string root;
+
+		for (const auto path: {"/sys/fs/cgroup", "/sys/fs/cgroup/unified"}) {
+			if (cosmos::fs::exists_file(std::string{path} + "/cgroup.procs")) {
+				root = path;
+				break;
+			}
+		}
+
+		if (root.empty()) {
+			std::cout << "no cgroup2 hierarchy found, skipping\n";
+			return;
+		}
+
+		const auto name = "cosmos-test-" + std::to_string(cosmos::to_integral(cosmos::proc::get_own_pid()));
+		const auto path = root + "/" + name;
+
+		try {
+			cosmos::fs::make_dir(path, cosmos::FileMode{cosmos::ModeT{0755}});
+		} catch (const cosmos::ApiError &ex) {
+			std::cout << "cannot create cgroup (" << ex.what() << "), skipping\n";
+			return;
+		}
+
+		cosmos::Directory dir{path};
+		const auto expected = "0::/" + name + "\n";
+		const std::string cmd{"grep ^0:: /proc/self/cgroup"};
+
+		cosmos::ChildCloner cloner;
+		cloner.setCGroup(dir.fd());
+
+		RUN_STEP("clone-cgroup", runChild(cloner, cmd) == expected);
+
+		cloner.setUseVFork(true);
+		RUN_STEP("vfork-cgroup", runChild(cloner, cmd) == expected);
+
+		dir.close();
+		cosmos::fs::remove_dir(path);
+	}
+};
+
+int main(const int argc, const char **argv) {
+	AffinityTest test;
+	return test.run(argc, argv);
+}
@@ -0,0 +1,147 @@
+// C++
+#include <iostream>
+#include <string>
+#include <vector>
+
+// cosmos
+#include <cosmos/error/ApiError.hxx>
+#include <cosmos/fs/AppendLog.hxx>
+#include <cosmos/fs/FileStatus.hxx>
+#include <cosmos/fs/TempDir.hxx>
+#include <cosmos/thread/PosixThread.hxx>
+
+// Test
+#include "TestBase.hxx"
+
+class AppendLogTest :
+		public cosmos::TestBase {
+
+	void runTests() override {
+		testSequential();
+		testConcurrent();
+		testPreallocate();
+		testNoSync();
+	}
+
+	cosmos::File openLog(const std::string &path) {
+		return cosmos::File{path, cosmos::OpenMode::READ_WRITE,
+				{cosmos::OpenFlag::CREATE, cosmos::OpenFlag::CLOEXEC},
+				cosmos::FileMode{cosmos::ModeT{0600}}};
+	}
+
+	std::string readAll(const std::string &path) {
+		cosmos::File file{path, cosmos::OpenMode::READ_ONLY};
+		std::string ret;
+		file.readAll(ret, cosmos::FileStatus{path}.size());
+		return ret;
+	}
+
+	void testSequential() {
+		START_TEST("sequential appends");
+		auto tmp = getTempDir();
+		const auto path = tmp.path() + "/log";
+
+		cosmos::AppendLog log{openLog(path)};
+
+		RUN_STEP("first-offset-zero", log.append("hello ") == 0);
+		RUN_STEP("second-offset-follows", log.append("world") == 6);
+		RUN_STEP("tail-updated", log.tail() == 11);
+		RUN_STEP("content-matches", readAll(path) == "hello world");
+
+		const auto stats = log.stats();
+		RUN_STEP("stats-match", stats.records == 2 && stats.batches == 2 && stats.bytes == 11);
+
+		// reopening continues at the end of the file
+		cosmos::AppendLog log2{openLog(path), cosmos::AppendLog::SyncMode::DSYNC_WRITE};
+
+		RUN_STEP("reopen-continues-at-end", log2.append("!") == 11);
+		RUN_STEP("dsync-content-matches", readAll(path) == "hello world!");
+	}
+
+	void testConcurrent() {
+		START_TEST("concurrent appends");
+		auto tmp = getTempDir();
+		const auto path = tmp.path() + "/log";
+		constexpr size_t THREADS = 8;
+		constexpr size_t RECORDS = 200;
+		const std::string record{"0123456789abcdef\n"};
+
+		cosmos::AppendLog log{openLog(path)};
+		std::vector<cosmos::PosixThread> threads;
+
+		for (size_t nr = 0; nr < THREADS; nr++) {
+			threads.emplace_back([&log, &record]() {
+				for (size_t i = 0; i < RECORDS; i++) {
+					log.append(record);
+				}
+			}, "appender");
+		}
+
+		for (auto &thread: threads) {
+			thread.join();
+		}
+
+		const auto stats = log.stats();
+		const auto total = THREADS * RECORDS * record.size();
+
+		std::cout << "wrote " << stats.records << " records in " << stats.batches << " batches\n";
+
+		RUN_STEP("all-records-counted", stats.records == THREADS * RECORDS);
+		RUN_STEP("batches-plausible", stats.batches >= 1 && stats.batches <= stats.records);
+		RUN_STEP("file-size-matches", static_cast<size_t>(cosmos::FileStatus{path}.size()) == total);
+
+		const auto data = readAll(path);
+		bool intact = data.size() == total;
+
+		for (size_t pos = 0; intact && pos < data.size(); pos += record.size()) {
+			intact = data.compare(pos, record.size(), record) == 0;
+		}
+
+		RUN_STEP("records-not-interleaved", intact);
+	}
+
+	void testPreallocate() {
+		START_TEST("preallocation");
+		auto tmp = getTempDir();
+		const auto path = tmp.path() + "/log";
+
+		cosmos::AppendLog log{openLog(path)};
+		log.append("data");
+
+		try {
+			log.preallocate(1024 * 1024);
+		} catch (const cosmos::ApiError &ex) {
+			if (ex.errnum() == cosmos::Errno::OP_NOT_SUPPORTED) {
+				std::cerr << "file system does not support preallocation, skipping\n";
+				return;
+			}
+			throw;
+		}
+
+		RUN_STEP("tail-unchanged", log.tail() == 4);
+		RUN_STEP("size-unchanged", cosmos::FileStatus{path}.size() == 4);
+		RUN_STEP("append-after-prealloc", log.append("more") == 4);
+	}
+
+	void testNoSync() {
+		START_TEST("no sync mode");
+		auto tmp = getTempDir();
+		const auto path = tmp.path() + "/log";
+
+		cosmos::AppendLog log{openLog(path), cosmos::AppendLog::SyncMode::NONE};
+		log.setWritebackThreshold(64);
+		const std::string record(100, 'x');
+
+		for (size_t i = 0; i < 10; i++) {
+			log.append(record);
+		}
+
+		DOES_NOT_THROW("explicit-sync", log.sync());
+		RUN_STEP("size-matches", cosmos::FileStatus{path}.size() == 1000);
+	}
+};
+
+int main(const int argc, const char **argv) {
+	AppendLogTest test;
+	return test.run(argc, argv);
+}
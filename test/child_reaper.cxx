@@ -0,0 +1,150 @@
+// C++
+#include <chrono>
+#include <iostream>
+#include <set>
+
+// cosmos
+#include <cosmos/error/UsageError.hxx>
+#include <cosmos/proc/ChildCloner.hxx>
+#include <cosmos/proc/ChildReaper.hxx>
+#include <cosmos/proc/signal.hxx>
+#include <cosmos/time/StopWatch.hxx>
+
+// Test
+#include "TestBase.hxx"
+
+using namespace std::chrono_literals;
+
+class ChildReaperTest :
+		public cosmos::TestBase {
+
+	void runTests() override {
+		testBatch();
+		testTimeout();
+		testDeadline();
+		testEscalation();
+		testErrors();
+	}
+
+	void testBatch() {
+		START_TEST("batch reaping");
+		cosmos::ChildReaper reaper;
+		cosmos::ChildCloner cloner{{"true"}};
+		std::set<cosmos::ProcessID> pids;
+		constexpr size_t NUM_CHILDREN = 100;
+
+		for (size_t num = 0; num < NUM_CHILDREN; num++) {
+			pids.insert(reaper.add(cloner.run()));
+		}
+
+		RUN_STEP("all-added", reaper.size() == NUM_CHILDREN);
+
+		cosmos::ChildReaper::ResultVector results;
+		size_t reaped = 0;
+		size_t successful = 0;
+
+		while (!reaper.empty()) {
+			reaper.wait(results);
+			reaped += results.size();
+
+			for (const auto &result: results) {
+				if (result.state.exitedSuccessfully() && !result.deadline_expired)
+					successful++;
+				pids.erase(result.pid);
+			}
+		}
+
+		RUN_STEP("all-reaped", reaped == NUM_CHILDREN && pids.empty());
+		RUN_STEP("all-successful", successful == NUM_CHILDREN);
+
+		reaper.wait(results);
+
+		RUN_STEP("empty-wait-returns", results.empty());
+	}
+
+	void testTimeout() {
+		START_TEST("wait timeout");
+		cosmos::ChildReaper reaper;
+		const auto pid = reaper.add(cosmos::ChildCloner{{"sleep", "10"}}.run());
+		cosmos::ChildReaper::ResultVector results;
+
+		reaper.wait(results, cosmos::IntervalTime{50ms});
+
+		RUN_STEP("timeout-returns-nothing", results.empty() && reaper.contains(pid));
+
+		reaper.kill(pid, cosmos::signal::KILL);
+		reaper.wait(results);
+
+		RUN_STEP("killed-child-reaped", results.size() == 1 && results[0].state.killed());
+		RUN_STEP("child-removed", !reaper.contains(pid));
+	}
+
+	void testDeadline() {
+		START_TEST("deadlines");
+		cosmos::ChildReaper reaper;
+		cosmos::ChildReaper::Deadline deadline;
+		deadline.timeout = cosmos::IntervalTime{100ms};
+		deadline.signal = cosmos::signal::TERMINATE;
+
+		const auto slow = reaper.add(cosmos::ChildCloner{{"sleep", "10"}}.run(), deadline);
+		const auto fast = reaper.add(cosmos::ChildCloner{{"true"}}.run(), deadline);
+		const auto cleared = reaper.add(cosmos::ChildCloner{{"sleep", "0.3"}}.run(), deadline);
+		reaper.clearDeadline(cleared);
+
+		cosmos::ChildReaper::ResultVector results;
+		bool slow_ok = false, fast_ok = false, cleared_ok = false;
+
+		while (!reaper.empty()) {
+			reaper.wait(results);
+
+			for (const auto &result: results) {
+				if (result.pid == slow) {
+					slow_ok = result.deadline_expired && result.state.killed() &&
+						*result.state.signal == cosmos::signal::TERMINATE;
+				} else if (result.pid == fast) {
+					fast_ok = !result.deadline_expired && result.state.exitedSuccessfully();
+				} else if (result.pid == cleared) {
+					cleared_ok = !result.deadline_expired && result.state.exitedSuccessfully();
+				}
+			}
+		}
+
+		RUN_STEP("deadline-signal-sent", slow_ok);
+		RUN_STEP("exit-before-deadline", fast_ok);
+		RUN_STEP("cleared-deadline-ignored", cleared_ok);
+	}
+
+	void testEscalation() {
+		START_TEST("kill escalation");
+		cosmos::ChildReaper reaper;
+		cosmos::ChildReaper::Deadline deadline;
+		deadline.timeout = cosmos::IntervalTime{50ms};
+		deadline.signal = cosmos::signal::TERMINATE;
+		deadline.kill_after = cosmos::IntervalTime{100ms};
+
+		// this child ignores SIGTERM
+		reaper.add(cosmos::ChildCloner{{"/bin/sh", "-c", "trap '' TERM; sleep 10"}}.run(), deadline);
+
+		cosmos::ChildReaper::ResultVector results;
+		cosmos::MonotonicStopWatch watch{cosmos::MonotonicStopWatch::InitialMark{true}};
+
+		reaper.wait(results);
+
+		RUN_STEP("escalated-to-kill", results.size() == 1 && results[0].deadline_expired &&
+				results[0].state.killed() && *results[0].state.signal == cosmos::signal::KILL);
+		RUN_STEP("escalation-timely", watch.elapsedMs() < 5000);
+	}
+
+	void testErrors() {
+		START_TEST("error handling");
+		cosmos::ChildReaper reaper;
+
+		EXPECT_EXCEPTION("add-empty-subproc", reaper.add(cosmos::SubProc{}));
+		EXPECT_EXCEPTION("unknown-pid", reaper.kill(cosmos::ProcessID{1}, cosmos::signal::KILL));
+	}
+};
+
+int main(const int argc, const char **argv) {
+	ChildReaperTest test;
+	return test.run(argc, argv);
+}
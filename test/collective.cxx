@@ -0,0 +1,157 @@
+// C++
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+// cosmos
+#include <cosmos/error/RuntimeError.hxx>
+#include <cosmos/thread/Barrier.hxx>
+#include <cosmos/thread/Latch.hxx>
+#include <cosmos/thread/PosixThread.hxx>
+#include <cosmos/thread/parallel.hxx>
+#include <cosmos/time/Clock.hxx>
+
+// Test
+#include "TestBase.hxx"
+
+using namespace std::chrono_literals;
+
+class CollectiveTest :
+		public cosmos::TestBase {
+
+	static constexpr size_t NUM_THREADS = 4;
+
+	void runTests() override {
+		testLatch();
+		testBarrier();
+		testParallelFor();
+		testParallelReduce();
+	}
+
+	void testLatch() {
+		START_TEST("Latch");
+		cosmos::Latch latch{NUM_THREADS};
+		std::atomic<size_t> arrived = 0;
+
+		RUN_STEP("initially-closed", !latch.tryWait());
+
+		const auto timeout = cosmos::MonotonicClock{}.now() + cosmos::MonotonicTime{10ms};
+		RUN_STEP("timed-wait-times-out", !latch.waitTimed(timeout));
+
+		std::vector<cosmos::PosixThread> threads;
+
+		for (size_t nr = 0; nr < NUM_THREADS; nr++) {
+			threads.emplace_back([&latch, &arrived]() {
+				arrived++;
+				latch.countDown();
+			});
+		}
+
+		latch.wait();
+		RUN_STEP("open-after-countdown", latch.tryWait() && latch.value() == 0);
+		RUN_STEP("all-arrived", arrived == NUM_THREADS);
+
+		for (auto &thread: threads) {
+			thread.join();
+		}
+	}
+
+	void testBarrier() {
+		START_TEST("Barrier");
+		EXPECT_EXCEPTION("zero-count-throws", cosmos::Barrier{0});
+
+		constexpr size_t PHASES = 1000;
+		cosmos::Barrier barrier{NUM_THREADS};
+		std::atomic<size_t> counter = 0;
+		std::atomic<size_t> serial = 0;
+		std::atomic_bool consistent = true;
+		std::vector<cosmos::PosixThread> threads;
+
+		for (size_t nr = 0; nr < NUM_THREADS; nr++) {
+			threads.emplace_back([&]() {
+				for (size_t phase = 0; phase < PHASES; phase++) {
+					counter++;
+
+					if (barrier.arriveAndWait()) {
+						serial++;
+					}
+
+					// all threads of this phase have incremented
+					if (counter.load() < (phase + 1) * NUM_THREADS) {
+						consistent = false;
+					}
+
+					barrier.arriveAndWait();
+				}
+			});
+		}
+
+		for (auto &thread: threads) {
+			thread.join();
+		}
+
+		RUN_STEP("phases-consistent", consistent);
+		RUN_STEP("one-serial-thread-per-phase", serial == PHASES);
+		RUN_STEP("phase-count", barrier.phase() == PHASES * 2);
+	}
+
+	void testParallelFor() {
+		START_TEST("parallel_for");
+		using cosmos::parallel::Schedule;
+
+		for (auto schedule: {Schedule::STATIC, Schedule::WORK_STEALING}) {
+			cosmos::parallel::Settings settings;
+			settings.threads = NUM_THREADS;
+			settings.schedule = schedule;
+
+			std::vector<int> visits(10000, 0);
+
+			cosmos::parallel::parallel_for(0, visits.size(), [&visits](size_t index) {
+				visits[index]++;
+			}, settings);
+
+			bool once = true;
+			for (const auto visit: visits) {
+				once = once && visit == 1;
+			}
+
+			RUN_STEP("each-index-visited-once", once);
+
+			size_t calls = 0;
+			cosmos::parallel::parallel_for(5, 5, [&calls](size_t) { calls++; }, settings);
+			RUN_STEP("empty-range", calls == 0);
+
+			EXPECT_EXCEPTION("exception-is-propagated",
+				cosmos::parallel::parallel_for(0, 1000, [](size_t index) {
+					if (index == 500)
+						throw cosmos::RuntimeError{"test"};
+				}, settings));
+		}
+
+		RUN_STEP("default-threads", cosmos::parallel::num_threads() >= 1);
+	}
+
+	void testParallelReduce() {
+		START_TEST("parallel_reduce");
+		using cosmos::parallel::Schedule;
+		constexpr size_t COUNT = 100000;
+
+		for (auto schedule: {Schedule::STATIC, Schedule::WORK_STEALING}) {
+			cosmos::parallel::Settings settings;
+			settings.schedule = schedule;
+			settings.grain = 7;
+
+			const auto sum = cosmos::parallel::parallel_reduce(0, COUNT, size_t{0},
+				[](size_t index) { return index; },
+				[](size_t a, size_t b) { return a + b; },
+				settings);
+
+			RUN_STEP("sum-matches", sum == COUNT * (COUNT - 1) / 2);
+		}
+	}
+};
+
+int main(const int argc, const char **argv) {
+	CollectiveTest test;
+	return test.run(argc, argv);
+}
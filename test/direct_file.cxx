@@ -0,0 +1,93 @@
+// C++
+#include <cstring>
+#include <iostream>
+
+// cosmos
+#include <cosmos/error/ApiError.hxx>
+#include <cosmos/error/UsageError.hxx>
+#include <cosmos/fs/DirectFile.hxx>
+#include <cosmos/fs/TempDir.hxx>
+
+// Test
+#include "TestBase.hxx"
+
+class DirectFileTest :
+		public cosmos::TestBase {
+
+	void runTests() override {
+		testDirectIO();
+	}
+
+	static bool isPowerOfTwo(const size_t val) {
+		return val != 0 && (val & (val - 1)) == 0;
+	}
+
+	void testDirectIO() {
+		START_TEST("direct I/O");
+		auto tmp = getTempDir();
+		const auto path = tmp.path() + "/direct";
+
+		cosmos::DirectFile file;
+
+		try {
+			file.open(path, cosmos::OpenMode::READ_WRITE,
+					{cosmos::OpenFlag::CREATE, cosmos::OpenFlag::CLOEXEC},
+					cosmos::FileMode{cosmos::ModeT{0600}});
+		} catch (const cosmos::ApiError &ex) {
+			if (ex.errnum() == cosmos::Errno::INVALID_ARG) {
+				std::cerr << "file system does not support O_DIRECT, skipping\n";
+				return;
+			}
+			throw;
+		}
+
+		const auto align = file.alignment();
+
+		RUN_STEP("memory-alignment-valid", isPowerOfTwo(align.memory));
+		RUN_STEP("offset-alignment-valid", isPowerOfTwo(align.offset));
+
+		auto buf = file.allocateBuffer(1);
+
+		RUN_STEP("buffer-size-rounded", buf.size() == align.offset);
+		RUN_STEP("buffer-aligned", file.isAligned(buf.data(), buf.size(), 0));
+
+		std::memset(buf.data(), 'a', buf.size());
+
+		RUN_STEP("aligned-write", file.writeAligned(buf.data(), buf.size(), 0) == buf.size());
+
+		std::memset(buf.data(), 0, buf.size());
+
+		RUN_STEP("aligned-read", file.readAligned(buf.data(), buf.size(), 0) == buf.size() && buf.data()[0] == 'a');
+
+		EXPECT_EXCEPTION("bad-length-rejected", file.readAligned(buf.data(), buf.size() - 1, 0));
+		EXPECT_EXCEPTION("bad-offset-rejected", file.readAligned(buf.data(), buf.size(), 1));
+
+		if (align.memory > 1) {
+			EXPECT_EXCEPTION("bad-memory-rejected", file.readAligned(buf.data() + 1, align.offset, 0));
+		}
+
+		auto buf2 = file.allocateBuffer(align.offset);
+		cosmos::ReadIOVector iovec;
+		iovec.push_back({buf.data(), buf.size()});
+		iovec.push_back({buf2.data(), buf2.size()});
+
+		EXPECT_EXCEPTION("bad-iovec-offset-rejected", file.readAligned(iovec, 3));
+
+		file.writeAligned(buf.data(), buf.size(), buf.size());
+
+		RUN_STEP("iovec-read", file.readAligned(iovec, 0));
+
+		cosmos::DirectFile moved{std::move(file)};
+
+		RUN_STEP("move-keeps-alignment", moved.alignment().offset == align.offset && !file.isOpen());
+
+		moved.close();
+
+		EXPECT_EXCEPTION("closed-file-rejected", moved.checkAligned(buf.data(), buf.size(), 0));
+	}
+};
+
+int main(const int argc, const char **argv) {
+	DirectFileTest test;
+	return test.run(argc, argv);
+}
@@ -0,0 +1,144 @@
+// C++
+#include <iostream>
+#include <memory>
+
+// cosmos
+#include <cosmos/error/ApiError.hxx>
+#include <cosmos/fs/FANotify.hxx>
+#include <cosmos/fs/FileHandle.hxx>
+#include <cosmos/fs/FileStatus.hxx>
+#include <cosmos/fs/File.hxx>
+#include <cosmos/fs/filesystem.hxx>
+#include <cosmos/fs/TempDir.hxx>
+#include <cosmos/proc/process.hxx>
+
+// Test
+#include "TestBase.hxx"
+
+class FANotifyTest :
+		public cosmos::TestBase {
+
+	using FANotify = cosmos::FANotify;
+	using EventType = FANotify::EventType;
+	using InitFlag = FANotify::InitFlag;
+
+	void runTests() override {
+		auto fan = create();
+
+		if (!fan) {
+			std::cerr << "fanotify not available, skipping tests\n";
+			return;
+		}
+
+		testDirEntryEvents(*fan);
+		testFileSystemMark();
+	}
+
+	std::unique_ptr<FANotify> create() {
+		try {
+			return std::make_unique<FANotify>(
+					FANotify::InitFlags{InitFlag::CLOEXEC, InitFlag::NONBLOCK, InitFlag::REPORT_DFID_NAME});
+		} catch (const cosmos::ApiError &ex) {
+			// unprivileged fanotify is only available since Linux 5.13
+			if (ex.errnum() == cosmos::Errno::PERMISSION || ex.errnum() == cosmos::Errno::INVALID_ARG)
+				return {};
+			throw;
+		}
+	}
+
+	void testDirEntryEvents(FANotify &fan) {
+		START_TEST("directory entry events");
+		auto tmp = getTempDir();
+		const auto &path = tmp.path();
+
+		fan.addMark(path, {EventType::CREATE, EventType::DELETE, EventType::ON_DIR},
+				FANotify::MarkType::INODE, {FANotify::MarkFlag::ONLY_DIR});
+
+		cosmos::fs::make_dir(path + "/sub", cosmos::FileMode{cosmos::ModeT{0700}});
+		cosmos::fs::remove_dir(path + "/sub");
+
+		const cosmos::FileHandle dir_handle{path};
+
+		auto event = fan.readEvent();
+
+		RUN_STEP("create-reported", event.events()[EventType::CREATE]);
+		RUN_STEP("create-is-dir", event.isDir());
+		RUN_STEP("create-name", event.name() == "sub");
+		RUN_STEP("no-fd-in-fid-mode", event.fd().raw() == cosmos::FileNum::INVALID);
+		RUN_STEP("dir-id-matches", event.dirID() && *event.dirID() == dir_handle);
+		RUN_STEP("dir-id-copy-matches", event.dirID()->copy() == dir_handle);
+
+		/* the kernel may merge the DELETE into the CREATE event, since
+		 * all event information is identical */
+		bool deleted = event.events()[EventType::DELETE];
+
+		while (auto next = fan.tryReadEvent()) {
+			if (next->name() == "sub" && next->events()[EventType::DELETE])
+				deleted = true;
+		}
+
+		RUN_STEP("delete-reported", deleted);
+
+		if (cosmos::proc::get_effective_user_id() != cosmos::UserID::ROOT)
+			return;
+
+		cosmos::File mount{path, cosmos::OpenMode::READ_ONLY, {cosmos::OpenFlag::DIRECTORY}};
+		auto fd = dir_handle.open(mount.fd(), cosmos::OpenMode::READ_ONLY, {cosmos::OpenFlag::DIRECTORY});
+		cosmos::File resolved{fd, cosmos::AutoCloseFD{true}};
+
+		RUN_STEP("handle-resolves-to-dir",
+				cosmos::FileStatus{resolved.fd()}.isSameFile(cosmos::FileStatus{mount.fd()}));
+	}
+
+	void testFileSystemMark() {
+		START_TEST("file system mark");
+
+		if (cosmos::proc::get_effective_user_id() != cosmos::UserID::ROOT) {
+			std::cerr << "not running as root, skipping\n";
+			return;
+		}
+
+		FANotify fan{{InitFlag::CLOEXEC, InitFlag::NONBLOCK, InitFlag::REPORT_DFID_NAME}, cosmos::OpenMode::READ_ONLY, {}, 256};
+
+		auto tmp = getTempDir();
+		const auto &path = tmp.path();
+		const auto sub = path + "/nested";
+		cosmos::fs::make_dir(sub, cosmos::FileMode{cosmos::ModeT{0700}});
+
+		try {
+			fan.addMark(path, {EventType::CREATE}, FANotify::MarkType::FILESYSTEM);
+		} catch (const cosmos::ApiError &ex) {
+			// e.g. in containers or on file systems without handle support
+			std::cerr << "cannot add filesystem mark: " << ex.what() << "\n";
+			return;
+		}
+
+		const cosmos::FileHandle sub_handle{sub};
+		constexpr size_t NUM_FILES = 32;
+
+		for (size_t i = 0; i < NUM_FILES; i++) {
+			cosmos::File f{sub + "/" + std::to_string(i), cosmos::OpenMode::WRITE_ONLY,
+				{cosmos::OpenFlag::CREATE}, cosmos::FileMode{cosmos::ModeT{0600}}};
+		}
+
+		size_t seen = 0;
+
+		/* other activity on the file system can be reported as well,
+		 * thus filter for the directory we're interested in; the small
+		 * buffer causes multiple batches to be read */
+		while (auto event = fan.tryReadEvent()) {
+			if (auto id = event->dirID(); id && *id == sub_handle) {
+				seen++;
+			}
+		}
+
+		RUN_STEP("all-nested-creates-seen", seen == NUM_FILES);
+
+		fan.flushMarks(FANotify::MarkType::FILESYSTEM);
+	}
+};
+
+int main(const int argc, const char **argv) {
+	FANotifyTest test;
+	return test.run(argc, argv);
+}
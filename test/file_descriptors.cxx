@@ -2,10 +2,12 @@
 #include <iostream>
 
 // cosmos
+#include <cosmos/error/ApiError.hxx>
 #include <cosmos/formatting.hxx>
 #include <cosmos/fs/FileDescriptor.hxx>
 #include <cosmos/fs/File.hxx>
 #include <cosmos/fs/FileLock.hxx>
+#include <cosmos/fs/FileStatus.hxx>
 #include <cosmos/fs/TempFile.hxx>
 #include <cosmos/io/Pipe.hxx>
 #include <cosmos/proc/process.hxx>
@@ -33,6 +35,7 @@ public:
 		testSignalSettings();
 		testFileLeases();
 		testRWHints();
+		testAllocate();
 	}
 
 	void testStdinFD() {
@@ -294,6 +297,51 @@ public:
 		file.fd().setAdvice(0, 1024, cosmos::FileDescriptor::AccessAdvice::SEQUENTIAL);
 		RUN_STEP("fadvise-works", true);
 	}
+
+	void testAllocate() {
+		START_TEST("Testing fallocate and readahead");
+
+		cosmos::TempFile file{"/tmp/fallocate_test.{}"};
+		auto fd = file.fd();
+		using AllocateFlag = cosmos::FileDescriptor::AllocateFlag;
+
+		try {
+			fd.allocate(0, 8192);
+		} catch (const cosmos::ApiError &ex) {
+			if (ex.errnum() == cosmos::Errno::OP_NOT_SUPPORTED) {
+				std::cerr << "file system does not support fallocate, skipping\n";
+				return;
+			}
+			throw;
+		}
+
+		RUN_STEP("allocate-grows-file", cosmos::FileStatus{fd}.size() == 8192);
+
+		fd.allocate(8192, 8192, cosmos::FileDescriptor::AllocateFlags{AllocateFlag::KEEP_SIZE});
+
+		RUN_STEP("keep-size-keeps-size", cosmos::FileStatus{fd}.size() == 8192);
+
+		const std::string data(8192, 'a');
+		file.writeAtPos(data.data(), data.size(), 0);
+
+		try {
+			fd.punchHole(0, 4096);
+
+			std::string buf(4096, 'x');
+			file.readAtPos(buf.data(), buf.size(), 0);
+
+			RUN_STEP("punched-hole-reads-zero", buf == std::string(4096, '\0'));
+			RUN_STEP("punch-hole-keeps-size", cosmos::FileStatus{fd}.size() == 8192);
+		} catch (const cosmos::ApiError &ex) {
+			if (ex.errnum() != cosmos::Errno::OP_NOT_SUPPORTED)
+				throw;
+			std::cerr << "file system does not support punching holes\n";
+		}
+
+		DOES_NOT_THROW("readahead-works", fd.readAhead(0, 8192));
+		EXPECT_EXCEPTION("bad-range-rejected", fd.allocate(0, 0));
+	}
+
 protected: // data
 
 	cosmos::FileDescriptor m_stdin_fd;
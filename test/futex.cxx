@@ -0,0 +1,250 @@
+// C++
+#include <chrono>
+#include <iostream>
+#include <new>
+#include <vector>
+
+// cosmos
+#include <cosmos/io/MemFile.hxx>
+#include <cosmos/memory.hxx>
+#include <cosmos/proc/Mapping.hxx>
+#include <cosmos/proc/process.hxx>
+#include <cosmos/thread/FutexCondition.hxx>
+#include <cosmos/thread/FutexMutex.hxx>
+#include <cosmos/thread/PosixThread.hxx>
+#include <cosmos/thread/Semaphore.hxx>
+#include <cosmos/thread/futex.hxx>
+#include <cosmos/time/Clock.hxx>
+#include <cosmos/time/time.hxx>
+
+// Test
+#include "TestBase.hxx"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+cosmos::MonotonicTime deadline(const std::chrono::milliseconds ms) {
+	return cosmos::MonotonicClock{}.now() + cosmos::MonotonicTime{ms};
+}
+
+/// Data placed in shared memory for the multi process test.
+struct SharedData {
+	alignas(cosmos::CACHE_LINE_SIZE) cosmos::FutexMutex mutex{cosmos::ProcessShared{true}};
+	alignas(cosmos::CACHE_LINE_SIZE) cosmos::Semaphore started{0, cosmos::ProcessShared{true}};
+	size_t counter = 0;
+};
+
+} // end anon ns
+
+class FutexTest :
+		public cosmos::TestBase {
+
+	void runTests() override {
+		testMutex();
+		testCondition();
+		testSemaphore();
+		testWaitMultiple();
+		testSharedMemory();
+	}
+
+	template <typename FUNC>
+	void runThreads(const size_t num, FUNC func) {
+		std::vector<cosmos::PosixThread> threads;
+
+		for (size_t i = 0; i < num; i++) {
+			threads.emplace_back(cosmos::PosixThread::Entry{func});
+		}
+
+		for (auto &thread: threads) {
+			thread.join();
+		}
+	}
+
+	void testMutex() {
+		START_TEST("futex mutex");
+		cosmos::FutexMutex mutex;
+
+		RUN_STEP("4-byte-mutex", sizeof(mutex) == 4);
+		RUN_STEP("initially-unlocked", !mutex.isLocked() && !mutex.isShared());
+		RUN_STEP("try-lock", mutex.tryLock() && mutex.isLocked());
+		RUN_STEP("try-lock-fails", !mutex.tryLock());
+		mutex.unlock();
+		RUN_STEP("unlocked", !mutex.isLocked());
+
+		constexpr size_t ITERATIONS = 20000;
+		size_t counter = 0;
+
+		runThreads(4, [&]() {
+			for (size_t i = 0; i < ITERATIONS; i++) {
+				cosmos::FutexMutexGuard guard{mutex};
+				counter++;
+			}
+		});
+
+		RUN_STEP("mutual-exclusion", counter == 4 * ITERATIONS);
+		RUN_STEP("unlocked-after-contention", !mutex.isLocked());
+	}
+
+	void testCondition() {
+		START_TEST("futex condition");
+		cosmos::FutexConditionMutex cond;
+
+		cond.lock();
+		RUN_STEP("wait-timed-out", cond.waitTimed(deadline(50ms)) ==
+				cosmos::FutexCondition::WaitTimedRes::TIMED_OUT);
+		RUN_STEP("locked-after-timeout", cond.isLocked());
+		cond.unlock();
+
+		constexpr size_t WAITERS = 8;
+		bool go = false;
+		size_t ready = 0;
+		size_t done = 0;
+
+		cosmos::PosixThread waker{[&]() {
+			// wait for all waiters to be sleeping
+			cosmos::FutexMutexGuard guard{cond};
+			while (ready != WAITERS) {
+				cond.wait();
+			}
+			go = true;
+			cond.broadcast();
+		}};
+
+		runThreads(WAITERS, [&]() {
+			cosmos::FutexMutexGuard guard{cond};
+			ready++;
+			// other waiters sleep on the same condition, a
+			// signal() could miss the waker
+			cond.broadcast();
+			while (!go) {
+				cond.wait();
+			}
+			done++;
+		});
+
+		waker.join();
+
+		RUN_STEP("broadcast-wakes-all", done == WAITERS);
+		RUN_STEP("unlocked-after-requeue", !cond.isLocked());
+
+		cosmos::FutexMutex shared_mutex{cosmos::ProcessShared{true}};
+		cosmos::FutexCondition private_cond;
+		EXPECT_EXCEPTION("mixed-shared-mode", private_cond.broadcast(shared_mutex));
+	}
+
+	void testSemaphore() {
+		START_TEST("semaphore");
+		cosmos::Semaphore sem{2};
+
+		RUN_STEP("initial-value", sem.value() == 2);
+		RUN_STEP("try-wait", sem.tryWait() && sem.tryWait());
+		RUN_STEP("try-wait-empty", !sem.tryWait());
+		RUN_STEP("wait-timed-out", !sem.waitTimed(deadline(50ms)));
+
+		sem.post(3);
+		RUN_STEP("post-multiple", sem.value() == 3);
+		sem.wait();
+		RUN_STEP("wait-decrements", sem.value() == 2);
+		RUN_STEP("wait-timed-succeeds", sem.waitTimed(deadline(50ms)) && sem.value() == 1);
+		sem.wait();
+
+		constexpr size_t ITEMS = 10000;
+		cosmos::Semaphore items;
+		size_t consumed = 0;
+
+		cosmos::PosixThread consumer{[&]() {
+			for (size_t i = 0; i < ITEMS; i++) {
+				items.wait();
+				consumed++;
+			}
+		}};
+
+		for (size_t i = 0; i < ITEMS; i++) {
+			items.post();
+		}
+
+		consumer.join();
+		RUN_STEP("all-items-consumed", consumed == ITEMS && items.value() == 0);
+	}
+
+	void testWaitMultiple() {
+		START_TEST("wait multiple");
+		cosmos::futex::Word first{0};
+		cosmos::futex::Word second{0};
+
+		const std::vector<cosmos::futex::WaitEntry> entries{{&first, 0}, {&second, 0}};
+
+		RUN_STEP("timeout", !cosmos::futex::wait_multiple(entries, deadline(50ms)));
+
+		second = 1;
+		RUN_STEP("value-mismatch", !cosmos::futex::wait_multiple(entries, deadline(5000ms)));
+		second = 0;
+
+		std::optional<size_t> woken;
+
+		cosmos::PosixThread waiter{[&]() {
+			// the values never change, only an explicit wake() ends this
+			while (!woken) {
+				woken = cosmos::futex::wait_multiple(entries, deadline(5000ms));
+			}
+		}};
+
+		// retry until the waiter is actually sleeping
+		while (cosmos::futex::wake(second) == 0) {
+			cosmos::time::sleep(1ms);
+		}
+
+		waiter.join();
+
+		RUN_STEP("woken-index", woken == 1U);
+	}
+
+	void testSharedMemory() {
+		START_TEST("process shared");
+		cosmos::MemFile file{"futex-test"};
+		file.truncate(sizeof(SharedData));
+
+		cosmos::Mapping mapping{sizeof(SharedData), cosmos::mem::MapSettings{
+			cosmos::mem::MapType::SHARED,
+			cosmos::mem::AccessFlags{cosmos::mem::AccessFlag::READ, cosmos::mem::AccessFlag::WRITE},
+			cosmos::mem::MapFlags{},
+			0,
+			file.fd()
+		}};
+
+		auto data = new (mapping.addr()) SharedData{};
+		RUN_STEP("shared-mode", data->mutex.isShared() && data->started.isShared());
+
+		constexpr size_t ITERATIONS = 20000;
+
+		auto increment = [data]() {
+			for (size_t i = 0; i < ITERATIONS; i++) {
+				cosmos::FutexMutexGuard guard{data->mutex};
+				data->counter++;
+			}
+		};
+
+		auto child = cosmos::proc::fork();
+
+		if (!child) {
+			data->started.post();
+			increment();
+			cosmos::proc::exit(cosmos::ExitStatus::SUCCESS);
+		}
+
+		RUN_STEP("child-started", data->started.waitTimed(deadline(10000ms)));
+		increment();
+
+		const auto res = cosmos::proc::wait(*child);
+		RUN_STEP("child-exited", res && res->exitedSuccessfully());
+		RUN_STEP("cross-process-exclusion", data->counter == 2 * ITERATIONS);
+
+		data->~SharedData();
+	}
+};
+
+int main(const int argc, const char **argv) {
+	FutexTest test;
+	return test.run(argc, argv);
+}
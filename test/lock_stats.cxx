@@ -0,0 +1,190 @@
+// C++
+#include <chrono>
+#include <sstream>
+
+// cosmos
+#include <cosmos/thread/Condition.hxx>
+#include <cosmos/thread/LockStats.hxx>
+#include <cosmos/thread/Mutex.hxx>
+#include <cosmos/thread/PosixThread.hxx>
+#include <cosmos/thread/RWLock.hxx>
+#include <cosmos/time/time.hxx>
+
+// Test
+#include "TestBase.hxx"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+const cosmos::LockStats::Summary* find_summary(
+		const std::vector<cosmos::LockStats::Summary> &summaries, const std::string_view name) {
+	for (const auto &summary: summaries) {
+		if (summary.name == name)
+			return &summary;
+	}
+
+	return nullptr;
+}
+
+} // end anon ns
+
+class LockStatsTest :
+		public cosmos::TestBase {
+
+	void runTests() override {
+		testMutex();
+		testRWLock();
+		testCondition();
+		testGlobal();
+	}
+
+	/// Blocks the calling thread in `acquire` while `holder` keeps the lock for a while.
+	template <typename ACQUIRE, typename RELEASE>
+	void contend(ACQUIRE acquire, RELEASE release) {
+		acquire();
+		cosmos::PosixThread thread{[&]() {
+			acquire();
+			release();
+		}};
+		cosmos::time::sleep(20ms);
+		release();
+		thread.join();
+	}
+
+	void testMutex() {
+		START_TEST("mutex");
+		cosmos::Mutex mutex;
+
+		RUN_STEP("no-stats-by-default", mutex.stats() == nullptr);
+
+		mutex.instrument("test-mutex");
+		RUN_STEP("stats-attached", mutex.stats() && mutex.stats()->name() == "test-mutex");
+
+		for (size_t i = 0; i < 10; i++) {
+			cosmos::MutexGuard g{mutex};
+		}
+
+		auto summary = mutex.stats()->summary();
+		RUN_STEP("uncontended-acquires", summary.acquisitions == 10 && summary.contentions == 0);
+
+		contend([&mutex]() { mutex.lock(); }, [&mutex]() { mutex.unlock(); });
+
+		summary = mutex.stats()->summary();
+		RUN_STEP("contended-acquire", summary.acquisitions == 12 && summary.contentions == 1);
+		RUN_STEP("wait-time-recorded", summary.wait_ns >= 10'000'000 && summary.max_wait_ns == summary.wait_ns);
+
+		size_t buckets_used = 0;
+		for (auto count: summary.histogram) {
+			buckets_used += count;
+		}
+		RUN_STEP("histogram-filled", buckets_used == 1);
+		RUN_STEP("percentile-bound", summary.percentile(50) >= summary.max_wait_ns);
+
+		mutex.instrument("renamed");
+		RUN_STEP("re-instrument-resets", mutex.stats()->summary().acquisitions == 0);
+
+		cosmos::ConditionMutex shared{cosmos::Mutex::Options{cosmos::Mutex::Option::PROCESS_SHARED}};
+		EXPECT_EXCEPTION("process-shared-rejected", shared.Mutex::instrument());
+		EXPECT_EXCEPTION("process-shared-cond-rejected", shared.Condition::instrument());
+		RUN_STEP("process-shared-not-instrumented", shared.Mutex::stats() == nullptr);
+	}
+
+	void testRWLock() {
+		START_TEST("rwlock");
+		cosmos::RWLock lock;
+		lock.instrument("test-rwlock");
+
+		{
+			cosmos::ReadLockGuard g1{lock};
+			// shared read locks don't contend
+			cosmos::ReadLockGuard g2{lock};
+		}
+
+		auto summary = lock.stats()->summary();
+		RUN_STEP("read-locks", summary.acquisitions == 2 && summary.contentions == 0);
+
+		contend([&lock]() { lock.writelock(); }, [&lock]() { lock.unlock(); });
+
+		summary = lock.stats()->summary();
+		RUN_STEP("write-contention", summary.contentions == 1 && summary.wait_ns >= 10'000'000);
+	}
+
+	void testCondition() {
+		START_TEST("condition");
+		cosmos::ConditionMutex cm;
+		cm.instrument("test-condition");
+		bool flag = false;
+
+		cosmos::PosixThread thread{[&]() {
+			cosmos::time::sleep(20ms);
+			cosmos::MutexGuard g{cm};
+			flag = true;
+			cm.signal();
+		}};
+
+		{
+			cosmos::MutexGuard g{cm};
+			while (!flag) {
+				cm.wait();
+			}
+		}
+
+		thread.join();
+
+		const auto summary = cm.Condition::stats()->summary();
+		RUN_STEP("waits-counted", summary.contentions >= 1 && summary.wait_ns >= 10'000'000);
+		RUN_STEP("mutex-instrumented-too", cm.Mutex::stats() != nullptr);
+	}
+
+	void testGlobal() {
+		START_TEST("global");
+
+		cosmos::Mutex busy;
+		busy.instrument("busy");
+		cosmos::Mutex idle;
+		idle.instrument("idle");
+		cosmos::Mutex plain;
+
+		contend([&busy]() { busy.lock(); }, [&busy]() { busy.unlock(); });
+		{
+			cosmos::MutexGuard g{idle};
+		}
+
+		auto summaries = cosmos::lock_stats::collect();
+		const auto busy_summary = find_summary(summaries, "busy");
+		const auto idle_summary = find_summary(summaries, "idle");
+
+		RUN_STEP("collected", busy_summary && idle_summary);
+		RUN_STEP("sorted-by-wait", busy_summary < idle_summary);
+
+		std::stringstream ss;
+		cosmos::lock_stats::dump(ss, 1);
+		RUN_STEP("dump-top", ss.str().find("busy") != ss.str().npos && ss.str().find("idle") == ss.str().npos);
+
+		cosmos::lock_stats::set_enabled(false);
+		{
+			cosmos::MutexGuard g{idle};
+		}
+		cosmos::lock_stats::set_enabled(true);
+		RUN_STEP("disabled-not-counted", idle.stats()->summary().acquisitions == 1);
+
+		cosmos::lock_stats::reset_all();
+		RUN_STEP("reset-all", busy.stats()->summary().contentions == 0);
+
+		{
+			cosmos::Mutex temp;
+			temp.instrument("temporary");
+			summaries = cosmos::lock_stats::collect();
+			RUN_STEP("registered", find_summary(summaries, "temporary") != nullptr);
+		}
+
+		summaries = cosmos::lock_stats::collect();
+		RUN_STEP("unregistered", find_summary(summaries, "temporary") == nullptr);
+	}
+};
+
+int main(const int argc, const char **argv) {
+	LockStatsTest test;
+	return test.run(argc, argv);
+}
@@ -0,0 +1,86 @@
+// C++
+#include <atomic>
+
+// cosmos
+#include <cosmos/thread/Barrier.hxx>
+#include <cosmos/thread/PosixThread.hxx>
+#include <cosmos/thread/membarrier.hxx>
+
+// Test
+#include "TestBase.hxx"
+
+class MembarrierTest :
+		public cosmos::TestBase {
+
+	void runTests() override {
+		testCommands();
+		testAsymmetricFence();
+	}
+
+	void testCommands() {
+		START_TEST("membarrier commands");
+		using cosmos::membarrier::Command;
+
+		const auto cmds = cosmos::membarrier::query();
+
+		if (!cmds[Command::PRIVATE_EXPEDITED]) {
+			RUN_STEP("fallback-without-expedited", !cosmos::membarrier::register_private_expedited());
+			return;
+		}
+
+		RUN_STEP("register-expedited", cosmos::membarrier::register_private_expedited());
+		RUN_STEP("registration-cached", cosmos::membarrier::has_private_expedited());
+
+		cosmos::membarrier::run(Command::PRIVATE_EXPEDITED);
+		cosmos::membarrier::heavy_fence();
+		cosmos::membarrier::light_fence();
+	}
+
+	void testAsymmetricFence() {
+		START_TEST("asymmetric fence");
+		constexpr size_t ROUNDS = 5000;
+
+		// store buffering litmus test: without the fences both threads
+		// could see the other's store not yet performed.
+		std::atomic<int> x = 0, y = 0;
+		int seen_x = 0, seen_y = 0;
+		size_t violations = 0;
+		cosmos::Barrier barrier{2};
+
+		cosmos::PosixThread reader{[&]() {
+			for (size_t round = 0; round < ROUNDS; round++) {
+				barrier.arriveAndWait();
+				x.store(1, std::memory_order_relaxed);
+				cosmos::membarrier::light_fence();
+				seen_y = y.load(std::memory_order_relaxed);
+				barrier.arriveAndWait();
+				barrier.arriveAndWait();
+			}
+		}};
+
+		for (size_t round = 0; round < ROUNDS; round++) {
+			barrier.arriveAndWait();
+			y.store(1, std::memory_order_relaxed);
+			cosmos::membarrier::heavy_fence();
+			seen_x = x.load(std::memory_order_relaxed);
+			barrier.arriveAndWait();
+
+			if (seen_x == 0 && seen_y == 0) {
+				violations++;
+			}
+
+			x = 0;
+			y = 0;
+			barrier.arriveAndWait();
+		}
+
+		reader.join();
+
+		RUN_STEP("no-store-buffering-observed", violations == 0);
+	}
+};
+
+int main(const int argc, const char **argv) {
+	MembarrierTest test;
+	return test.run(argc, argv);
+}
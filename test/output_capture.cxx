@@ -0,0 +1,140 @@
+// C++
+#include <iostream>
+#include <string>
+#include <vector>
+
+// cosmos
+#include <cosmos/error/UsageError.hxx>
+#include <cosmos/fs/File.hxx>
+#include <cosmos/fs/FileStatus.hxx>
+#include <cosmos/fs/TempDir.hxx>
+#include <cosmos/proc/ChildCloner.hxx>
+#include <cosmos/proc/OutputCapture.hxx>
+#include <cosmos/proc/SubProc.hxx>
+
+// Test
+#include "TestBase.hxx"
+
+class OutputCaptureTest :
+		public cosmos::TestBase {
+
+	void runTests() override {
+		testMemory();
+		testTruncation();
+		testFile();
+		testErrors();
+	}
+
+	using Capture = cosmos::OutputCapture;
+
+	void processAll(Capture &capture) {
+		while (capture.active() != 0) {
+			capture.process();
+		}
+	}
+
+	void testMemory() {
+		START_TEST("parallel memory capture");
+		Capture capture{64 * 1024};
+		constexpr size_t NUM_CHILDREN = 20;
+		std::vector<std::pair<Capture::Handle, cosmos::SubProc>> children;
+
+		for (size_t num = 0; num < NUM_CHILDREN; num++) {
+			const auto id = std::to_string(num);
+			cosmos::ChildCloner cloner{{"/bin/sh", "-c",
+				"echo out" + id + "; echo err" + id + " >&2"}};
+			auto handle = capture.prepare(cloner, Capture::Target::toMemory(), Capture::Target::toMemory());
+			auto proc = cloner.run();
+			capture.started(handle);
+			children.emplace_back(handle, std::move(proc));
+		}
+
+		RUN_STEP("all-active", capture.active() == NUM_CHILDREN);
+
+		processAll(capture);
+
+		size_t good = 0;
+
+		for (size_t num = 0; num < NUM_CHILDREN; num++) {
+			auto &[handle, proc] = children[num];
+			const auto id = std::to_string(num);
+			const auto res = proc.wait();
+			const auto output = capture.take(handle);
+
+			if (res.exitedSuccessfully() &&
+					output.out.data == "out" + id + "\n" &&
+					output.err.data == "err" + id + "\n" &&
+					!output.out.truncated && !output.err.truncated) {
+				good++;
+			}
+		}
+
+		RUN_STEP("all-output-captured", good == NUM_CHILDREN);
+	}
+
+	void testTruncation() {
+		START_TEST("memory limit");
+		Capture capture;
+		// produce 1 MiB of output
+		cosmos::ChildCloner cloner{{"/bin/sh", "-c", "head -c 1048576 /dev/zero"}};
+		auto handle = capture.prepare(cloner, Capture::Target::toMemory(1000));
+		auto proc = cloner.run();
+		capture.started(handle);
+
+		processAll(capture);
+
+		const auto res = proc.wait();
+		const auto output = capture.take(handle);
+
+		RUN_STEP("child-not-blocked", res.exitedSuccessfully());
+		RUN_STEP("data-capped", output.out.data.size() == 1000 && output.out.truncated);
+		RUN_STEP("total-counted", output.out.total == 1048576);
+		RUN_STEP("stderr-not-captured", output.err.data.empty() && output.err.total == 0);
+	}
+
+	void testFile() {
+		START_TEST("file target");
+		auto tmp = getTempDir();
+		const auto path = tmp.path() + "/out";
+		cosmos::File file{path, cosmos::OpenMode::WRITE_ONLY,
+				{cosmos::OpenFlag::CREATE, cosmos::OpenFlag::CLOEXEC},
+				cosmos::FileMode{cosmos::ModeT{0600}}};
+
+		Capture capture;
+		cosmos::ChildCloner cloner{{"/bin/sh", "-c", "seq 1 10000"}};
+		auto handle = capture.prepare(cloner, Capture::Target::toFile(file.fd()));
+		auto proc = cloner.run();
+		capture.started(handle);
+
+		processAll(capture);
+
+		const auto res = proc.wait();
+		const auto output = capture.take(handle);
+		cosmos::FileStatus status{path};
+
+		RUN_STEP("child-succeeded", res.exitedSuccessfully());
+		RUN_STEP("no-memory-used", output.out.data.empty());
+		RUN_STEP("all-data-forwarded", output.out.total == 48894 &&
+				static_cast<size_t>(status.size()) == output.out.total);
+	}
+
+	void testErrors() {
+		START_TEST("error handling");
+		Capture capture;
+		cosmos::ChildCloner cloner{{"true"}};
+		auto handle = capture.prepare(cloner, Capture::Target::toMemory());
+
+		RUN_STEP("not-finished-before-start", !capture.finished(handle));
+		EXPECT_EXCEPTION("take-unfinished", capture.take(handle));
+
+		capture.discard(handle);
+
+		EXPECT_EXCEPTION("discarded-handle-invalid", capture.finished(handle));
+		RUN_STEP("process-without-channels", !capture.process());
+	}
+};
+
+int main(const int argc, const char **argv) {
+	OutputCaptureTest test;
+	return test.run(argc, argv);
+}
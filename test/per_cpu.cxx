@@ -0,0 +1,83 @@
+// C++
+#include <vector>
+
+// cosmos
+#include <cosmos/proc/process.hxx>
+#include <cosmos/thread/PerCPUCounter.hxx>
+#include <cosmos/thread/PosixThread.hxx>
+#include <cosmos/thread/rseq.hxx>
+#include <cosmos/thread/thread.hxx>
+
+// Test
+#include "TestBase.hxx"
+
+class PerCPUTest :
+		public cosmos::TestBase {
+
+	void runTests() override {
+		testCurrentCPU();
+		testCounter();
+		testCounterThreads();
+	}
+
+	void testCurrentCPU() {
+		START_TEST("current CPU");
+		const auto cpus = cosmos::proc::get_affinity();
+		const auto cpu = cosmos::thread::get_cpu();
+
+		RUN_STEP("cpu-in-affinity-mask", cpus.isSet(cpu));
+
+		if (cosmos::rseq::is_available()) {
+			RUN_STEP("rseq-area-present", cosmos::rseq::area() != nullptr);
+		}
+	}
+
+	void testCounter() {
+		START_TEST("PerCPUCounter basics");
+		cosmos::PerCPUCounter counter;
+
+		RUN_STEP("has-slots", counter.slots() >= 1);
+		RUN_STEP("slots-cover-possible-cpus", counter.slots() == cosmos::rseq::possible_cpu_slots());
+		RUN_STEP("slots-cover-current-cpu", cosmos::rseq::current_cpu() < counter.slots());
+
+		std::atomic<int64_t> too_few{0};
+		EXPECT_EXCEPTION("too-few-slots-rejected", cosmos::rseq::percpu_add(&too_few, sizeof(too_few), 0, 1));
+		RUN_STEP("rseq-usage-consistent", counter.usesRSeq() == cosmos::rseq::has_percpu_ops());
+		RUN_STEP("initially-zero", counter.value() == 0);
+
+		counter.increment();
+		counter.add(10);
+		counter.decrement();
+		RUN_STEP("sum-after-updates", counter.value() == 10);
+
+		counter.reset();
+		RUN_STEP("zero-after-reset", counter.value() == 0);
+	}
+
+	void testCounterThreads() {
+		START_TEST("PerCPUCounter threads");
+		constexpr size_t NUM_THREADS = 8;
+		constexpr size_t INCREMENTS = 200000;
+		cosmos::PerCPUCounter counter;
+		std::vector<cosmos::PosixThread> threads;
+
+		for (size_t nr = 0; nr < NUM_THREADS; nr++) {
+			threads.emplace_back([&counter]() {
+				for (size_t i = 0; i < INCREMENTS; i++) {
+					counter.increment();
+				}
+			});
+		}
+
+		for (auto &thread: threads) {
+			thread.join();
+		}
+
+		RUN_STEP("no-increments-lost", counter.value() == NUM_THREADS * INCREMENTS);
+	}
+};
+
+int main(const int argc, const char **argv) {
+	PerCPUTest test;
+	return test.run(argc, argv);
+}
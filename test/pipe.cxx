@@ -16,6 +16,7 @@ class PipeTest :
 
 	void runTests() override {
 		testLoopback();
+		testPipeSize();
 	}
 
 	void testLoopback() {
@@ -35,6 +36,19 @@ class PipeTest :
 			std::cerr << "Got '" << s << "' instead\n" << std::endl;
 		}
 	}
+
+	void testPipeSize() {
+		START_TEST("pipe size");
+		cosmos::Pipe pip;
+		const auto orig_size = pip.readEnd().getPipeSize();
+
+		RUN_STEP("get-pipe-size", orig_size > 0);
+
+		const auto new_size = pip.writeEnd().setPipeSize(orig_size * 2);
+
+		RUN_STEP("set-pipe-size", new_size >= orig_size * 2);
+		RUN_STEP("size-applies-to-both-ends", pip.readEnd().getPipeSize() == new_size);
+	}
 };
 
 int main(const int argc, const char **argv) {
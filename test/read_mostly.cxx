@@ -0,0 +1,184 @@
+// C++
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// cosmos
+#include <cosmos/thread/PosixThread.hxx>
+#include <cosmos/thread/RCU.hxx>
+#include <cosmos/thread/SeqLock.hxx>
+
+// Test
+#include "TestBase.hxx"
+
+namespace {
+
+/// A value whose members always need to be consistent to each other.
+struct Snapshot {
+	size_t a = 0;
+	size_t b = 0;
+	char c = 0;
+};
+
+/// Tracks the number of live instances to verify reclamation.
+struct Config {
+	explicit Config(size_t v) : value{v} { ++live; }
+	~Config() { --live; }
+
+	size_t value;
+	static inline std::atomic<size_t> live{0};
+};
+
+} // end anon ns
+
+class ReadMostlyTest :
+		public cosmos::TestBase {
+
+	void runTests() override {
+		testSeqLock();
+		testSeqLockThreads();
+		testRCU();
+		testRCUThreads();
+	}
+
+	void testSeqLock() {
+		START_TEST("SeqLock basics");
+		cosmos::SeqLock<Snapshot> lock{Snapshot{1, 2, 'x'}};
+
+		auto snap = lock.load();
+		RUN_STEP("initial-value", snap.a == 1 && snap.b == 2 && snap.c == 'x');
+		RUN_STEP("initial-version", lock.version() == 0);
+
+		lock.store(Snapshot{3, 4, 'y'});
+		snap = lock.load();
+		RUN_STEP("stored-value", snap.a == 3 && snap.b == 4 && snap.c == 'y');
+		RUN_STEP("version-incremented", lock.version() == 1);
+	}
+
+	void testSeqLockThreads() {
+		START_TEST("SeqLock threads");
+		constexpr size_t NUM_READERS = 4;
+		constexpr size_t NUM_WRITES = 100000;
+		cosmos::SeqLock<Snapshot> lock;
+		std::atomic<bool> done{false};
+		std::atomic<bool> consistent{true};
+		std::vector<cosmos::PosixThread> threads;
+
+		for (size_t nr = 0; nr < NUM_READERS; nr++) {
+			threads.emplace_back([&]() {
+				while (!done) {
+					const auto snap = lock.load();
+					if (snap.b != snap.a * 2) {
+						consistent = false;
+					}
+				}
+			});
+		}
+
+		// two concurrent writers
+		auto write = [&lock]() {
+			for (size_t i = 0; i < NUM_WRITES; i++) {
+				lock.store(Snapshot{i, i * 2, 'z'});
+			}
+		};
+
+		cosmos::PosixThread writer{write};
+		write();
+		writer.join();
+		done = true;
+
+		for (auto &thread: threads) {
+			thread.join();
+		}
+
+		RUN_STEP("snapshots-consistent", consistent.load());
+		RUN_STEP("all-writes-counted", lock.version() == 2 * NUM_WRITES);
+	}
+
+	void testRCU() {
+		START_TEST("RCU basics");
+		{
+			cosmos::RCUDomain domain;
+			cosmos::RCUPointer<Config> ptr{domain, std::make_unique<Config>(1)};
+
+			RUN_STEP("initial-object", ptr.read()->value == 1);
+
+			{
+				cosmos::RCUDomain::Reader reader{domain};
+				const auto old = ptr.read();
+
+				ptr.update(std::make_unique<Config>(2));
+				RUN_STEP("new-object-published", ptr.read()->value == 2);
+				RUN_STEP("old-object-deferred", domain.pending() == 1 && old->value == 1);
+
+				reader.offline();
+				RUN_STEP("offline-reader-not-waited-for", domain.collect() == 0);
+				reader.online();
+
+				ptr.update(std::make_unique<Config>(3));
+				RUN_STEP("retired-again", domain.pending() == 1);
+
+				reader.quiescent();
+				RUN_STEP("reclaimed-after-quiescent", domain.collect() == 0);
+				RUN_STEP("live-objects", Config::live == 1);
+			}
+
+			ptr.updateSync(std::make_unique<Config>(4));
+			RUN_STEP("sync-update-reclaims", domain.pending() == 0 && Config::live == 1);
+
+			ptr.update(std::make_unique<Config>(5));
+		}
+
+		RUN_STEP("all-reclaimed", Config::live == 0);
+	}
+
+	void testRCUThreads() {
+		START_TEST("RCU threads");
+		constexpr size_t NUM_READERS = 4;
+		constexpr size_t NUM_UPDATES = 2000;
+		cosmos::RCUDomain domain;
+		cosmos::RCUPointer<Config> ptr{domain, std::make_unique<Config>(0)};
+		std::atomic<bool> done{false};
+		std::atomic<bool> monotonic{true};
+		std::vector<cosmos::PosixThread> threads;
+
+		for (size_t nr = 0; nr < NUM_READERS; nr++) {
+			threads.emplace_back([&]() {
+				cosmos::RCUDomain::Reader reader{domain};
+				size_t last = 0;
+				while (!done) {
+					const auto cur = ptr.read()->value;
+					if (cur < last) {
+						monotonic = false;
+					}
+					last = cur;
+					reader.quiescent();
+				}
+			});
+		}
+
+		for (size_t i = 1; i <= NUM_UPDATES; i++) {
+			if (i % 2) {
+				ptr.update(std::make_unique<Config>(i));
+			} else {
+				ptr.updateSync(std::make_unique<Config>(i));
+			}
+		}
+
+		done = true;
+
+		for (auto &thread: threads) {
+			thread.join();
+		}
+
+		RUN_STEP("readers-saw-monotonic-values", monotonic.load());
+		RUN_STEP("final-value", ptr.read()->value == NUM_UPDATES);
+		RUN_STEP("nothing-pending", domain.collect() == 0 && Config::live == 1);
+	}
+};
+
+int main(const int argc, const char **argv) {
+	ReadMostlyTest test;
+	return test.run(argc, argv);
+}
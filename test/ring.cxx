@@ -0,0 +1,209 @@
+// C++
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// cosmos
+#include <cosmos/error/UsageError.hxx>
+#include <cosmos/io/Poller.hxx>
+#include <cosmos/thread/Doorbell.hxx>
+#include <cosmos/thread/MPMCRing.hxx>
+#include <cosmos/thread/PosixThread.hxx>
+#include <cosmos/thread/SPSCRing.hxx>
+
+// Test
+#include "TestBase.hxx"
+
+class RingTest :
+		public cosmos::TestBase {
+
+	void runTests() override {
+		testBasics<cosmos::SPSCRing<std::string>>("SPSCRing basics");
+		testBasics<cosmos::MPMCRing<std::string>>("MPMCRing basics");
+		testSPSCThreads();
+		testMPMCThreads();
+		testDoorbell<cosmos::SPSCRing<size_t>>("SPSCRing doorbell");
+		testDoorbell<cosmos::MPMCRing<size_t>>("MPMCRing doorbell");
+	}
+
+	template <typename RING>
+	void testBasics(const std::string &label) {
+		START_TEST(label);
+
+		EXPECT_EXCEPTION("bad-capacity", RING{5});
+
+		RING ring{4};
+		std::string item;
+
+		RUN_STEP("capacity", ring.capacity() == 4);
+		RUN_STEP("initially-empty", ring.emptyApprox() && !ring.pop(item));
+
+		for (size_t i = 0; i < 4; i++) {
+			ring.push(std::to_string(i));
+		}
+
+		RUN_STEP("push-to-full-fails", !ring.push(std::string{"excess"}));
+		RUN_STEP("size-when-full", ring.sizeApprox() == 4);
+
+		RUN_STEP("pop-first", ring.pop(item) && item == "0");
+		RUN_STEP("push-after-pop", ring.push(std::string{"4"}));
+
+		std::array<std::string, 8> items;
+		RUN_STEP("pop-batch", ring.popBatch(items) == 4);
+		RUN_STEP("batch-order", items[0] == "1" && items[3] == "4");
+
+		std::array<std::string, 6> input{"a", "b", "c", "d", "e", "f"};
+		RUN_STEP("push-batch-partial", ring.pushBatch(input) == 4);
+		RUN_STEP("pop-batch-partial", ring.popBatch(std::span{items.data(), 3}) == 3);
+		RUN_STEP("pop-batch-rest", ring.popBatch(items) == 1 && items[0] == "d");
+		RUN_STEP("empty-again", ring.emptyApprox());
+
+		// empty spans with ready slots at both ends
+		ring.push(std::string{"x"});
+		RUN_STEP("push-empty-batch", ring.pushBatch(std::span<std::string>{}) == 0);
+		RUN_STEP("pop-empty-batch", ring.popBatch(std::span<std::string>{}) == 0);
+		RUN_STEP("pop-after-empty-batch", ring.pop(item) && item == "x");
+	}
+
+	void testSPSCThreads() {
+		START_TEST("SPSCRing threads");
+		constexpr size_t NUM_ITEMS = 500000;
+		cosmos::SPSCRing<size_t> ring{64};
+		bool in_order = true;
+		size_t received = 0;
+
+		cosmos::PosixThread consumer{[&]() {
+			std::array<size_t, 16> batch;
+			while (received < NUM_ITEMS) {
+				const auto count = ring.popBatch(batch);
+				for (size_t i = 0; i < count; i++) {
+					in_order = in_order && batch[i] == received++;
+				}
+				if (count == 0) {
+					// we might be running on a single CPU
+					std::this_thread::yield();
+				}
+			}
+		}};
+
+		for (size_t i = 0; i < NUM_ITEMS;) {
+			if (ring.push(size_t{i}))
+				i++;
+			else
+				std::this_thread::yield();
+		}
+
+		consumer.join();
+		RUN_STEP("all-received-in-order", in_order && received == NUM_ITEMS);
+	}
+
+	void testMPMCThreads() {
+		START_TEST("MPMCRing threads");
+		constexpr size_t NUM_THREADS = 4;
+		constexpr size_t ITEMS_PER_THREAD = 200000;
+		cosmos::MPMCRing<size_t> ring{128};
+		std::atomic<size_t> sum{0};
+		std::atomic<size_t> received{0};
+		std::vector<cosmos::PosixThread> threads;
+
+		for (size_t nr = 0; nr < NUM_THREADS; nr++) {
+			threads.emplace_back([&, nr]() {
+				// producer
+				std::array<size_t, 8> batch;
+				for (size_t i = 0; i < ITEMS_PER_THREAD;) {
+					size_t count = 0;
+					while (count < batch.size() && i + count < ITEMS_PER_THREAD) {
+						batch[count] = nr * ITEMS_PER_THREAD + i + count;
+						count++;
+					}
+					const auto pushed = ring.pushBatch(std::span{batch.data(), count});
+					if (pushed == 0)
+						std::this_thread::yield();
+					i += pushed;
+				}
+			});
+			threads.emplace_back([&]() {
+				// consumer
+				std::array<size_t, 8> batch;
+				while (received < NUM_THREADS * ITEMS_PER_THREAD) {
+					const auto count = ring.popBatch(batch);
+					for (size_t i = 0; i < count; i++) {
+						sum += batch[i];
+					}
+					received += count;
+					if (count == 0)
+						std::this_thread::yield();
+				}
+			});
+		}
+
+		for (auto &thread: threads) {
+			thread.join();
+		}
+
+		constexpr size_t TOTAL = NUM_THREADS * ITEMS_PER_THREAD;
+		RUN_STEP("all-received", received == TOTAL);
+		RUN_STEP("sum-matches", sum == TOTAL * (TOTAL - 1) / 2);
+	}
+
+	template <typename RING>
+	void testDoorbell(const std::string &label) {
+		START_TEST(label);
+		cosmos::Doorbell bell;
+		RING ring{16, &bell};
+		size_t item;
+
+		RUN_STEP("not-rung-initially", !bell.acknowledge());
+
+		ring.push(size_t{1});
+		RUN_STEP("rung-on-first-push", bell.acknowledge());
+
+		ring.push(size_t{2});
+		RUN_STEP("not-rung-if-non-empty", !bell.acknowledge());
+
+		ring.pop(item);
+		ring.pop(item);
+		RUN_STEP("pop-until-empty", !ring.pop(item));
+
+		ring.push(size_t{3});
+		RUN_STEP("rung-after-drain", bell.acknowledge());
+		ring.pop(item);
+
+		// consumer sleeping in a Poller, woken by the producer
+		constexpr size_t NUM_ITEMS = 100000;
+		cosmos::Poller poller{16};
+		poller.addFD(bell.fd(), {cosmos::Poller::MonitorFlag::INPUT});
+		size_t received = 0;
+		size_t wakeups = 0;
+
+		cosmos::PosixThread producer{[&]() {
+			for (size_t i = 0; i < NUM_ITEMS;) {
+				if (ring.push(size_t{i}))
+					i++;
+				else
+					std::this_thread::yield();
+			}
+		}};
+
+		while (received < NUM_ITEMS) {
+			poller.wait();
+			wakeups++;
+			bell.acknowledge();
+			while (ring.pop(item)) {
+				received++;
+			}
+		}
+
+		producer.join();
+		RUN_STEP("poller-received-all", received == NUM_ITEMS);
+		RUN_STEP("fewer-wakeups-than-items", wakeups <= NUM_ITEMS);
+	}
+};
+
+int main(const int argc, const char **argv) {
+	RingTest test;
+	return test.run(argc, argv);
+}
@@ -0,0 +1,162 @@
+// C++
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <variant>
+
+// cosmos
+#include <cosmos/error/ApiError.hxx>
+#include <cosmos/io/Pipe.hxx>
+#include <cosmos/io/StreamAdaptor.hxx>
+#include <cosmos/proc/ChildCloner.hxx>
+#include <cosmos/proc/Scheduler.hxx>
+#include <cosmos/proc/SubProc.hxx>
+#include <cosmos/thread/PosixThread.hxx>
+#include <cosmos/thread/thread.hxx>
+
+// Test
+#include "TestBase.hxx"
+
+using namespace std::chrono_literals;
+
+class SchedulerTest :
+		public cosmos::TestBase {
+
+	void runTests() override {
+		testGetSettings();
+		testThreadSettings();
+		testChildSettings();
+		testUtilClamp();
+		testDeadline();
+	}
+
+	static cosmos::SchedulerPolicy policyOf(const cosmos::SchedulerSettingsVariant &settings) {
+		return std::visit([](auto &&s) { return s.policy(); }, settings);
+	}
+
+	/// Applies `settings` in a separate thread and returns the settings read back there.
+	std::optional<cosmos::SchedulerSettingsVariant> applyInThread(
+			const cosmos::SchedulerSettings &settings, std::optional<cosmos::Errno> &error) {
+		std::optional<cosmos::SchedulerSettingsVariant> ret;
+
+		cosmos::PosixThread thread{[&]() {
+			try {
+				settings.apply(cosmos::ThreadID::SELF);
+				ret = cosmos::get_scheduler_settings(cosmos::as_pid(cosmos::thread::get_tid()));
+			} catch (const cosmos::ApiError &ex) {
+				error = ex.errnum();
+			}
+		}};
+
+		thread.join();
+		return ret;
+	}
+
+	void testGetSettings() {
+		START_TEST("get settings");
+		const auto settings = cosmos::get_scheduler_settings();
+
+		RUN_STEP("default-policy-other", policyOf(settings) == cosmos::SchedulerPolicy::OTHER);
+		RUN_STEP("no-reset-on-fork", !std::get<cosmos::OtherSchedulerSettings>(settings).resetOnFork());
+	}
+
+	void testThreadSettings() {
+		START_TEST("thread settings");
+		std::optional<cosmos::Errno> error;
+
+		cosmos::BatchSchedulerSettings batch;
+		batch.setNiceValue(5);
+		batch.setResetOnFork(true);
+
+		auto res = applyInThread(batch, error);
+
+		RUN_STEP("batch-applied", res && policyOf(*res) == cosmos::SchedulerPolicy::BATCH);
+		if (res) {
+			const auto &loaded = std::get<cosmos::BatchSchedulerSettings>(*res);
+			RUN_STEP("batch-nice-value", loaded.niceValue() == 5);
+			RUN_STEP("reset-on-fork", loaded.resetOnFork());
+		}
+
+		RUN_STEP("main-thread-unaffected",
+				policyOf(cosmos::get_scheduler_settings()) == cosmos::SchedulerPolicy::OTHER);
+
+		res = applyInThread(cosmos::IdleSchedulerSettings{}, error);
+		RUN_STEP("idle-applied", res && policyOf(*res) == cosmos::SchedulerPolicy::IDLE);
+	}
+
+	void testChildSettings() {
+		START_TEST("child settings");
+
+		for (const auto vfork: {false, true}) {
+			// field 41 of the stat file is the scheduling policy
+			cosmos::ChildCloner cloner{{"cut", "-d", " ", "-f", "41", "/proc/self/stat"}};
+			cosmos::Pipe pipe;
+			cloner.setUseVFork(vfork);
+			cloner.setStdOut(pipe.writeEnd());
+			cloner.setSchedulerSettings(cosmos::IdleSchedulerSettings{});
+
+			auto proc = cloner.run();
+			pipe.closeWriteEnd();
+
+			cosmos::InputStreamAdaptor output{pipe};
+			std::string policy;
+			std::getline(output, policy);
+			proc.wait();
+
+			RUN_STEP(vfork ? "vfork-child-idle" : "child-idle",
+					policy == std::to_string(SCHED_IDLE));
+		}
+	}
+
+	void testUtilClamp() {
+		START_TEST("utilization clamping");
+		std::optional<cosmos::Errno> error;
+
+		cosmos::OtherSchedulerSettings other;
+		other.setNiceValue(0);
+		other.setUtilClamp({0, 512});
+
+		const auto res = applyInThread(other, error);
+
+		if (error) {
+			// kernel without CONFIG_UCLAMP_TASK
+			RUN_STEP("uclamp-not-supported", *error == cosmos::Errno::OP_NOT_SUPPORTED);
+			return;
+		}
+
+		const auto clamp = std::get<cosmos::OtherSchedulerSettings>(*res).utilClamp();
+		RUN_STEP("uclamp-applied", clamp && clamp->min == 0 && clamp->max == 512);
+	}
+
+	void testDeadline() {
+		START_TEST("deadline scheduling");
+		std::optional<cosmos::Errno> error;
+
+		const cosmos::DeadlineSchedulerSettings deadline{2ms, 5ms, 10ms};
+		const auto res = applyInThread(deadline, error);
+
+		if (error) {
+			// missing privileges, or bandwidth not available
+			std::cout << "applying deadline settings failed with " << cosmos::to_integral(*error) << ", skipping\n";
+			RUN_STEP("expected-deadline-error", *error == cosmos::Errno::PERMISSION ||
+					*error == cosmos::Errno::BUSY);
+			return;
+		}
+
+		RUN_STEP("deadline-applied", policyOf(*res) == cosmos::SchedulerPolicy::DEADLINE);
+
+		const auto &loaded = std::get<cosmos::DeadlineSchedulerSettings>(*res);
+		RUN_STEP("deadline-parameters", loaded.runtime() == 2ms &&
+				loaded.deadline() == 5ms && loaded.period() == 10ms);
+
+		cosmos::DeadlineSchedulerSettings bad{5ms, 2ms};
+		applyInThread(bad, error);
+		RUN_STEP("invalid-parameters-rejected", error == cosmos::Errno::INVALID_ARG);
+	}
+};
+
+int main(const int argc, const char **argv) {
+	SchedulerTest test;
+	return test.run(argc, argv);
+}
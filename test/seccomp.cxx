@@ -0,0 +1,275 @@
+// C++
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Linux
+#include <fcntl.h>
+#include <linux/filter.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// cosmos
+#include <cosmos/error/ApiError.hxx>
+#include <cosmos/error/UsageError.hxx>
+#include <cosmos/io/Pipe.hxx>
+#include <cosmos/io/Poller.hxx>
+#include <cosmos/io/StreamAdaptor.hxx>
+#include <cosmos/net/network.hxx>
+#include <cosmos/proc/ChildCloner.hxx>
+#include <cosmos/proc/process.hxx>
+#include <cosmos/proc/ptrace.hxx>
+#include <cosmos/proc/seccomp.hxx>
+#include <cosmos/proc/SeccompListener.hxx>
+#include <cosmos/proc/SubProc.hxx>
+#include <cosmos/proc/Tracee.hxx>
+
+// Test
+#include "TestBase.hxx"
+
+using Filter = cosmos::seccomp::Filter;
+using Result = cosmos::seccomp::Result;
+using Response = cosmos::seccomp::Response;
+
+class SeccompTest :
+		public cosmos::TestBase {
+
+	void runTests() override {
+		testProgram();
+		testErrno();
+		testTrace();
+		testChildCloner();
+		testUserNotification();
+	}
+
+	void testProgram() {
+		START_TEST("filter program");
+		Filter filter;
+		// arch check, x32 check, load nr and default return
+		const auto base = filter.program().size();
+		RUN_STEP("base-program", base >= 4);
+
+		filter.set({SYS_getppid, SYS_getpid}, Result::error(cosmos::Errno::PERMISSION));
+		RUN_STEP("two-rules", filter.program().size() == base + 4);
+
+		filter.set(SYS_getpid, Result::allow());
+		RUN_STEP("default-rule-elided", filter.program().size() == base + 2);
+
+		filter.reset(SYS_getppid);
+		RUN_STEP("rule-reset", filter.program().size() == base);
+
+		RUN_STEP("result-raw", Result::error(cosmos::Errno::PERMISSION).raw() == (SECCOMP_RET_ERRNO | EPERM));
+		RUN_STEP("result-data", Result::trace(42).data() == 42 &&
+				Result::trace(42).action() == cosmos::seccomp::Action::TRACE);
+
+		filter.set(-1, Result::trap());
+		EXPECT_EXCEPTION("negative-nr", filter.program());
+	}
+
+	/// Runs `func` in a forked child process and returns whether it exited successfully.
+	template <typename FUNC>
+	bool runInChild(FUNC func) {
+		auto child = cosmos::proc::fork();
+
+		if (!child) {
+			bool good = false;
+			try {
+				good = func();
+			} catch (const std::exception &ex) {
+				std::cerr << "child failed: " << ex.what() << "\n";
+			}
+			cosmos::proc::exit(good ? cosmos::ExitStatus::SUCCESS : cosmos::ExitStatus::FAILURE);
+		}
+
+		const auto res = cosmos::proc::wait(*child);
+		return res && res->exitedSuccessfully();
+	}
+
+	void testErrno() {
+		START_TEST("errno result");
+
+		RUN_STEP("getppid-denied", runInChild([]() {
+			Filter{}.set(SYS_getppid, Result::error(cosmos::Errno::PERMISSION)).install();
+			return ::syscall(SYS_getppid) == -1 && errno == EPERM &&
+				::syscall(SYS_getpid) > 0;
+		}));
+
+		RUN_STEP("filters-stack", runInChild([]() {
+			Filter{}.set(SYS_getppid, Result::error(cosmos::Errno::PERMISSION)).install();
+			Filter{}.set(SYS_getppid, Result::error(cosmos::Errno::BUSY)).install();
+			// ERRNO results of equal precedence: the most recent filter wins
+			return ::syscall(SYS_getppid) == -1 && errno == EBUSY;
+		}));
+
+		RUN_STEP("no-listener-fd", runInChild([]() {
+			return Filter{}.install().invalid();
+		}));
+	}
+
+	void testTrace() {
+		START_TEST("trace result");
+		cosmos::Pipe pipe;
+
+		auto child = cosmos::proc::fork();
+
+		if (!child) {
+			// wait for the parent to attach
+			pipe.closeWriteEnd();
+			char ch;
+			(void)::read(cosmos::to_integral(pipe.readEnd().raw()), &ch, 1);
+			Filter{}.set(SYS_getppid, Result::trace(42)).install();
+			const bool good = ::syscall(SYS_getppid) > 0;
+			cosmos::proc::exit(good ? cosmos::ExitStatus::SUCCESS : cosmos::ExitStatus::FAILURE);
+		}
+
+		pipe.closeReadEnd();
+		cosmos::Tracee tracee{*child};
+		tracee.seize(cosmos::ptrace::Opts{cosmos::ptrace::Opt::TRACESECCOMP, cosmos::ptrace::Opt::EXITKILL});
+		pipe.closeWriteEnd();
+
+		const cosmos::WaitFlags flags{
+			cosmos::WaitFlag::WAIT_FOR_EXITED, cosmos::WaitFlag::WAIT_FOR_STOPPED};
+		auto res = cosmos::proc::wait(*child, flags);
+
+		bool seccomp_stop = false;
+
+		if (res && res->trapped() && res->signal->isPtraceEventStop()) {
+			const auto [signr, event] = cosmos::ptrace::decode_event(*res->signal);
+			seccomp_stop = event == cosmos::ptrace::Event::SECCOMP &&
+				tracee.getSeccompRetDataEventMsg() == 42;
+		}
+
+		RUN_STEP("seccomp-event-stop", seccomp_stop);
+
+		if (res && res->trapped()) {
+			tracee.restart(cosmos::Tracee::RestartMode::CONT);
+			res = cosmos::proc::wait(*child, flags);
+		}
+
+		RUN_STEP("traced-call-succeeds", res && res->exitedSuccessfully());
+	}
+
+	void testChildCloner() {
+		START_TEST("child cloner");
+		cosmos::ChildCloner cloner{{"/bin/sh", "-c", "echo filtered"}};
+		cosmos::Pipe pipe;
+		cloner.setStdOut(pipe.writeEnd());
+
+		Filter filter;
+		filter.set(SYS_getppid, Result::error(cosmos::Errno::PERMISSION));
+		cloner.setPostForkCB([&filter](const cosmos::ChildCloner&) {
+			filter.install();
+		});
+
+		auto proc = cloner.run();
+		pipe.closeWriteEnd();
+
+		cosmos::InputStreamAdaptor output{pipe};
+		std::string line;
+		std::getline(output, line);
+		const auto res = proc.wait();
+
+		RUN_STEP("filtered-exec", res.exitedSuccessfully() && line == "filtered");
+	}
+
+	/// Child process entry point for testUserNotification().
+	static void notifiedChild(cosmos::UnixConnection &conn) {
+		Filter filter;
+		filter.set({SYS_getppid, SYS_openat, SYS_gettid}, Result::notify());
+		cosmos::seccomp::send_listener(conn,
+				filter.install(cosmos::seccomp::FilterFlags{cosmos::seccomp::FilterFlag::NEW_LISTENER}));
+
+		// emulated by the supervisor
+		const auto ppid = ::syscall(SYS_getppid);
+		// the supervisor injects a pipe write end
+		const auto fd = ::syscall(SYS_openat, AT_FDCWD, "/nonexistent", O_WRONLY);
+		// passed on to the kernel
+		const auto tid = ::syscall(SYS_gettid);
+
+		bool good = ppid == 4242 && fd >= 0 &&
+			tid == cosmos::to_integral(cosmos::proc::get_own_pid());
+
+		if (good) {
+			good = ::write(static_cast<int>(fd), "ok\n", 3) == 3;
+		}
+
+		cosmos::proc::exit(good ? cosmos::ExitStatus::SUCCESS : cosmos::ExitStatus::FAILURE);
+	}
+
+	void testUserNotification() {
+		START_TEST("user notification");
+		auto [parent_end, child_end] = cosmos::net::create_stream_socket_pair();
+		cosmos::Pipe pipe;
+
+		cosmos::ChildCloner cloner;
+		cloner.setNoExe();
+		cloner.setPostForkCB([&child_end](const cosmos::ChildCloner&) {
+			notifiedChild(child_end);
+		});
+
+		auto proc = cloner.run();
+		child_end.close();
+
+		auto listener = cosmos::seccomp::receive_listener(parent_end);
+		RUN_STEP("listener-received", listener.isOpen());
+
+		cosmos::Poller poller{8};
+		poller.addFD(listener.fd(), {cosmos::Poller::MonitorFlag::INPUT});
+
+		std::vector<long> seen;
+		bool hangup = false;
+
+		while (!hangup) {
+			const auto events = poller.wait(cosmos::IntervalTime{std::chrono::milliseconds{10000}});
+
+			if (events.empty()) {
+				std::cerr << "timeout waiting for notifications\n";
+				proc.kill(cosmos::signal::KILL);
+				break;
+			}
+
+			for (const auto &event: events) {
+				const auto mask = event.getEvents();
+
+				if (mask[cosmos::Poller::Event::INPUT_READY]) {
+					cosmos::seccomp::Notification notif;
+					listener.receive(notif);
+					seen.push_back(notif.syscallNr());
+
+					switch (notif.syscallNr()) {
+						case SYS_getppid:
+							listener.respond(Response::success(notif, 4242));
+							break;
+						case SYS_openat:
+							listener.respondWithFD(notif, pipe.writeEnd());
+							break;
+						default:
+							listener.respond(Response::cont(notif));
+							break;
+					}
+				} else if (mask[cosmos::Poller::Event::HANGUP_OCCURED]) {
+					hangup = true;
+				}
+			}
+		}
+
+		pipe.closeWriteEnd();
+		const auto res = proc.wait();
+
+		cosmos::InputStreamAdaptor output{pipe};
+		std::string line;
+		std::getline(output, line);
+
+		const std::vector<long> expected{SYS_getppid, SYS_openat, SYS_gettid};
+		RUN_STEP("all-notifications-seen", seen == expected);
+		RUN_STEP("listener-hangup", hangup);
+		RUN_STEP("child-results-ok", res.exitedSuccessfully());
+		RUN_STEP("injected-fd-works", line == "ok");
+	}
+};
+
+int main(const int argc, const char **argv) {
+	SeccompTest test;
+	return test.run(argc, argv);
+}
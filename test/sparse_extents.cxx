@@ -0,0 +1,103 @@
+// C++
+#include <iostream>
+#include <string>
+#include <vector>
+
+// cosmos
+#include <cosmos/error/ApiError.hxx>
+#include <cosmos/fs/File.hxx>
+#include <cosmos/fs/SparseExtents.hxx>
+#include <cosmos/fs/TempDir.hxx>
+
+// Test
+#include "TestBase.hxx"
+
+class SparseExtentsTest :
+		public cosmos::TestBase {
+
+	void runTests() override {
+		testEmpty();
+		testSparse();
+	}
+
+	cosmos::File createFile(const std::string &path) {
+		return cosmos::File{path, cosmos::OpenMode::READ_WRITE,
+				{cosmos::OpenFlag::CREATE, cosmos::OpenFlag::CLOEXEC},
+				cosmos::FileMode{cosmos::ModeT{0600}}};
+	}
+
+	void testEmpty() {
+		START_TEST("empty file");
+		auto tmp = getTempDir();
+		auto file = createFile(tmp.path() + "/empty");
+
+		cosmos::SparseExtents extents{file.fd()};
+
+		RUN_STEP("no-extents", !extents.nextExtent());
+		RUN_STEP("begin-equals-end", begin(extents) == end(extents));
+	}
+
+	void testSparse() {
+		START_TEST("sparse file");
+		auto tmp = getTempDir();
+		auto file = createFile(tmp.path() + "/sparse");
+		// use a large distance to stay clear of file system block sizes
+		constexpr off_t MB = 1024 * 1024;
+		const std::string data(4096, 'a');
+
+		file.writeAtPos(data.data(), data.size(), 0);
+		file.writeAtPos(data.data(), data.size(), 4 * MB);
+		file.truncate(8 * MB);
+
+		std::vector<cosmos::SparseExtents::Extent> found;
+		cosmos::SparseExtents extents{file.fd()};
+
+		for (const auto &extent: extents) {
+			found.push_back(extent);
+		}
+
+		RUN_STEP("found-extents", !found.empty());
+		RUN_STEP("first-extent-at-start", found.front().offset == 0);
+		RUN_STEP("last-extent-covers-data", found.back().end() >= 4 * MB + 4096);
+
+		if (found.size() == 1) {
+			// no hole detection, the complete file is data
+			std::cerr << "file system does not report holes, skipping\n";
+			RUN_STEP("whole-file-is-data", found.front().end() == 8 * MB);
+			return;
+		}
+
+		RUN_STEP("two-extents", found.size() == 2);
+		RUN_STEP("second-extent-at-data", found[1].offset <= 4 * MB && found[1].end() < 8 * MB);
+
+		cosmos::SparseExtents from_middle{file.fd(), 2 * MB};
+		auto first = from_middle.nextExtent();
+
+		RUN_STEP("start-offset-skips-first", first && *first == found[1]);
+		RUN_STEP("iteration-ends", !from_middle.nextExtent());
+
+		from_middle.rewind();
+
+		RUN_STEP("rewind-restarts", from_middle.nextExtent() == first);
+
+		try {
+			file.fd().punchHole(4 * MB, 4096);
+		} catch (const cosmos::ApiError &ex) {
+			if (ex.errnum() == cosmos::Errno::OP_NOT_SUPPORTED)
+				return;
+			throw;
+		}
+
+		size_t count = 0;
+		for ([[maybe_unused]] const auto &extent: extents) {
+			count++;
+		}
+
+		RUN_STEP("punched-extent-disappears", count == 1);
+	}
+};
+
+int main(const int argc, const char **argv) {
+	SparseExtentsTest test;
+	return test.run(argc, argv);
+}
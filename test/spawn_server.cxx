@@ -0,0 +1,181 @@
+// C++
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// cosmos
+#include <cosmos/error/UsageError.hxx>
+#include <cosmos/io/Pipe.hxx>
+#include <cosmos/io/StreamAdaptor.hxx>
+#include <cosmos/proc/ChildCloner.hxx>
+#include <cosmos/proc/signal.hxx>
+#include <cosmos/proc/SpawnServer.hxx>
+#include <cosmos/proc/SubProc.hxx>
+#include <cosmos/utils.hxx>
+
+// Test
+#include "TestBase.hxx"
+
+/// Allows to kill the helper process for testing.
+class TestSpawnServer :
+		public cosmos::SpawnServer {
+public:
+	void killHelper() {
+		m_helper.kill(cosmos::signal::KILL);
+	}
+};
+
+class SpawnServerTest :
+		public cosmos::TestBase {
+
+	void runTests() override {
+		m_server.start();
+		testSetup();
+		testFDInheritance();
+		testErrors();
+		testMany();
+		testHelperDied();
+		testStop();
+	}
+
+	std::string readAll(cosmos::Pipe &pipe) {
+		pipe.closeWriteEnd();
+		cosmos::InputStreamAdaptor stream{pipe};
+		std::stringstream ss;
+		ss << stream.rdbuf();
+		return ss.str();
+	}
+
+	void testSetup() {
+		START_TEST("child setup");
+
+		RUN_STEP("server-running", m_server.running());
+
+		cosmos::Pipe pipe;
+		cosmos::ChildCloner cloner{{"/bin/sh", "-c", "pwd; echo $FOO"}};
+		cloner.setCWD("/");
+		cloner.setEnv({"FOO=bar"});
+		cloner.setStdOut(pipe.writeEnd());
+
+		auto proc = m_server.spawn(cloner);
+		const auto output = readAll(pipe);
+		// the child needs to be our own child for this to work
+		auto res = proc.wait();
+
+		RUN_STEP("child-exited-successfully", res.exitedSuccessfully());
+		RUN_STEP("cwd-and-env-applied", output == "/\nbar\n");
+	}
+
+	void testFDInheritance() {
+		START_TEST("FD inheritance");
+
+		cosmos::Pipe inherited, output, output2;
+		const auto fd = cosmos::to_integral(inherited.readEnd().raw());
+		cosmos::ChildCloner cloner{{"/bin/sh", "-c",
+			std::string{"test -e /proc/self/fd/"} + std::to_string(fd) + " && echo ok"}};
+		cloner.setStdOut(output.writeEnd());
+		auto res = m_server.spawn(cloner).wait();
+
+		RUN_STEP("non-inherited-fd-missing", res.exited() && res.status == cosmos::ExitStatus{1});
+
+		cloner.setStdOut(output2.writeEnd());
+		cloner.addInheritFD(inherited.readEnd());
+		auto proc = m_server.spawn(cloner);
+		const auto text = readAll(output2);
+		res = proc.wait();
+
+		RUN_STEP("inherited-fd-keeps-number", res.exitedSuccessfully() && text == "ok\n");
+	}
+
+	void testErrors() {
+		START_TEST("error handling");
+
+		cosmos::ChildCloner cloner;
+		cloner.setExe("/_not_existing");
+		auto data = m_server.spawn(cloner).wait();
+
+		RUN_STEP("exit-status prog-not-found", data.exited() && data.status == cosmos::ExitStatus::PROG_NOT_FOUND);
+
+		cloner.setExe("true");
+		cloner.setPostForkCB([](const cosmos::ChildCloner &) {});
+
+		EXPECT_EXCEPTION("post-fork-cb-rejected", m_server.spawn(cloner));
+
+		cloner.resetPostForkCB();
+		cloner.setForwardChildErrors(true);
+
+		EXPECT_EXCEPTION("forward-child-errors-rejected", m_server.spawn(cloner));
+
+		EXPECT_EXCEPTION("missing-exe-rejected", m_server.spawn(cosmos::ChildCloner{}));
+	}
+
+	void testMany() {
+		START_TEST("many children");
+
+		cosmos::ChildCloner cloner{{"true"}};
+		std::vector<cosmos::SubProc> procs;
+		constexpr size_t NUM_CHILDREN = 50;
+
+		for (size_t num = 0; num < NUM_CHILDREN; num++) {
+			procs.push_back(m_server.spawn(cloner));
+		}
+
+		size_t successful = 0;
+
+		for (auto &proc: procs) {
+			if (proc.wait().exitedSuccessfully())
+				successful++;
+		}
+
+		RUN_STEP("all-children-succeeded", successful == NUM_CHILDREN);
+	}
+
+	void testHelperDied() {
+		START_TEST("helper died");
+
+		if (!m_server.running()) {
+			// no helper when running on Valgrind
+			return;
+		}
+
+		m_server.killHelper();
+
+		cosmos::ChildCloner cloner{{"true"}};
+		auto res = m_server.spawn(cloner).wait();
+
+		RUN_STEP("fallback-spawn-works", res.exitedSuccessfully());
+		RUN_STEP("helper-reaped", !m_server.running());
+
+		res = m_server.spawn(cloner).wait();
+
+		RUN_STEP("further-spawns-work", res.exitedSuccessfully());
+
+		m_server.start();
+
+		RUN_STEP("restart-after-death", m_server.running());
+	}
+
+	void testStop() {
+		START_TEST("stop server");
+
+		m_server.stop();
+
+		RUN_STEP("server-stopped", !m_server.running());
+
+		// spawning should still work without the helper
+		cosmos::ChildCloner cloner{{"true"}};
+		auto res = m_server.spawn(cloner).wait();
+
+		RUN_STEP("direct-spawn-works", res.exitedSuccessfully());
+	}
+
+protected:
+
+	TestSpawnServer m_server;
+};
+
+int main(const int argc, const char **argv) {
+	SpawnServerTest test;
+	return test.run(argc, argv);
+}
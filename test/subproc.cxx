@@ -841,6 +841,99 @@ public:
 	}
 };
 
+class VForkTest :
+		public cosmos::TestBase {
+public:
+	void runTests() override {
+		testSetup();
+		testFDInheritance();
+		testErrors();
+	}
+
+	std::string readAll(cosmos::Pipe &pipe) {
+		pipe.closeWriteEnd();
+		cosmos::InputStreamAdaptor stream{pipe};
+		std::stringstream ss;
+		ss << stream.rdbuf();
+		return ss.str();
+	}
+
+	void testSetup() {
+		START_TEST("vfork mode child setup");
+
+		cosmos::Pipe pipe;
+		cosmos::ChildCloner cloner{{"/bin/sh", "-c", "pwd; echo $FOO"}};
+		cloner.setUseVFork(true);
+		cloner.setCWD("/");
+		cloner.setEnv({"FOO=bar"});
+		cloner.setStdOut(pipe.writeEnd());
+
+		auto proc = cloner.run();
+		const auto output = readAll(pipe);
+		auto res = proc.wait();
+
+		RUN_STEP("child-exited-successfully", res.exitedSuccessfully());
+		RUN_STEP("cwd-and-env-applied", output == "/\nbar\n");
+	}
+
+	void testFDInheritance() {
+		START_TEST("vfork mode FD inheritance");
+
+		cosmos::Pipe leaked, inherited;
+		// a file descriptor lacking O_CLOEXEC should not leak into the child
+		leaked.readEnd().setCloseOnExec(false);
+
+		auto check_fd = [](const cosmos::FileDescriptor fd) {
+			return std::string{"test -e /proc/self/fd/"} +
+				std::to_string(cosmos::to_integral(fd.raw()));
+		};
+
+		cosmos::ChildCloner cloner{{"/bin/sh", "-c", check_fd(leaked.readEnd())}};
+		cloner.setUseVFork(true);
+		auto res = cloner.run().wait();
+
+		RUN_STEP("leaked-fd-closed", res.exited() && res.status == cosmos::ExitStatus{1});
+
+		cloner.setArgsFromView({"/bin/sh", "-c", check_fd(inherited.readEnd())});
+		cloner.addInheritFD(inherited.readEnd());
+		res = cloner.run().wait();
+
+		RUN_STEP("inherited-fd-present", res.exitedSuccessfully());
+	}
+
+	void testErrors() {
+		START_TEST("vfork mode pre-exec errors");
+
+		cosmos::ChildCloner cloner;
+		cloner.setUseVFork(true);
+		cloner.setExe("/_not_existing");
+		auto data = cloner.run().wait();
+
+		RUN_STEP("exit-status prog-not-found", data.exited() && data.status == cosmos::ExitStatus::PROG_NOT_FOUND);
+
+		cloner.setExe("/etc/fstab");
+		data = cloner.run().wait();
+
+		RUN_STEP("exit-status prog-not-executable", data.exited() && data.status == cosmos::ExitStatus::PROG_NOT_EXECUTABLE);
+
+		cloner.setForwardChildErrors(true);
+		cloner.setExe("/not/existing");
+
+		try {
+			auto proc = cloner.run();
+			RUN_STEP("run() succeeded in spite of pre-exec error", false);
+			(void)proc.wait();
+		} catch (const cosmos::ApiError &ex) {
+			RUN_STEP("pre-exec-error errno matches", ex.errnum() == cosmos::Errno::NO_ENTRY);
+		}
+
+		cloner.setExe("true");
+		cloner.setPostForkCB([](const cosmos::ChildCloner &) {});
+
+		EXPECT_EXCEPTION("post-fork-cb-rejected", cloner.run());
+	}
+};
+
 template <typename T>
 void runTest(const int argc, const char **argv) {
 	T test;
@@ -863,6 +956,7 @@ int main(const int argc, const char **argv) {
 		runTest<RedirectNonStdTest>(argc, argv);
 		runTest<WaitTest>(argc, argv);
 		runTest<PreExecErrorTest>(argc, argv);
+		runTest<VForkTest>(argc, argv);
 		return 0;
 	} catch (const cosmos::CosmosError &ex) {
 		std::cerr << ex.what() << std::endl;
@@ -2,13 +2,19 @@
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <climits>
+#include <optional>
 
 // cosmos
 #include <cosmos/cosmos.hxx>
 #include <cosmos/error/UsageError.hxx>
+#include <cosmos/proc/Mapping.hxx>
+#include <cosmos/proc/limits.hxx>
 #include <cosmos/proc/prctl.hxx>
+#include <cosmos/proc/process.hxx>
 #include <cosmos/thread/Mutex.hxx>
 #include <cosmos/thread/PosixThread.hxx>
+#include <cosmos/thread/ThreadAttributes.hxx>
 #include <cosmos/thread/pthread.hxx>
 #include <cosmos/thread/thread.hxx>
 #include <cosmos/time/Clock.hxx>
@@ -31,6 +37,7 @@ class ThreadTest :
 		tryJoinTest();
 		timedJoinTest();
 		detachedTest();
+		attributesTest();
 	}
 
 protected: // functions
@@ -145,6 +152,95 @@ protected: // functions
 		RUN_STEP("detached-was-still-running", m_was_running);
 	}
 
+	void attributesTest() {
+		START_TEST("thread attributes");
+		constexpr size_t STACK_SIZE = 64 * 1024;
+
+		auto get_stack = [](void *&addr, size_t &size) {
+			pthread_attr_t attr;
+			::pthread_getattr_np(::pthread_self(), &attr);
+			::pthread_attr_getstack(&attr, &addr, &size);
+			::pthread_attr_destroy(&attr);
+		};
+
+		{
+			void *addr = nullptr;
+			size_t size = 0;
+			cosmos::PosixThread thread{[&]() { get_stack(addr, size); },
+				cosmos::ThreadAttributes{}.setStackSize(STACK_SIZE).setGuardSize(0)};
+			thread.join();
+			RUN_STEP("small-stack-size", size >= STACK_SIZE && size < 2 * STACK_SIZE);
+		}
+
+		{
+			cosmos::Mapping mapping{STACK_SIZE, cosmos::mem::MapSettings{
+				cosmos::mem::MapType::PRIVATE,
+				cosmos::mem::AccessFlags{cosmos::mem::AccessFlag::READ, cosmos::mem::AccessFlag::WRITE},
+				cosmos::mem::MapFlags{cosmos::mem::MapFlag::ANONYMOUS, cosmos::mem::MapFlag::STACK}
+			}};
+			void *addr = nullptr;
+			size_t size = 0;
+			cosmos::ThreadAttributes attrs;
+			attrs.setStack(mapping);
+			cosmos::PosixThread thread{[&]() { get_stack(addr, size); }, attrs, "own-stack"};
+			thread.join();
+			RUN_STEP("caller-provided-stack", addr == mapping.addr() && size == STACK_SIZE);
+		}
+
+		// locking the stack plus surrounding pages fails with the
+		// small RLIMIT_MEMLOCK found in many containers
+		if (const auto memlock = cosmos::proc::get_limit(cosmos::LimitType::MEMLOCK).getSoftLimit();
+				memlock != RLIM_INFINITY && memlock < 4 * STACK_SIZE) {
+			std::cerr << "RLIMIT_MEMLOCK is too small for a prefaulted stack, skipping\n";
+		} else {
+			bool was_running = false;
+			cosmos::PosixThread thread{[&]() { was_running = true; },
+				cosmos::ThreadAttributes{}.setStackSize(STACK_SIZE).setPrefaultStack(true)};
+			thread.join();
+			RUN_STEP("prefaulted-stack", was_running);
+		}
+
+		{
+			const auto cpus = cosmos::proc::get_affinity();
+			unsigned first = 0;
+			while (!cpus.isSet(first))
+				first++;
+			cosmos::CPUSet single;
+			single.set(first);
+			unsigned ran_on = UINT_MAX;
+			cosmos::PosixThread thread{[&]() { ran_on = cosmos::proc::get_current_cpu(); },
+				cosmos::ThreadAttributes{}.setAffinity(single)};
+			thread.join();
+			RUN_STEP("initial-affinity", ran_on == first);
+		}
+
+		{
+			cosmos::BatchSchedulerSettings batch;
+			std::optional<cosmos::SchedulerPolicy> policy;
+			cosmos::PosixThread thread{[&]() {
+					policy = std::visit([](auto &&settings) {
+						return settings.policy();
+					}, cosmos::get_scheduler_settings());
+				},
+				cosmos::ThreadAttributes{}.setSchedulerSettings(batch)};
+			thread.join();
+			RUN_STEP("initial-scheduler-settings", policy == cosmos::SchedulerPolicy::BATCH);
+		}
+
+		{
+			bool was_running = false;
+			cosmos::FifoSchedulerSettings bad_prio;
+			bad_prio.setPriority(1000);
+			EXPECT_EXCEPTION("bad-scheduler-settings-throw",
+				cosmos::PosixThread([&]() { was_running = true; },
+					cosmos::ThreadAttributes{}.setSchedulerSettings(bad_prio)));
+			EXPECT_EXCEPTION("bad-stack-size-throws",
+				cosmos::PosixThread([&]() { was_running = true; },
+					cosmos::ThreadAttributes{}.setStackSize(1)));
+			RUN_STEP("entry-not-run", !was_running);
+		}
+	}
+
 	ExitValue simpleEntry(ThreadArg arg) {
 		m_was_running = true;
 
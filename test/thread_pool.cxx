@@ -0,0 +1,204 @@
+// C++
+#include <array>
+#include <atomic>
+#include <optional>
+#include <string>
+
+// cosmos
+#include <cosmos/error/UsageError.hxx>
+#include <cosmos/proc/process.hxx>
+#include <cosmos/thread/ThreadPool.hxx>
+#include <cosmos/thread/thread.hxx>
+
+// Test
+#include "TestBase.hxx"
+
+class ThreadPoolTest :
+		public cosmos::TestBase {
+
+	void runTests() override {
+		testBasics();
+		testRecursive();
+		testLargeTasks();
+		testWorkerInfo();
+		testDestruction();
+	}
+
+	void testBasics() {
+		START_TEST("basic submission");
+		cosmos::ThreadPool pool{cosmos::ThreadPool::Settings{.workers = 4}};
+
+		RUN_STEP("num-workers", pool.numWorkers() == 4);
+		RUN_STEP("no-current-worker", !pool.currentWorker());
+
+		std::atomic<size_t> counter{0};
+		constexpr size_t NUM_TASKS = 10000;
+
+		for (size_t i = 0; i < NUM_TASKS; i++) {
+			pool.submit([&counter]() { counter++; });
+		}
+
+		pool.waitIdle();
+		RUN_STEP("all-tasks-run", counter == NUM_TASKS);
+
+		// idle without any tasks must return immediately
+		pool.waitIdle();
+
+		for (size_t i = 0; i < NUM_TASKS; i++) {
+			pool.submit([&counter]() { counter++; });
+		}
+
+		pool.waitIdle();
+		RUN_STEP("all-tasks-run-again", counter == 2 * NUM_TASKS);
+	}
+
+	/// Splits a range recursively into tasks, exercising the local deques.
+	void split(cosmos::ThreadPool &pool, std::atomic<size_t> &sum,
+			const size_t start, const size_t end) {
+		if (end - start <= 16) {
+			size_t local = 0;
+			for (auto i = start; i < end; i++)
+				local += i;
+			sum += local;
+			return;
+		}
+
+		const auto mid = start + (end - start) / 2;
+
+		pool.submit([this, &pool, &sum, start, mid]() { split(pool, sum, start, mid); });
+		pool.submit([this, &pool, &sum, mid, end]() { split(pool, sum, mid, end); });
+	}
+
+	void testRecursive() {
+		START_TEST("recursive submission");
+		cosmos::ThreadPool pool{cosmos::ThreadPool::Settings{.workers = 4}};
+		std::atomic<size_t> sum{0};
+		constexpr size_t END = 100000;
+
+		pool.submit([this, &pool, &sum]() { split(pool, sum, 0, END); });
+		pool.waitIdle();
+
+		RUN_STEP("sum-matches", sum == END * (END - 1) / 2);
+	}
+
+	void testLargeTasks() {
+		START_TEST("large tasks");
+		cosmos::ThreadPool pool{cosmos::ThreadPool::Settings{.workers = 2}};
+		std::atomic<size_t> sum{0};
+		std::array<size_t, 32> values;
+
+		for (size_t i = 0; i < values.size(); i++) {
+			values[i] = i;
+		}
+
+		// neither trivially copyable nor small enough to be stored inline
+		const std::string label{"some label that does not fit into SSO"};
+
+		for (size_t i = 0; i < 100; i++) {
+			pool.submit([&sum, values, label]() {
+				for (auto value: values) {
+					sum += value;
+				}
+				sum += label.size();
+			});
+		}
+
+		pool.waitIdle();
+		RUN_STEP("sum-matches", sum == 100 * (31 * 32 / 2 + label.size()));
+
+		std::atomic<bool> ran{false};
+		pool.submit([&ran]() {
+			ran = true;
+			throw cosmos::UsageError{"task failure"};
+		});
+		pool.waitIdle();
+		RUN_STEP("throwing-task-ran", ran.load());
+
+		// non std::exception types must not escape the worker either
+		pool.submit([]() {
+			throw 42;
+		});
+		pool.waitIdle();
+		RUN_STEP("foreign-exception-handled", true);
+	}
+
+	void testWorkerInfo() {
+		START_TEST("worker info");
+		cosmos::ThreadPool pool{cosmos::ThreadPool::Settings{
+			.workers = 3, .name = "tpool", .pin_cpus = true}};
+		std::array<std::optional<size_t>, 3> indices;
+		std::atomic<size_t> done{0};
+
+		// a task running in one worker can't tell which worker will run
+		// which task, so collect results from many tasks per worker.
+		for (size_t i = 0; i < 300; i++) {
+			pool.submit([&]() {
+				const auto index = pool.currentWorker();
+				if (index && *index < indices.size()) {
+					indices[*index] = index;
+				}
+				done++;
+			});
+		}
+
+		pool.waitIdle();
+		RUN_STEP("tasks-done", done == 300);
+
+		std::atomic<bool> name_ok{false};
+		pool.submit([&]() {
+			const auto name = cosmos::thread::get_name();
+			const auto index = pool.currentWorker();
+			name_ok = index && name == "tpool" + std::to_string(*index);
+		});
+		pool.waitIdle();
+		RUN_STEP("worker-name", name_ok.load());
+
+		bool saw_index = false;
+		for (const auto &index: indices) {
+			saw_index = saw_index || index.has_value();
+		}
+		RUN_STEP("saw-worker-index", saw_index);
+
+		std::atomic<bool> wait_throws{false};
+		pool.submit([&]() {
+			try {
+				pool.waitIdle();
+			} catch (const cosmos::UsageError &) {
+				wait_throws = true;
+			}
+		});
+		pool.waitIdle();
+		RUN_STEP("wait-idle-in-task-throws", wait_throws.load());
+	}
+
+	void testDestruction() {
+		START_TEST("destruction");
+		std::atomic<size_t> counter{0};
+		constexpr size_t NUM_TASKS = 5000;
+
+		{
+			cosmos::ThreadPool pool{cosmos::ThreadPool::Settings{.workers = 3}};
+
+			for (size_t i = 0; i < NUM_TASKS; i++) {
+				pool.submit([&pool, &counter]() {
+					counter++;
+					// follow-up tasks submitted during shutdown
+					pool.submit([&counter]() { counter++; });
+				});
+			}
+		}
+
+		RUN_STEP("pending-tasks-drained", counter == 2 * NUM_TASKS);
+
+		{
+			// a default pool without any work
+			cosmos::ThreadPool pool;
+			RUN_STEP("default-workers", pool.numWorkers() == cosmos::proc::get_affinity().cpus().size());
+		}
+	}
+};
+
+int main(const int argc, const char **argv) {
+	ThreadPoolTest test;
+	return test.run(argc, argv);
+}
@@ -1,8 +1,12 @@
 // C++
 #include <iostream>
+#include <new>
 
 // Cosmos
 #include <cosmos/cosmos.hxx>
+#include <cosmos/io/MemFile.hxx>
+#include <cosmos/proc/Mapping.hxx>
+#include <cosmos/proc/process.hxx>
 #include <cosmos/thread/Mutex.hxx>
 #include <cosmos/thread/Condition.hxx>
 #include <cosmos/time/Clock.hxx>
@@ -10,10 +14,28 @@
 // Test
 #include "TestBase.hxx"
 
+namespace {
+
+/// Data placed in shared memory for the robust mutex test.
+struct SharedData {
+	cosmos::ConditionMutex cond_mutex{cosmos::Mutex::Options{
+		cosmos::Mutex::Option::ROBUST,
+		cosmos::Mutex::Option::PROCESS_SHARED}};
+	size_t counter = 0;
+};
+
+} // end anon ns
+
 class ThreadPrimTest :
 		public cosmos::TestBase {
 
 	void runTests() override {
+		testBasics();
+		testPrioInherit();
+		testRobustShared();
+	}
+
+	void testBasics() {
 		START_TEST("thread primitives");
 		/*
 		 * lacking actual threads yet this is a bit of a over
@@ -45,6 +67,63 @@ class ThreadPrimTest :
 		// be generous with the upper limit
 		RUN_STEP("returned-from-wait-in-time", time_spent.getSeconds() <= 60);
 	}
+
+	void testPrioInherit() {
+		START_TEST("priority inheritance");
+		cosmos::ConditionMutex condmux{cosmos::Mutex::Option::PRIO_INHERIT};
+
+		RUN_STEP("has-option", condmux.options()[cosmos::Mutex::Option::PRIO_INHERIT]);
+
+		condmux.lock();
+		condmux.signal();
+		auto wait_res = condmux.waitTimed(cosmos::MonotonicClock{}.now());
+		RUN_STEP("pi-wait-timed-out", wait_res == cosmos::Condition::WaitTimedRes::TIMED_OUT);
+		condmux.unlock();
+	}
+
+	void testRobustShared() {
+		START_TEST("robust process shared");
+		cosmos::MemFile file{"robust-mutex-test"};
+		file.truncate(sizeof(SharedData));
+
+		cosmos::Mapping mapping{sizeof(SharedData), cosmos::mem::MapSettings{
+			cosmos::mem::MapType::SHARED,
+			cosmos::mem::AccessFlags{cosmos::mem::AccessFlag::READ, cosmos::mem::AccessFlag::WRITE},
+			cosmos::mem::MapFlags{},
+			0,
+			file.fd()
+		}};
+
+		auto data = new (mapping.addr()) SharedData{};
+		auto &cm = data->cond_mutex;
+
+		RUN_STEP("regular-lock", cm.lockRobust() == cosmos::Mutex::LockResult::ACQUIRED);
+		cm.unlock();
+
+		auto child = cosmos::proc::fork();
+
+		if (!child) {
+			// die while holding the lock
+			(void)cm.lockRobust();
+			data->counter++;
+			cosmos::proc::exit(cosmos::ExitStatus::SUCCESS);
+		}
+
+		const auto res = cosmos::proc::wait(*child);
+		RUN_STEP("child-exited", res && res->exitedSuccessfully());
+
+		RUN_STEP("owner-died", cm.lockRobust() == cosmos::Mutex::LockResult::OWNER_DIED);
+		RUN_STEP("child-modified-data", data->counter == 1);
+		cm.makeConsistent();
+		cm.unlock();
+
+		RUN_STEP("recovered", cm.lockRobust() == cosmos::Mutex::LockResult::ACQUIRED);
+		auto wait_res = cm.waitTimed(cosmos::MonotonicClock{}.now());
+		RUN_STEP("shared-wait-timed-out", wait_res == cosmos::Condition::WaitTimedRes::TIMED_OUT);
+		cm.unlock();
+
+		data->~SharedData();
+	}
 };
 
 int main(const int argc, const char **argv) {
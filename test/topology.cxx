@@ -0,0 +1,165 @@
+// C++
+#include <iostream>
+#include <string>
+
+// cosmos
+#include <cosmos/error/RuntimeError.hxx>
+#include <cosmos/error/UsageError.hxx>
+#include <cosmos/fs/File.hxx>
+#include <cosmos/fs/filesystem.hxx>
+#include <cosmos/fs/TempDir.hxx>
+#include <cosmos/proc/CPUSet.hxx>
+#include <cosmos/proc/process.hxx>
+#include <cosmos/proc/Topology.hxx>
+
+// Test
+#include "TestBase.hxx"
+
+using Topology = cosmos::Topology;
+using CPUSet = cosmos::CPUSet;
+
+class TopologyTest :
+		public cosmos::TestBase {
+
+	void runTests() override {
+		testCPUList();
+		testFakeSysfs();
+		testSystem();
+	}
+
+	void testCPUList() {
+		START_TEST("CPU list format");
+		RUN_STEP("parse-ranges", CPUSet::fromList("0-2,5,7-8\n") == CPUSet({0, 1, 2, 5, 7, 8}));
+		RUN_STEP("parse-empty", CPUSet::fromList("").empty());
+		RUN_STEP("format-ranges", CPUSet({0, 1, 2, 5, 7, 8}).toList() == "0-2,5,7-8");
+		RUN_STEP("format-empty", CPUSet{}.toList().empty());
+		RUN_STEP("difference", (CPUSet({0, 1, 2}) - CPUSet({1, 5})) == CPUSet({0, 2}));
+		EXPECT_EXCEPTION("bad-list", CPUSet::fromList("0-x"));
+		EXPECT_EXCEPTION("bad-range", CPUSet::fromList("3-1"));
+	}
+
+	void writeAttr(const std::string &path, const std::string &value) {
+		cosmos::fs::make_all_dirs(path.substr(0, path.rfind('/')), cosmos::FileMode{cosmos::ModeT{0755}});
+		cosmos::File file{path, cosmos::OpenMode::WRITE_ONLY,
+				{cosmos::OpenFlag::CREATE, cosmos::OpenFlag::CLOEXEC},
+				cosmos::FileMode{cosmos::ModeT{0644}}};
+		file.writeAll(value + "\n");
+	}
+
+	/*
+	 * Two packages with two cores each, two hardware threads per core.
+	 * CPU 7 is offline. Each core has its own L1, each package a shared
+	 * L3. Each package forms a NUMA node.
+	 */
+	void createFakeSysfs(const std::string &root) {
+		const auto cpu = root + "/cpu";
+		writeAttr(cpu + "/online", "0-6");
+		writeAttr(cpu + "/isolated", "6");
+		writeAttr(cpu + "/nohz_full", "(null)");
+
+		for (unsigned nr = 0; nr < 8; nr++) {
+			const auto base = cpu + "/cpu" + std::to_string(nr);
+			const auto package = nr / 4;
+			const auto core = (nr % 4) / 2;
+			const auto siblings = std::to_string(nr & ~1U) + "-" + std::to_string(nr | 1U);
+			const auto package_cpus = std::to_string(package * 4) + "-" + std::to_string(package * 4 + 3);
+
+			writeAttr(base + "/topology/physical_package_id", std::to_string(package));
+			writeAttr(base + "/topology/core_id", std::to_string(core));
+			writeAttr(base + "/topology/thread_siblings_list", siblings);
+			writeAttr(base + "/topology/core_siblings_list", package_cpus);
+
+			writeAttr(base + "/cache/index0/level", "1");
+			writeAttr(base + "/cache/index0/type", "Data");
+			writeAttr(base + "/cache/index0/size", "48K");
+			writeAttr(base + "/cache/index0/coherency_line_size", "64");
+			writeAttr(base + "/cache/index0/ways_of_associativity", "12");
+			writeAttr(base + "/cache/index0/shared_cpu_list", siblings);
+
+			writeAttr(base + "/cache/index1/level", "3");
+			writeAttr(base + "/cache/index1/type", "Unified");
+			writeAttr(base + "/cache/index1/size", "32M");
+			writeAttr(base + "/cache/index1/shared_cpu_list", package_cpus);
+		}
+
+		const auto node = root + "/node";
+		writeAttr(node + "/online", "0-1");
+		writeAttr(node + "/node0/cpulist", "0-3");
+		writeAttr(node + "/node0/distance", "10 21");
+		writeAttr(node + "/node1/cpulist", "4-7");
+		writeAttr(node + "/node1/distance", "21 10");
+	}
+
+	void testFakeSysfs() {
+		START_TEST("fake sysfs");
+		auto tmp = getTempDir();
+		createFakeSysfs(tmp.path());
+
+		const Topology topo{tmp.path()};
+
+		RUN_STEP("online", topo.online() == CPUSet::fromList("0-6"));
+		RUN_STEP("isolated", topo.isolated() == CPUSet{6});
+		RUN_STEP("nohz-full-unused", topo.nohzFull().empty());
+		RUN_STEP("housekeeping", topo.housekeeping() == CPUSet::fromList("0-5"));
+		RUN_STEP("num-cpus", topo.cpus().size() == 7);
+
+		const auto &cpu5 = topo.cpu(5);
+		RUN_STEP("cpu-ids", cpu5.package == 1 && cpu5.core == 0 && cpu5.node == 1U);
+		RUN_STEP("smt-siblings", cpu5.smt_siblings == CPUSet({4, 5}));
+		RUN_STEP("offline-sibling-dropped", topo.cpu(6).smt_siblings == CPUSet{6});
+		RUN_STEP("package-cpus", cpu5.package_cpus == CPUSet({4, 5, 6}));
+		EXPECT_EXCEPTION("offline-cpu", topo.cpu(7));
+
+		// 4 L1 caches (one per core) and 2 L3 caches
+		RUN_STEP("distinct-caches", topo.caches().size() == 6);
+		const auto &l1 = topo.caches()[cpu5.caches[0]];
+		RUN_STEP("cache-info", l1.level == 1 && l1.type == Topology::CacheType::DATA &&
+				l1.size == 48 * 1024 && l1.line_size == 64 && l1.ways == 12);
+		RUN_STEP("l3-shared", topo.cacheSharers(1, 3) == CPUSet::fromList("0-3"));
+		RUN_STEP("unknown-level", topo.cacheSharers(1, 2).empty());
+
+		RUN_STEP("primary-threads", topo.primaryThreads() == CPUSet({0, 2, 4, 6}));
+
+		RUN_STEP("num-nodes", topo.nodes().size() == 2);
+		RUN_STEP("node-cpus", topo.nodes()[1].cpus == CPUSet::fromList("4-6"));
+		RUN_STEP("local-distance", topo.distance(0, 0) == 10U);
+		RUN_STEP("remote-distance", topo.distance(1, 0) == 21U);
+		RUN_STEP("unknown-node", !topo.distance(0, 2));
+
+		EXPECT_EXCEPTION("bad-root", Topology{tmp.path() + "/missing"});
+	}
+
+	void testSystem() {
+		START_TEST("system topology");
+		const Topology topo;
+
+		std::cout << "online CPUs: " << topo.online().toList() << "\n";
+		std::cout << "primary threads: " << topo.primaryThreads().toList() << "\n";
+		std::cout << "caches: " << topo.caches().size() << ", NUMA nodes: " << topo.nodes().size() << "\n";
+
+		RUN_STEP("have-online-cpus", !topo.online().empty());
+		RUN_STEP("affinity-within-online", (cosmos::proc::get_affinity() - topo.online()).empty());
+		RUN_STEP("cpu-per-online", topo.cpus().size() == topo.online().count());
+		RUN_STEP("current-cpu-known", topo.cpu(cosmos::proc::get_current_cpu()).nr == cosmos::proc::get_current_cpu());
+
+		bool siblings_consistent = true;
+		for (const auto &cpu: topo.cpus()) {
+			for (const auto sibling: cpu.smt_siblings.cpus()) {
+				if (!topo.cpu(sibling).smt_siblings.isSet(cpu.nr))
+					siblings_consistent = false;
+			}
+		}
+
+		RUN_STEP("siblings-consistent", siblings_consistent);
+		RUN_STEP("primary-threads-nonempty", !topo.primaryThreads().empty());
+
+		for (const auto &node: topo.nodes()) {
+			RUN_STEP("node-distance-complete", node.distances.size() == topo.nodes().size());
+		}
+	}
+};
+
+int main(const int argc, const char **argv) {
+	TopologyTest test;
+	return test.run(argc, argv);
+}
@@ -0,0 +1,158 @@
+// C++
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+// Linux
+#include <limits.h>
+#include <unistd.h>
+
+// cosmos
+#include <cosmos/error/ApiError.hxx>
+#include <cosmos/io/Pipe.hxx>
+#include <cosmos/proc/Mapping.hxx>
+#include <cosmos/proc/mman.hxx>
+#include <cosmos/proc/process.hxx>
+#include <cosmos/proc/Tracee.hxx>
+
+// Test
+#include "TestBase.hxx"
+
+namespace {
+
+char g_data[] = "some data in the tracee's memory";
+char g_target[] = "to be overwritten";
+
+} // end anon ns
+
+class TraceeTest :
+		public cosmos::TestBase {
+
+	void runTests() override {
+		setupMemory();
+		testMemory();
+	}
+
+	/// Sets up a mapping of three pages followed by an inaccessible guard page.
+	void setupMemory() {
+		m_page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+		m_mapping = cosmos::Mapping{4 * m_page_size, cosmos::mem::MapSettings{
+			cosmos::mem::MapType::PRIVATE,
+			cosmos::mem::AccessFlags{cosmos::mem::AccessFlag::READ, cosmos::mem::AccessFlag::WRITE},
+			cosmos::mem::MapFlags{cosmos::mem::MapFlag::ANONYMOUS}
+		}};
+
+		m_pages = reinterpret_cast<char*>(m_mapping.addr());
+		m_guard = m_pages + 3 * m_page_size;
+
+		// a string spanning all three pages, ending right before the guard page
+		std::memset(m_pages, 'x', 3 * m_page_size - 1);
+		m_guard[-1] = '\0';
+
+		// a read-only page to test writes via /proc/<pid>/mem
+		m_pages[0] = 'r';
+		cosmos::mem::protect(m_guard, m_page_size, cosmos::mem::AccessFlags{});
+	}
+
+	void protectFirstPage() {
+		cosmos::mem::protect(m_pages, m_page_size, cosmos::mem::AccessFlags{cosmos::mem::AccessFlag::READ});
+	}
+
+	void testMemory() {
+		START_TEST("tracee memory access");
+		cosmos::Pipe pipe;
+		protectFirstPage();
+
+		auto child = cosmos::proc::fork();
+
+		if (!child) {
+			// wait for the parent to be done
+			pipe.closeWriteEnd();
+			char ch;
+			(void)::read(cosmos::to_integral(pipe.readEnd().raw()), &ch, 1);
+
+			const bool good = std::string_view{g_target} == "overwritten data!" &&
+				m_pages[0] == 'w';
+			cosmos::proc::exit(good ? cosmos::ExitStatus::SUCCESS : cosmos::ExitStatus::FAILURE);
+		}
+
+		pipe.closeReadEnd();
+		cosmos::Tracee tracee{*child};
+
+		try {
+			checkReads(tracee);
+			checkWrites(tracee);
+		} catch (...) {
+			pipe.closeWriteEnd();
+			cosmos::proc::wait(*child);
+			throw;
+		}
+
+		pipe.closeWriteEnd();
+		const auto res = cosmos::proc::wait(*child);
+		RUN_STEP("child-sees-writes", res && res->exitedSuccessfully());
+	}
+
+	void checkReads(cosmos::Tracee &tracee) {
+		std::string buf(sizeof(g_data) - 1, '\0');
+		RUN_STEP("read-block", tracee.readMemory(g_data, buf.data(), buf.size()) == buf.size() &&
+				buf == g_data);
+
+		std::string first(4, '\0'), second(5, '\0');
+		cosmos::ReadIOVector iovec;
+		iovec.emplace_back(first);
+		iovec.emplace_back(second);
+		const auto bytes = tracee.readMemory(g_data, iovec);
+		RUN_STEP("scatter-read", bytes == 9 && first == "some" && second == " data" &&
+				iovec.leftBytes() == 0);
+
+		// more entries than the kernel accepts in a single system call
+		std::string many(2 * IOV_MAX + 1, '\0');
+		cosmos::ReadIOVector many_vec;
+		for (auto &ch: many) {
+			many_vec.emplace_back(&ch, 1);
+		}
+		RUN_STEP("read-more-than-iov-max", tracee.readMemory(m_pages + 1, many_vec) == many.size() &&
+				many == std::string(many.size(), 'x'));
+
+		RUN_STEP("read-string", tracee.readString(g_data) == g_data);
+
+		const auto long_str = tracee.readString(m_pages + 1, 4 * m_page_size);
+		RUN_STEP("read-multi-page-string", long_str.size() == 3 * m_page_size - 2 &&
+				long_str == std::string(3 * m_page_size - 2, 'x'));
+		RUN_STEP("read-string-truncated", tracee.readString(m_pages + 1, 10) == std::string(10, 'x'));
+
+		std::string partial(m_page_size, '\0');
+		RUN_STEP("partial-read", tracee.readMemory(m_guard - 100, partial.data(), partial.size()) == 100);
+
+		EXPECT_EXCEPTION("read-unmapped", tracee.readMemory(m_guard, partial.data(), partial.size()));
+	}
+
+	void checkWrites(cosmos::Tracee &tracee) {
+		const std::string_view data{"overwritten data!"};
+		RUN_STEP("write-block", tracee.writeMemory(g_target, data.data(), data.size() + 1) == data.size() + 1);
+
+		// this is a read-only page, requiring the /proc/<pid>/mem fallback
+		const char ch = 'w';
+		RUN_STEP("write-read-only", tracee.writeMemory(m_pages, &ch, 1) == 1);
+
+		// the low address range is never mapped. Note that the guard page
+		// can't be used here, since /proc/<pid>/mem is even able to
+		// write to PROT_NONE pages.
+		auto unmapped = reinterpret_cast<void*>(m_page_size);
+		EXPECT_EXCEPTION("write-unmapped", tracee.writeMemory(unmapped, &ch, 1));
+	}
+
+protected: // data
+
+	size_t m_page_size = 0;
+	cosmos::Mapping m_mapping;
+	char *m_pages = nullptr;
+	char *m_guard = nullptr;
+};
+
+int main(const int argc, const char **argv) {
+	TraceeTest test;
+	return test.run(argc, argv);
+}
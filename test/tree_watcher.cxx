@@ -0,0 +1,165 @@
+// C++
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+// cosmos
+#include <cosmos/fs/File.hxx>
+#include <cosmos/fs/filesystem.hxx>
+#include <cosmos/fs/TempDir.hxx>
+#include <cosmos/fs/TreeWatcher.hxx>
+#include <cosmos/time/time.hxx>
+
+// Test
+#include "TestBase.hxx"
+
+using namespace std::chrono_literals;
+
+class TreeWatcherTest :
+		public cosmos::TestBase {
+
+	using TreeWatcher = cosmos::TreeWatcher;
+	using EventType = TreeWatcher::EventType;
+
+	void runTests() override {
+		testTreeTracking();
+		testCoalescing();
+		testRescan();
+	}
+
+	static void makeDir(const std::string &path) {
+		cosmos::fs::make_dir(path, cosmos::FileMode{cosmos::ModeT{0700}});
+	}
+
+	static void writeFile(const std::string &path) {
+		cosmos::File f{path, cosmos::OpenMode::WRITE_ONLY,
+			{cosmos::OpenFlag::CREATE, cosmos::OpenFlag::TRUNCATE},
+			cosmos::FileMode{cosmos::ModeT{0600}}};
+		f.writeAll(std::string_view{"data"});
+	}
+
+	static const TreeWatcher::Change* findChange(
+			const TreeWatcher::ChangeList &changes, const std::string &path) {
+		auto it = std::find_if(changes.begin(), changes.end(),
+				[&path](const TreeWatcher::Change &change) {
+					return change.path == path;
+				});
+
+		return it == changes.end() ? nullptr : &(*it);
+	}
+
+	void testTreeTracking() {
+		START_TEST("tree tracking");
+		auto tmp = getTempDir();
+		const auto &root = tmp.path();
+		makeDir(root + "/a");
+		makeDir(root + "/a/b");
+
+		TreeWatcher watcher{{EventType::CREATE, EventType::CLOSE_WRITE, EventType::DELETE}};
+		watcher.addTree(root);
+
+		RUN_STEP("initial-watches", watcher.numWatches() == 3);
+
+		makeDir(root + "/c");
+		writeFile(root + "/c/f");
+		watcher.readEvents();
+		/* the subdir may have been scanned before or after `f` was
+		 * written, either way it must only be reported once */
+		auto changes = watcher.takeChanges(true);
+
+		RUN_STEP("new-subdir-watched", watcher.numWatches() == 4);
+
+		auto change = findChange(changes, root + "/c");
+		RUN_STEP("subdir-created", change && change->is_dir && change->events[EventType::CREATE]);
+		change = findChange(changes, root + "/c/f");
+		RUN_STEP("file-in-new-subdir", change && !change->is_dir && change->events[EventType::CREATE]);
+		RUN_STEP("coalesced-per-path", std::count_if(changes.begin(), changes.end(),
+				[&root](const auto &c) { return c.path == root + "/c/f"; }) == 1);
+
+		cosmos::fs::rename(root + "/c", root + "/a/c2");
+		watcher.readEvents();
+		watcher.takeChanges(true);
+
+		RUN_STEP("rename-keeps-watch", watcher.numWatches() == 4);
+
+		writeFile(root + "/a/c2/g");
+		watcher.readEvents();
+		changes = watcher.takeChanges(true);
+
+		RUN_STEP("renamed-path-reported", findChange(changes, root + "/a/c2/g") != nullptr);
+
+		auto outside = getTempDir();
+		cosmos::fs::rename(root + "/a/b", outside.path() + "/b");
+		watcher.readEvents();
+
+		RUN_STEP("moved-out-dropped", watcher.numWatches() == 3);
+
+		writeFile(outside.path() + "/b/h");
+		watcher.readEvents();
+		changes = watcher.takeChanges(true);
+
+		RUN_STEP("moved-out-not-reported", findChange(changes, root + "/a/b/h") == nullptr);
+
+		cosmos::fs::remove_tree(root + "/a/c2");
+		watcher.readEvents();
+		changes = watcher.takeChanges(true);
+
+		RUN_STEP("deleted-dir-dropped", watcher.numWatches() == 2);
+		change = findChange(changes, root + "/a/c2");
+		RUN_STEP("deleted-dir-reported", change && change->events[EventType::DELETE]);
+	}
+
+	void testCoalescing() {
+		START_TEST("coalescing window");
+		auto tmp = getTempDir();
+		const auto &root = tmp.path();
+
+		TreeWatcher watcher{{EventType::CLOSE_WRITE, EventType::MODIFY},
+			cosmos::IntervalTime{200ms}};
+		watcher.addTree(root);
+
+		RUN_STEP("no-timeout-if-idle", !watcher.nextTimeout());
+
+		writeFile(root + "/f");
+		writeFile(root + "/f");
+		watcher.readEvents();
+
+		RUN_STEP("pending-after-events", watcher.hasPending());
+		RUN_STEP("timeout-while-pending", watcher.nextTimeout() &&
+				cosmos::IntervalTime{0} < *watcher.nextTimeout());
+		RUN_STEP("not-yet-due", watcher.takeChanges().empty());
+
+		cosmos::time::sleep(250ms);
+
+		auto changes = watcher.takeChanges();
+
+		RUN_STEP("single-change-when-due", changes.size() == 1);
+		RUN_STEP("merged-event-types", changes.size() == 1 &&
+				changes[0].events[EventType::CLOSE_WRITE] &&
+				changes[0].events[EventType::MODIFY]);
+		RUN_STEP("no-pending-after-take", !watcher.hasPending());
+	}
+
+	void testRescan() {
+		START_TEST("rescan on overload");
+		auto tmp = getTempDir();
+		const auto &root = tmp.path();
+
+		TreeWatcher watcher{{EventType::CLOSE_WRITE}, cosmos::IntervalTime{0}, 2};
+		watcher.addTree(root);
+
+		for (auto name: {"1", "2", "3", "4"}) {
+			writeFile(root + "/" + name);
+		}
+
+		watcher.readEvents();
+		auto changes = watcher.takeChanges();
+
+		RUN_STEP("rescan-reported", !changes.empty() && changes[0].rescan && changes[0].path == root);
+	}
+};
+
+int main(const int argc, const char **argv) {
+	TreeWatcherTest test;
+	return test.run(argc, argv);
+}